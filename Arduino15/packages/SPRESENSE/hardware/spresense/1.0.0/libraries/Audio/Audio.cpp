@@ -23,6 +23,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <nuttx/init.h>
 #include <nuttx/arch.h>
@@ -31,6 +32,7 @@
 #include <arch/board/board.h>
 
 #include "Audio.h"
+#include "AudioFileSink.h"
 #include "MemoryUtil.h"
 
 #include <File.h>
@@ -1452,37 +1454,40 @@ err_t AudioClass::writeWavHeader(File& myFile)
 /*--------------------------------------------------------------------------*/
 err_t AudioClass::readFrames(File& myFile)
 {
-  if (!m_recorder_simple_fifo_buf)
+  AudioFifoSpan span;
+
+  /* Write from the FIFO buffer directly. */
+
+  err_t rst = peekFrames(&span);
+  if (rst != AUDIOLIB_ECODE_OK)
     {
-      print_err("ERROR: FIFO area is not allocated.\n");
-      return AUDIOLIB_ECODE_SIMPLEFIFO_ERROR;
+      return rst;
     }
 
-  size_t data_size = CMN_SimpleFifoGetOccupiedSize(&m_recorder_simple_fifo_handle);
-  print_dbg("dsize = %d\n", data_size);
+  print_dbg("dsize = %d\n", span.size1 + span.size2);
 
-  while (data_size > 0)
+  if (span.size1 > 0)
     {
-      int size = (data_size > FIFO_FRAME_SIZE) ? FIFO_FRAME_SIZE : data_size;
-
-      if (CMN_SimpleFifoPoll(&m_recorder_simple_fifo_handle, (void*)m_es_recorder_buf, size) == 0)
+      int ret = myFile.write(span.data1, span.size1);
+      if (ret < 0)
         {
-          print_err("ERROR: Fail to get data from simple FIFO.\n");
-          return AUDIOLIB_ECODE_SIMPLEFIFO_ERROR;
+          print_err("ERROR: Cannot write recorded data to output file.\n");
+          return AUDIOLIB_ECODE_FILEACCESS_ERROR;
         }
+    }
 
-      int ret = myFile.write((uint8_t*)&m_es_recorder_buf, size);
-      m_es_size += size;
-      data_size -= size;
-
+  if (span.size2 > 0)
+    {
+      int ret = myFile.write(span.data2, span.size2);
       if (ret < 0)
         {
           print_err("ERROR: Cannot write recorded data to output file.\n");
+          consumeFrames(span.size1);
           return AUDIOLIB_ECODE_FILEACCESS_ERROR;
         }
     }
 
-  return AUDIOLIB_ECODE_OK;
+  return consumeFrames(span.size1 + span.size2);
 }
 
 /*--------------------------------------------------------------------------*/
@@ -1538,6 +1543,86 @@ err_t AudioClass::readFrames(char* p_buffer, uint32_t buffer_size, uint32_t* rea
   return rst;
 }
 
+/*--------------------------------------------------------------------------*/
+err_t AudioClass::peekFrames(AudioFifoSpan* span, uint32_t max_size)
+{
+  CMN_SimpleFifoPeekHandle peek;
+
+  if (span == NULL)
+    {
+      print_err("ERROR: Buffer area not specified.\n");
+      return AUDIOLIB_ECODE_BUFFER_AREA_ERROR;
+    }
+
+  memset(span, 0, sizeof(AudioFifoSpan));
+
+  if (!m_recorder_simple_fifo_buf)
+    {
+      print_err("ERROR: FIFO area is not allocated.\n");
+      return AUDIOLIB_ECODE_SIMPLEFIFO_ERROR;
+    }
+
+  size_t data_size = CMN_SimpleFifoGetOccupiedSize(&m_recorder_simple_fifo_handle);
+  if ((max_size > 0) && (data_size > max_size))
+    {
+      data_size = max_size;
+    }
+
+  if (data_size == 0)
+    {
+      return AUDIOLIB_ECODE_OK;
+    }
+
+  if (CMN_SimpleFifoPeek(&m_recorder_simple_fifo_handle, &peek, data_size) != data_size)
+    {
+      print_err("ERROR: Fail to peek data in simple FIFO.\n");
+      return AUDIOLIB_ECODE_SIMPLEFIFO_ERROR;
+    }
+
+  span->data1 = (uint8_t*)peek.m_pChunk1;
+  span->size1 = (uint32_t)peek.m_szChunk1;
+  if (peek.m_szChunk2 > 0)
+    {
+      span->data2 = (uint8_t*)peek.m_pChunk2;
+      span->size2 = (uint32_t)peek.m_szChunk2;
+    }
+
+  return AUDIOLIB_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+err_t AudioClass::consumeFrames(uint32_t size)
+{
+  if (!m_recorder_simple_fifo_buf)
+    {
+      print_err("ERROR: FIFO area is not allocated.\n");
+      return AUDIOLIB_ECODE_SIMPLEFIFO_ERROR;
+    }
+
+  if (size == 0)
+    {
+      return AUDIOLIB_ECODE_OK;
+    }
+
+  if (size > CMN_SimpleFifoGetOccupiedSize(&m_recorder_simple_fifo_handle))
+    {
+      print_err("ERROR: Release size is over the data in FIFO.\n");
+      return AUDIOLIB_ECODE_BUFFER_SIZE_ERROR;
+    }
+
+  /* Poll without destination only moves the read position. */
+
+  if (CMN_SimpleFifoPoll(&m_recorder_simple_fifo_handle, NULL, size) == 0)
+    {
+      print_err("ERROR: Fail to get data from simple FIFO.\n");
+      return AUDIOLIB_ECODE_SIMPLEFIFO_ERROR;
+    }
+
+  m_es_size += size;
+
+  return AUDIOLIB_ECODE_OK;
+}
+
 /*--------------------------------------------------------------------------*/
 err_t AudioClass::setRenderingClockMode(AsClkMode mode)
 {
@@ -2008,7 +2093,7 @@ void  input_device_callback(uint32_t size)
 /*--------------------------------------------------------------------------*/
 void  output_device_callback(uint32_t size)
 {
-    /* do nothing */
+    AudioFileSink::notify(size);
 }
 
 }
@@ -52,6 +52,8 @@ class File;
 #include <audio/dsp_framework/customproc_command_base.h>
 #include <memutils/simple_fifo/CMN_SimpleFifo.h>
 
+#include "AudioFifoSpan.h"
+
 #define WRITE_FIFO_FRAME_NUM  (8)
 #define WRITE_FIFO_FRAME_SIZE (1024*2*3)
 #define WRITE_BUF_SIZE   (WRITE_FIFO_FRAME_NUM * WRITE_FIFO_FRAME_SIZE)
@@ -871,6 +873,35 @@ public:
       uint32_t* read_size    /**< Read size.(byte) */
   );
 
+  /**
+   * @brief Peek Stream Data in FIFO without copy
+   *
+   * @details This function gives the generated Stream data in the Stream FIFO
+   *          as up to two regions of the FIFO buffer, instead of copying it
+   *          like readFrames. The data can be processed in place, and it
+   *          should be released by consumeFrames after that.
+   *          Calling this function again gives the same data until it is
+   *          released.
+   *          It can be called on RecorderMode.
+   *
+   */
+  err_t peekFrames(
+      AudioFifoSpan* span,     /**< [out] Regions of the data. Sizes are 0 if no data. */
+      uint32_t       max_size = 0 /**< Maximum bytes to peek. 0 for all. */
+  );
+
+  /**
+   * @brief Release Stream Data in FIFO
+   *
+   * @details This function releases the oldest data given by peekFrames,
+   *          so that the FIFO can be reused by the recorder.
+   *          It can be called on RecorderMode.
+   *
+   */
+  err_t consumeFrames(
+      uint32_t size /**< Bytes to release, up to the size given by peekFrames. */
+  );
+
   /**
    * @brief Set Rendering clock mode.
    *
@@ -1010,6 +1041,11 @@ public:
 
 private:
 
+  /* AudioFileSink drains the recorder FIFO, and AudioPlayerFeeder fills the player FIFOs. */
+
+  friend class AudioFileSink;
+  template <class PLAYER> friend class PlayerFeederFor;
+
   /**
    * To avoid create multiple instance
    */
@@ -0,0 +1,42 @@
+/*
+ *  AudioFifoSpan.h - Audio include file for the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef AudioFifoSpan_h
+#define AudioFifoSpan_h
+
+#include <stdint.h>
+
+/**
+ * @brief Recorded data in the FIFO, given by peekFrames() of AudioClass and
+ *        MediaRecorder.
+ *
+ * @details The data is in the FIFO buffer. It is split into two regions
+ *          when it wraps around at the end of the buffer. The data stays
+ *          valid and is not overwritten by the recorder until it is released
+ *          by consumeFrames(). The split is at a sample boundary if the FIFO
+ *          size is a multiple of the bytes of a sample of all channels.
+ */
+typedef struct {
+  uint8_t  *data1; /**< Oldest data */
+  uint32_t size1;  /**< Bytes of data1 */
+  uint8_t  *data2; /**< Data continued from the top of the buffer, or NULL */
+  uint32_t size2;  /**< Bytes of data2 */
+} AudioFifoSpan;
+
+#endif // AudioFifoSpan_h
@@ -0,0 +1,466 @@
+/*
+ *  AudioFileSink.cpp - Recorder file writer for the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+//***************************************************************************
+// Included Files
+//***************************************************************************
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "AudioFileSink.h"
+
+/* The sink which the recorder callback drains into. Only one recorder exists. */
+
+static AudioFileSink *s_active_sink = NULL;
+
+/****************************************************************************
+ * Public API on AudioFileSink
+ ****************************************************************************/
+AudioFileSink::AudioFileSink()
+  : m_fifo(NULL)
+  , m_running(false)
+  , m_stopping(false)
+  , m_write_error(false)
+  , m_is_wav(false)
+  , m_header_size(0)
+  , m_blocks(NULL)
+  , m_block_size(0)
+  , m_block_num(0)
+  , m_fill_idx(0)
+  , m_fill_len(0)
+  , m_write_idx(0)
+  , m_full_num(0)
+  , m_writer_tid(-1)
+{
+  sem_init(&m_lock, 0, 1);
+  sem_init(&m_drain_lock, 0, 1);
+  sem_init(&m_full_sem, 0, 0);
+  memset(&m_stat, 0, sizeof(m_stat));
+}
+
+/*--------------------------------------------------------------------------*/
+AudioFileSink::~AudioFileSink()
+{
+  if (m_running)
+    {
+      end();
+    }
+
+  sem_destroy(&m_lock);
+  sem_destroy(&m_drain_lock);
+  sem_destroy(&m_full_sem);
+}
+
+/*--------------------------------------------------------------------------*/
+err_t AudioFileSink::begin(const char *path, size_t prealloc_size,
+                           size_t block_size, int block_num)
+{
+  AudioClass *audio = AudioClass::getInstance();
+
+  if (m_running)
+    {
+      print_err("ERROR: File sink is already running.\n");
+      return AUDIOLIB_ECODE_PARAMETER_ERROR;
+    }
+
+  if ((path == NULL) || (block_num < 2) ||
+      (block_size < RawFile::SECTOR_SIZE) ||
+      (block_size % RawFile::SECTOR_SIZE != 0))
+    {
+      print_err("ERROR: Invalid parameter of file sink.\n");
+      return AUDIOLIB_ECODE_PARAMETER_ERROR;
+    }
+
+  /* The recorder uses the FIFO of Player0. */
+
+  if (audio->m_player0_simple_fifo_buf == NULL)
+    {
+      print_err("ERROR: FIFO area is not allocated.\n");
+      return AUDIOLIB_ECODE_SIMPLEFIFO_ERROR;
+    }
+
+  m_blocks = RawFile::allocBuffer(block_size * block_num);
+  if (m_blocks == NULL)
+    {
+      print_err("ERROR: Fail to allocate memory.\n");
+      return AUDIOLIB_ECODE_BUFFER_AREA_ERROR;
+    }
+
+  if (!m_file.create(path, prealloc_size))
+    {
+      print_err("ERROR: Cannot open %s.\n", path);
+      release();
+      return AUDIOLIB_ECODE_FILEACCESS_ERROR;
+    }
+
+  m_fifo        = &audio->m_player0_simple_fifo_handle;
+  m_block_size  = block_size;
+  m_block_num   = block_num;
+  m_fill_idx    = 0;
+  m_fill_len    = 0;
+  m_write_idx   = 0;
+  m_full_num    = 0;
+  m_write_error = false;
+  m_stopping    = false;
+  memset(&m_stat, 0, sizeof(m_stat));
+  while (sem_trywait(&m_full_sem) == 0);
+
+  /* Reserve the header with the maximum size. It is patched once by end(). */
+
+  m_is_wav = (audio->m_codec_type == AS_CODECTYPE_WAV);
+  m_header_size = 0;
+  if (m_is_wav)
+    {
+      m_wav_format = audio->m_wav_format;
+      m_wav_format.total_size = 0xffffffff;
+      m_wav_format.data_size  = 0xffffffff - sizeof(WAVHEADER) + 8;
+      memcpy(m_blocks, &m_wav_format, sizeof(WAVHEADER));
+      m_header_size = sizeof(WAVHEADER);
+      m_fill_len = m_header_size;
+    }
+
+  struct sched_param param;
+  pthread_attr_t tattr;
+
+  pthread_attr_init(&tattr);
+  tattr.stacksize = WRITER_THREAD_STACK_SIZE;
+  param.sched_priority = WRITER_THREAD_PRIO;
+  pthread_attr_setschedparam(&tattr, &param);
+
+  m_running = true;
+  if (pthread_create(&m_writer_tid, &tattr,
+                     (pthread_startroutine_t)AudioFileSink::writer_thread,
+                     (void *)this))
+    {
+      print_err("ERROR: Cannot create writer thread.\n");
+      m_running = false;
+      release();
+      return AUDIOLIB_ECODE_PARAMETER_ERROR;
+    }
+  pthread_setname_np(m_writer_tid, "audio_file_sink");
+
+  sem_wait(&m_drain_lock);
+  s_active_sink = this;
+  sem_post(&m_drain_lock);
+
+  return AUDIOLIB_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+err_t AudioFileSink::end()
+{
+  uint32_t errors = 0;
+
+  if (!m_running)
+    {
+      return AUDIOLIB_ECODE_PARAMETER_ERROR;
+    }
+
+  /* The recorder has been stopped. Write the rest of the FIFO. */
+
+  s_active_sink = NULL;
+  while ((CMN_SimpleFifoGetOccupiedSize(m_fifo) > 0) && !m_write_error)
+    {
+      drain(0);
+      if (CMN_SimpleFifoGetOccupiedSize(m_fifo) > 0)
+        {
+          usleep(POLL_INTERVAL_MS * 1000);
+        }
+    }
+
+  /* The writer writes all full blocks before it stops. */
+
+  lock();
+  m_stopping = true;
+  unlock();
+  sem_post(&m_full_sem);
+  pthread_join(m_writer_tid, NULL);
+  m_writer_tid = -1;
+
+  if (!m_write_error && (m_fill_len > 0))
+    {
+      if (!write_out(m_blocks + m_fill_idx * m_block_size, m_fill_len))
+        {
+          m_write_error = true;
+          errors++;
+        }
+      m_fill_len = 0;
+    }
+
+  /* Only the data in the file is counted, also after a write error. */
+
+  if (m_is_wav)
+    {
+      lock();
+      uint32_t data_size = (uint32_t)m_stat.bytes;
+      unlock();
+
+      m_wav_format.total_size = data_size + sizeof(WAVHEADER) - 8;
+      m_wav_format.data_size  = data_size;
+      if (!m_file.seek(0) ||
+          !m_file.write(&m_wav_format, sizeof(WAVHEADER)))
+        {
+          print_err("Fail to write file(wav header)\n");
+          m_write_error = true;
+          errors++;
+        }
+    }
+
+  if (!m_file.finish())
+    {
+      m_write_error = true;
+      errors++;
+    }
+
+  lock();
+  m_stat.errors += errors;
+  unlock();
+
+  /* Wait for a callback running now. */
+
+  sem_wait(&m_drain_lock);
+  m_running = false;
+  sem_post(&m_drain_lock);
+
+  release();
+
+  return m_write_error ? AUDIOLIB_ECODE_FILEACCESS_ERROR : AUDIOLIB_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+err_t AudioFileSink::getStat(AudioFileSinkStat *stat)
+{
+  if (stat == NULL)
+    {
+      return AUDIOLIB_ECODE_PARAMETER_ERROR;
+    }
+
+  lock();
+  *stat = m_stat;
+  unlock();
+
+  return AUDIOLIB_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioFileSink::notify(uint32_t size)
+{
+  AudioFileSink *sink = s_active_sink;
+
+  if (sink != NULL)
+    {
+      sink->drain(size);
+    }
+}
+
+/****************************************************************************
+ * Private API on AudioFileSink
+ ****************************************************************************/
+void AudioFileSink::release()
+{
+  if (m_blocks != NULL)
+    {
+      free(m_blocks);
+      m_blocks = NULL;
+    }
+
+  m_file.close();
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioFileSink::drain(uint32_t frame_size)
+{
+  sem_wait(&m_drain_lock);
+
+  if (!m_running)
+    {
+      sem_post(&m_drain_lock);
+      return;
+    }
+
+  size_t data_size = CMN_SimpleFifoGetOccupiedSize(m_fifo);
+
+  lock();
+  if (data_size > m_stat.maxFifoUsed)
+    {
+      m_stat.maxFifoUsed = data_size;
+    }
+  unlock();
+
+  /* Only the drain fills the block of m_fill_idx, and the writer does not
+   * touch it until it is counted in m_full_num. So the copy needs no lock.
+   */
+
+  while (data_size > 0)
+    {
+      lock();
+      bool full = (m_full_num == m_block_num);
+      if (full && (s_active_sink == this))
+        {
+          m_stat.stalls++;
+        }
+      unlock();
+
+      if (full)
+        {
+          break;
+        }
+
+      size_t size = m_block_size - m_fill_len;
+      if (size > data_size)
+        {
+          size = data_size;
+        }
+
+      if (CMN_SimpleFifoPoll(m_fifo, m_blocks + m_fill_idx * m_block_size + m_fill_len,
+                             size) == 0)
+        {
+          print_err("ERROR: Fail to get data from simple FIFO.\n");
+          break;
+        }
+
+      m_fill_len += size;
+      data_size -= size;
+
+      lock();
+      if (m_fill_len == m_block_size)
+        {
+          m_fill_idx = (m_fill_idx + 1) % m_block_num;
+          m_fill_len = 0;
+          m_full_num++;
+          m_stat.queued = m_full_num;
+          if (m_full_num > m_stat.maxQueued)
+            {
+              m_stat.maxQueued = m_full_num;
+            }
+          unlock();
+          sem_post(&m_full_sem);
+        }
+      else
+        {
+          unlock();
+        }
+    }
+
+  /* The recorder drops the next frame if it does not fit. */
+
+  if ((frame_size > 0) && (CMN_SimpleFifoGetVacantSize(m_fifo) < frame_size))
+    {
+      lock();
+      m_stat.overruns++;
+      unlock();
+    }
+
+  sem_post(&m_drain_lock);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioFileSink::write_out(const uint8_t *data, size_t len)
+{
+  uint32_t us;
+  bool ok = m_file.write(data, len, &us);
+
+  if (!ok)
+    {
+      print_err("ERROR: Cannot write recorded data to output file.\n");
+    }
+
+  /* A failed write can leave a part of the data in the file. */
+
+  off_t size = m_file.size();
+
+  lock();
+  m_stat.bytes = (size > (off_t)m_header_size) ? (size - m_header_size) : 0;
+  if (ok)
+    {
+      m_stat.blocks++;
+      if (us > m_stat.maxWriteUs)
+        {
+          m_stat.maxWriteUs = us;
+        }
+    }
+  unlock();
+
+  return ok;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioFileSink::writer_thread(void *arg)
+{
+  AudioFileSink *sink = (AudioFileSink *)arg;
+  struct timespec ts;
+
+  while (1)
+    {
+      /* Also drain by itself in case the recorder does not call back. */
+
+      clock_gettime(CLOCK_REALTIME, &ts);
+      ts.tv_nsec += POLL_INTERVAL_MS * 1000000L;
+      if (ts.tv_nsec >= 1000000000L)
+        {
+          ts.tv_sec++;
+          ts.tv_nsec -= 1000000000L;
+        }
+
+      if (sem_timedwait(&sink->m_full_sem, &ts) != 0)
+        {
+          if (!sink->m_stopping && (s_active_sink == sink))
+            {
+              sink->drain(0);
+            }
+          continue;
+        }
+
+      sink->lock();
+      if (sink->m_full_num == 0)
+        {
+          bool stop = sink->m_stopping;
+          sink->unlock();
+          if (stop)
+            {
+              break;
+            }
+          continue;
+        }
+      uint8_t *block = sink->m_blocks + sink->m_write_idx * sink->m_block_size;
+      sink->unlock();
+
+      if (!sink->m_write_error && !sink->write_out(block, sink->m_block_size))
+        {
+          sink->m_write_error = true;
+          sink->lock();
+          sink->m_stat.errors++;
+          sink->unlock();
+        }
+
+      /* Give the block back to the drain. */
+
+      sink->lock();
+      sink->m_write_idx = (sink->m_write_idx + 1) % sink->m_block_num;
+      sink->m_full_num--;
+      sink->m_stat.queued = sink->m_full_num;
+      sink->unlock();
+    }
+
+  pthread_exit(0);
+}
@@ -0,0 +1,155 @@
+/*
+ *  AudioFileSink.h - Recorder file writer for the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file AudioFileSink.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Recorder file writer for the Spresense SDK.
+ * @details Writes the recorder output of AudioClass to a file from a
+ *          background thread, instead of readFrames(File&) in loop().
+ */
+
+#ifndef AudioFileSink_h
+#define AudioFileSink_h
+
+#include <stdint.h>
+#include <semaphore.h>
+#include <pthread.h>
+
+#include <RawFile.h>
+
+#include "Audio.h"
+
+/**
+ * @brief Statistics of AudioFileSink
+ */
+typedef struct {
+  uint64_t bytes;       /**< Audio bytes written to the file, without the WAV header */
+  uint32_t blocks;      /**< Blocks written to the file */
+  uint32_t overruns;    /**< Times the FIFO was found without room for the next frame. The recorder drops frames then. */
+  uint32_t stalls;      /**< Times all blocks were waiting for the storage, and the data stayed in the FIFO */
+  uint32_t errors;      /**< Write errors */
+  int      queued;      /**< Blocks waiting for the storage now */
+  int      maxQueued;   /**< Maximum of queued */
+  uint32_t maxFifoUsed; /**< Maximum bytes in the FIFO */
+  uint32_t maxWriteUs;  /**< Longest write in microseconds */
+} AudioFileSinkStat;
+
+/**
+ * @class AudioFileSink
+ * @brief Recorder file writer
+ *
+ * @details The FIFO of the recorder is drained into blocks of block_size
+ *          bytes each time the recorder puts a frame, and a writer thread
+ *          writes the full blocks to the file. While the storage is busy,
+ *          the other blocks and the FIFO keep the captured data, so a stall
+ *          of the SD card does not lose frames. Blocks are a multiple of the
+ *          sector size, and the WAV header is in the first block, so each
+ *          write is sector aligned in the file.
+ *
+ *          Call begin() after initRecorder() and before startRecorder(), and
+ *          end() after stopRecorder(). Do not call readFrames() meanwhile.
+ */
+class AudioFileSink
+{
+public:
+  AudioFileSink();
+  ~AudioFileSink();
+
+  /**
+   * @brief Open the file and start the writer thread.
+   *
+   * @details For WAV, the header is written with the maximum size, so the
+   *          file is readable even if end() is not called. end() patches it
+   *          with the recorded size. If prealloc_size is given, the file is
+   *          extended in advance so that the storage does not allocate
+   *          clusters while recording, and end() truncates it.
+   *          A path without "/mnt/" is treated as a file on the SD card.
+   */
+  err_t begin(
+      const char *path,          /**< Output file */
+      size_t prealloc_size = 0,  /**< Preallocated bytes (0 for none) */
+      size_t block_size = 32768, /**< Bytes of one write, multiple of 512 */
+      int block_num = 2          /**< Number of blocks, 2 or more */
+  );
+
+  /**
+   * @brief Write the rest and close the file.
+   *
+   * @details Call after stopRecorder(). The data left in the FIFO is
+   *          written, the WAV header is patched, and the preallocated area
+   *          is truncated.
+   */
+  err_t end();
+
+  /**
+   * @brief Get statistics.
+   *
+   * @details Can be called while recording and after end().
+   */
+  err_t getStat(AudioFileSinkStat *stat /**< [out] Statistics */);
+
+  /**
+   * @brief Check recording.
+   */
+  bool isRecording() { return m_running; };
+
+  /**
+   * @brief Called by the recorder when a frame is put into the FIFO.
+   */
+  static void notify(uint32_t size);
+
+private:
+  static const int WRITER_THREAD_STACK_SIZE = 2048;
+  static const int WRITER_THREAD_PRIO = 100;
+  static const int POLL_INTERVAL_MS = 20;
+
+  CMN_SimpleFifoHandle *m_fifo;
+  RawFile   m_file;
+  bool      m_running;
+  bool      m_stopping;
+  bool      m_write_error;
+  bool      m_is_wav;
+  WAVHEADER m_wav_format;
+  size_t    m_header_size;
+
+  uint8_t  *m_blocks;
+  size_t    m_block_size;
+  int       m_block_num;
+  int       m_fill_idx;
+  size_t    m_fill_len;
+  int       m_write_idx;
+  int       m_full_num;
+
+  sem_t     m_lock;
+  sem_t     m_drain_lock;
+  sem_t     m_full_sem;
+  pthread_t m_writer_tid;
+
+  AudioFileSinkStat m_stat;
+
+  void lock() { sem_wait(&m_lock); };
+  void unlock() { sem_post(&m_lock); };
+  void drain(uint32_t frame_size);
+  bool write_out(const uint8_t *data, size_t len);
+  void release();
+  static void writer_thread(void *arg);
+};
+
+#endif // AudioFileSink_h
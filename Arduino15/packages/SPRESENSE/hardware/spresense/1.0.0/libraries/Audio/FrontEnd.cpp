@@ -237,6 +237,26 @@ err_t FrontEnd::init(uint8_t channel_number,
   snprintf(frontend_init.dsp_path, sizeof(frontend_init.dsp_path), "%s", dsp_path);
   frontend_init.data_path         = data_path;
   frontend_init.dest              = dest;
+
+  /* With the chain, the frames come to the chain first, and the chain
+   * delivers them to the destination.
+   */
+
+  if (m_chain)
+    {
+      if (!m_chain->begin(channel_number, bit_length, samples_per_frame))
+        {
+          print_err("Error: Chain does not support the format!\n");
+          return FRONTEND_ECODE_COMMAND_ERROR;
+        }
+
+      m_chain_data_path   = data_path;
+      m_chain_dest        = dest;
+      m_chain_frame_bytes = channel_number * ((bit_length == AS_BITLENGTH_16) ? 2 : 4);
+
+      frontend_init.data_path = AsDataPathCallback;
+      frontend_init.dest.cb   = chainCallback;
+    }
   frontend_init.out_fs            = AS_SAMPLINGRATE_16000;
 
   result = AS_InitMicFrontend(&frontend_init);
@@ -370,6 +390,14 @@ err_t FrontEnd::setpreproc(AsInitPreProcParam *param)
   return FRONTEND_ECODE_OK;
 }
 
+/*--------------------------------------------------------------------------*/
+err_t FrontEnd::setChain(FrontEndChain *chain)
+{
+  m_chain = chain;
+
+  return FRONTEND_ECODE_OK;
+}
+
 /*--------------------------------------------------------------------------*/
 err_t FrontEnd::setMicGain(int16_t mic_gain)
 {
@@ -522,3 +550,34 @@ err_t FrontEnd::setCapturingClkMode(uint8_t clk_mode)
   return FRONTEND_ECODE_OK;
 }
 
+/****************************************************************************
+ * Private API on FrontEnd Class
+ ****************************************************************************/
+
+void FrontEnd::chainCallback(AsPcmDataParam pcm)
+{
+  FrontEnd *fed = FrontEnd::getInstance();
+
+  /* Process in place on the capture buffer. No copy of the frame. */
+
+  if (pcm.is_valid && (pcm.size > 0) && fed->m_chain && (fed->m_chain_frame_bytes > 0))
+    {
+      fed->m_chain->process(pcm.mh.getPa(), pcm.size / fed->m_chain_frame_bytes);
+    }
+
+  if (fed->m_chain_data_path == AsDataPathCallback)
+    {
+      fed->m_chain_dest.cb(pcm);
+      return;
+    }
+
+  err_t er = MsgLib::send<AsPcmDataParam>(fed->m_chain_dest.msg.msgqid,
+                                          MsgPriNormal,
+                                          fed->m_chain_dest.msg.msgtype,
+                                          MSGQ_AUD_FRONTEND,
+                                          pcm);
+  if (er != ERR_OK)
+    {
+      print_err("Error: Fail to deliver the frame [%d]!\n", er);
+    }
+}
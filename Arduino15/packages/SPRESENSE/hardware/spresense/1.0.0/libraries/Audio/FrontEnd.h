@@ -41,6 +41,7 @@
 #include <memutils/simple_fifo/CMN_SimpleFifo.h>
 
 #include "ObjectConnector.h"
+#include "FrontEndChain.h"
 
 /*--------------------------------------------------------------------------*/
 
@@ -247,6 +248,21 @@ public:
       AsSetPreProcParam *param /**< Set command packet parameter for pre-process DSP */
   );
 
+  /**
+   * @brief Set CPU processing chain.
+   *
+   * @details The stages of the chain process each captured frame in place
+   *          on the CPU, after the pre-process DSP and before the frame is
+   *          delivered to the destination given to init(). Call this before
+   *          init(), or before MediaRecorder::init() or Recognizer. Give
+   *          NULL to remove the chain.
+   *
+   */
+
+  err_t setChain(
+      FrontEndChain *chain /**< Processing chain, or NULL */
+  );
+
   /**
    * @brief Set Mic gain.
    *
@@ -293,6 +309,9 @@ private:
 
   FrontEnd()
     : m_fed_callback(NULL)
+    , m_chain(NULL)
+    , m_chain_data_path(AsDataPathMessage)
+    , m_chain_frame_bytes(0)
   {}
   FrontEnd(const FrontEnd&);
   FrontEnd& operator=(const FrontEnd&);
@@ -304,6 +323,17 @@ private:
 
   MicFrontendCallback m_fed_callback;
 
+  /**
+   * CPU processing chain, and the destination after the chain
+   */
+
+  FrontEndChain *m_chain;
+  uint8_t        m_chain_data_path;
+  AsDataDest     m_chain_dest;
+  uint32_t       m_chain_frame_bytes;
+
+  static void chainCallback(AsPcmDataParam pcm);
+
   /**
    * Baseband setting
    */
@@ -0,0 +1,189 @@
+/*
+ *  FrontEndChain.cpp - CPU processing chain on the FrontEnd capture path
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+//***************************************************************************
+// Included Files
+//***************************************************************************
+#include <string.h>
+#if !defined(__arm__)
+#include <time.h>
+#endif
+
+#include "FrontEndChain.h"
+
+#if defined(__arm__)
+/* Cycle counter of the Cortex-M4 (DWT_CYCCNT), enabled by TRCENA of DEMCR */
+
+#define CORE_DEMCR      (*(volatile uint32_t *)0xe000edfc)
+#define CORE_DWT_CTRL   (*(volatile uint32_t *)0xe0001000)
+#define CORE_DWT_CYCCNT (*(volatile uint32_t *)0xe0001004)
+
+#define DEMCR_TRCENA    (1 << 24)
+#define DWT_CYCCNTENA   (1 << 0)
+
+static inline uint32_t cycle_count(void)
+{
+  return CORE_DWT_CYCCNT;
+}
+#else
+/* On a host build (tools/audio_sim), the cycles are nanoseconds. */
+
+static inline uint32_t cycle_count(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+#endif
+
+/****************************************************************************
+ * Public API on FrontEndChain
+ ****************************************************************************/
+FrontEndChain::FrontEndChain()
+  : m_stage_num(0)
+{
+  memset(m_stages, 0, sizeof(m_stages));
+  memset(m_enabled, 0, sizeof(m_enabled));
+  memset(m_stat, 0, sizeof(m_stat));
+}
+
+/*--------------------------------------------------------------------------*/
+bool FrontEndChain::add(FrontEndStage *stage, const char *name)
+{
+  if ((stage == NULL) || (stage == this) ||
+      (m_stage_num >= FRONTENDCHAIN_STAGE_NUM))
+    {
+      return false;
+    }
+
+  m_stages[m_stage_num]  = stage;
+  m_enabled[m_stage_num] = true;
+  memset(&m_stat[m_stage_num], 0, sizeof(FrontEndStageStat));
+  m_stat[m_stage_num].name = (name != NULL) ? name : "";
+  m_stage_num++;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void FrontEndChain::clear()
+{
+  m_stage_num = 0;
+  memset(m_stages, 0, sizeof(m_stages));
+  memset(m_enabled, 0, sizeof(m_enabled));
+  memset(m_stat, 0, sizeof(m_stat));
+}
+
+/*--------------------------------------------------------------------------*/
+bool FrontEndChain::enable(int index, bool enable)
+{
+  if ((index < 0) || (index >= m_stage_num))
+    {
+      return false;
+    }
+
+  m_enabled[index] = enable;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool FrontEndChain::getStat(int index, FrontEndStageStat *stat)
+{
+  if ((index < 0) || (index >= m_stage_num) || (stat == NULL))
+    {
+      return false;
+    }
+
+  *stat = m_stat[index];
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void FrontEndChain::resetStat()
+{
+  for (int i = 0; i < m_stage_num; i++)
+    {
+      const char *name = m_stat[i].name;
+
+      memset(&m_stat[i], 0, sizeof(FrontEndStageStat));
+      m_stat[i].name = name;
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+bool FrontEndChain::begin(uint8_t channels, uint8_t bit_length, uint32_t samples)
+{
+#if defined(__arm__)
+  /* The cycle counter is shared, so only enable it, and never stop it. */
+
+  CORE_DEMCR    |= DEMCR_TRCENA;
+  CORE_DWT_CTRL |= DWT_CYCCNTENA;
+#endif
+
+  for (int i = 0; i < m_stage_num; i++)
+    {
+      if (!m_stages[i]->begin(channels, bit_length, samples))
+        {
+          return false;
+        }
+    }
+
+  resetStat();
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool FrontEndChain::process(void *data, uint32_t samples)
+{
+  bool result = true;
+
+  for (int i = 0; i < m_stage_num; i++)
+    {
+      if (!m_enabled[i])
+        {
+          continue;
+        }
+
+      FrontEndStageStat *stat = &m_stat[i];
+
+      uint32_t start = cycle_count();
+      bool ok = m_stages[i]->process(data, samples);
+      uint32_t cycles = cycle_count() - start;
+
+      stat->frames++;
+      stat->cycles = cycles;
+      stat->totalCycles += cycles;
+      if (cycles > stat->maxCycles)
+        {
+          stat->maxCycles = cycles;
+        }
+
+      if (!ok)
+        {
+          stat->errors++;
+          result = false;
+        }
+    }
+
+  return result;
+}
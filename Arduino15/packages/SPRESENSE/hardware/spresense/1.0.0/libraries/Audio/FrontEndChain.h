@@ -0,0 +1,186 @@
+/*
+ *  FrontEndChain.h - CPU processing chain on the FrontEnd capture path
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file FrontEndChain.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief CPU processing chain on the FrontEnd capture path.
+ * @details Runs processing stages on each captured frame in place, before
+ *          the frame is delivered to MediaRecorder, Recognizer or the
+ *          application. Set the chain by FrontEnd::setChain().
+ */
+
+#ifndef FrontEndChain_h
+#define FrontEndChain_h
+
+#include <stdint.h>
+
+#define FRONTENDCHAIN_STAGE_NUM 8
+
+/**
+ * @class FrontEndStage
+ * @brief A processing stage of FrontEndChain
+ *
+ * @details Derive this class and implement process(). The data is the
+ *          captured frame, interleaved for all channels. 16bit samples are
+ *          int16_t, and 24bit samples are int32_t.
+ */
+class FrontEndStage
+{
+public:
+  virtual ~FrontEndStage() {}
+
+  /**
+   * @brief Prepare for the format of the capture.
+   *
+   * @details Called by FrontEnd::init().
+   *
+   * @return false if the format is not supported.
+   */
+  virtual bool begin(
+      uint8_t channels,   /**< Number of channels */
+      uint8_t bit_length, /**< 16 or 24 */
+      uint32_t samples    /**< Samples per channel of a frame */
+  ) { return true; }
+
+  /**
+   * @brief Process a frame in place.
+   *
+   * @details Called from the FrontEnd task. Keep it within the frame time.
+   *
+   * @return false on an error. The frame is delivered anyway.
+   */
+  virtual bool process(
+      void *data,      /**< [in,out] Interleaved PCM */
+      uint32_t samples /**< Samples per channel */
+  ) = 0;
+};
+
+/**
+ * @class FrontEndFilterStage
+ * @brief Stage for a filter of the SignalProcessing library
+ *
+ * @details Wraps a filter which has process(q15_t *, int) to filter
+ *          interleaved data in place, such as IIRCascadeClass. Only 16bit
+ *          is supported.
+ */
+template <class T>
+class FrontEndFilterStage : public FrontEndStage
+{
+public:
+  FrontEndFilterStage(T *filter) : m_filter(filter) {}
+
+  virtual bool begin(uint8_t channels, uint8_t bit_length, uint32_t samples)
+  {
+    return (m_filter != 0) && (bit_length == 16);
+  }
+
+  virtual bool process(void *data, uint32_t samples)
+  {
+    return m_filter->process((int16_t *)data, (int)samples) >= 0;
+  }
+
+private:
+  T *m_filter;
+};
+
+/**
+ * @brief Statistics of a stage
+ */
+typedef struct {
+  const char *name;        /**< Name given to add() */
+  uint32_t    frames;      /**< Processed frames */
+  uint32_t    errors;      /**< Frames of which process() returned false */
+  uint32_t    cycles;      /**< CPU cycles of the last frame */
+  uint32_t    maxCycles;   /**< Maximum of cycles */
+  uint64_t    totalCycles; /**< Sum of cycles */
+} FrontEndStageStat;
+
+/**
+ * @class FrontEndChain
+ * @brief Chain of processing stages
+ *
+ * @details The stages run in the order of add() on the same buffer, so the
+ *          frame is not copied. A chain is a stage too, so a chain can be
+ *          added to another chain as a sub graph. The CPU cycles of each
+ *          stage are measured by the cycle counter of the core.
+ *
+ *          Add the stages before FrontEnd::init(), and do not change the
+ *          chain while capturing.
+ */
+class FrontEndChain : public FrontEndStage
+{
+public:
+  FrontEndChain();
+
+  /**
+   * @brief Add a stage to the end of the chain.
+   *
+   * @return false if the chain is full.
+   */
+  bool add(
+      FrontEndStage *stage, /**< Stage to add */
+      const char *name = "" /**< Name for the statistics */
+  );
+
+  /**
+   * @brief Remove all stages.
+   */
+  void clear();
+
+  /**
+   * @brief Enable or disable a stage.
+   *
+   * @details A disabled stage is skipped. This can be changed while
+   *          capturing.
+   */
+  bool enable(
+      int index,  /**< Index of the stage in the order of add() */
+      bool enable /**< true to run the stage */
+  );
+
+  /**
+   * @brief Number of stages.
+   */
+  int getStageNum() { return m_stage_num; };
+
+  /**
+   * @brief Get statistics of a stage.
+   */
+  bool getStat(
+      int index,              /**< Index of the stage */
+      FrontEndStageStat *stat /**< [out] Statistics */
+  );
+
+  /**
+   * @brief Clear the statistics of all stages.
+   */
+  void resetStat();
+
+  virtual bool begin(uint8_t channels, uint8_t bit_length, uint32_t samples);
+  virtual bool process(void *data, uint32_t samples);
+
+private:
+  FrontEndStage    *m_stages[FRONTENDCHAIN_STAGE_NUM];
+  bool              m_enabled[FRONTENDCHAIN_STAGE_NUM];
+  FrontEndStageStat m_stat[FRONTENDCHAIN_STAGE_NUM];
+  int               m_stage_num;
+};
+
+#endif // FrontEndChain_h
@@ -380,6 +380,10 @@ public:
 
 private:
 
+  /* MediaPlayerFeeder fills the player FIFOs. */
+
+  template <class PLAYER> friend class PlayerFeederFor;
+
   /**
    * To avoid create multiple instance
    */
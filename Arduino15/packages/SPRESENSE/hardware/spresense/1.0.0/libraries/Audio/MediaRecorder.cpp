@@ -23,6 +23,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <arch/board/cxd56_audio.h>
 
@@ -596,6 +597,86 @@ err_t MediaRecorder::readFrames(uint8_t* p_buffer, uint32_t buffer_size, uint32_
   return rst;
 }
 
+/*--------------------------------------------------------------------------*/
+err_t MediaRecorder::peekFrames(AudioFifoSpan* span, uint32_t max_size)
+{
+  CMN_SimpleFifoPeekHandle peek;
+
+  if (span == NULL)
+    {
+      print_err("ERROR: Buffer area not specified.\n");
+      return MEDIARECORDER_ECODE_BUFFER_AREA_ERROR;
+    }
+
+  memset(span, 0, sizeof(AudioFifoSpan));
+
+  if (m_recorder_simple_fifo_buf == NULL)
+    {
+      print_err("ERROR: FIFO area is not allcated.\n");
+      return MEDIARECORDER_ECODE_BUFFER_AREA_ERROR;
+    }
+
+  size_t data_size = CMN_SimpleFifoGetOccupiedSize(&m_recorder_simple_fifo_handle);
+  if ((max_size > 0) && (data_size > max_size))
+    {
+      data_size = max_size;
+    }
+
+  if (data_size == 0)
+    {
+      return MEDIARECORDER_ECODE_OK;
+    }
+
+  if (CMN_SimpleFifoPeek(&m_recorder_simple_fifo_handle, &peek, data_size) != data_size)
+    {
+      print_err("ERROR: Fail to peek data in simple FIFO.\n");
+      return MEDIARECORDER_ECODE_BUFFER_POLL_ERROR;
+    }
+
+  span->data1 = (uint8_t*)peek.m_pChunk1;
+  span->size1 = (uint32_t)peek.m_szChunk1;
+  if (peek.m_szChunk2 > 0)
+    {
+      span->data2 = (uint8_t*)peek.m_pChunk2;
+      span->size2 = (uint32_t)peek.m_szChunk2;
+    }
+
+  return MEDIARECORDER_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+err_t MediaRecorder::consumeFrames(uint32_t size)
+{
+  if (m_recorder_simple_fifo_buf == NULL)
+    {
+      print_err("ERROR: FIFO area is not allcated.\n");
+      return MEDIARECORDER_ECODE_BUFFER_AREA_ERROR;
+    }
+
+  if (size == 0)
+    {
+      return MEDIARECORDER_ECODE_OK;
+    }
+
+  if (size > CMN_SimpleFifoGetOccupiedSize(&m_recorder_simple_fifo_handle))
+    {
+      print_err("ERROR: Release size is over the data in FIFO.\n");
+      return MEDIARECORDER_ECODE_BUFFER_SIZE_ERROR;
+    }
+
+  /* Poll without destination only moves the read position. */
+
+  if (CMN_SimpleFifoPoll(&m_recorder_simple_fifo_handle, NULL, size) == 0)
+    {
+      print_err("ERROR: Fail to get data from simple FIFO.\n");
+      return MEDIARECORDER_ECODE_BUFFER_POLL_ERROR;
+    }
+
+  m_es_size += size;
+
+  return MEDIARECORDER_ECODE_OK;
+}
+
 /*--------------------------------------------------------------------------*/
 err_t MediaRecorder::writeWavHeader(File& myfile)
 {
@@ -40,6 +40,7 @@ class File;
 #include <memutils/simple_fifo/CMN_SimpleFifo.h>
 
 #include "FrontEnd.h"
+#include "AudioFifoSpan.h"
 
 /*--------------------------------------------------------------------------*/
 
@@ -309,6 +310,32 @@ public:
       uint32_t* read_size
   );
 
+  /**
+   * @brief Peek a recorded audio data without copy
+   *
+   * @details This function gives encoded audio data in media recorder as up to
+   *          two regions of the FIFO buffer, instead of copying it like readFrames.
+   *          The data can be processed in place, and it should be released by
+   *          consumeFrames after that. Calling this API again gives the same
+   *          data until it is released. If max_size is 0, all data is given.
+   *
+   */
+
+  err_t peekFrames(
+      AudioFifoSpan* span,
+      uint32_t max_size = 0
+  );
+
+  /**
+   * @brief Release a recorded audio data
+   *
+   * @details This function releases size bytes of the oldest data given by
+   *          peekFrames, so that the FIFO can be reused by media recorder.
+   *
+   */
+
+  err_t consumeFrames(uint32_t size);
+
   /**
    * @brief Write WAV header to file
    *
@@ -0,0 +1,372 @@
+/*
+ *  OutputMixerStream.cpp - Low latency PCM streaming on OutputMixer
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+//***************************************************************************
+// Included Files
+//***************************************************************************
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "OutputMixerStream.h"
+#include "MemoryUtil.h"
+
+/* Streams by the handle, for the callback of the renderer. The identifier
+ * of the PCM is the handle.
+ */
+
+static OutputMixerStream *s_streams[2];
+
+/****************************************************************************
+ * Public API on OutputMixerStream
+ ****************************************************************************/
+OutputMixerStream::OutputMixerStream()
+  : m_handle(OutputMixer0)
+  , m_fill(NULL)
+  , m_arg(NULL)
+  , m_samples(0)
+  , m_bit_length(16)
+  , m_frame_size(0)
+  , m_frame_num(0)
+  , m_running(false)
+  , m_stopping(false)
+  , m_ended(false)
+  , m_send_idx(0)
+  , m_done_idx(0)
+  , m_in_flight(0)
+  , m_stream_tid(-1)
+{
+  sem_init(&m_done_sem, 0, 0);
+  memset(&m_stat, 0, sizeof(m_stat));
+}
+
+/*--------------------------------------------------------------------------*/
+OutputMixerStream::~OutputMixerStream()
+{
+  end();
+  sem_destroy(&m_done_sem);
+}
+
+/*--------------------------------------------------------------------------*/
+err_t OutputMixerStream::begin(AsOutputMixerHandle handle,
+                               OutputMixerStreamFill fill,
+                               void *arg,
+                               uint32_t samples,
+                               uint8_t channels,
+                               uint8_t bit_length,
+                               int frames)
+{
+  if (m_running)
+    {
+      print_err("ERROR: Stream is already running.\n");
+      return OUTPUTMIXER_ECODE_COMMAND_ERROR;
+    }
+
+  if (((handle != OutputMixer0) && (handle != OutputMixer1)) ||
+      (s_streams[handle] != NULL) || (fill == NULL) || (samples == 0) ||
+      (channels == 0) || ((bit_length != 16) && (bit_length != 24)) ||
+      (frames < 2) || (frames > OUTPUTMIXERSTREAM_FRAME_MAX))
+    {
+      print_err("ERROR: Invalid parameter of stream.\n");
+      return OUTPUTMIXER_ECODE_COMMAND_ERROR;
+    }
+
+  m_handle     = handle;
+  m_fill       = fill;
+  m_arg        = arg;
+  m_samples    = samples;
+  m_bit_length = bit_length;
+  m_frame_num  = frames;
+  m_send_idx   = 0;
+  m_done_idx   = 0;
+  m_in_flight  = 0;
+  m_stopping   = false;
+  m_ended      = false;
+  memset(&m_stat, 0, sizeof(m_stat));
+
+  /* 24bit is in 4 bytes for the renderer. */
+
+  m_frame_size = samples * channels * ((bit_length == 16) ? 2 : 4);
+
+  /* All frames are taken from the pool now, so that the rendering does not
+   * wait for the pool or fail to allocate.
+   */
+
+  for (int i = 0; i < m_frame_num; i++)
+    {
+      if (m_mh[i].allocSeg(S0_REND_PCM_BUF_POOL, m_frame_size) != ERR_OK)
+        {
+          print_err("ERROR: Cannot allocate frame %d of %lu bytes.\n",
+                    i, (unsigned long)m_frame_size);
+          release();
+          return OUTPUTMIXER_ECODE_COMMAND_ERROR;
+        }
+    }
+
+  s_streams[m_handle] = this;
+  m_running = true;
+
+  /* Fill all frames before the thread starts, not to start by an underrun. */
+
+  for (int i = 0; i < m_frame_num; i++)
+    {
+      if (!send(false))
+        {
+          end();
+          return OUTPUTMIXER_ECODE_COMMAND_ERROR;
+        }
+    }
+
+  struct sched_param param;
+  pthread_attr_t tattr;
+
+  pthread_attr_init(&tattr);
+  tattr.stacksize = STREAM_THREAD_STACK_SIZE;
+  param.sched_priority = STREAM_THREAD_PRIO;
+  pthread_attr_setschedparam(&tattr, &param);
+
+  if (pthread_create(&m_stream_tid, &tattr,
+                     (pthread_startroutine_t)OutputMixerStream::stream_thread,
+                     (void *)this))
+    {
+      print_err("ERROR: Cannot create stream thread.\n");
+      m_stream_tid = -1;
+      end();
+      return OUTPUTMIXER_ECODE_COMMAND_ERROR;
+    }
+  pthread_setname_np(m_stream_tid, "mixer_stream");
+
+  return OUTPUTMIXER_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+err_t OutputMixerStream::end()
+{
+  err_t ret = OUTPUTMIXER_ECODE_OK;
+
+  if (!m_running)
+    {
+      return OUTPUTMIXER_ECODE_OK;
+    }
+
+  m_stopping = true;
+
+  if (m_stream_tid != (pthread_t)-1)
+    {
+      sem_post(&m_done_sem);
+      pthread_join(m_stream_tid, NULL);
+      m_stream_tid = -1;
+    }
+
+  /* Wait for a free frame, and send it as the last one. The renderer stops
+   * after the frames before it.
+   */
+
+  uint32_t start = millis();
+
+  while ((__atomic_load_n(&m_in_flight, __ATOMIC_ACQUIRE) >= m_frame_num) &&
+         (millis() - start < END_TIMEOUT_MS))
+    {
+      usleep(1000);
+    }
+
+  if ((m_in_flight >= m_frame_num) || !send(true))
+    {
+      print_err("ERROR: Cannot send the end of stream.\n");
+      ret = OUTPUTMIXER_ECODE_COMMAND_ERROR;
+    }
+
+  /* The frames can be freed after the renderer has released them. */
+
+  while (!__atomic_load_n(&m_ended, __ATOMIC_ACQUIRE) &&
+         (__atomic_load_n(&m_in_flight, __ATOMIC_ACQUIRE) > 0) &&
+         (millis() - start < END_TIMEOUT_MS))
+    {
+      usleep(1000);
+    }
+
+  if (m_in_flight > 0)
+    {
+      print_err("ERROR: Renderer did not complete the stream.\n");
+      ret = OUTPUTMIXER_ECODE_COMMAND_ERROR;
+    }
+
+  release();
+
+  return ret;
+}
+
+/*--------------------------------------------------------------------------*/
+void OutputMixerStream::getStat(OutputMixerStreamStat *stat)
+{
+  if (stat == NULL)
+    {
+      return;
+    }
+
+  *stat = m_stat;
+  stat->inFlight = __atomic_load_n(&m_in_flight, __ATOMIC_ACQUIRE);
+}
+
+/****************************************************************************
+ * Private API on OutputMixerStream
+ ****************************************************************************/
+bool OutputMixerStream::send(bool is_end)
+{
+  int idx = m_send_idx;
+  void *buf = m_mh[idx].getPa();
+
+  if (is_end)
+    {
+      memset(buf, 0, m_frame_size);
+    }
+  else
+    {
+      uint32_t start = micros();
+      bool filled = m_fill(buf, m_samples, m_arg);
+      uint32_t us = micros() - start;
+
+      if (!filled)
+        {
+          memset(buf, 0, m_frame_size);
+          m_stat.silentFrames++;
+        }
+
+      if (us > m_stat.maxFillUs)
+        {
+          m_stat.maxFillUs = us;
+        }
+    }
+
+  /* The renderer takes its own reference of the frame. Ours keeps the
+   * frame in this stream after the renderer releases it.
+   */
+
+  AsPcmDataParam pcm;
+
+  pcm.mh         = m_mh[idx];
+  pcm.identifier = m_handle;
+  pcm.callback   = 0;
+  pcm.bit_length = m_bit_length;
+  pcm.size       = m_frame_size;
+  pcm.sample     = m_samples;
+  pcm.is_end     = is_end;
+  pcm.is_valid   = true;
+
+  m_sent_us[idx] = micros();
+  m_send_idx = (idx + 1) % m_frame_num;
+  __atomic_add_fetch(&m_in_flight, 1, __ATOMIC_ACQ_REL);
+
+  if (OutputMixer::getInstance()->sendData(m_handle, send_callback, pcm) != OUTPUTMIXER_ECODE_OK)
+    {
+      __atomic_sub_fetch(&m_in_flight, 1, __ATOMIC_ACQ_REL);
+      m_send_idx = idx;
+      return false;
+    }
+
+  m_stat.frames++;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void OutputMixerStream::done(bool is_end)
+{
+  /* The renderer completes the frames in the order of sending. */
+
+  int idx = m_done_idx;
+  uint32_t us = micros() - m_sent_us[idx];
+
+  m_done_idx = (idx + 1) % m_frame_num;
+
+  m_stat.latencyUs = us;
+  if (us > m_stat.maxLatencyUs)
+    {
+      m_stat.maxLatencyUs = us;
+    }
+
+  int left = __atomic_sub_fetch(&m_in_flight, 1, __ATOMIC_ACQ_REL);
+  if ((left == 0) && !m_stopping)
+    {
+      m_stat.underruns++;
+    }
+
+  if (is_end)
+    {
+      __atomic_store_n(&m_ended, true, __ATOMIC_RELEASE);
+    }
+
+  sem_post(&m_done_sem);
+}
+
+/*--------------------------------------------------------------------------*/
+void OutputMixerStream::release()
+{
+  for (int i = 0; i < OUTPUTMIXERSTREAM_FRAME_MAX; i++)
+    {
+      if (!m_mh[i].isNull())
+        {
+          m_mh[i].freeSeg();
+        }
+    }
+
+  if (s_streams[m_handle] == this)
+    {
+      s_streams[m_handle] = NULL;
+    }
+
+  m_running = false;
+}
+
+/*--------------------------------------------------------------------------*/
+void OutputMixerStream::stream_thread(void *arg)
+{
+  OutputMixerStream *stream = (OutputMixerStream *)arg;
+
+  while (!stream->m_stopping)
+    {
+      sem_wait(&stream->m_done_sem);
+
+      /* Refill the frames released by the renderer */
+
+      while (!stream->m_stopping &&
+             (__atomic_load_n(&stream->m_in_flight, __ATOMIC_ACQUIRE) < stream->m_frame_num))
+        {
+          if (!stream->send(false))
+            {
+              print_err("ERROR: Fail to send PCM.\n");
+              break;
+            }
+        }
+    }
+
+  pthread_exit(0);
+}
+
+/*--------------------------------------------------------------------------*/
+void OutputMixerStream::send_callback(int32_t identifier, bool is_end)
+{
+  if ((identifier < 0) || (identifier > 1) || (s_streams[identifier] == NULL))
+    {
+      return;
+    }
+
+  s_streams[identifier]->done(is_end);
+}
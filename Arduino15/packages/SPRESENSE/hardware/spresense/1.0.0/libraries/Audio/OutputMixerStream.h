@@ -0,0 +1,154 @@
+/*
+ *  OutputMixerStream.h - Low latency PCM streaming on OutputMixer
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file OutputMixerStream.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Low latency PCM streaming on OutputMixer.
+ * @details Keeps a fixed number of PCM frames in the renderer, and asks the
+ *          application for the next frame each time one is rendered.
+ */
+
+#ifndef OutputMixerStream_h
+#define OutputMixerStream_h
+
+#include <stdint.h>
+#include <semaphore.h>
+#include <pthread.h>
+
+#include "OutputMixer.h"
+
+/* Segments of S0_REND_PCM_BUF_POOL in the memory layouts */
+
+#define OUTPUTMIXERSTREAM_FRAME_MAX 5
+
+/**
+ * @brief Fill a frame of PCM.
+ *
+ * @return false if no data is ready. Silence is rendered then.
+ */
+typedef bool (*OutputMixerStreamFill)(
+    void *buf,         /**< [out] Interleaved PCM of a frame */
+    uint32_t samples,  /**< Samples per channel of the frame */
+    void *arg          /**< Argument given to begin() */
+);
+
+/**
+ * @brief Statistics of OutputMixerStream
+ */
+typedef struct {
+  uint32_t frames;       /**< Frames sent to the renderer */
+  uint32_t silentFrames; /**< Frames of silence because the fill function had no data */
+  uint32_t underruns;    /**< Times the renderer had no frame left */
+  int      inFlight;     /**< Frames in the renderer now */
+  uint32_t latencyUs;    /**< Time from sending to the end of rendering of the last frame */
+  uint32_t maxLatencyUs; /**< Maximum of latencyUs */
+  uint32_t maxFillUs;    /**< Longest fill function in microseconds */
+} OutputMixerStreamStat;
+
+/**
+ * @class OutputMixerStream
+ * @brief PCM streaming on an output mixer
+ *
+ * @details The frames are pre-allocated from S0_REND_PCM_BUF_POOL, and
+ *          they go around between the renderer and the fill function. When
+ *          the renderer completes a frame, a thread of high priority calls
+ *          the fill function for the frame and sends it again. The latency
+ *          is the number of frames times the frame time, for example 2
+ *          frames of 240 samples at 48kHz are 10 ms.
+ *
+ *          Call begin() after OutputMixer::activate() and end() before
+ *          OutputMixer::deactivate(). Do not call OutputMixer::sendData()
+ *          on the same handle meanwhile.
+ */
+class OutputMixerStream
+{
+public:
+  OutputMixerStream();
+  ~OutputMixerStream();
+
+  /**
+   * @brief Allocate the frames and start streaming.
+   *
+   * @details The fill function is called for all frames before this
+   *          returns, and then from the stream thread.
+   */
+  err_t begin(
+      AsOutputMixerHandle handle,  /**< OutputMixer0 or OutputMixer1 */
+      OutputMixerStreamFill fill,  /**< Function to fill a frame */
+      void *arg = NULL,            /**< Argument of the fill function */
+      uint32_t samples = 240,      /**< Samples per channel of a frame */
+      uint8_t channels = 2,        /**< Number of channels */
+      uint8_t bit_length = 16,     /**< Bit length. 16 or 24 */
+      int frames = 2               /**< Frames in the renderer, 2 up to 5 */
+  );
+
+  /**
+   * @brief Stop streaming and free the frames.
+   *
+   * @details The frames in the renderer are played out, and the last frame
+   *          is sent with the end flag.
+   */
+  err_t end();
+
+  /**
+   * @brief Get statistics.
+   */
+  void getStat(OutputMixerStreamStat *stat /**< [out] Statistics */);
+
+  /**
+   * @brief Check streaming.
+   */
+  bool isStreaming() { return m_running; };
+
+private:
+  static const int STREAM_THREAD_STACK_SIZE = 2048;
+  static const int STREAM_THREAD_PRIO = 150;
+  static const int END_TIMEOUT_MS = 500;
+
+  AsOutputMixerHandle m_handle;
+  OutputMixerStreamFill m_fill;
+  void     *m_arg;
+  uint32_t  m_samples;
+  uint8_t   m_bit_length;
+  uint32_t  m_frame_size;
+  int       m_frame_num;
+  bool      m_running;
+  bool      m_stopping;
+  bool      m_ended;
+
+  MemMgrLite::MemHandle m_mh[OUTPUTMIXERSTREAM_FRAME_MAX];
+  uint32_t  m_sent_us[OUTPUTMIXERSTREAM_FRAME_MAX];
+  int       m_send_idx;
+  int       m_done_idx;
+  int       m_in_flight;
+
+  sem_t     m_done_sem;
+  pthread_t m_stream_tid;
+
+  OutputMixerStreamStat m_stat;
+
+  bool send(bool is_end);
+  void done(bool is_end);
+  void release();
+  static void stream_thread(void *arg);
+  static void send_callback(int32_t identifier, bool is_end);
+};
+
+#endif // OutputMixerStream_h
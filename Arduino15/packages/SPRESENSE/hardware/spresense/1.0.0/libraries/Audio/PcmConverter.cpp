@@ -0,0 +1,509 @@
+/*
+ *  PcmConverter.cpp - PCM format conversion and resampling
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+//***************************************************************************
+// Included Files
+//***************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "PcmConverter.h"
+
+#if defined(__arm__)
+/* Use CMSIS library */
+#define ARM_MATH_CM4
+#define __FPU_PRESENT 1U
+#include <cmsis/arm_math.h>
+#endif
+
+#define print_err printf
+
+/* Beta of the Kaiser window of the filter (about -60dB stop band) */
+
+#define RESAMPLER_KAISER_BETA 6.0f
+
+/* Pass band edge to the lower Nyquist frequency */
+
+#define RESAMPLER_CUTOFF 0.9f
+
+#define RESAMPLER_PHASE_MAX 256
+
+/*--------------------------------------------------------------------------*/
+static inline int16_t sat16(int32_t val)
+{
+#if defined(__arm__)
+  return (int16_t)__SSAT(val, 16);
+#else
+  return (val > 32767) ? 32767 : ((val < -32768) ? -32768 : val);
+#endif
+}
+
+/*--------------------------------------------------------------------------*/
+static inline int64_t dot_q15(const int16_t *a, const int16_t *b, uint32_t n)
+{
+#if defined(__arm__)
+  q63_t result;
+
+  /* Two products per instruction by SMLALD */
+
+  arm_dot_prod_q15((q15_t *)a, (q15_t *)b, n, &result);
+  return result;
+#else
+  int64_t sum = 0;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum += (int32_t)a[i] * b[i];
+    }
+  return sum;
+#endif
+}
+
+/*--------------------------------------------------------------------------*/
+static float bessel_i0(float x)
+{
+  float sum = 1.0f;
+  float term = 1.0f;
+
+  for (int k = 1; k < 32; k++)
+    {
+      term *= (x / (2.0f * k)) * (x / (2.0f * k));
+      sum += term;
+      if (term < sum * 1e-8f)
+        {
+          break;
+        }
+    }
+
+  return sum;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+  while (b != 0)
+    {
+      uint32_t t = a % b;
+      a = b;
+      b = t;
+    }
+
+  return a;
+}
+
+/****************************************************************************
+ * PcmConverter
+ ****************************************************************************/
+uint32_t PcmConverter::toS16(void *buf, uint32_t samples, PcmFormat format, bool dither)
+{
+  int16_t *dst = (int16_t *)buf;
+  const uint8_t *src8 = (const uint8_t *)buf;
+  const int32_t *src32 = (const int32_t *)buf;
+  uint32_t rnd = 0;
+
+  if (format == PcmFormatS16)
+    {
+      return samples * sizeof(int16_t);
+    }
+
+  /* The result is never behind the input, so it can be written in place. */
+
+  for (uint32_t i = 0; i < samples; i++)
+    {
+      int32_t val;
+
+      if (format == PcmFormatS24P)
+        {
+          val = (int32_t)(((uint32_t)src8[0] << 8) |
+                          ((uint32_t)src8[1] << 16) |
+                          ((uint32_t)src8[2] << 24)) >> 8;
+          src8 += 3;
+        }
+      else if (format == PcmFormatS24)
+        {
+          val = src32[i];
+        }
+      else
+        {
+          val = src32[i] >> 8;
+        }
+
+      /* Rounding, with triangular dither of +-1 LSB of the result.
+       * A random number of 32bit is for 2 samples.
+       */
+
+      int32_t round = 128;
+
+      if (dither)
+        {
+          if ((i & 1) == 0)
+            {
+              m_seed ^= m_seed << 13;
+              m_seed ^= m_seed >> 17;
+              m_seed ^= m_seed << 5;
+              rnd = m_seed;
+            }
+          else
+            {
+              rnd >>= 16;
+            }
+          round += (int32_t)(rnd & 0xff) + (int32_t)((rnd >> 8) & 0xff) - 255;
+        }
+
+      /* val is within 24bit, so the addition does not overflow. */
+
+      dst[i] = sat16((val + round) >> 8);
+    }
+
+  return samples * sizeof(int16_t);
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t PcmConverter::mixToMono(int16_t *buf, uint32_t frames, uint8_t channels)
+{
+  if (channels <= 1)
+    {
+      return frames * sizeof(int16_t);
+    }
+
+  uint32_t i = 0;
+
+  if (channels == 2)
+    {
+#if defined(__arm__)
+      /* Halving add of 2 frames at once */
+
+      for (; i + 2 <= frames; i += 2)
+        {
+          uint32_t w0;
+          uint32_t w1;
+
+          memcpy(&w0, &buf[i * 2], sizeof(w0));
+          memcpy(&w1, &buf[i * 2 + 2], sizeof(w1));
+
+          uint32_t left = __PKHBT(w0, w1, 16);
+          uint32_t right = __PKHTB(w1, w0, 16);
+          uint32_t mono = __SHADD16(left, right);
+
+          memcpy(&buf[i], &mono, sizeof(mono));
+        }
+#endif
+      for (; i < frames; i++)
+        {
+          buf[i] = (int16_t)(((int32_t)buf[i * 2] + buf[i * 2 + 1]) >> 1);
+        }
+    }
+  else
+    {
+      /* The average rounded to the nearest, by a shift for 4 and 8. For the
+       * others, the sum is offset to be positive for an unsigned divide.
+       */
+
+      int shift = (channels == 4) ? 2 : ((channels == 8) ? 3 : 0);
+      uint32_t offset = (uint32_t)channels * 32768 + channels / 2;
+
+      for (; i < frames; i++)
+        {
+          const int16_t *src = &buf[i * channels];
+          int32_t sum = 0;
+
+          for (int ch = 0; ch < channels; ch++)
+            {
+              sum += src[ch];
+            }
+
+          buf[i] = (shift > 0)
+            ? (int16_t)((sum + (1 << (shift - 1))) >> shift)
+            : (int16_t)((int32_t)(((uint32_t)sum + offset) / channels) - 32768);
+        }
+    }
+
+  return frames * sizeof(int16_t);
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t PcmConverter::selectChannels(int16_t *buf,
+                                      uint32_t frames,
+                                      uint8_t channels,
+                                      const uint8_t *select,
+                                      uint8_t select_num)
+{
+  if ((select == NULL) || (select_num == 0) || (select_num > channels) ||
+      (channels > PCMRESAMPLER_CH_MAX))
+    {
+      print_err("ERROR: Invalid channel selection.\n");
+      return 0;
+    }
+
+  for (int ch = 0; ch < select_num; ch++)
+    {
+      if (select[ch] >= channels)
+        {
+          print_err("ERROR: Invalid channel selection.\n");
+          return 0;
+        }
+    }
+
+  if (select_num == 1)
+    {
+      int sel = select[0];
+
+      for (uint32_t i = 0; i < frames; i++)
+        {
+          buf[i] = buf[i * channels + sel];
+        }
+    }
+  else
+    {
+      int16_t frame[PCMRESAMPLER_CH_MAX];
+
+      /* The frame is copied first, as the result may overwrite it. */
+
+      for (uint32_t i = 0; i < frames; i++)
+        {
+          memcpy(frame, &buf[i * channels], channels * sizeof(int16_t));
+          for (int ch = 0; ch < select_num; ch++)
+            {
+              buf[i * select_num + ch] = frame[select[ch]];
+            }
+        }
+    }
+
+  return frames * select_num * sizeof(int16_t);
+}
+
+/****************************************************************************
+ * PcmResampler
+ ****************************************************************************/
+PcmResampler::PcmResampler()
+  : m_up(0)
+  , m_down(0)
+  , m_channels(0)
+  , m_taps(0)
+  , m_coef(NULL)
+  , m_work(NULL)
+  , m_phase(0)
+{
+}
+
+/*--------------------------------------------------------------------------*/
+PcmResampler::~PcmResampler()
+{
+  end();
+}
+
+/*--------------------------------------------------------------------------*/
+bool PcmResampler::begin(uint32_t in_rate, uint32_t out_rate, uint8_t channels, uint8_t taps)
+{
+  end();
+
+  if ((in_rate == 0) || (out_rate == 0) || (channels == 0) ||
+      (channels > PCMRESAMPLER_CH_MAX) || (taps == 0) || (taps > PCMRESAMPLER_TAPS_MAX))
+    {
+      print_err("ERROR: Invalid parameter of resampler.\n");
+      return false;
+    }
+
+  uint32_t div = gcd(in_rate, out_rate);
+
+  m_up       = out_rate / div;
+  m_down     = in_rate / div;
+  m_channels = channels;
+  m_taps     = taps;
+
+  if (m_up > RESAMPLER_PHASE_MAX)
+    {
+      print_err("ERROR: Ratio of the rates is too complex.\n");
+      return false;
+    }
+
+  m_coef = (int16_t *)malloc(m_taps * m_up * sizeof(int16_t));
+  m_work = (int16_t *)malloc((m_taps - 1 + BLOCK_FRAMES) * m_channels * sizeof(int16_t));
+  if ((m_coef == NULL) || (m_work == NULL))
+    {
+      print_err("ERROR: Fail to allocate memory.\n");
+      end();
+      return false;
+    }
+
+  design();
+  reset();
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void PcmResampler::end()
+{
+  free(m_coef);
+  free(m_work);
+  m_coef = NULL;
+  m_work = NULL;
+  m_up   = 0;
+}
+
+/*--------------------------------------------------------------------------*/
+void PcmResampler::reset()
+{
+  if (m_work != NULL)
+    {
+      memset(m_work, 0, (m_taps - 1 + BLOCK_FRAMES) * m_channels * sizeof(int16_t));
+    }
+
+  m_phase = 0;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t PcmResampler::outputFrames(uint32_t frames)
+{
+  uint64_t end = (uint64_t)frames * m_up;
+
+  if ((m_up == 0) || (end <= m_phase))
+    {
+      return 0;
+    }
+
+  return (uint32_t)((end - m_phase + m_down - 1) / m_down);
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t PcmResampler::process(const int16_t *in, uint32_t frames, int16_t *out, uint32_t out_frames)
+{
+  uint32_t hist = m_taps - 1;
+  uint32_t stride = hist + BLOCK_FRAMES;
+  uint32_t out_num = 0;
+
+  if ((m_up == 0) || (in == NULL) || (out == NULL))
+    {
+      return 0;
+    }
+
+  for (uint32_t pos = 0; pos < frames; pos += BLOCK_FRAMES)
+    {
+      uint32_t len = frames - pos;
+      if (len > BLOCK_FRAMES)
+        {
+          len = BLOCK_FRAMES;
+        }
+
+      /* Deinterleave the block after the kept samples. The block is read
+       * before the outputs of it are written, so in and out can be the
+       * same buffer when the outputs are not more than the inputs.
+       */
+
+      const int16_t *src = &in[pos * m_channels];
+      for (int ch = 0; ch < m_channels; ch++)
+        {
+          int16_t *work = &m_work[ch * stride + hist];
+          for (uint32_t i = 0; i < len; i++)
+            {
+              work[i] = src[i * m_channels + ch];
+            }
+        }
+
+      /* Output at the positions of the upsampled input */
+
+      uint32_t end = len * m_up;
+      for (; m_phase < end; m_phase += m_down)
+        {
+          uint32_t n = m_phase / m_up;
+          const int16_t *coef = &m_coef[(m_phase % m_up) * m_taps];
+
+          for (int ch = 0; ch < m_channels; ch++)
+            {
+              int64_t acc = dot_q15(coef, &m_work[ch * stride + n], m_taps);
+
+              /* Within 22bit after the shift for up to 64 taps */
+
+              if (out_num < out_frames)
+                {
+                  out[out_num * m_channels + ch] = sat16((int32_t)((acc + (1 << 14)) >> 15));
+                }
+            }
+
+          if (out_num < out_frames)
+            {
+              out_num++;
+            }
+        }
+
+      m_phase -= end;
+
+      /* Keep the last samples for the next block */
+
+      for (int ch = 0; ch < m_channels; ch++)
+        {
+          int16_t *work = &m_work[ch * stride];
+          memmove(work, work + len, hist * sizeof(int16_t));
+        }
+    }
+
+  return out_num;
+}
+
+/*--------------------------------------------------------------------------*/
+void PcmResampler::design()
+{
+  uint32_t len = m_taps * m_up;
+  float center = (len - 1) / 2.0f;
+  float fc = RESAMPLER_CUTOFF * 0.5f / ((m_up > m_down) ? m_up : m_down);
+  float i0_beta = bessel_i0(RESAMPLER_KAISER_BETA);
+  float *h = (float *)malloc(len * sizeof(float));
+  float sum = 0.0f;
+
+  if (h == NULL)
+    {
+      print_err("ERROR: Fail to allocate memory.\n");
+      memset(m_coef, 0, len * sizeof(int16_t));
+      return;
+    }
+
+  /* Windowed sinc at the upsampled rate */
+
+  for (uint32_t k = 0; k < len; k++)
+    {
+      float x = k - center;
+      float sinc = (x == 0.0f) ? 1.0f : sinf(2.0f * (float)M_PI * fc * x) / (2.0f * (float)M_PI * fc * x);
+      float r = (len > 1) ? (2.0f * k / (len - 1) - 1.0f) : 0.0f;
+      float w = bessel_i0(RESAMPLER_KAISER_BETA * sqrtf(1.0f - r * r)) / i0_beta;
+
+      h[k] = 2.0f * fc * sinc * w;
+      sum += h[k];
+    }
+
+  /* Gain of 1 in each phase. The phase p takes h[p + i * up] for the input
+   * i samples before, and the coefficients are reversed to multiply the
+   * samples in the order of time.
+   */
+
+  for (uint32_t p = 0; p < m_up; p++)
+    {
+      for (uint32_t i = 0; i < m_taps; i++)
+        {
+          float c = h[p + (m_taps - 1 - i) * m_up] * m_up / sum * 32768.0f;
+          int32_t q = (int32_t)lrintf(c);
+
+          m_coef[p * m_taps + i] = (q > 32767) ? 32767 : ((q < -32768) ? -32768 : q);
+        }
+    }
+
+  free(h);
+}
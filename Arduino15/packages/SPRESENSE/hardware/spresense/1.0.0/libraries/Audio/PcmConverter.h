@@ -0,0 +1,185 @@
+/*
+ *  PcmConverter.h - PCM format conversion and resampling
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file PcmConverter.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief PCM format conversion and resampling.
+ * @details Converts captured PCM blocks in place, such as the spans of
+ *          peekFrames() or the buffer of readFrames(), to 16bit PCM with
+ *          fewer channels and a lower sampling rate. Uses the SIMD
+ *          instructions of the Cortex-M4 through CMSIS, and builds on other
+ *          hosts with plain C.
+ */
+
+#ifndef PcmConverter_h
+#define PcmConverter_h
+
+#include <stdint.h>
+
+#define PCMRESAMPLER_CH_MAX   8
+#define PCMRESAMPLER_TAPS_MAX 64
+
+/**
+ * @brief Sample format of the input PCM
+ */
+typedef enum {
+  PcmFormatS16,   /**< 16bit */
+  PcmFormatS24P,  /**< 24bit packed in 3 bytes */
+  PcmFormatS24,   /**< 24bit in the lower bits of 32bit, sign extended */
+  PcmFormatS32    /**< 32bit, or 24bit in the upper bits of 32bit */
+} PcmFormat;
+
+/**
+ * @class PcmConverter
+ * @brief Bit length and channel conversion in place
+ *
+ * @details The result is written from the start of the buffer, and the
+ *          functions return the size of the result.
+ */
+class PcmConverter
+{
+public:
+  PcmConverter() : m_seed(0x12345678) {}
+
+  /**
+   * @brief Convert samples to 16bit.
+   *
+   * @details With dither, triangular noise of 1 LSB of the result is added
+   *          before rounding, so that quiet signals do not become
+   *          distortion.
+   *
+   * @return Bytes of the result.
+   */
+  uint32_t toS16(
+      void *buf,          /**< Samples of all channels */
+      uint32_t samples,   /**< Number of samples. Frames x channels */
+      PcmFormat format,   /**< Format of the input */
+      bool dither = true  /**< Add dither */
+  );
+
+  /**
+   * @brief Mix the channels to mono by the average.
+   *
+   * @details The average is rounded to the nearest. For 2 channels, it is
+   *          rounded down as the halving add of the DSP instructions.
+   *
+   * @return Bytes of the result.
+   */
+  static uint32_t mixToMono(
+      int16_t *buf,       /**< Interleaved 16bit samples */
+      uint32_t frames,    /**< Number of frames */
+      uint8_t channels    /**< Number of channels */
+  );
+
+  /**
+   * @brief Pick channels from each frame.
+   *
+   * @details select is the list of the channel indexes of the result. For
+   *          example, {0, 4} picks the 1st and the 5th microphone of the
+   *          8 channel map.
+   *
+   * @return Bytes of the result, or 0 on invalid parameters.
+   */
+  static uint32_t selectChannels(
+      int16_t *buf,            /**< Interleaved 16bit samples */
+      uint32_t frames,         /**< Number of frames */
+      uint8_t channels,        /**< Number of channels */
+      const uint8_t *select,   /**< Channel indexes to pick */
+      uint8_t select_num       /**< Number of indexes, up to channels */
+  );
+
+private:
+  uint32_t m_seed;
+};
+
+/**
+ * @class PcmResampler
+ * @brief Polyphase FIR resampler for 16bit PCM
+ *
+ * @details Converts the sampling rate by the ratio of out_rate to in_rate
+ *          with a windowed sinc filter of taps coefficients per output
+ *          sample. The filter keeps the samples of the previous call, so
+ *          the input can be given block by block, such as the two spans of
+ *          peekFrames(). If out_rate is not above in_rate, the output can
+ *          be the same buffer as the input.
+ */
+class PcmResampler
+{
+public:
+  PcmResampler();
+  ~PcmResampler();
+
+  /**
+   * @brief Create the filter.
+   *
+   * @details The rates are reduced by their greatest common divisor, and
+   *          the reduced out_rate is the number of the filter phases, such
+   *          as 1 for 48000 to 16000 and 160 for 44100 to 16000. The memory
+   *          for the coefficients is taps x phases x 2 bytes.
+   */
+  bool begin(
+      uint32_t in_rate,     /**< Sampling rate of the input */
+      uint32_t out_rate,    /**< Sampling rate of the output */
+      uint8_t channels,     /**< Number of channels, up to 8 */
+      uint8_t taps = 48     /**< Coefficients per output sample, up to 64 */
+  );
+
+  /**
+   * @brief Free the filter.
+   */
+  void end();
+
+  /**
+   * @brief Clear the samples kept from the previous call.
+   */
+  void reset();
+
+  /**
+   * @brief Resample interleaved 16bit frames.
+   *
+   * @return Number of output frames.
+   */
+  uint32_t process(
+      const int16_t *in,    /**< Input frames */
+      uint32_t frames,      /**< Number of input frames */
+      int16_t *out,         /**< Output frames. Can be in if out_rate <= in_rate */
+      uint32_t out_frames   /**< Size of out in frames */
+  );
+
+  /**
+   * @brief Maximum number of output frames for the input frames.
+   */
+  uint32_t outputFrames(uint32_t frames);
+
+private:
+  static const int BLOCK_FRAMES = 128;
+
+  uint32_t  m_up;        /* Interpolation factor (phases) */
+  uint32_t  m_down;      /* Decimation factor */
+  uint8_t   m_channels;
+  uint8_t   m_taps;
+  int16_t  *m_coef;      /* taps x phases, reversed in each phase */
+  int16_t  *m_work;      /* (taps - 1 + BLOCK_FRAMES) x channels, planar */
+  uint32_t  m_phase;     /* Position of the next output in the upsampled input */
+
+  void design();
+};
+
+#endif // PcmConverter_h
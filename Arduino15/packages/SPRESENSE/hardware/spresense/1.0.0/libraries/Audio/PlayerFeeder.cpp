@@ -0,0 +1,477 @@
+/*
+ *  PlayerFeeder.cpp - Background file reader for the audio players
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+//***************************************************************************
+// Included Files
+//***************************************************************************
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "PlayerFeeder.h"
+
+#define print_err printf
+
+#define REMAIN_UNLIMITED 0xffffffff
+
+/****************************************************************************
+ * Public API on PlayerFeeder
+ ****************************************************************************/
+PlayerFeeder::PlayerFeeder()
+  : m_fifo(NULL)
+  , m_running(false)
+  , m_stopping(false)
+  , m_primed(false)
+  , m_empty(false)
+  , m_queue_head(0)
+  , m_queue_num(0)
+  , m_pending(0)
+  , m_remain(0)
+  , m_next_remain(0)
+  , m_stage(NULL)
+  , m_read_size(0)
+  , m_stage_pos(0)
+  , m_stage_len(0)
+  , m_feeder_tid(-1)
+{
+  sem_init(&m_lock, 0, 1);
+  sem_init(&m_wake, 0, 0);
+  memset(&m_stat, 0, sizeof(m_stat));
+}
+
+/*--------------------------------------------------------------------------*/
+PlayerFeeder::~PlayerFeeder()
+{
+  end();
+  sem_destroy(&m_lock);
+  sem_destroy(&m_wake);
+}
+
+/*--------------------------------------------------------------------------*/
+bool PlayerFeeder::queue(const char *path, uint32_t offset, uint32_t size)
+{
+  if (path == NULL)
+    {
+      return false;
+    }
+
+  lock();
+
+  if (m_queue_num >= PLAYERFEEDER_QUEUE_NUM)
+    {
+      unlock();
+      return false;
+    }
+
+  Entry *e = &m_queue[(m_queue_head + m_queue_num) % PLAYERFEEDER_QUEUE_NUM];
+
+  if (RawFile::fullPath(e->path, sizeof(e->path), path) == NULL)
+    {
+      unlock();
+      return false;
+    }
+  e->offset = offset;
+  e->size   = size;
+  m_queue_num++;
+  m_pending++;
+
+  unlock();
+
+  sem_post(&m_wake);
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerFeeder::end()
+{
+  if (!m_running)
+    {
+      return;
+    }
+
+  m_stopping = true;
+  sem_post(&m_wake);
+  pthread_join(m_feeder_tid, NULL);
+  m_feeder_tid = -1;
+
+  release();
+  m_running = false;
+}
+
+/*--------------------------------------------------------------------------*/
+int PlayerFeeder::queued()
+{
+  lock();
+  int num = m_queue_num;
+  unlock();
+
+  return num;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t PlayerFeeder::buffered()
+{
+  if (m_fifo == NULL)
+    {
+      return 0;
+    }
+
+  return CMN_SimpleFifoGetOccupiedSize(m_fifo);
+}
+
+/*--------------------------------------------------------------------------*/
+bool PlayerFeeder::isEnd()
+{
+  lock();
+  bool end = (m_pending == 0) && (m_stage_pos == m_stage_len);
+  unlock();
+
+  return end;
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerFeeder::getStat(PlayerFeederStat *stat)
+{
+  if (stat == NULL)
+    {
+      return;
+    }
+
+  lock();
+  *stat = m_stat;
+  unlock();
+}
+
+/****************************************************************************
+ * Protected API on PlayerFeeder
+ ****************************************************************************/
+bool PlayerFeeder::start(CMN_SimpleFifoHandle *fifo, size_t read_size)
+{
+  if (m_running)
+    {
+      print_err("ERROR: Feeder is already running.\n");
+      return false;
+    }
+
+  if ((fifo == NULL) || (read_size < RawFile::SECTOR_SIZE) ||
+      (read_size % RawFile::SECTOR_SIZE != 0))
+    {
+      print_err("ERROR: Invalid parameter of feeder.\n");
+      return false;
+    }
+
+  m_stage = RawFile::allocBuffer(read_size);
+  if (m_stage == NULL)
+    {
+      print_err("ERROR: Fail to allocate memory.\n");
+      return false;
+    }
+
+  m_fifo      = fifo;
+  m_read_size = read_size;
+  m_stage_pos = 0;
+  m_stage_len = 0;
+  m_stopping  = false;
+  m_primed    = false;
+  m_empty     = false;
+  memset(&m_stat, 0, sizeof(m_stat));
+
+  struct sched_param param;
+  pthread_attr_t tattr;
+
+  pthread_attr_init(&tattr);
+  tattr.stacksize = FEEDER_THREAD_STACK_SIZE;
+  param.sched_priority = FEEDER_THREAD_PRIO;
+  pthread_attr_setschedparam(&tattr, &param);
+
+  m_running = true;
+  if (pthread_create(&m_feeder_tid, &tattr,
+                     (pthread_startroutine_t)PlayerFeeder::feeder_thread,
+                     (void *)this))
+    {
+      print_err("ERROR: Cannot create feeder thread.\n");
+      m_running = false;
+      release();
+      return false;
+    }
+  pthread_setname_np(m_feeder_tid, "player_feeder");
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerFeeder::wait_poll()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  ts.tv_nsec += POLL_INTERVAL_MS * 1000000L;
+  if (ts.tv_nsec >= 1000000000L)
+    {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000L;
+    }
+  sem_timedwait(&m_wake, &ts);
+}
+
+/*--------------------------------------------------------------------------*/
+ssize_t PlayerFeeder::read_file(RawFile &file, uint8_t *buf, size_t size, uint32_t *us)
+{
+  return file.read(buf, size, us);
+}
+
+/****************************************************************************
+ * Private API on PlayerFeeder
+ ****************************************************************************/
+void PlayerFeeder::release()
+{
+  m_file.close();
+  m_next_file.close();
+
+  if (m_stage != NULL)
+    {
+      free(m_stage);
+      m_stage = NULL;
+    }
+
+  lock();
+  m_queue_head = 0;
+  m_queue_num  = 0;
+  m_pending    = 0;
+  m_stage_pos  = 0;
+  m_stage_len  = 0;
+  unlock();
+}
+
+/*--------------------------------------------------------------------------*/
+bool PlayerFeeder::open_entry(RawFile *file, uint32_t *remain)
+{
+  Entry e;
+
+  lock();
+  if (m_queue_num == 0)
+    {
+      unlock();
+      return false;
+    }
+  e = m_queue[m_queue_head];
+  m_queue_head = (m_queue_head + 1) % PLAYERFEEDER_QUEUE_NUM;
+  m_queue_num--;
+  unlock();
+
+  if (!file->openRead(e.path, e.offset))
+    {
+      print_err("ERROR: Cannot open %s.\n", e.path);
+      lock();
+      m_stat.errors++;
+      m_pending--;
+      unlock();
+      return false;
+    }
+
+  *remain = (e.size > 0) ? e.size : REMAIN_UNLIMITED;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerFeeder::close_file(bool completed)
+{
+  m_file.close();
+
+  lock();
+  m_stat.tracks += completed ? 1 : 0;
+  m_pending--;
+  unlock();
+}
+
+/*--------------------------------------------------------------------------*/
+bool PlayerFeeder::read_stage()
+{
+  /* The next file is opened in advance, so that it follows without a gap. */
+
+  if (!m_file.isOpen())
+    {
+      if (m_next_file.isOpen())
+        {
+          m_file = m_next_file;
+          m_remain = m_next_remain;
+          m_next_file = RawFile();
+        }
+      else if (!open_entry(&m_file, &m_remain))
+        {
+          return false;
+        }
+    }
+
+  if (!m_next_file.isOpen())
+    {
+      open_entry(&m_next_file, &m_next_remain);
+    }
+
+  /* Keep the reads on the sector boundary after the offset of the data. */
+
+  off_t pos = m_file.position();
+  size_t size = m_read_size - ((pos > 0) ? (pos % RawFile::SECTOR_SIZE) : 0);
+  if (size > m_remain)
+    {
+      size = m_remain;
+    }
+
+  uint32_t us;
+  ssize_t ret = read_file(m_file, m_stage, size, &us);
+
+  if (ret < 0)
+    {
+      print_err("ERROR: Fail to read file.\n");
+      lock();
+      m_stat.errors++;
+      unlock();
+    }
+
+  if (ret <= 0)
+    {
+      close_file(ret == 0);
+      return false;
+    }
+
+  if (m_remain != REMAIN_UNLIMITED)
+    {
+      m_remain -= ret;
+    }
+
+  lock();
+  m_stage_pos = 0;
+  m_stage_len = ret;
+  if (us > m_stat.maxReadUs)
+    {
+      m_stat.maxReadUs = us;
+    }
+  unlock();
+
+  if (m_remain == 0)
+    {
+      close_file(true);
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool PlayerFeeder::offer_stage()
+{
+  size_t size = m_stage_len - m_stage_pos;
+  size_t vacant = CMN_SimpleFifoGetVacantSize(m_fifo);
+  bool all = true;
+
+  if (vacant < size)
+    {
+      size = vacant;
+      all = false;
+
+      /* From here, the FIFO has been filled once. */
+
+      if (!m_primed)
+        {
+          m_primed = true;
+          lock();
+          m_stat.fifoMin = CMN_SimpleFifoGetOccupiedSize(m_fifo) + size;
+          unlock();
+        }
+    }
+
+  if ((size > 0) && (CMN_SimpleFifoOffer(m_fifo, m_stage + m_stage_pos, size) == 0))
+    {
+      print_err("Simple FIFO is full!\n");
+      return false;
+    }
+
+  lock();
+  m_stage_pos += size;
+  m_stat.bytes += size;
+  unlock();
+
+  return all;
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerFeeder::check_level()
+{
+  if (!m_primed)
+    {
+      return;
+    }
+
+  uint32_t level = CMN_SimpleFifoGetOccupiedSize(m_fifo);
+
+  lock();
+  if (level < m_stat.fifoMin)
+    {
+      m_stat.fifoMin = level;
+    }
+
+  /* Count once until the data comes again. */
+
+  if ((level == 0) && !m_empty)
+    {
+      m_stat.underruns++;
+    }
+  unlock();
+
+  m_empty = (level == 0);
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerFeeder::feeder_thread(void *arg)
+{
+  PlayerFeeder *feeder = (PlayerFeeder *)arg;
+
+  while (!feeder->m_stopping)
+    {
+      bool wait = false;
+
+      if (feeder->m_stage_pos == feeder->m_stage_len)
+        {
+          if (!feeder->read_stage())
+            {
+              /* Wait for a file only if no file is left. */
+
+              feeder->lock();
+              wait = (feeder->m_pending == 0);
+              feeder->unlock();
+            }
+        }
+      else
+        {
+          /* The data of the last read is there while the FIFO has no room. */
+
+          feeder->check_level();
+          wait = !feeder->offer_stage();
+        }
+
+      if (wait)
+        {
+          feeder->wait_poll();
+        }
+    }
+
+  pthread_exit(0);
+}
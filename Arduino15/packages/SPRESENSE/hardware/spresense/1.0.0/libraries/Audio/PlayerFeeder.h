@@ -0,0 +1,235 @@
+/*
+ *  PlayerFeeder.h - Background file reader for the audio players
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file PlayerFeeder.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Background file reader for the audio players.
+ * @details Reads the files of a playlist from a background thread into the
+ *          FIFO of a player, instead of writeFrames(File&) in loop().
+ *          Use AudioPlayerFeeder for AudioClass and MediaPlayerFeeder for
+ *          MediaPlayer. Both are PlayerFeederFor of the player class.
+ */
+
+#ifndef PlayerFeeder_h
+#define PlayerFeeder_h
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <semaphore.h>
+#include <pthread.h>
+
+#include <memutils/simple_fifo/CMN_SimpleFifo.h>
+#include <RawFile.h>
+
+#define PLAYERFEEDER_QUEUE_NUM 4
+#define PLAYERFEEDER_PATH_LEN  128
+
+/**
+ * @brief Statistics of PlayerFeeder
+ */
+typedef struct {
+  uint64_t bytes;      /**< Bytes given to the player */
+  uint32_t tracks;     /**< Files read to the end */
+  uint32_t underruns;  /**< Times the FIFO ran out of data while playing */
+  uint32_t errors;     /**< Open or read errors. The file is skipped. */
+  uint32_t fifoMin;    /**< Minimum bytes in the FIFO after it was filled */
+  uint32_t maxReadUs;  /**< Longest read in microseconds */
+} PlayerFeederStat;
+
+/**
+ * @class PlayerFeeder
+ * @brief Background file reader for a player
+ *
+ * @details The thread reads the queued files with reads of read_size bytes
+ *          and puts the data into the FIFO of the player. The FIFO is the
+ *          read-ahead buffer, so give a large buffer size to setPlayerMode()
+ *          or MediaPlayer::activate() to bridge long stalls of the SD card.
+ *
+ *          The files are played without a gap. The next file is opened while
+ *          the current one is being read, and its data follows the current
+ *          one in the FIFO. All files should have the same format.
+ *
+ *          Call begin() after initPlayer(), queue files, wait until the FIFO
+ *          is filled and start the player. When isEnd() becomes true, stop
+ *          the player with AS_STOPPLAYER_ESEND.
+ */
+class PlayerFeeder
+{
+public:
+  PlayerFeeder();
+  virtual ~PlayerFeeder();
+
+  /**
+   * @brief Add a file to the playlist.
+   *
+   * @details The data from offset is played. If size is 0, it is played to
+   *          the end of the file. For a WAV file, give the data chunk.
+   *          A path without "/mnt/" is treated as a file on the SD card.
+   *          Files can be added while playing.
+   *
+   * @return false if the playlist is full.
+   */
+  bool queue(
+      const char *path,  /**< File to play */
+      uint32_t offset = 0, /**< Offset of the data */
+      uint32_t size = 0    /**< Bytes of the data. 0 for the whole file. */
+  );
+
+  /**
+   * @brief Stop reading and close the files.
+   */
+  void end();
+
+  /**
+   * @brief Number of files waiting in the playlist, without the current one.
+   */
+  int queued();
+
+  /**
+   * @brief Bytes in the FIFO of the player.
+   */
+  uint32_t buffered();
+
+  /**
+   * @brief Check the end of the playlist.
+   *
+   * @return true if all files have been put into the FIFO.
+   */
+  bool isEnd();
+
+  /**
+   * @brief Get statistics.
+   */
+  void getStat(PlayerFeederStat *stat /**< [out] Statistics */);
+
+protected:
+  static const int POLL_INTERVAL_MS = 10;
+
+  bool start(CMN_SimpleFifoHandle *fifo, size_t read_size);
+
+  /**
+   * @brief Wait while the feeder has nothing to do.
+   *
+   * @details Called on the feeder thread when the FIFO is full or no file
+   *          is left. Returns after POLL_INTERVAL_MS, or when a file is
+   *          queued or end() is called. Override it to run the feeder on
+   *          another clock, e.g. the simulated time on a host.
+   */
+  virtual void wait_poll();
+
+  /**
+   * @brief Read the next data of the current file.
+   *
+   * @details Called on the feeder thread for each read. us is the time of
+   *          the read for the statistics. Override it to add the latency of
+   *          a slower storage, e.g. on a host.
+   *
+   * @return Bytes read, 0 at the end of the file, or -1 for failure.
+   */
+  virtual ssize_t read_file(RawFile &file, uint8_t *buf, size_t size, uint32_t *us);
+
+private:
+  static const int FEEDER_THREAD_STACK_SIZE = 2048;
+  static const int FEEDER_THREAD_PRIO = 120;
+
+  typedef struct {
+    char     path[PLAYERFEEDER_PATH_LEN];
+    uint32_t offset;
+    uint32_t size;
+  } Entry;
+
+  CMN_SimpleFifoHandle *m_fifo;
+  bool      m_running;
+  bool      m_stopping;
+  bool      m_primed;
+  bool      m_empty;
+
+  Entry     m_queue[PLAYERFEEDER_QUEUE_NUM];
+  int       m_queue_head;
+  int       m_queue_num;
+  int       m_pending;
+
+  RawFile   m_file;
+  uint32_t  m_remain;
+  RawFile   m_next_file;
+  uint32_t  m_next_remain;
+
+  uint8_t  *m_stage;
+  size_t    m_read_size;
+  size_t    m_stage_pos;
+  size_t    m_stage_len;
+
+  sem_t     m_lock;
+  sem_t     m_wake;
+  pthread_t m_feeder_tid;
+
+  PlayerFeederStat m_stat;
+
+  void lock() { sem_wait(&m_lock); };
+  void unlock() { sem_post(&m_lock); };
+  bool open_entry(RawFile *file, uint32_t *remain);
+  void close_file(bool completed);
+  bool read_stage();
+  bool offer_stage();
+  void check_level();
+  void release();
+  static void feeder_thread(void *arg);
+};
+
+/**
+ * @class PlayerFeederFor
+ * @brief PlayerFeeder for a player of AudioClass or MediaPlayer
+ *
+ * @details Use it as AudioPlayerFeeder or MediaPlayerFeeder.
+ */
+template <class PLAYER>
+class PlayerFeederFor : public PlayerFeeder
+{
+public:
+
+  /**
+   * @brief Start the feeder thread for the player.
+   *
+   * @details Call after AudioClass::setPlayerMode() or
+   *          MediaPlayer::activate(). The read-ahead is the FIFO size
+   *          given to them.
+   *
+   * @return false if the FIFO of the player is not allocated, or the
+   *         feeder cannot start.
+   */
+  bool begin(
+      typename PLAYER::PlayerId id, /**< Select Player ID. */
+      size_t read_size = 16384      /**< Bytes of one read, multiple of 512 */
+  )
+  {
+    PLAYER *player = PLAYER::getInstance();
+    bool first = (id == PLAYER::Player0);
+    uint32_t *p_fifo = first
+      ? player->m_player0_simple_fifo_buf : player->m_player1_simple_fifo_buf;
+    CMN_SimpleFifoHandle *handle = first
+      ? &player->m_player0_simple_fifo_handle : &player->m_player1_simple_fifo_handle;
+
+    /* Without the FIFO area, the handle is not initialized. */
+
+    return start(p_fifo ? handle : NULL, read_size);
+  }
+};
+
+#endif // PlayerFeeder_h
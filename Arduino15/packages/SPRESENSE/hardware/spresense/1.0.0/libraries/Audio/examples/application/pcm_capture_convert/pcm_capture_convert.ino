@@ -0,0 +1,211 @@
+/*
+ *  pcm_capture_convert.ino - PCM capture converted to 16kHz 16bit mono in place
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <Audio.h>
+#include <PcmConverter.h>
+
+AudioClass *theAudio;
+
+/* Captured by 4 microphones at 48kHz 24bit. The recorder puts a 24bit
+ * sample in 3 bytes, the same as the WAV files.
+ */
+
+static const int32_t channel_num = 4;
+static const int32_t frame_size  = channel_num * 3;
+static const int32_t recoding_frames = 48000 * 10; /* 10 seconds */
+
+/* The FIFO size is a multiple of the frame size, so that the data is not
+ * split in the middle of a frame where the FIFO wraps around.
+ */
+
+static const uint32_t fifo_size = frame_size * 768 * 16;
+
+/* The microphone to use */
+
+static const uint8_t mic_select[] = { 0 };
+
+static PcmConverter theConverter;
+static PcmResampler theResampler;
+
+/* Level of the 16kHz mono signal in the current second */
+
+static uint64_t s_power;
+static int32_t s_samples;
+
+bool ErrEnd = false;
+
+/**
+ * @brief Audio attention callback
+ *
+ * When audio internal error occurs, this function will be called back.
+ */
+
+void audio_attention_cb(const ErrorAttentionParam *atprm)
+{
+  puts("Attention!");
+
+  if (atprm->error_code >= AS_ATTENTION_CODE_WARNING)
+    {
+      ErrEnd = true;
+    }
+}
+
+/**
+ *  @brief Setup audio device to capture PCM stream
+ *
+ *  Select input device as microphone <br>
+ *  Capture 4 channels at 48kHz 24bit <br>
+ *  Prepare the resampler from 48kHz to 16kHz
+ */
+void setup()
+{
+  theAudio = AudioClass::getInstance();
+
+  theAudio->begin(audio_attention_cb);
+
+  puts("initialization Audio Library");
+
+  theAudio->setRecorderMode(AS_SETRECDR_STS_INPUTDEVICE_MIC, 0, fifo_size);
+
+  theAudio->initRecorder(AS_CODECTYPE_PCM, "/mnt/sd0/BIN", AS_SAMPLINGRATE_48000,
+                         AS_BITLENGTH_24, AS_CHANNEL_4CH);
+  puts("Init Recorder!");
+
+  if (!theResampler.begin(48000, 16000, 1))
+    {
+      puts("Resampler error");
+      exit(1);
+    }
+
+  puts("Rec!");
+  theAudio->startRecorder();
+}
+
+/**
+ * @brief Signal process for 16kHz 16bit mono, such as keyword spotting
+ */
+
+void signal_process(const int16_t *pcm, uint32_t samples)
+{
+  for (uint32_t i = 0; i < samples; i++)
+    {
+      s_power += (int32_t)pcm[i] * pcm[i];
+    }
+
+  s_samples += samples;
+  if (s_samples >= 16000)
+    {
+      printf("Level %lu\n", (unsigned long)sqrt((double)s_power / s_samples));
+      s_power = 0;
+      s_samples = 0;
+    }
+}
+
+/**
+ * @brief Convert the captured data in the FIFO
+ *
+ * 24bit to 16bit, 4 channels to 1 channel and 48kHz to 16kHz. Each result
+ * is smaller than the input, so all steps work in the same area.
+ */
+
+void convert_frames(uint8_t *data, uint32_t size)
+{
+  int16_t *pcm = (int16_t *)data;
+  uint32_t frames = size / frame_size;
+
+  theConverter.toS16(data, frames * channel_num, PcmFormatS24P);
+  PcmConverter::selectChannels(pcm, frames, channel_num, mic_select, sizeof(mic_select));
+  frames = theResampler.process(pcm, frames, pcm, frames);
+
+  signal_process(pcm, frames);
+}
+
+/**
+ * @brief Process the captured data in place and release it
+ */
+
+err_t execute_frames(uint32_t *frames)
+{
+  AudioFifoSpan span;
+
+  err_t err = theAudio->peekFrames(&span);
+  if (err != AUDIOLIB_ECODE_OK)
+    {
+      return err;
+    }
+
+  if (span.size1 > 0)
+    {
+      convert_frames(span.data1, span.size1);
+    }
+  if (span.size2 > 0)
+    {
+      convert_frames(span.data2, span.size2);
+    }
+
+  *frames = (span.size1 + span.size2) / frame_size;
+
+  return theAudio->consumeFrames(span.size1 + span.size2);
+}
+
+/**
+ * @brief Capture frames of PCM data
+ */
+void loop() {
+
+  static int32_t total_frames = 0;
+  uint32_t frames = 0;
+
+  err_t err = execute_frames(&frames);
+  if (err != AUDIOLIB_ECODE_OK)
+    {
+      theAudio->stopRecorder();
+      goto exitRecording;
+    }
+
+  total_frames += frames;
+
+  /* Stop Recording */
+  if (total_frames > recoding_frames)
+    {
+      theAudio->stopRecorder();
+      goto exitRecording;
+    }
+
+  if (ErrEnd)
+    {
+      printf("Error End\n");
+      theAudio->stopRecorder();
+      goto exitRecording;
+    }
+
+  /* Wait for some frames. 10 ms at least by the system tick. */
+
+  usleep(10000);
+
+  return;
+
+exitRecording:
+
+  theAudio->setReadyMode();
+  theAudio->end();
+
+  puts("End Recording");
+  exit(1);
+}
@@ -0,0 +1,193 @@
+/*
+ *  pcm_capture_span.ino - PCM capture example processing the data in place
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <Audio.h>
+
+AudioClass *theAudio;
+
+static const int32_t channel_num  = 4;
+static const int32_t sample_size  = channel_num * sizeof(int16_t);
+static const int32_t recoding_size = 48000 * sample_size * 10; /* 10 seconds */
+
+/* Peak level of each channel in the current second */
+
+static int s_peak[channel_num];
+static int32_t s_samples;
+
+bool ErrEnd = false;
+
+/**
+ * @brief Audio attention callback
+ *
+ * When audio internal error occurs, this function will be called back.
+ */
+
+void audio_attention_cb(const ErrorAttentionParam *atprm)
+{
+  puts("Attention!");
+
+  if (atprm->error_code >= AS_ATTENTION_CODE_WARNING)
+    {
+      ErrEnd = true;
+   }
+}
+
+/**
+ *  @brief Setup audio device to capture PCM stream
+ *
+ *  Select input device as microphone <br>
+ *  Set PCM capture sapling rate parameters to 48 kb/s <br>
+ *  Set channel number 4 to capture audio from 4 microphones simultaneously <br>
+ *  System directory "/mnt/sd0/BIN" will be searched for PCM codec
+ */
+void setup()
+{
+  theAudio = AudioClass::getInstance();
+
+  theAudio->begin(audio_attention_cb);
+
+  puts("initialization Audio Library");
+
+  /* Select input device as microphone.
+   * The FIFO size is a multiple of the sample size of all channels,
+   * so the data is not split in the middle of a sample.
+   */
+  theAudio->setRecorderMode(AS_SETRECDR_STS_INPUTDEVICE_MIC);
+
+  theAudio->initRecorder(AS_CODECTYPE_PCM, "/mnt/sd0/BIN", AS_SAMPLINGRATE_48000, AS_CHANNEL_4CH);
+  puts("Init Recorder!");
+
+  puts("Rec!");
+  theAudio->startRecorder();
+}
+
+/**
+ * @brief Audio signal process for your application
+ *
+ * The data is read in the FIFO buffer. No copy to the application buffer.
+ */
+
+void signal_process(const uint8_t *data, uint32_t size)
+{
+  const int16_t *pcm = (const int16_t *)data;
+
+  for (uint32_t i = 0; i < size / sample_size; i++)
+    {
+      for (int ch = 0; ch < channel_num; ch++)
+        {
+          int v = pcm[i * channel_num + ch];
+          v = (v < 0) ? -v : v;
+          if (v > s_peak[ch])
+            {
+              s_peak[ch] = v;
+            }
+        }
+    }
+
+  s_samples += size / sample_size;
+  if (s_samples >= 48000)
+    {
+      printf("Peak %6d %6d %6d %6d\n", s_peak[0], s_peak[1], s_peak[2], s_peak[3]);
+      memset(s_peak, 0, sizeof(s_peak));
+      s_samples = 0;
+    }
+}
+
+/**
+ * @brief Process the captured data in place and release it
+ */
+
+err_t execute_frames(uint32_t *size)
+{
+  AudioFifoSpan span;
+
+  err_t err = theAudio->peekFrames(&span);
+  if (err != AUDIOLIB_ECODE_OK)
+    {
+      return err;
+    }
+
+  /* The data wraps around at the end of the FIFO */
+
+  if (span.size1 > 0)
+    {
+      signal_process(span.data1, span.size1);
+    }
+  if (span.size2 > 0)
+    {
+      signal_process(span.data2, span.size2);
+    }
+
+  *size = span.size1 + span.size2;
+
+  /* The recorder can reuse the area after this */
+
+  return theAudio->consumeFrames(*size);
+}
+
+/**
+ * @brief Capture frames of PCM data
+ */
+void loop() {
+
+  static int32_t total_size = 0;
+  uint32_t read_size = 0;
+
+  err_t err = execute_frames(&read_size);
+  if (err != AUDIOLIB_ECODE_OK)
+    {
+      theAudio->stopRecorder();
+      goto exitRecording;
+    }
+
+  total_size += read_size;
+
+  /* Stop Recording */
+  if (total_size > recoding_size)
+    {
+      theAudio->stopRecorder();
+
+      /* Get ramaining data(flushing) */
+      sleep(1); /* For data pipline stop */
+      execute_frames(&read_size);
+
+      goto exitRecording;
+    }
+
+  if (ErrEnd)
+    {
+      printf("Error End\n");
+      theAudio->stopRecorder();
+      goto exitRecording;
+    }
+
+  /* Wait for some frames. 10 ms at least by the system tick. */
+
+  usleep(10000);
+
+  return;
+
+exitRecording:
+
+  theAudio->setReadyMode();
+  theAudio->end();
+
+  puts("End Recording");
+  exit(1);
+}
@@ -0,0 +1,213 @@
+/*
+ *  player_gapless.ino - Gapless WAV playback with the background file reader
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <SDHCI.h>
+#include <Audio.h>
+#include <AudioPlayerFeeder.h>
+
+/* The files are played in this order without a gap.
+ * All files must have the same sampling rate, bit length and channels.
+ */
+
+static const char *playlist[] = {
+  "Sound1.wav",
+  "Sound2.wav",
+  "Sound3.wav",
+};
+
+static const int playlist_num = sizeof(playlist) / sizeof(playlist[0]);
+
+SDClass theSD;
+AudioClass *theAudio;
+AudioPlayerFeeder theFeeder;
+
+WavContainerFormatParser theParser;
+
+/* The FIFO of the player is the read-ahead buffer of the feeder.
+ * 256KB keeps about 1.3 seconds of 48kHz 16bit stereo audio
+ * while the SD card is busy.
+ */
+
+static const uint32_t player_buffer_size = 256 * 1024;
+
+static int s_next = 0;
+bool ErrEnd = false;
+
+/**
+ * @brief Audio attention callback
+ *
+ * When audio internal error occurs, this function will be called back.
+ */
+
+static void audio_attention_cb(const ErrorAttentionParam *atprm)
+{
+  puts("Attention!");
+
+  if (atprm->error_code >= AS_ATTENTION_CODE_WARNING)
+    {
+      ErrEnd = true;
+    }
+}
+
+/**
+ * @brief Add the next file of the playlist to the feeder
+ */
+
+static bool queue_next(fmt_chunk_t *fmt)
+{
+  char path[64];
+
+  snprintf(path, sizeof(path), "/mnt/sd0/%s", playlist[s_next]);
+
+  handel_wav_parser_t *handle
+    = (handel_wav_parser_t *)theParser.parseChunk(path, fmt);
+  if (handle == NULL)
+    {
+      printf("Wav parser error. [%s]\n", path);
+      return false;
+    }
+
+  /* Only the data chunk is given to the player */
+
+  uint32_t data_offset = handle->data_offset;
+  uint32_t data_size = handle->data_size;
+
+  theParser.resetParser((handel_wav_parser *)handle);
+
+  if (!theFeeder.queue(path, data_offset, data_size))
+    {
+      return false;
+    }
+
+  printf("Queued %s\n", path);
+  s_next++;
+
+  return true;
+}
+
+static void print_stat()
+{
+  PlayerFeederStat stat;
+
+  theFeeder.getStat(&stat);
+  printf("%lu bytes, tracks %lu, underruns %lu, errors %lu, "
+         "FIFO min %lu, read max %lu us\n",
+         (unsigned long)stat.bytes, (unsigned long)stat.tracks,
+         (unsigned long)stat.underruns, (unsigned long)stat.errors,
+         (unsigned long)stat.fifoMin, (unsigned long)stat.maxReadUs);
+}
+
+void setup()
+{
+  /* Initialize SD */
+  while (!theSD.begin())
+    {
+      /* wait until SD card is mounted. */
+      Serial.println("Insert SD card.");
+    }
+
+  /* The format of the first file is used for all files */
+
+  fmt_chunk_t fmt;
+
+  if (!queue_next(&fmt))
+    {
+      exit(1);
+    }
+
+  theAudio = AudioClass::getInstance();
+
+  theAudio->begin(audio_attention_cb);
+
+  puts("initialization Audio Library");
+
+  theAudio->setRenderingClockMode((fmt.rate <= 48000) ? AS_CLKMODE_NORMAL : AS_CLKMODE_HIRES);
+
+  /* Set output device to speaker with a large buffer of player 0 */
+
+  theAudio->setPlayerMode(AS_SETPLAYER_OUTPUTDEVICE_SPHP, AS_SP_DRV_MODE_LINEOUT,
+                          player_buffer_size, player_buffer_size);
+
+  err_t err = theAudio->initPlayer(AudioClass::Player0, AS_CODECTYPE_WAV, "/mnt/sd0/BIN", fmt.rate, fmt.bit, fmt.channel);
+  if (err != AUDIOLIB_ECODE_OK)
+    {
+      printf("Player0 initialize error\n");
+      exit(1);
+    }
+
+  /* Start reading. The rest of the playlist is added in loop(). */
+
+  if (!theFeeder.begin(AudioClass::Player0))
+    {
+      printf("Feeder start error\n");
+      exit(1);
+    }
+
+  /* Wait for the half of the buffer before starting the player */
+
+  while ((theFeeder.buffered() < player_buffer_size / 2) && !theFeeder.isEnd())
+    {
+      usleep(10000);
+    }
+
+  theAudio->setVolume(-160);
+
+  theAudio->startPlayer(AudioClass::Player0);
+  puts("Play!");
+}
+
+void loop()
+{
+  fmt_chunk_t fmt;
+
+  /* Nothing to do for the file reading here. loop() can do other work. */
+
+  if ((s_next < playlist_num) && (theFeeder.queued() == 0))
+    {
+      queue_next(&fmt);
+    }
+
+  if (ErrEnd)
+    {
+      printf("Error End\n");
+      theAudio->stopPlayer(AudioClass::Player0);
+      goto stop_player;
+    }
+
+  if ((s_next < playlist_num) || !theFeeder.isEnd())
+    {
+      sleep(1);
+      print_stat();
+      return;
+    }
+
+  /* All data is in the FIFO. Stop after it is played. */
+
+  theAudio->stopPlayer(AudioClass::Player0, AS_STOPPLAYER_ESEND);
+
+stop_player:
+  theFeeder.end();
+  print_stat();
+
+  theAudio->setReadyMode();
+  theAudio->end();
+
+  printf("Exit player\n");
+  exit(1);
+}
@@ -0,0 +1,175 @@
+/*
+ *  recorder_wav_sink.ino - Long WAV recording with the background file writer
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <SDHCI.h>
+#include <Audio.h>
+#include <AudioFileSink.h>
+
+#include <arch/board/board.h>
+
+#define RECORD_FILE_NAME "Sound.wav"
+
+SDClass theSD;
+AudioClass *theAudio;
+AudioFileSink theSink;
+
+bool ErrEnd = false;
+
+/**
+ * @brief Audio attention callback
+ *
+ * When audio internal error occurs, this function will be called back.
+ */
+
+static void audio_attention_cb(const ErrorAttentionParam *atprm)
+{
+  puts("Attention!");
+
+  if (atprm->error_code >= AS_ATTENTION_CODE_WARNING)
+    {
+      ErrEnd = true;
+   }
+}
+
+/* Sampling rate
+ * Set 16000 or 48000
+ */
+
+static const uint32_t recoding_sampling_rate = 48000;
+
+/* Number of input channels
+ * Set either 1, 2, or 4.
+ */
+
+static const uint8_t  recoding_cannel_number = 4;
+
+/* Audio bit depth
+ * Set 16 or 24
+ */
+
+static const uint8_t  recoding_bit_length = 16;
+
+/* Recording time[second] */
+
+static const uint32_t recoding_time = 60;
+
+/* Bytes per second */
+
+static const int32_t recoding_byte_per_second = recoding_sampling_rate *
+                                                recoding_cannel_number *
+                                                recoding_bit_length / 8;
+
+/* Total recording size */
+
+static const int32_t recoding_size = recoding_byte_per_second * recoding_time;
+
+/* Blocks of the file writer. 4 blocks of 32KB keep about 340 ms of 4ch audio
+ * in addition to the FIFO while the SD card is busy.
+ */
+
+static const size_t sink_block_size = 32768;
+static const int    sink_block_num  = 4;
+
+static void print_stat()
+{
+  AudioFileSinkStat stat;
+
+  theSink.getStat(&stat);
+  printf("%lu bytes, overruns %lu, stalls %lu, errors %lu, "
+         "queued max %d, FIFO max %lu, write max %lu us\n",
+         (unsigned long)stat.bytes, (unsigned long)stat.overruns,
+         (unsigned long)stat.stalls, (unsigned long)stat.errors,
+         stat.maxQueued, (unsigned long)stat.maxFifoUsed,
+         (unsigned long)stat.maxWriteUs);
+}
+
+void setup()
+{
+  /* Initialize SD */
+  while (!theSD.begin())
+    {
+      /* wait until SD card is mounted. */
+      Serial.println("Insert SD card.");
+    }
+
+  theAudio = AudioClass::getInstance();
+
+  theAudio->begin(audio_attention_cb);
+
+  puts("initialization Audio Library");
+
+  /* Select input device as microphone */
+  theAudio->setRecorderMode(AS_SETRECDR_STS_INPUTDEVICE_MIC);
+
+  /* Search for WAVDEC codec in "/mnt/sd0/BIN" directory */
+  theAudio->initRecorder(AS_CODECTYPE_WAV,
+                         "/mnt/sd0/BIN",
+                         recoding_sampling_rate,
+                         recoding_bit_length,
+                         recoding_cannel_number);
+  puts("Init Recorder!");
+
+  /* The file is extended to the whole recording in advance,
+   * and the writer thread writes it while recording.
+   */
+
+  if (theSink.begin(RECORD_FILE_NAME, recoding_size + sink_block_size,
+                    sink_block_size, sink_block_num) != AUDIOLIB_ECODE_OK)
+    {
+      printf("File open error\n");
+      exit(1);
+    }
+
+  printf("Open! [%s]\n", RECORD_FILE_NAME);
+
+  theAudio->startRecorder();
+  puts("Recording Start!");
+}
+
+void loop()
+{
+  AudioFileSinkStat stat;
+
+  /* Nothing to do for the recording here. loop() can do other work. */
+
+  sleep(1);
+
+  theSink.getStat(&stat);
+  print_stat();
+
+  if ((stat.bytes < (uint64_t)recoding_size) && !ErrEnd && (stat.errors == 0))
+    {
+      return;
+    }
+
+  if (ErrEnd)
+    {
+      printf("Error End\n");
+    }
+
+  theAudio->stopRecorder();
+  theSink.end();
+  print_stat();
+
+  theAudio->setReadyMode();
+  theAudio->end();
+
+  puts("End Recording");
+  exit(1);
+}
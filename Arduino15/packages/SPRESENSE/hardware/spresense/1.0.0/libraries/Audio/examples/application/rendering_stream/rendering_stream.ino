@@ -0,0 +1,153 @@
+/*
+ *  rendering_stream.ino - Low latency rendering example with OutputMixerStream
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <OutputMixer.h>
+#include <OutputMixerStream.h>
+#include <MemoryUtil.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <arch/board/board.h>
+
+/* 2 frames of 240 samples at 48kHz keep 10 ms in the renderer. */
+
+#define FRAME_SAMPLE (240)
+#define CHNUM        (2)
+#define FRAME_NUM    (2)
+
+static const float tone_freq = 1000.0f;
+static const float sampling_rate = 48000.0f;
+
+OutputMixer *theMixer;
+OutputMixerStream theStream;
+
+bool ErrEnd = false;
+
+static float s_phase;
+
+/**
+ * @brief Fill a frame with a sine tone
+ *
+ * Called from the stream thread each time a frame is rendered.
+ * Keep it short, and return false if the data is not ready.
+ */
+
+static bool fill_frame(void *buf, uint32_t samples, void *arg)
+{
+  int16_t *pcm = (int16_t *)buf;
+  const float step = 2.0f * (float)M_PI * tone_freq / sampling_rate;
+
+  for (uint32_t i = 0; i < samples; i++) {
+    int16_t v = (int16_t)(8192.0f * sinf(s_phase));
+    pcm[i * CHNUM]     = v;
+    pcm[i * CHNUM + 1] = v;
+
+    s_phase += step;
+    if (s_phase > 2.0f * (float)M_PI) {
+      s_phase -= 2.0f * (float)M_PI;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Mixer done callback procedure
+ */
+static void outputmixer_done_callback(MsgQueId requester_dtq,
+                                      MsgType reply_of,
+                                      AsOutputMixDoneParam *done_param)
+{
+  return;
+}
+
+static void attention_cb(const ErrorAttentionParam *atprm)
+{
+  puts("Attention!");
+
+  if (atprm->error_code >= AS_ATTENTION_CODE_WARNING) {
+    ErrEnd = true;
+  }
+}
+
+void setup()
+{
+  printf("setup() start\n");
+
+  /* Initialize memory pools and message libs */
+  initMemoryPools();
+  createStaticPools(MEM_LAYOUT_PLAYER);
+
+  /* Start audio system */
+  theMixer  = OutputMixer::getInstance();
+  theMixer->activateBaseband();
+
+  /* Create Objects */
+  theMixer->create(attention_cb);
+
+  /* Set rendering clock */
+  theMixer->setRenderingClkMode(OUTPUTMIXER_RNDCLK_NORMAL);
+
+  /* Activate Mixer Object */
+  theMixer->activate(OutputMixer0, HPOutputDevice, outputmixer_done_callback);
+
+  usleep(100 * 1000);
+
+  /* Set main volume */
+  theMixer->setVolume(-160, 0, 0);
+
+  /* Unmute */
+  board_external_amp_mute_control(false);
+
+  /* Start streaming. The frames are sent from here on. */
+  if (theStream.begin(OutputMixer0, fill_frame, NULL,
+                      FRAME_SAMPLE, CHNUM, 16, FRAME_NUM) != OUTPUTMIXER_ECODE_OK) {
+    printf("Stream start error\n");
+    exit(1);
+  }
+
+  printf("setup() complete\n");
+}
+
+void loop()
+{
+  static int count = 0;
+  OutputMixerStreamStat stat;
+
+  sleep(1);
+
+  theStream.getStat(&stat);
+  printf("%lu frames, silent %lu, underruns %lu, latency %lu us (max %lu), fill max %lu us\n",
+         (unsigned long)stat.frames, (unsigned long)stat.silentFrames,
+         (unsigned long)stat.underruns, (unsigned long)stat.latencyUs,
+         (unsigned long)stat.maxLatencyUs, (unsigned long)stat.maxFillUs);
+
+  if ((++count < 10) && !ErrEnd) {
+    return;
+  }
+
+  /* Mute and stop */
+  board_external_amp_mute_control(true);
+
+  theStream.end();
+  theMixer->deactivate(OutputMixer0);
+
+  puts("End Rendering");
+  exit(1);
+}
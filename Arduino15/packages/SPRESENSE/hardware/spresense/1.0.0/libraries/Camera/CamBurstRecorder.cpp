@@ -0,0 +1,368 @@
+/*
+ *  CamBurstRecorder.cpp - JPEG burst recorder for the Spresense Camera
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file CamBurstRecorder.cpp
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief JPEG burst recorder for the Spresense Camera.
+ */
+
+#include <Arduino.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CamBurstRecorder.h"
+
+CamBurstRecorder::CamBurstRecorder()
+  : running(false), stopping(false),
+    queue(NULL), queue_depth(0), queue_head(0), queue_num(0),
+    chunk(NULL), chunk_size(0), chunk_len(0), writer_tid(-1),
+    start_ms(0), write_error(false)
+{
+  sem_init(&queue_lock, 0, 1);
+  sem_init(&queue_sem, 0, 0);
+  memset(&stat, 0, sizeof(stat));
+}
+
+CamBurstRecorder::~CamBurstRecorder()
+{
+  end();
+  sem_destroy(&queue_lock);
+  sem_destroy(&queue_sem);
+}
+
+// Private : Free the buffers and close the file.
+void CamBurstRecorder::release()
+{
+  if (queue != NULL)
+    {
+      delete[] queue;
+      queue = NULL;
+    }
+
+  if (chunk != NULL)
+    {
+      free(chunk);
+      chunk = NULL;
+    }
+
+  file.close();
+}
+
+// Public : Start recording.
+CamErr CamBurstRecorder::begin(const char *path, size_t prealloc_size,
+                               int depth, size_t csize)
+{
+  if (running)
+    {
+      return CAM_ERR_ALREADY_INITIALIZED;
+    }
+
+  if ((path == NULL) || (depth < 1) ||
+      (csize < RawFile::SECTOR_SIZE) || (csize % RawFile::SECTOR_SIZE != 0))
+    {
+      return CAM_ERR_INVALID_PARAM;
+    }
+
+  queue = new CamImage[depth];
+  chunk = RawFile::allocBuffer(csize);
+  if ((queue == NULL) || (chunk == NULL))
+    {
+      release();
+      return CAM_ERR_NO_MEMORY;
+    }
+
+  if (!file.create(path, prealloc_size))
+    {
+      release();
+      return CAM_ERR_INVALID_PARAM;
+    }
+
+  queue_depth = depth;
+  queue_head = 0;
+  queue_num = 0;
+  chunk_size = csize;
+  chunk_len = 0;
+  write_error = false;
+  stopping = false;
+  start_ms = 0;
+  memset(&stat, 0, sizeof(stat));
+  while (sem_trywait(&queue_sem) == 0);
+
+  struct sched_param param;
+  pthread_attr_t tattr;
+
+  pthread_attr_init(&tattr);
+  tattr.stacksize = WRITER_THREAD_STACK_SIZE;
+  param.sched_priority = WRITER_THREAD_PRIO;
+  pthread_attr_setschedparam(&tattr, &param);
+
+  running = true;
+  if (pthread_create(&writer_tid, &tattr,
+                     (pthread_startroutine_t)CamBurstRecorder::writer_thread,
+                     (void *)this))
+    {
+      running = false;
+      release();
+      return CAM_ERR_CANT_CREATE_THREAD;
+    }
+  pthread_setname_np(writer_tid, "cam_burst_writer");
+
+  return CAM_ERR_SUCCESS;
+}
+
+// Public : Queue a frame.
+bool CamBurstRecorder::push(CamImage &img)
+{
+  if (!running || !img.isAvailable())
+    {
+      return false;
+    }
+
+  lock();
+
+  if (stopping || (queue_num >= queue_depth))
+    {
+      stat.dropped++;
+      unlock();
+      return false;
+    }
+
+  // The rate is measured from the first frame.
+  if (start_ms == 0)
+    {
+      start_ms = millis();
+    }
+
+  // Only the reference count goes up here. No copy of the image.
+  queue[(queue_head + queue_num) % queue_depth] = img;
+  queue_num++;
+  stat.queued = queue_num;
+  if (queue_num > stat.maxQueued)
+    {
+      stat.maxQueued = queue_num;
+    }
+
+  unlock();
+
+  sem_post(&queue_sem);
+  return true;
+}
+
+// Private : Write to the file and measure the latency.
+bool CamBurstRecorder::write_out(const uint8_t *data, size_t len)
+{
+  uint32_t us;
+
+  if (!file.write(data, len, &us))
+    {
+      return false;
+    }
+
+  lock();
+  if (us > stat.maxWriteUs)
+    {
+      stat.maxWriteUs = us;
+    }
+  unlock();
+
+  return true;
+}
+
+// Private : Add a frame to the chunk, and write the full chunks.
+void CamBurstRecorder::write_frame(const uint8_t *data, size_t len)
+{
+  size_t total = len;
+
+  if (write_error)
+    {
+      lock();
+      stat.errors++;
+      unlock();
+      return;
+    }
+
+  while (len > 0)
+    {
+      // Nothing to gather. Write the whole chunks from the camera buffer.
+      if ((chunk_len == 0) && (len >= chunk_size))
+        {
+          size_t direct = len - (len % chunk_size);
+          if (!write_out(data, direct))
+            {
+              write_error = true;
+              lock();
+              stat.errors++;
+              unlock();
+              return;
+            }
+          data += direct;
+          len -= direct;
+          continue;
+        }
+
+      size_t n = chunk_size - chunk_len;
+      if (n > len)
+        {
+          n = len;
+        }
+      memcpy(chunk + chunk_len, data, n);
+      chunk_len += n;
+      data += n;
+      len -= n;
+
+      if (chunk_len == chunk_size)
+        {
+          if (!write_out(chunk, chunk_size))
+            {
+              write_error = true;
+              lock();
+              stat.errors++;
+              unlock();
+              return;
+            }
+          chunk_len = 0;
+        }
+    }
+
+  lock();
+  stat.frames++;
+  stat.bytes += total;
+  update_rate();
+  unlock();
+}
+
+// Private : Update fps and MB/s. Call with the lock.
+void CamBurstRecorder::update_rate()
+{
+  if (stat.frames == 0)
+    {
+      return;
+    }
+
+  stat.elapsed_ms = millis() - start_ms;
+  if (stat.elapsed_ms > 0)
+    {
+      stat.fps = (float)stat.frames * 1000.0f / (float)stat.elapsed_ms;
+      stat.mbps = (float)stat.bytes / 1000.0f / (float)stat.elapsed_ms;
+    }
+}
+
+// Private Static : Writer thread.
+void CamBurstRecorder::writer_thread(void *arg)
+{
+  CamBurstRecorder *rec = (CamBurstRecorder *)arg;
+  CamImage img;
+
+  while (1)
+    {
+      sem_wait(&rec->queue_sem);
+
+      rec->lock();
+      if (rec->queue_num == 0)
+        {
+          bool stop = rec->stopping;
+          rec->unlock();
+          if (stop)
+            {
+              break;
+            }
+          continue;
+        }
+
+      img = rec->queue[rec->queue_head];
+      rec->queue[rec->queue_head] = CamImage();
+      rec->queue_head = (rec->queue_head + 1) % rec->queue_depth;
+      rec->queue_num--;
+      rec->stat.queued = rec->queue_num;
+      rec->unlock();
+
+      rec->write_frame(img.getImgBuff(), img.getImgSize());
+
+      // Give the buffer back to the sensor.
+      img = CamImage();
+    }
+
+  pthread_exit(0);
+}
+
+// Public : Stop recording.
+CamErr CamBurstRecorder::end()
+{
+  CamErr err = CAM_ERR_SUCCESS;
+
+  if (!running)
+    {
+      return CAM_ERR_NOT_INITIALIZED;
+    }
+
+  // The writer writes all queued frames before it stops.
+  lock();
+  stopping = true;
+  unlock();
+  sem_post(&queue_sem);
+  pthread_join(writer_tid, NULL);
+  writer_tid = -1;
+
+  if (!write_error && (chunk_len > 0))
+    {
+      if (!write_out(chunk, chunk_len))
+        {
+          write_error = true;
+        }
+      chunk_len = 0;
+    }
+
+  // The preallocated area is truncated to the data in the file.
+  if (!file.finish())
+    {
+      write_error = true;
+    }
+
+  lock();
+  update_rate();
+  unlock();
+
+  if (write_error)
+    {
+      err = CAM_ERR_ILLEGAL_DEVERR;
+    }
+
+  release();
+  running = false;
+  start_ms = 0;
+
+  return err;
+}
+
+// Public : Get statistics.
+CamErr CamBurstRecorder::getStat(CamBurstStat *s)
+{
+  if (s == NULL)
+    {
+      return CAM_ERR_INVALID_PARAM;
+    }
+
+  lock();
+  *s = stat;
+  unlock();
+
+  return CAM_ERR_SUCCESS;
+}
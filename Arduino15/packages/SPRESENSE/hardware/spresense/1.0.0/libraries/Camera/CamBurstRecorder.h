@@ -0,0 +1,185 @@
+/*
+ *  CamBurstRecorder.h - JPEG burst recorder for the Spresense Camera
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file CamBurstRecorder.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief JPEG burst recorder for the Spresense Camera.
+ * @details [en] Records JPEG video frames into one file from a background
+ *               thread, so the storage latency does not stop the capture.
+ *               The frames are concatenated as they are (Motion JPEG stream). <BR>
+ *          [ja] JPEG動画フレームをバックグラウンドスレッドで1つのファイルに記録する。
+ *               ストレージの遅延によりキャプチャが止まらない。フレームはそのまま
+ *               連結される(Motion JPEGストリーム)。
+ */
+
+#ifndef __SPRESENSE_CAMBURSTRECORDER_H__
+#define __SPRESENSE_CAMBURSTRECORDER_H__
+
+#include <stdint.h>
+#include <semaphore.h>
+#include <pthread.h>
+
+#include <Camera.h>
+#include <RawFile.h>
+
+/**
+ * @ingroup camera
+ * @{
+ */
+
+/**
+ * @struct CamBurstStat
+ * @brief [en] Statistics of the burst recording. <BR>
+ *        [ja] バースト記録の統計情報
+ */
+typedef struct {
+  uint32_t frames;      /**< [en] Recorded frames                    <BR> [ja] 記録したフレーム数 */
+  uint32_t dropped;     /**< [en] Frames dropped by the full queue   <BR> [ja] キューが一杯で破棄したフレーム数 */
+  uint32_t errors;      /**< [en] Frames not written by an error     <BR> [ja] エラーにより書けなかったフレーム数 */
+  uint64_t bytes;       /**< [en] Recorded bytes                     <BR> [ja] 記録したバイト数 */
+  uint32_t elapsed_ms;  /**< [en] Time from the first frame          <BR> [ja] 最初のフレームからの時間 */
+  float    fps;         /**< [en] Sustained frames per second        <BR> [ja] 平均フレームレート */
+  float    mbps;        /**< [en] Sustained MB (10^6 bytes) per second <BR> [ja] 平均書き込み速度 (MB/s) */
+  int      queued;      /**< [en] Frames waiting for the writer now  <BR> [ja] 現在書き込み待ちのフレーム数 */
+  int      maxQueued;   /**< [en] Maximum of queued                  <BR> [ja] queuedの最大値 */
+  uint32_t maxWriteUs;  /**< [en] Longest write call in microseconds <BR> [ja] 最も長い書き込みの時間(マイクロ秒) */
+} CamBurstStat;
+
+/**
+ * @class CamBurstRecorder
+ * @brief [en] JPEG burst recorder. <BR>
+ *        [ja] JPEGバーストレコーダ
+ *
+ * @details [en] Call push() from the camera callback. The image is queued by
+ *               its reference count without copy, and the writer thread
+ *               gathers the frames into writes of the chunk size, which is a
+ *               multiple of the sector size. Each frame is copied into the
+ *               chunk buffer and released at once, so the camera buffer goes
+ *               back to the sensor without waiting for the storage. A frame
+ *               larger than the chunk is written directly from the camera buffer.
+ *               The queue depth should be less than the number of the video
+ *               buffers of CameraClass::begin(). <BR>
+ *          [ja] カメラのコールバックから push() を呼ぶこと。画像はコピーせずに
+ *               参照カウントでキューに入り、書き込みスレッドがチャンクサイズ
+ *               (セクタサイズの倍数)の書き込みにまとめる。各フレームはチャンク
+ *               バッファにコピーされてすぐに解放されるため、カメラのバッファは
+ *               ストレージを待たずにセンサに戻る。チャンクより大きなフレームは
+ *               カメラのバッファから直接書き込まれる。キューの深さは
+ *               CameraClass::begin() の動画バッファ数より小さくすること。
+ */
+class CamBurstRecorder {
+
+public:
+  CamBurstRecorder();
+  ~CamBurstRecorder();
+
+  /**
+   * @brief Start recording.
+   * @details [en] Open the file and start the writer thread. If prealloc_size is
+   *               given, the file is extended to the size in advance so that the
+   *               storage does not allocate clusters during the burst, and it is
+   *               truncated to the recorded size by end(). A path without "/mnt/"
+   *               is treated as a file on the SD card. <BR>
+   *          [ja] ファイルを開いて書き込みスレッドを開始する。prealloc_sizeを指定すると
+   *               バースト中にクラスタ割り当てが起きないよう事前にファイルを拡張し、
+   *               end() で記録したサイズに切り詰める。"/mnt/" で始まらないパスは
+   *               SDカード上のファイルとして扱う。
+   * @return [en] Error code defined as #CamErr. <BR>
+   *         [ja] #CamErr で定義されているエラーコード
+   */
+  CamErr begin(
+    const char *path,          /**< [en] Output file <BR> [ja] 出力ファイル */
+    size_t prealloc_size = 0,  /**< [en] Preallocated bytes (0 for none) <BR> [ja] 事前確保するバイト数(0で確保しない) */
+    int queue_depth = 2,       /**< [en] Frames waiting for the writer <BR> [ja] 書き込み待ちのフレーム数 */
+    size_t chunk_size = 32768  /**< [en] Bytes of one write, multiple of 512 <BR> [ja] 1回の書き込みのバイト数(512の倍数) */
+  );
+
+  /**
+   * @brief Queue a frame.
+   * @details [en] Queue a JPEG frame to the writer thread. This does not block. <BR>
+   *          [ja] JPEGフレームを書き込みスレッドのキューに入れる。ブロックしない。
+   * @return [en] true if queued, false if dropped. <BR>
+   *         [ja] キューに入れた場合はtrue、破棄した場合はfalse
+   */
+  bool push(CamImage &img /**< [en] JPEG frame <BR> [ja] JPEGフレーム */);
+
+  /**
+   * @brief Stop recording.
+   * @details [en] Write all queued frames, truncate the preallocated area and
+   *               close the file. <BR>
+   *          [ja] キュー内の全フレームを書き込み、事前確保した領域を切り詰めて
+   *               ファイルを閉じる。
+   * @return [en] Error code defined as #CamErr. <BR>
+   *         [ja] #CamErr で定義されているエラーコード
+   */
+  CamErr end();
+
+  /**
+   * @brief Get statistics.
+   * @details [en] Can be called while recording and after end(). <BR>
+   *          [ja] 記録中および end() の後に呼び出せる。
+   * @return [en] Error code defined as #CamErr. <BR>
+   *         [ja] #CamErr で定義されているエラーコード
+   */
+  CamErr getStat(CamBurstStat *stat /**< [out] [en] Statistics <BR> [ja] 統計情報 */);
+
+  /**
+   * @brief Check recording.
+   * @return [en] true while recording. <BR>
+   *         [ja] 記録中の場合はtrue
+   */
+  bool isRecording() { return running; };
+
+private:
+  static const int WRITER_THREAD_STACK_SIZE = 1024;
+  static const int WRITER_THREAD_PRIO = 100;
+
+  RawFile file;
+  bool running;
+  bool stopping;
+
+  CamImage *queue;
+  int queue_depth;
+  int queue_head;
+  int queue_num;
+  sem_t queue_lock;
+  sem_t queue_sem;
+
+  uint8_t *chunk;
+  size_t chunk_size;
+  size_t chunk_len;
+
+  pthread_t writer_tid;
+  CamBurstStat stat;
+  uint32_t start_ms;
+  bool write_error;
+
+  void lock() { sem_wait(&queue_lock); };
+  void unlock() { sem_post(&queue_lock); };
+  bool write_out(const uint8_t *data, size_t len);
+  void write_frame(const uint8_t *data, size_t len);
+  void update_rate();
+  void release();
+  static void writer_thread(void *arg);
+};
+
+/** @} camera */
+
+#endif /* __SPRESENSE_CAMBURSTRECORDER_H__ */
@@ -0,0 +1,883 @@
+/*
+ *  CamImageProc.cpp - Software image processing for the Spresense Camera
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file CamImageProc.cpp
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Software image processing used by CamImage.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "CamImageProc.h"
+
+/****************************************************************************
+ * Pixel conversion.
+ *
+ * Full range BT.601 in Q16 fixed point, the same as JFIF.
+ ****************************************************************************/
+
+/* Channel layout of the intermediate rows */
+
+enum swimg_space {
+  SPACE_GRAY, /* Y */
+  SPACE_RGB,  /* R, G, B */
+  SPACE_YUV,  /* Y, U, V for each pixel */
+};
+
+static inline uint8_t clip8(int v)
+{
+  return (v < 0) ? 0 : ((v > 255) ? 255 : (uint8_t)v);
+}
+
+/* Chroma terms are shared by the pair of pixels of YUV422 */
+
+struct chroma {
+  int r;
+  int g;
+  int b;
+};
+
+static inline void uv2chroma(int u, int v, chroma *c)
+{
+  int d = u - 128;
+  int e = v - 128;
+
+  c->r = (91881 * e + 32768) >> 16;
+  c->g = (22554 * d + 46802 * e + 32768) >> 16;
+  c->b = (116130 * d + 32768) >> 16;
+}
+
+static inline void chroma2rgb(int y, const chroma *c, uint8_t *rgb)
+{
+  rgb[0] = clip8(y + c->r);
+  rgb[1] = clip8(y - c->g);
+  rgb[2] = clip8(y + c->b);
+}
+
+static inline void yuv2rgb(int y, int u, int v, uint8_t *rgb)
+{
+  chroma c;
+
+  uv2chroma(u, v, &c);
+  chroma2rgb(y, &c, rgb);
+}
+
+static inline uint8_t rgb2y(int r, int g, int b)
+{
+  return (uint8_t)((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+}
+
+static inline void rgb2yuv(int r, int g, int b, uint8_t *yuv)
+{
+  yuv[0] = rgb2y(r, g, b);
+  yuv[1] = clip8(((-11059 * r - 21709 * g + 32768 * b + 32768) >> 16) + 128);
+  yuv[2] = clip8(((32768 * r - 27439 * g - 5329 * b + 32768) >> 16) + 128);
+}
+
+static inline void unpack565(const uint8_t *p, uint8_t *rgb)
+{
+  unsigned int v = p[0] | (p[1] << 8);
+  unsigned int r = (v >> 11) & 0x1f;
+  unsigned int g = (v >> 5) & 0x3f;
+  unsigned int b = v & 0x1f;
+
+  rgb[0] = (r << 3) | (r >> 2);
+  rgb[1] = (g << 2) | (g >> 4);
+  rgb[2] = (b << 3) | (b >> 2);
+}
+
+static inline void pack565(const uint8_t *rgb, uint8_t *p)
+{
+  unsigned int v = ((rgb[0] & 0xf8) << 8) | ((rgb[1] & 0xfc) << 3) | (rgb[2] >> 3);
+
+  p[0] = v & 0xff;
+  p[1] = v >> 8;
+}
+
+static int channels_of(swimg_space space)
+{
+  return (space == SPACE_GRAY) ? 1 : 3;
+}
+
+/* Choose the intermediate layout which loses nothing for the conversion */
+
+static swimg_space select_space(SWIMG_FMT srcfmt, SWIMG_FMT dstfmt)
+{
+  if (dstfmt == SWIMG_FMT_GRAY)
+    {
+      return SPACE_GRAY;
+    }
+
+  if ((dstfmt == SWIMG_FMT_YUV422) &&
+      ((srcfmt == SWIMG_FMT_YUV422) || (srcfmt == SWIMG_FMT_GRAY)))
+    {
+      return SPACE_YUV;
+    }
+
+  return SPACE_RGB;
+}
+
+/* Unpack n pixels from x0 of a source row */
+
+static void unpack_row(const uint8_t *row, SWIMG_FMT fmt, int x0, int n,
+                       swimg_space space, uint8_t *out)
+{
+  uint8_t tmp[3];
+  int x;
+
+  switch (fmt)
+    {
+      case SWIMG_FMT_YUV422:
+        if (space == SPACE_RGB)
+          {
+            chroma c;
+
+            for (x = x0; (x & 1) && (x < x0 + n); x++, out += 3)
+              {
+                const uint8_t *p = row + (x - 1) * 2;
+                yuv2rgb(p[3], p[0], p[2], out);
+              }
+
+            for (; x + 1 < x0 + n; x += 2, out += 6)
+              {
+                const uint8_t *p = row + x * 2;
+                uv2chroma(p[0], p[2], &c);
+                chroma2rgb(p[1], &c, out);
+                chroma2rgb(p[3], &c, out + 3);
+              }
+
+            if (x < x0 + n)
+              {
+                const uint8_t *p = row + x * 2;
+                yuv2rgb(p[1], p[0], p[2], out);
+              }
+            break;
+          }
+
+        if (space == SPACE_GRAY)
+          {
+            /* Y of pixel x is at 2x + 1 */
+
+            for (x = x0; x < x0 + n; x++)
+              {
+                *out++ = row[x * 2 + 1];
+              }
+            break;
+          }
+
+        for (x = x0; x < x0 + n; x++)
+          {
+            const uint8_t *p = row + (x & ~1) * 2;
+
+            *out++ = row[x * 2 + 1];
+            *out++ = p[0];
+            *out++ = p[2];
+          }
+        break;
+
+      case SWIMG_FMT_RGB565:
+      case SWIMG_FMT_RGB888:
+        for (x = x0; x < x0 + n; x++)
+          {
+            if (fmt == SWIMG_FMT_RGB565)
+              {
+                unpack565(row + x * 2, tmp);
+              }
+            else
+              {
+                memcpy(tmp, row + x * 3, 3);
+              }
+
+            if (space == SPACE_GRAY)
+              {
+                *out++ = rgb2y(tmp[0], tmp[1], tmp[2]);
+              }
+            else if (space == SPACE_YUV)
+              {
+                rgb2yuv(tmp[0], tmp[1], tmp[2], out);
+                out += 3;
+              }
+            else
+              {
+                memcpy(out, tmp, 3);
+                out += 3;
+              }
+          }
+        break;
+
+      case SWIMG_FMT_GRAY:
+        if (space == SPACE_GRAY)
+          {
+            memcpy(out, row + x0, n);
+            break;
+          }
+
+        for (x = x0; x < x0 + n; x++)
+          {
+            *out++ = row[x];
+            *out++ = (space == SPACE_YUV) ? 128 : row[x];
+            *out++ = (space == SPACE_YUV) ? 128 : row[x];
+          }
+        break;
+    }
+}
+
+/* Pack n pixels into a destination row. n must be even for YUV422. */
+
+static void pack_row(const uint8_t *in, swimg_space space, int n,
+                     SWIMG_FMT fmt, uint8_t *row)
+{
+  uint8_t tmp[6];
+  int x;
+
+  switch (fmt)
+    {
+      case SWIMG_FMT_YUV422:
+        for (x = 0; x < n; x += 2)
+          {
+            const uint8_t *a = tmp;
+            const uint8_t *b = tmp + 3;
+
+            if (space == SPACE_YUV)
+              {
+                a = in;
+                b = in + 3;
+              }
+            else if (space == SPACE_RGB)
+              {
+                rgb2yuv(in[0], in[1], in[2], tmp);
+                rgb2yuv(in[3], in[4], in[5], tmp + 3);
+              }
+            else
+              {
+                tmp[0] = in[0];
+                tmp[3] = in[1];
+                tmp[1] = tmp[2] = tmp[4] = tmp[5] = 128;
+              }
+
+            *row++ = (a[1] + b[1] + 1) >> 1;
+            *row++ = a[0];
+            *row++ = (a[2] + b[2] + 1) >> 1;
+            *row++ = b[0];
+            in += channels_of(space) * 2;
+          }
+        break;
+
+      case SWIMG_FMT_RGB565:
+      case SWIMG_FMT_RGB888:
+        for (x = 0; x < n; x++)
+          {
+            const uint8_t *rgb = tmp;
+
+            if (space == SPACE_RGB)
+              {
+                rgb = in;
+                in += 3;
+              }
+            else if (space == SPACE_YUV)
+              {
+                yuv2rgb(in[0], in[1], in[2], tmp);
+                in += 3;
+              }
+            else
+              {
+                tmp[0] = tmp[1] = tmp[2] = *in++;
+              }
+
+            if (fmt == SWIMG_FMT_RGB565)
+              {
+                pack565(rgb, row);
+                row += 2;
+              }
+            else
+              {
+                memcpy(row, rgb, 3);
+                row += 3;
+              }
+          }
+        break;
+
+      case SWIMG_FMT_GRAY:
+        if (space == SPACE_GRAY)
+          {
+            memcpy(row, in, n);
+            break;
+          }
+
+        for (x = 0; x < n; x++, in += 3)
+          {
+            *row++ = (space == SPACE_YUV) ? in[0] : rgb2y(in[0], in[1], in[2]);
+          }
+        break;
+    }
+}
+
+int swimg_bytes_per_pixel(SWIMG_FMT fmt)
+{
+  switch (fmt)
+    {
+      case SWIMG_FMT_YUV422:
+      case SWIMG_FMT_RGB565:
+        return 2;
+      case SWIMG_FMT_GRAY:
+        return 1;
+      case SWIMG_FMT_RGB888:
+        return 3;
+    }
+
+  return 0;
+}
+
+static bool is_valid_fmt(SWIMG_FMT fmt, int width)
+{
+  if (swimg_bytes_per_pixel(fmt) == 0)
+    {
+      return false;
+    }
+
+  /* A pair of pixels shares U and V */
+
+  return (fmt != SWIMG_FMT_YUV422) || ((width & 1) == 0);
+}
+
+int swimg_convert(const uint8_t *src, SWIMG_FMT srcfmt,
+                  uint8_t *dst, SWIMG_FMT dstfmt, int width, int height)
+{
+  if ((src == NULL) || (dst == NULL) || (width <= 0) || (height <= 0) ||
+      !is_valid_fmt(srcfmt, width) || !is_valid_fmt(dstfmt, width))
+    {
+      return -EINVAL;
+    }
+
+  int sstride = width * swimg_bytes_per_pixel(srcfmt);
+  int dstride = width * swimg_bytes_per_pixel(dstfmt);
+
+  if (srcfmt == dstfmt)
+    {
+      if (src != dst)
+        {
+          memmove(dst, src, (size_t)sstride * height);
+        }
+      return 0;
+    }
+
+  swimg_space space = select_space(srcfmt, dstfmt);
+  uint8_t *work = (uint8_t *)malloc(width * channels_of(space));
+  if (work == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  /* The whole row is unpacked before its output is written, so an in-place
+   * conversion only has to visit the rows in the order which never
+   * overwrites a row not read yet.
+   */
+
+  bool backward = (dstride > sstride);
+
+  for (int i = 0; i < height; i++)
+    {
+      int y = backward ? (height - 1 - i) : i;
+
+      unpack_row(src + y * sstride, srcfmt, 0, width, space, work);
+      pack_row(work, space, width, dstfmt, dst + y * dstride);
+    }
+
+  free(work);
+  return 0;
+}
+
+/****************************************************************************
+ * Resampling.
+ *
+ * Rows of the clipped area are unpacked on demand, and each resampled
+ * output row is handed to a sink which packs or normalizes it.
+ ****************************************************************************/
+
+typedef void (*swimg_sink_t)(void *arg, const uint8_t *row, int y);
+
+struct swimg_source {
+  const uint8_t *img;
+  int            stride;
+  SWIMG_FMT      fmt;
+  int            x;      /* Left of the clip area */
+  int            y;      /* Top of the clip area */
+  int            width;  /* Size of the clip area */
+  int            height;
+  swimg_space    space;
+  int            nch;
+};
+
+static void fetch_row(const swimg_source *s, int y, uint8_t *out)
+{
+  unpack_row(s->img + (s->y + y) * s->stride, s->fmt, s->x, s->width,
+             s->space, out);
+}
+
+/* Center aligned bilinear sample positions in Q16 */
+
+static void bilinear_table(int in, int out, int *idx, uint8_t *frac)
+{
+  for (int i = 0; i < out; i++)
+    {
+      int64_t pos = ((int64_t)(2 * i + 1) * in << 16) / (2 * out) - 32768;
+
+      if (pos < 0)
+        {
+          pos = 0;
+        }
+
+      idx[i] = (int)(pos >> 16);
+      frac[i] = (uint8_t)((pos >> 8) & 0xff);
+
+      if (idx[i] >= in - 1)
+        {
+          idx[i] = in - 1;
+          frac[i] = 0;
+        }
+    }
+}
+
+static int resample_bilinear(const swimg_source *s, int dw, int dh,
+                             swimg_sink_t sink, void *arg)
+{
+  int nch = s->nch;
+  int ret = -ENOMEM;
+
+  int      *xidx = (int *)malloc(dw * sizeof(int));
+  uint8_t  *xfrac = (uint8_t *)malloc(dw);
+  int      *yidx = (int *)malloc(dh * sizeof(int));
+  uint8_t  *yfrac = (uint8_t *)malloc(dh);
+  uint8_t  *line = (uint8_t *)malloc(s->width * nch);
+  uint16_t *hbuf = (uint16_t *)malloc(dw * nch * 2 * sizeof(uint16_t));
+  uint8_t  *out = (uint8_t *)malloc(dw * nch);
+
+  if (xidx && xfrac && yidx && yfrac && line && hbuf && out)
+    {
+      uint16_t *h[2] = { hbuf, hbuf + dw * nch };
+      int       cached[2] = { -1, -1 };
+
+      bilinear_table(s->width, dw, xidx, xfrac);
+      bilinear_table(s->height, dh, yidx, yfrac);
+
+      for (int y = 0; y < dh; y++)
+        {
+          int sy[2] = { yidx[y], yidx[y] + 1 };
+
+          if (sy[1] >= s->height)
+            {
+              sy[1] = s->height - 1;
+            }
+
+          /* Reuse the horizontally filtered rows of the previous line */
+
+          if ((cached[0] != sy[0]) && (cached[1] == sy[0]))
+            {
+              uint16_t *t = h[0];
+              h[0] = h[1];
+              h[1] = t;
+              cached[0] = cached[1];
+              cached[1] = -1;
+            }
+
+          for (int k = 0; k < 2; k++)
+            {
+              if ((cached[k] == sy[k]) || ((k == 1) && (yfrac[y] == 0)))
+                {
+                  continue;
+                }
+
+              fetch_row(s, sy[k], line);
+
+              uint16_t *dst = h[k];
+              for (int x = 0; x < dw; x++)
+                {
+                  const uint8_t *p0 = line + xidx[x] * nch;
+                  const uint8_t *p1 = (xfrac[x] != 0) ? (p0 + nch) : p0;
+                  int f = xfrac[x];
+
+                  for (int c = 0; c < nch; c++)
+                    {
+                      *dst++ = (uint16_t)((p0[c] << 8) + (p1[c] - p0[c]) * f);
+                    }
+                }
+
+              cached[k] = sy[k];
+            }
+
+          int fy = yfrac[y];
+          const uint16_t *r0 = h[0];
+          const uint16_t *r1 = (fy != 0) ? h[1] : h[0];
+
+          for (int i = 0; i < dw * nch; i++)
+            {
+              out[i] = (uint8_t)(((r0[i] << 8) + (r1[i] - r0[i]) * fy + 32768) >> 16);
+            }
+
+          sink(arg, out, y);
+        }
+
+      ret = 0;
+    }
+
+  free(out);
+  free(hbuf);
+  free(line);
+  free(yfrac);
+  free(yidx);
+  free(xfrac);
+  free(xidx);
+  return ret;
+}
+
+static int resample_area(const swimg_source *s, int dw, int dh,
+                         swimg_sink_t sink, void *arg)
+{
+  int nch = s->nch;
+  int ret = -ENOMEM;
+
+  int      *xstart = (int *)malloc((dw + 1) * sizeof(int));
+  uint8_t  *line = (uint8_t *)malloc(s->width * nch);
+  uint32_t *sum = (uint32_t *)malloc(s->width * nch * sizeof(uint32_t));
+  uint8_t  *out = (uint8_t *)malloc(dw * nch);
+
+  if (xstart && line && sum && out)
+    {
+      for (int x = 0; x <= dw; x++)
+        {
+          xstart[x] = (int)((int64_t)x * s->width / dw);
+        }
+
+      for (int y = 0; y < dh; y++)
+        {
+          int y0 = (int)((int64_t)y * s->height / dh);
+          int y1 = (int)((int64_t)(y + 1) * s->height / dh);
+
+          if (y1 <= y0)
+            {
+              y1 = y0 + 1;
+            }
+
+          /* Vertical sum of the covered rows */
+
+          memset(sum, 0, s->width * nch * sizeof(uint32_t));
+          for (int sy = y0; sy < y1; sy++)
+            {
+              fetch_row(s, sy, line);
+              for (int i = 0; i < s->width * nch; i++)
+                {
+                  sum[i] += line[i];
+                }
+            }
+
+          uint8_t *dst = out;
+          for (int x = 0; x < dw; x++)
+            {
+              int x0 = xstart[x];
+              int x1 = (xstart[x + 1] > x0) ? xstart[x + 1] : (x0 + 1);
+              uint32_t area = (uint32_t)(x1 - x0) * (y1 - y0);
+
+              for (int c = 0; c < nch; c++)
+                {
+                  uint32_t acc = 0;
+                  for (int sx = x0; sx < x1; sx++)
+                    {
+                      acc += sum[sx * nch + c];
+                    }
+                  *dst++ = (uint8_t)((acc + area / 2) / area);
+                }
+            }
+
+          sink(arg, out, y);
+        }
+
+      ret = 0;
+    }
+
+  free(out);
+  free(sum);
+  free(line);
+  free(xstart);
+  return ret;
+}
+
+static int resample(const uint8_t *src, int sw, int sh, SWIMG_FMT srcfmt,
+                    const swimg_rect_t *rect, swimg_space space,
+                    int dw, int dh, SWIMG_RESIZE method,
+                    swimg_sink_t sink, void *arg)
+{
+  swimg_source s;
+
+  if ((src == NULL) || (sw <= 0) || (sh <= 0) || (dw <= 0) || (dh <= 0) ||
+      !is_valid_fmt(srcfmt, sw))
+    {
+      return -EINVAL;
+    }
+
+  if (rect != NULL)
+    {
+      if ((rect->x1 < 0) || (rect->x1 > rect->x2) || (rect->x2 >= sw) ||
+          (rect->y1 < 0) || (rect->y1 > rect->y2) || (rect->y2 >= sh))
+        {
+          return -EINVAL;
+        }
+
+      s.x = rect->x1;
+      s.y = rect->y1;
+      s.width = rect->x2 - rect->x1 + 1;
+      s.height = rect->y2 - rect->y1 + 1;
+    }
+  else
+    {
+      s.x = 0;
+      s.y = 0;
+      s.width = sw;
+      s.height = sh;
+    }
+
+  s.img = src;
+  s.stride = sw * swimg_bytes_per_pixel(srcfmt);
+  s.fmt = srcfmt;
+  s.space = space;
+  s.nch = channels_of(space);
+
+  if (method == SWIMG_RESIZE_AUTO)
+    {
+      method = ((s.width >= dw * 2) && (s.height >= dh * 2)) ?
+               SWIMG_RESIZE_AREA : SWIMG_RESIZE_BILINEAR;
+    }
+
+  if (method == SWIMG_RESIZE_AREA)
+    {
+      return resample_area(&s, dw, dh, sink, arg);
+    }
+
+  return resample_bilinear(&s, dw, dh, sink, arg);
+}
+
+/****************************************************************************
+ * Output sinks.
+ ****************************************************************************/
+
+struct pack_arg {
+  uint8_t    *dst;
+  int         stride;
+  int         width;
+  SWIMG_FMT   fmt;
+  swimg_space space;
+};
+
+static void pack_sink(void *arg, const uint8_t *row, int y)
+{
+  pack_arg *a = (pack_arg *)arg;
+
+  pack_row(row, a->space, a->width, a->fmt, a->dst + y * a->stride);
+}
+
+struct tensor_arg {
+  void *dst;
+  int   width;
+  int   height;
+  int   nch;
+  int   xstride;   /* Distance between pixels */
+  int   cstride;   /* Distance between channels */
+  int   map[3];    /* Channel of the resampled row for each output channel */
+  union {
+    float  f[3][256];
+    int8_t q[3][256];
+  } lut;           /* Output value of each channel and pixel value */
+};
+
+template <typename T>
+static void tensor_row(const tensor_arg *a, const T (*lut)[256],
+                       const uint8_t *row, int y)
+{
+  int w = a->width;
+  int nch = a->nch;
+  T *dst = (T *)a->dst + y * w * a->xstride;
+
+  if (nch == 1)
+    {
+      for (int x = 0; x < w; x++)
+        {
+          dst[x] = lut[0][row[x]];
+        }
+      return;
+    }
+
+  for (int c = 0; c < nch; c++)
+    {
+      const T *l = lut[c];
+      const uint8_t *p = row + a->map[c];
+      T *d = dst + c * a->cstride;
+
+      for (int x = 0; x < w; x++, p += 3, d += a->xstride)
+        {
+          *d = l[*p];
+        }
+    }
+}
+
+static void float_sink(void *arg, const uint8_t *row, int y)
+{
+  tensor_arg *a = (tensor_arg *)arg;
+
+  tensor_row<float>(a, a->lut.f, row, y);
+}
+
+static void int8_sink(void *arg, const uint8_t *row, int y)
+{
+  tensor_arg *a = (tensor_arg *)arg;
+
+  tensor_row<int8_t>(a, a->lut.q, row, y);
+}
+
+static inline int round_int(float v)
+{
+  return (v >= 0.0f) ? (int)(v + 0.5f) : -(int)(-v + 0.5f);
+}
+
+int swimg_clip_resize_to_tensor(const uint8_t *src, int sw, int sh, SWIMG_FMT srcfmt,
+                                const swimg_rect_t *rect,
+                                const swimg_tensor_t *tensor, int dw, int dh,
+                                SWIMG_RESIZE method)
+{
+  if ((tensor == NULL) || (tensor->data == NULL) ||
+      ((tensor->channels != 1) && (tensor->channels != 3)) ||
+      (tensor->type > SWIMG_TENSOR_UINT8))
+    {
+      return -EINVAL;
+    }
+
+  /* The caller buffer must be aligned for the element type */
+
+  if ((tensor->type == SWIMG_TENSOR_FLOAT32) &&
+      (((uintptr_t)tensor->data & (sizeof(float) - 1)) != 0))
+    {
+      return -EINVAL;
+    }
+
+  tensor_arg *arg = (tensor_arg *)malloc(sizeof(tensor_arg));
+  if (arg == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  int nch = tensor->channels;
+
+  arg->dst = tensor->data;
+  arg->width = dw;
+  arg->height = dh;
+  arg->nch = nch;
+  arg->xstride = tensor->planar ? 1 : nch;
+  arg->cstride = tensor->planar ? (dw * dh) : 1;
+
+  for (int c = 0; c < nch; c++)
+    {
+      arg->map[c] = (tensor->bgr && (nch == 3)) ? (2 - c) : c;
+
+      for (int v = 0; v < 256; v++)
+        {
+          float f = (v - tensor->mean[c]) * tensor->scale[c];
+
+          if (tensor->type == SWIMG_TENSOR_FLOAT32)
+            {
+              arg->lut.f[c][v] = f;
+              continue;
+            }
+
+          int q = round_int(f * tensor->qscale) + tensor->zero_point;
+
+          if (tensor->type == SWIMG_TENSOR_INT8)
+            {
+              q = (q < -128) ? -128 : ((q > 127) ? 127 : q);
+            }
+          else
+            {
+              q = clip8(q);
+            }
+
+          /* UINT8 shares the table, only the sign of the byte differs */
+
+          arg->lut.q[c][v] = (int8_t)(uint8_t)q;
+        }
+    }
+
+  int ret = resample(src, sw, sh, srcfmt, rect,
+                     (nch == 1) ? SPACE_GRAY : SPACE_RGB, dw, dh, method,
+                     (tensor->type == SWIMG_TENSOR_FLOAT32) ? float_sink : int8_sink,
+                     arg);
+
+  free(arg);
+  return ret;
+}
+
+int swimg_clip_and_resize(const uint8_t *src, int sw, int sh, SWIMG_FMT srcfmt,
+                          const swimg_rect_t *rect,
+                          uint8_t *dst, int dw, int dh, SWIMG_FMT dstfmt,
+                          SWIMG_RESIZE method)
+{
+  pack_arg arg;
+
+  if ((dst == NULL) || !is_valid_fmt(dstfmt, dw))
+    {
+      return -EINVAL;
+    }
+
+  arg.dst = dst;
+  arg.stride = dw * swimg_bytes_per_pixel(dstfmt);
+  arg.width = dw;
+  arg.fmt = dstfmt;
+  arg.space = select_space(srcfmt, dstfmt);
+
+  return resample(src, sw, sh, srcfmt, rect, arg.space, dw, dh, method,
+                  pack_sink, &arg);
+}
+
+int swimg_clip_resize_normalize(const uint8_t *src, int sw, int sh, SWIMG_FMT srcfmt,
+                                const swimg_rect_t *rect,
+                                float *dst, int dw, int dh, int channels,
+                                const float *mean, const float *scale,
+                                bool planar, SWIMG_RESIZE method)
+{
+  swimg_tensor_t tensor;
+
+  if ((channels != 1) && (channels != 3))
+    {
+      return -EINVAL;
+    }
+
+  memset(&tensor, 0, sizeof(tensor));
+  tensor.data = dst;
+  tensor.type = SWIMG_TENSOR_FLOAT32;
+  tensor.channels = channels;
+  tensor.planar = planar;
+
+  for (int c = 0; c < channels; c++)
+    {
+      tensor.mean[c] = mean ? mean[c] : 0.0f;
+      tensor.scale[c] = scale ? scale[c] : 1.0f;
+    }
+
+  return swimg_clip_resize_to_tensor(src, sw, sh, srcfmt, rect, &tensor,
+                                     dw, dh, method);
+}
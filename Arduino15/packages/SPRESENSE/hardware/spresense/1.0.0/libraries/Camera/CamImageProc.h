@@ -0,0 +1,178 @@
+/*
+ *  CamImageProc.h - Software image processing for the Spresense Camera
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file CamImageProc.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Software image processing used by CamImage.
+ * @details Pixel format conversion, resize and normalization without the
+ *          2D accelerator. CamImage uses these functions when the request
+ *          is out of the limitation of the accelerator. This file does not
+ *          depend on the Spresense SDK, so it can be built on a PC.
+ *
+ *          The kernels work on a row at a time in fixed point. Each source
+ *          row is unpacked once into 8bit channels, the resampling uses
+ *          per-column index/weight tables computed once per call, and the
+ *          output format is packed at the end of the same pass, so
+ *          clipping, resizing, conversion and normalization need no
+ *          intermediate image.
+ */
+
+#ifndef __SPRESENSE_CAMIMAGEPROC_H__
+#define __SPRESENSE_CAMIMAGEPROC_H__
+
+#include <stdint.h>
+
+/**
+ * @enum SWIMG_FMT
+ * @brief Pixel formats of the software image processing
+ */
+enum SWIMG_FMT {
+  SWIMG_FMT_YUV422, /**< YUV422 packed (U, Y0, V, Y1) */
+  SWIMG_FMT_RGB565, /**< RGB565 (16bit word per pixel) */
+  SWIMG_FMT_GRAY,   /**< 8bit gray scale */
+  SWIMG_FMT_RGB888, /**< RGB888 packed (R, G, B) */
+};
+
+/**
+ * @enum SWIMG_RESIZE
+ * @brief Resize methods
+ */
+enum SWIMG_RESIZE {
+  SWIMG_RESIZE_AUTO,     /**< Area for 1/2 or smaller, otherwise bilinear */
+  SWIMG_RESIZE_BILINEAR, /**< Bilinear interpolation */
+  SWIMG_RESIZE_AREA,     /**< Average of the covered source pixels */
+};
+
+/**
+ * @struct swimg_rect_t
+ * @brief Clip rectangle (both corners are included)
+ */
+typedef struct {
+  int x1;
+  int y1;
+  int x2;
+  int y2;
+} swimg_rect_t;
+
+/**
+ * @enum SWIMG_TENSOR_TYPE
+ * @brief Element types of the tensor output
+ */
+enum SWIMG_TENSOR_TYPE {
+  SWIMG_TENSOR_FLOAT32, /**< float */
+  SWIMG_TENSOR_INT8,    /**< int8_t (q7 when qscale is 2^n) */
+  SWIMG_TENSOR_UINT8,   /**< uint8_t */
+};
+
+/**
+ * @struct swimg_tensor_t
+ * @brief Layout and normalization of the tensor output
+ * @details Each element is x = (pixel - mean[c]) * scale[c], where pixel is
+ *          0 to 255 and c is the output channel. Integer types store
+ *          round(x * qscale) + zero_point with saturation.
+ */
+typedef struct {
+  void              *data;       /**< Output, width * height * channels elements */
+  SWIMG_TENSOR_TYPE  type;       /**< Element type */
+  int                channels;   /**< 1 (gray) or 3 (color) */
+  bool               planar;     /**< true for CHW, false for HWC */
+  bool               bgr;        /**< Color order is B, G, R instead of R, G, B */
+  float              mean[3];    /**< Mean of each output channel */
+  float              scale[3];   /**< Scale of each output channel */
+  float              qscale;     /**< Quantization scale of the integer types */
+  int                zero_point; /**< Quantization offset of the integer types */
+} swimg_tensor_t;
+
+/**
+ * @brief Bytes per pixel of the format
+ */
+int swimg_bytes_per_pixel(SWIMG_FMT fmt);
+
+/**
+ * @brief Convert the pixel format
+ * @param [in] src - source image
+ * @param [in] srcfmt - format of the source
+ * @param [out] dst - destination image. It can be the same as src.
+ * @param [in] dstfmt - format of the destination
+ * @param [in] width - width of the image
+ * @param [in] height - height of the image
+ * @return 0 on success, or -EINVAL / -ENOMEM
+ */
+int swimg_convert(const uint8_t *src, SWIMG_FMT srcfmt,
+                  uint8_t *dst, SWIMG_FMT dstfmt, int width, int height);
+
+/**
+ * @brief Clip and resize at any ratio, and convert the pixel format
+ * @param [in] src - source image
+ * @param [in] sw, sh - size of the source
+ * @param [in] srcfmt - format of the source
+ * @param [in] rect - clip rectangle in the source, or NULL for all
+ * @param [out] dst - destination image (must not overlap src)
+ * @param [in] dw, dh - size of the destination
+ * @param [in] dstfmt - format of the destination
+ * @param [in] method - resize method
+ * @return 0 on success, or -EINVAL / -ENOMEM
+ */
+int swimg_clip_and_resize(const uint8_t *src, int sw, int sh, SWIMG_FMT srcfmt,
+                          const swimg_rect_t *rect,
+                          uint8_t *dst, int dw, int dh, SWIMG_FMT dstfmt,
+                          SWIMG_RESIZE method);
+
+/**
+ * @brief Clip, resize and normalize into a float tensor
+ * @param [in] src - source image
+ * @param [in] sw, sh - size of the source
+ * @param [in] srcfmt - format of the source
+ * @param [in] rect - clip rectangle in the source, or NULL for all
+ * @param [out] dst - output tensor of dw * dh * channels floats
+ * @param [in] dw, dh - size of the output
+ * @param [in] channels - 1 (gray) or 3 (RGB)
+ * @param [in] mean - value subtracted for each channel, or NULL for 0
+ * @param [in] scale - factor multiplied for each channel, or NULL for 1
+ * @param [in] planar - true for CHW layout, false for HWC layout
+ * @param [in] method - resize method
+ * @return 0 on success, or -EINVAL / -ENOMEM
+ * @details dst[c] = (pixel[c] - mean[c]) * scale[c], where pixel is 0 to 255.
+ */
+int swimg_clip_resize_normalize(const uint8_t *src, int sw, int sh, SWIMG_FMT srcfmt,
+                                const swimg_rect_t *rect,
+                                float *dst, int dw, int dh, int channels,
+                                const float *mean, const float *scale,
+                                bool planar, SWIMG_RESIZE method);
+
+/**
+ * @brief Clip, resize and normalize into a tensor of any element type
+ * @param [in] src - source image
+ * @param [in] sw, sh - size of the source
+ * @param [in] srcfmt - format of the source
+ * @param [in] rect - clip rectangle in the source, or NULL for all
+ * @param [in] tensor - output buffer and its layout
+ * @param [in] dw, dh - size of the output
+ * @param [in] method - resize method
+ * @return 0 on success, or -EINVAL / -ENOMEM
+ * @details The output values of every pixel value are tabulated before the
+ *          pass, so the type and normalization cost nothing per element.
+ */
+int swimg_clip_resize_to_tensor(const uint8_t *src, int sw, int sh, SWIMG_FMT srcfmt,
+                                const swimg_rect_t *rect,
+                                const swimg_tensor_t *tensor, int dw, int dh,
+                                SWIMG_RESIZE method);
+
+#endif /* __SPRESENSE_CAMIMAGEPROC_H__ */
@@ -28,10 +28,12 @@
 #include <fcntl.h>
 #include <sched.h>
 #include <errno.h>
+#include <time.h>
 #include <assert.h>
 #include <sys/ioctl.h>
 
 #include <Camera.h>
+#include "CamImageProc.h"
 #include <arch/board/cxd56_imageproc.h>
 #include <nuttx/video/isx012.h>
 #include <nuttx/video/isx019.h>
@@ -144,6 +146,12 @@ size_t ImgBuff::calc_img_size(int w, int h, CAM_IMAGE_PIX_FMT fmt, int jpgbufsiz
           case CAM_IMAGE_PIX_FMT_JPG:
             ret = (size_t)(w * h * 2 / jpgbufsize_divisor);
             break;
+          case CAM_IMAGE_PIX_FMT_GRAY:
+            ret = w * h;
+            break;
+          case CAM_IMAGE_PIX_FMT_RGB888:
+            ret = w * h * 3;
+            break;
           default:
             break;
         }
@@ -167,19 +175,61 @@ void ImgBuff::update_actual_size(size_t sz)
 CamImage::CamImage(const CamImage &obj)
 {
   img_buff = obj.img_buff;
-  img_buff->incRef();
+  if (img_buff != NULL)
+    {
+      img_buff->incRef();
+    }
 }
 
 CamImage &CamImage::operator=(const CamImage &obj)
 {
-  ImgBuff::delete_inst(img_buff);
+  // Take the new reference first, for the case of the same buffer.
+  if (obj.img_buff != NULL)
+    {
+      obj.img_buff->incRef();
+    }
 
+  ImgBuff::delete_inst(img_buff);
   img_buff = obj.img_buff;
-  img_buff->incRef();
 
   return (*this);
 }
 
+// Format of the software image processing, or false if not supported.
+static bool to_swimg_fmt(CAM_IMAGE_PIX_FMT fmt, SWIMG_FMT *swfmt)
+{
+  switch (fmt)
+    {
+      case CAM_IMAGE_PIX_FMT_YUV422:
+        *swfmt = SWIMG_FMT_YUV422;
+        return true;
+      case CAM_IMAGE_PIX_FMT_RGB565:
+        *swfmt = SWIMG_FMT_RGB565;
+        return true;
+      case CAM_IMAGE_PIX_FMT_GRAY:
+        *swfmt = SWIMG_FMT_GRAY;
+        return true;
+      case CAM_IMAGE_PIX_FMT_RGB888:
+        *swfmt = SWIMG_FMT_RGB888;
+        return true;
+      default:
+        return false;
+    }
+}
+
+static CamErr swimg_error(int ret)
+{
+  switch (ret)
+    {
+      case 0:
+        return CAM_ERR_SUCCESS;
+      case -ENOMEM:
+        return CAM_ERR_NO_MEMORY;
+      default:
+        return CAM_ERR_INVALID_PARAM;
+    }
+}
+
 CamErr CamImage::convertPixFormat(CAM_IMAGE_PIX_FMT to_fmt)
 {
   CAM_IMAGE_PIX_FMT from_fmt = getPixFormat();
@@ -192,6 +242,13 @@ CamErr CamImage::convertPixFormat(CAM_IMAGE_PIX_FMT to_fmt)
       return CAM_ERR_NOT_PERMITTED;
     }
 
+  if (from_fmt == to_fmt)
+    {
+      return CAM_ERR_SUCCESS;
+    }
+
+  // Use the hardware for the conversions it supports.
+
   switch (from_fmt)
     {
       case CAM_IMAGE_PIX_FMT_YUV422:
@@ -200,16 +257,16 @@ CamErr CamImage::convertPixFormat(CAM_IMAGE_PIX_FMT to_fmt)
             case CAM_IMAGE_PIX_FMT_RGB565:
               imageproc_convert_yuv2rgb(buff, width, height);
               setPixFormat(to_fmt);
-              break;
+              return CAM_ERR_SUCCESS;
 
             case CAM_IMAGE_PIX_FMT_GRAY:
               imageproc_convert_yuv2gray(buff, buff, width, height);
               setActualSize(width * height);
               setPixFormat(to_fmt);
-              break;
+              return CAM_ERR_SUCCESS;
 
             default:
-              return CAM_ERR_INVALID_PARAM;
+              break;
           }
 
         break;
@@ -220,25 +277,67 @@ CamErr CamImage::convertPixFormat(CAM_IMAGE_PIX_FMT to_fmt)
             case CAM_IMAGE_PIX_FMT_YUV422:
               imageproc_convert_rgb2yuv(buff, width, height);
               setPixFormat(to_fmt);
-              break;
+              return CAM_ERR_SUCCESS;
 
             case CAM_IMAGE_PIX_FMT_GRAY:
               imageproc_convert_rgb2yuv(buff, width, height);
               imageproc_convert_yuv2gray(buff, buff, width, height);
               setActualSize(width * height);
               setPixFormat(to_fmt);
-              break;
+              return CAM_ERR_SUCCESS;
 
             default:
-              return CAM_ERR_INVALID_PARAM;
+              break;
           }
 
         break;
 
       default:
-        return CAM_ERR_INVALID_PARAM;
+        break;
+    }
+
+  // Others are converted by software.
+
+  SWIMG_FMT sw_from, sw_to;
+  if (!to_swimg_fmt(from_fmt, &sw_from) || !to_swimg_fmt(to_fmt, &sw_to))
+    {
+      return CAM_ERR_INVALID_PARAM;
+    }
+
+  size_t size = (size_t)width * height * swimg_bytes_per_pixel(sw_to);
+  if (size <= img_buff->buf_size)
+    {
+      CamErr err = swimg_error(swimg_convert(buff, sw_from, buff, sw_to, width, height));
+      if (err == CAM_ERR_SUCCESS)
+        {
+          setActualSize(size);
+          setPixFormat(to_fmt);
+        }
+      return err;
     }
 
+  // The image grows, so convert into a new buffer.
+
+  ImgBuff *newbuf = new ImgBuff(img_buff->buf_type, width, height, to_fmt, 1, NULL);
+  if (newbuf == NULL || !newbuf->is_valid())
+    {
+      if(newbuf != NULL) delete newbuf;
+      return CAM_ERR_NO_MEMORY;
+    }
+
+  CamErr err = swimg_error(swimg_convert(buff, sw_from, newbuf->buff, sw_to, width, height));
+  if (err != CAM_ERR_SUCCESS)
+    {
+      delete newbuf;
+      return err;
+    }
+
+  newbuf->update_actual_size(size);
+
+  ImgBuff::delete_inst(img_buff);
+  img_buff = newbuf;
+  img_buff->incRef();
+
   return CAM_ERR_SUCCESS;
 }
 
@@ -308,26 +407,54 @@ bool CamImage::check_hw_resize_param(int iw, int ih, int ow, int oh)
 }
 
 
-CamErr CamImage::resizeImageByHW(CamImage &img, int width, int height)
+bool CamImage::check_clip_param(int lefttop_x, int lefttop_y,
+                                int rightbottom_x, int rightbottom_y)
 {
+  int clip_width  = rightbottom_x - lefttop_x + 1;
+  int clip_height = rightbottom_y - lefttop_y + 1;
+
+  return !( (lefttop_x   < 0) || (lefttop_x  > rightbottom_x) ||
+            (lefttop_y   < 0) || (lefttop_y  > rightbottom_y) ||
+            (clip_width  < 0) || (clip_width  > getWidth())   ||
+            (clip_height < 0) || (clip_height > getHeight())  ||
+            (rightbottom_x >= getWidth()) || (rightbottom_y >= getHeight()) );
+}
+
+CamErr CamImage::resize_image(CamImage &img,
+                              int lefttop_x, int lefttop_y,
+                              int rightbottom_x, int rightbottom_y,
+                              int width, int height,
+                              CAM_RESIZE_METHOD method)
+{
+  SWIMG_FMT swfmt;
+
   // Input instance must not be Capture Frames.
   if((img.is_valid()) && (img.img_buff->cam_ref != NULL))
     {
       return CAM_ERR_INVALID_PARAM;
     }
 
+  if (getImgBuff() == NULL)
+    {
+      return CAM_ERR_NOT_PERMITTED;
+    }
+
   // Format check.
-  if( getPixFormat() != CAM_IMAGE_PIX_FMT_YUV422 )
+  if( !to_swimg_fmt(getPixFormat(), &swfmt) )
     {
       return CAM_ERR_INVALID_PARAM;
     }
 
-  // HW limitation check.
-  if( !check_hw_resize_param( img_buff->width, img_buff->height, width, height ) )
+  // Check clip area.
+  if( !check_clip_param(lefttop_x, lefttop_y, rightbottom_x, rightbottom_y) )
     {
       return CAM_ERR_INVALID_PARAM;
     }
 
+  int clip_width  = rightbottom_x - lefttop_x + 1;
+  int clip_height = rightbottom_y - lefttop_y + 1;
+  bool whole = (clip_width == getWidth()) && (clip_height == getHeight());
+
   CamImage *tmp_img = new CamImage(V4L2_BUF_TYPE_VIDEO_CAPTURE, width, height, getPixFormat());
   if( tmp_img == NULL || !tmp_img->is_valid() )
     {
@@ -336,13 +463,51 @@ CamErr CamImage::resizeImageByHW(CamImage &img, int width, int height)
     }
   tmp_img->setActualSize(tmp_img->img_buff->buf_size);
 
-  // Execute resizing.
-  int ret = imageproc_resize(getImgBuff(), getWidth(), getHeight(),
-                  tmp_img->getImgBuff(), tmp_img->getWidth(), tmp_img->getHeight(), 16);
+  int ret = -1;
+
+  // Use the HW for the requests within its limitation.
+  if( (method == CAM_RESIZE_AUTO) &&
+      (getPixFormat() == CAM_IMAGE_PIX_FMT_YUV422) &&
+      check_hw_resize_param( clip_width, clip_height, width, height ) )
+    {
+      if (whole)
+        {
+          ret = imageproc_resize(getImgBuff(), getWidth(), getHeight(),
+                      tmp_img->getImgBuff(), tmp_img->getWidth(), tmp_img->getHeight(), 16);
+        }
+      else
+        {
+          imageproc_rect_t inrect;
+
+          inrect.x1 = lefttop_x;
+          inrect.y1 = lefttop_y;
+          inrect.x2 = rightbottom_x;
+          inrect.y2 = rightbottom_y;
+
+          ret = imageproc_clip_and_resize(getImgBuff(), getWidth(), getHeight(),
+                      tmp_img->getImgBuff(), tmp_img->getWidth(), tmp_img->getHeight(), 16, &inrect);
+        }
+    }
+
+  // Otherwise, or if the HW failed, resize by software.
   if( ret != 0 )
     {
-      delete tmp_img;
-      return CAM_ERR_ILLEGAL_DEVERR;
+      swimg_rect_t rect;
+
+      rect.x1 = lefttop_x;
+      rect.y1 = lefttop_y;
+      rect.x2 = rightbottom_x;
+      rect.y2 = rightbottom_y;
+
+      CamErr err = swimg_error(swimg_clip_and_resize(getImgBuff(), getWidth(), getHeight(), swfmt,
+                                                     whole ? NULL : &rect,
+                                                     tmp_img->getImgBuff(), width, height, swfmt,
+                                                     (SWIMG_RESIZE)method));
+      if( err != CAM_ERR_SUCCESS )
+        {
+          delete tmp_img;
+          return err;
+        }
     }
 
   // if the image has image buffer, delete it.
@@ -361,6 +526,11 @@ CamErr CamImage::resizeImageByHW(CamImage &img, int width, int height)
   return CAM_ERR_SUCCESS;
 }
 
+CamErr CamImage::resizeImageByHW(CamImage &img, int width, int height)
+{
+  return resize_image(img, 0, 0, getWidth() - 1, getHeight() - 1,
+                      width, height, CAM_RESIZE_AUTO);
+}
 
 CamErr CamImage::clipAndResizeImageByHW(
     CamImage &img,
@@ -371,75 +541,67 @@ CamErr CamImage::clipAndResizeImageByHW(
     int width,
     int height)
 {
-  int clip_width, clip_height;
-  imageproc_rect_t inrect;
+  return resize_image(img, lefttop_x, lefttop_y, rightbottom_x, rightbottom_y,
+                      width, height, CAM_RESIZE_AUTO);
+}
 
-  // Input instance must not be Capture Frames.
-  if((img.is_valid()) && (img.img_buff->cam_ref != NULL))
-    {
-      return CAM_ERR_INVALID_PARAM;
-    }
+CamErr CamImage::resizeImage(CamImage &img, int width, int height,
+                             CAM_RESIZE_METHOD method)
+{
+  return resize_image(img, 0, 0, getWidth() - 1, getHeight() - 1,
+                      width, height, method);
+}
 
-  // Format check.
-  if( getPixFormat() != CAM_IMAGE_PIX_FMT_YUV422 )
-    {
-      return CAM_ERR_INVALID_PARAM;
-    }
+CamErr CamImage::clipAndResizeImage(
+    CamImage &img,
+    int lefttop_x,
+    int lefttop_y,
+    int rightbottom_x,
+    int rightbottom_y,
+    int width,
+    int height,
+    CAM_RESIZE_METHOD method)
+{
+  return resize_image(img, lefttop_x, lefttop_y, rightbottom_x, rightbottom_y,
+                      width, height, method);
+}
 
-  clip_width  = rightbottom_x - lefttop_x + 1;
-  clip_height = rightbottom_y - lefttop_y + 1;
+CamErr CamImage::clipAndResizeImageToFloat(
+    float *out,
+    int lefttop_x,
+    int lefttop_y,
+    int rightbottom_x,
+    int rightbottom_y,
+    int width,
+    int height,
+    int channels,
+    const float *mean,
+    const float *scale,
+    bool planar,
+    CAM_RESIZE_METHOD method)
+{
+  SWIMG_FMT swfmt;
+  swimg_rect_t rect;
 
-  // Check clip area.
-  if( (lefttop_x   < 0) || (lefttop_x  > rightbottom_x) ||
-      (lefttop_y   < 0) || (lefttop_y  > rightbottom_y) ||
-      (clip_width  < 0) || (clip_width  > getWidth())   ||
-      (clip_height < 0) || (clip_height > getHeight()) )
+  if (getImgBuff() == NULL)
     {
-      return CAM_ERR_INVALID_PARAM;
+      return CAM_ERR_NOT_PERMITTED;
     }
 
-  // HW limitation check.
-  if( !check_hw_resize_param( clip_width, clip_height, width, height ) )
+  if( (out == NULL) || !to_swimg_fmt(getPixFormat(), &swfmt) ||
+      !check_clip_param(lefttop_x, lefttop_y, rightbottom_x, rightbottom_y) )
     {
       return CAM_ERR_INVALID_PARAM;
     }
 
-  CamImage *tmp_img = new CamImage(V4L2_BUF_TYPE_VIDEO_CAPTURE, width, height, getPixFormat());
-  if( tmp_img == NULL || !tmp_img->is_valid() )
-    {
-      if(tmp_img != NULL) delete tmp_img;
-      return CAM_ERR_NO_MEMORY;
-    }
-  tmp_img->setActualSize(tmp_img->img_buff->buf_size);
+  rect.x1 = lefttop_x;
+  rect.y1 = lefttop_y;
+  rect.x2 = rightbottom_x;
+  rect.y2 = rightbottom_y;
 
-  inrect.x1 = lefttop_x;
-  inrect.y1 = lefttop_y;
-  inrect.x2 = rightbottom_x;
-  inrect.y2 = rightbottom_y;
-
-  // Execute clip and resize.
-  int ret = imageproc_clip_and_resize(getImgBuff(), getWidth(), getHeight(),
-                  tmp_img->getImgBuff(), tmp_img->getWidth(), tmp_img->getHeight(), 16, &inrect);
-  if( ret != 0 )
-    {
-      delete tmp_img;
-      return CAM_ERR_ILLEGAL_DEVERR;
-    }
-
-  // if the image has image buffer, delete it.
-  if( img.is_valid() )
-    {
-      ImgBuff::delete_inst(img.img_buff);
-    }
-
-  // Set resized image buffer into input parameter.
-  img.img_buff = tmp_img->img_buff;
-  img.img_buff->incRef();
-
-  tmp_img->img_buff = NULL;
-  delete tmp_img;
-
-  return CAM_ERR_SUCCESS;
+  return swimg_error(swimg_clip_resize_normalize(getImgBuff(), getWidth(), getHeight(), swfmt,
+                                                 &rect, out, width, height, channels,
+                                                 mean, scale, planar, (SWIMG_RESIZE)method));
 }
 
 
@@ -507,9 +669,15 @@ CameraClass::CameraClass(const char *path)
     still_pix_fmt(CAM_IMAGE_PIX_FMT_NONE),
     video_imgs(NULL), still_img(NULL),
     loop_dqbuf_en(false), video_cb(NULL),
-    frame_tid(-1), frame_exchange_mq(-1), dq_tid(-1)
+    frame_tid(-1), frame_queue(NULL), frame_queue_head(0), frame_queue_num(0),
+    delivery_policy(CAM_DELIVERY_QUEUE_ALL), delivery_depth(1),
+    latest_frame(NULL), dq_tid(-1)
 {
   sem_init(&video_cb_access_sem, 0, 1);
+  sem_init(&frame_queue_lock, 0, 1);
+  sem_init(&frame_queue_sem, 0, 0);
+  sem_init(&latest_frame_sem, 0, 0);
+  memset(&stream_stat, 0, sizeof(stream_stat));
 }
 
 // Public : Destructor.
@@ -582,6 +750,15 @@ CamErr CameraClass::create_videobuff(int w, int h, int buff_num, CAM_IMAGE_PIX_F
       return CAM_ERR_NO_MEMORY;
     }
 
+  // All buffers can wait for the application at the same time.
+  frame_queue = (CamImage **)malloc(sizeof(CamImage *) * buff_num);
+  if (frame_queue == NULL)
+    {
+      free(video_imgs);
+      video_imgs = NULL;
+      return CAM_ERR_NO_MEMORY;
+    }
+
   for (i = 0; i < buff_num; i++)
     {
       video_imgs[i]
@@ -599,6 +776,9 @@ CamErr CameraClass::create_videobuff(int w, int h, int buff_num, CAM_IMAGE_PIX_F
               DELETE_CAMIMAGE(video_imgs[i]);
             }
           delete video_imgs;
+          video_imgs = NULL;
+          free(frame_queue);
+          frame_queue = NULL;
           return CAM_ERR_NO_MEMORY;
         }
 
@@ -665,6 +845,9 @@ void CameraClass::delete_videobuff()
     delete video_imgs;
   }
 
+  free(frame_queue);
+  frame_queue = NULL;
+
   video_imgs = NULL;
   video_buf_num = 0;
 }
@@ -767,26 +950,15 @@ CamErr CameraClass::set_video_frame_rate(CAM_VIDEO_FPS fps)
   return CAM_ERR_SUCCESS;
 }
 
-#define CAM_FRAME_MQ_NAME "thecamera_mq"
-
 CamErr CameraClass::create_dq_thread()
 {
   CamErr err = CAM_ERR_SUCCESS;
 
   struct sched_param param;
   pthread_attr_t tattr;
-  struct mq_attr mq_attr;
-
-  mq_attr.mq_maxmsg  = CAM_FRAME_MQ_SIZE;
-  mq_attr.mq_msgsize = sizeof(CamImage *);
-  mq_attr.mq_flags   = 0;
 
-  // Message queue for exchange frame buffer between dqbuf_thread and frame_handling_thread.
-  frame_exchange_mq = mq_open(CAM_FRAME_MQ_NAME, (O_RDWR | O_CREAT), 0666, &mq_attr);
-  if(frame_exchange_mq < 0)
-    {
-      return CAM_ERR_ILLEGAL_DEVERR;
-    }
+  // Frame queue between dqbuf_thread and frame_handling_thread.
+  flush_frames();
 
   // thread for callback to user operation.
   pthread_attr_init(&tattr);
@@ -802,7 +974,6 @@ CamErr CameraClass::create_dq_thread()
         (void *)this))
     {
       loop_dqbuf_en = false;
-      mq_close(frame_exchange_mq);
       return CAM_ERR_CANT_CREATE_THREAD;
     }
   else
@@ -823,10 +994,8 @@ CamErr CameraClass::create_dq_thread()
         (void *)this))
     {
       loop_dqbuf_en = false;
-      CamImage *req = NULL;
-      mq_send(frame_exchange_mq, (const char *)&req, sizeof(CamImage *), 0);
+      sem_post(&frame_queue_sem);
       pthread_join(frame_tid, NULL);
-      mq_close(frame_exchange_mq);
       err = CAM_ERR_CANT_CREATE_THREAD;
     }
   else
@@ -847,14 +1016,27 @@ void CameraClass::delete_dq_thread()
       pthread_join(dq_tid, NULL);
       dq_tid = -1;
 
-      CamImage *req = NULL;
-      mq_send(frame_exchange_mq, (const char *)&req, sizeof(CamImage *), 0);
+      sem_post(&frame_queue_sem);
       pthread_join(frame_tid, NULL);
       frame_tid = -1;
-      mq_close(frame_exchange_mq);
+
+      flush_frames();
     }
 }
 
+// Private : Forget all waiting frames. The buffers are deleted or requeued by the caller.
+void CameraClass::flush_frames()
+{
+  lock_frame_queue();
+  frame_queue_head = 0;
+  frame_queue_num = 0;
+  latest_frame = NULL;
+  stream_stat.queued = 0;
+  while (sem_trywait(&frame_queue_sem) == 0);
+  while (sem_trywait(&latest_frame_sem) == 0);
+  unlock_frame_queue();
+}
+
 // Public : Start to use the Camera.
 CamErr CameraClass::begin(int buff_num, CAM_VIDEO_FPS fps, int video_width, int video_height,
                           CAM_IMAGE_PIX_FMT video_fmt, int jpgbufsize_divisor)
@@ -973,6 +1155,25 @@ CamErr CameraClass::startStreaming(bool enable, camera_cb_t cb)
       video_cb = cb;
       unlock_video_cb();
 
+      // The latest frame kept for tryGetLatestFrame() is not needed any more.
+      if (cb != NULL)
+        {
+          lock_frame_queue();
+          CamImage *img = latest_frame;
+          latest_frame = NULL;
+          if (img != NULL)
+            {
+              sem_trywait(&latest_frame_sem);
+              stream_stat.dropped++;
+            }
+          unlock_frame_queue();
+
+          if (img != NULL)
+            {
+              enqueue_video_buff(img);
+            }
+        }
+
       if (ioctl(video_fd, req, (unsigned long)&type) < 0)
         {
           err =  convert_errno2camerr(errno);
@@ -1312,21 +1513,108 @@ int CameraClass::ioctl_dequeue_stream_buf(struct v4l2_buffer *buf,
 }
 
 CamImage *CameraClass::search_vimg(int index)
+{
+  // The index of the buffer is the position in video_imgs.
+  if ((index >= 0) && (index < video_buf_num) && video_imgs[index]->isIdx(index))
+    {
+      return video_imgs[index];
+    }
+
+  return NULL;
+}
+
+// Private : Pass a dequeued frame to frame_handle_thread.
+void CameraClass::push_frame(CamImage *img)
+{
+  CamImage *drop = NULL;
+  int limit;
+
+  lock_frame_queue();
+
+  switch (delivery_policy)
+    {
+      case CAM_DELIVERY_LATEST:
+        limit = 1;
+        break;
+      case CAM_DELIVERY_DROP_OLDEST:
+        limit = (delivery_depth < video_buf_num) ? delivery_depth : video_buf_num;
+        break;
+      default:
+        limit = video_buf_num;
+        break;
+    }
+
+  stream_stat.received++;
+
+  // Over the depth, the oldest frames go back to the sensor. The count of
+  // frame_queue_sem is left as it is, so it never goes below the number of
+  // the queued frames and frame_handle_thread only sees a spare wakeup.
+  while (frame_queue_num >= limit)
+    {
+      drop = frame_queue[frame_queue_head];
+      frame_queue_head = (frame_queue_head + 1) % video_buf_num;
+      frame_queue_num--;
+      stream_stat.dropped++;
+      enqueue_video_buff(drop);
+    }
+
+  frame_queue[(frame_queue_head + frame_queue_num) % video_buf_num] = img;
+  frame_queue_num++;
+  stream_stat.queued = frame_queue_num;
+  if (frame_queue_num > stream_stat.maxQueued)
+    {
+      stream_stat.maxQueued = frame_queue_num;
+    }
+
+  unlock_frame_queue();
+
+  if (drop == NULL)
+    {
+      sem_post(&frame_queue_sem);
+    }
+}
+
+// Private : Take the oldest frame for frame_handle_thread.
+CamImage *CameraClass::pop_frame()
 {
   CamImage *img = NULL;
 
-  for (int i = 0; i < video_buf_num; i++)
+  lock_frame_queue();
+  if (frame_queue_num > 0)
     {
-      if (video_imgs[i]->isIdx(index))
-        {
-          img = video_imgs[i];
-          break;
-        }
+      img = frame_queue[frame_queue_head];
+      frame_queue_head = (frame_queue_head + 1) % video_buf_num;
+      frame_queue_num--;
+      stream_stat.queued = frame_queue_num;
     }
+  unlock_frame_queue();
 
   return img;
 }
 
+// Private : Keep the frame for tryGetLatestFrame() and release the older one.
+void CameraClass::keep_latest_frame(CamImage *img)
+{
+  lock_frame_queue();
+  CamImage *old = latest_frame;
+  latest_frame = img;
+  if (old != NULL)
+    {
+      stream_stat.dropped++;
+    }
+  else
+    {
+      // Post under the lock so that the count always matches latest_frame.
+      sem_post(&latest_frame_sem);
+    }
+  unlock_frame_queue();
+
+  if (old != NULL)
+    {
+      enqueue_video_buff(old);
+    }
+}
+
 // Private Static : dqbuf buffer handling thread.
 void CameraClass::dqbuf_thread(void *arg)
 {
@@ -1350,14 +1638,12 @@ void CameraClass::dqbuf_thread(void *arg)
               else
                 {
                   img->setActualSize((size_t)0);
+                  cam->lock_frame_queue();
+                  cam->stream_stat.errors++;
+                  cam->unlock_frame_queue();
                 }
 
-              if(mq_send(cam->frame_exchange_mq, (const char *)&img, sizeof(CamImage *), 0)
-                  < 0)
-                {
-                  // in error case, the buf returns camera queue.
-                  cam->enqueue_video_buff(img);
-                }
+              cam->push_frame(img);
             }
         }
     }
@@ -1372,29 +1658,142 @@ void CameraClass::frame_handle_thread(void *arg)
 
   while (cam->loop_dqbuf_en)
     {
-      if(mq_receive(cam->frame_exchange_mq, (char *)&img, sizeof(CamImage *), 0)
-           >= 0)
+      if (sem_wait(&cam->frame_queue_sem) < 0)
         {
-          if(img)
+          continue;
+        }
+
+      img = cam->pop_frame();
+      if(img)
+        {
+          cam->lock_video_cb();
+          if (cam->video_cb != NULL)
             {
-              cam->lock_video_cb();
-              if (cam->video_cb != NULL)
-                {
-                  img->setPixFormat(cam->video_pix_fmt);
-                  cam->video_cb(*img);
-                }
-              else
-                {
-                  // No one handles this. Back to queue then.
-                  cam->enqueue_video_buff(img);
-                }
-              cam->unlock_video_cb();
+              img->setPixFormat(cam->video_pix_fmt);
+              cam->video_cb(*img);
+
+              cam->lock_frame_queue();
+              cam->stream_stat.delivered++;
+              cam->unlock_frame_queue();
             }
+          else
+            {
+              // Nobody handles this now. Keep it for tryGetLatestFrame().
+              cam->keep_latest_frame(img);
+            }
+          cam->unlock_video_cb();
         }
     }
   pthread_exit(0);
 }
 
+// Public : Set delivery policy of video frames.
+CamErr CameraClass::setDeliveryPolicy(CAM_DELIVERY_POLICY policy, int depth)
+{
+  if ((policy > CAM_DELIVERY_LATEST) || (depth < 1))
+    {
+      return CAM_ERR_INVALID_PARAM;
+    }
+
+  lock_frame_queue();
+  delivery_policy = policy;
+  delivery_depth = depth;
+  unlock_frame_queue();
+
+  return CAM_ERR_SUCCESS;
+}
+
+// Public : Get the latest video frame without callback.
+CamImage CameraClass::tryGetLatestFrame(int timeout_ms)
+{
+  CamImage ret;
+  CamImage *img = NULL;
+  struct timespec abstime;
+  int result;
+
+  if (!is_device_ready())
+    {
+      return ret;
+    }
+
+  if (timeout_ms > 0)
+    {
+      clock_gettime(CLOCK_REALTIME, &abstime);
+      abstime.tv_sec += timeout_ms / 1000;
+      abstime.tv_nsec += (timeout_ms % 1000) * 1000000;
+      if (abstime.tv_nsec >= 1000000000)
+        {
+          abstime.tv_sec++;
+          abstime.tv_nsec -= 1000000000;
+        }
+    }
+
+  // The frame can be taken back by startStreaming() after the count is
+  // got, so wait again until the deadline if no frame is left.
+  while (img == NULL)
+    {
+      if (timeout_ms == 0)
+        {
+          result = sem_trywait(&latest_frame_sem);
+        }
+      else if (timeout_ms < 0)
+        {
+          result = sem_wait(&latest_frame_sem);
+        }
+      else
+        {
+          result = sem_timedwait(&latest_frame_sem, &abstime);
+        }
+
+      if (result < 0)
+        {
+          return ret;
+        }
+
+      lock_frame_queue();
+      img = latest_frame;
+      latest_frame = NULL;
+      if (img != NULL)
+        {
+          stream_stat.delivered++;
+        }
+      unlock_frame_queue();
+    }
+
+  // The buffer goes back to the sensor when the last copy is released.
+  img->setPixFormat(video_pix_fmt);
+  ret = *img;
+
+  return ret;
+}
+
+// Public : Get statistics of video streaming.
+CamErr CameraClass::getStreamStat(CamStreamStat *stat)
+{
+  if (stat == NULL)
+    {
+      return CAM_ERR_INVALID_PARAM;
+    }
+
+  lock_frame_queue();
+  *stat = stream_stat;
+  unlock_frame_queue();
+
+  return CAM_ERR_SUCCESS;
+}
+
+// Public : Clear statistics of video streaming.
+void CameraClass::clearStreamStat()
+{
+  lock_frame_queue();
+  stream_stat.received = 0;
+  stream_stat.delivered = 0;
+  stream_stat.dropped = 0;
+  stream_stat.errors = 0;
+  stream_stat.maxQueued = stream_stat.queued;
+  unlock_frame_queue();
+}
+
 
 // Private Static :
 void CameraClass::release_buf(ImgBuff *buf)
@@ -1406,13 +1805,10 @@ void CameraClass::release_buf(ImgBuff *buf)
       return;
     }
 
-  for (int i=0; i < video_buf_num; i++)
+  CamImage *img = search_vimg(idx);
+  if (img != NULL)
     {
-      if (video_imgs[i]->isIdx(idx))
-        {
-          enqueue_video_buff(video_imgs[i]);
-          break;
-        }
+      enqueue_video_buff(img);
     }
 }
 
@@ -64,9 +64,20 @@ enum CAM_IMAGE_PIX_FMT {
   CAM_IMAGE_PIX_FMT_YUV422 = V4L2_PIX_FMT_UYVY,   /**< YUV422 packed. */
   CAM_IMAGE_PIX_FMT_JPG    = V4L2_PIX_FMT_JPEG,   /**< JPEG format */
   CAM_IMAGE_PIX_FMT_GRAY,                         /**< Gray-scale */
+  CAM_IMAGE_PIX_FMT_RGB888,                       /**< RGB888 packed (R, G, B) */
   CAM_IMAGE_PIX_FMT_NONE,                         /**< No defined format */
 };
 
+/**
+ * @enum CAM_RESIZE_METHOD
+ * @brief [en] Resize method of software image processing <BR>
+ *        [ja] ソフトウェア画像処理のリサイズ方法
+ */
+enum CAM_RESIZE_METHOD {
+  CAM_RESIZE_AUTO,     /**< [en] HW if possible. Otherwise area for 1/2 or smaller, bilinear for others <BR> [ja] 可能ならHW、それ以外は1/2以下で平均画素法、その他はバイリニア */
+  CAM_RESIZE_BILINEAR, /**< [en] Bilinear interpolation by software <BR> [ja] ソフトウェアによるバイリニア補間 */
+  CAM_RESIZE_AREA,     /**< [en] Area average by software         <BR> [ja] ソフトウェアによる平均画素法 */
+};
 
 /**
  * @enum CamErr
@@ -239,6 +250,31 @@ enum CAM_VIDEO_FPS {
   CAM_VIDEO_FPS_120,  /**< 120 FPS */
 };
 
+/**
+ * @enum CAM_DELIVERY_POLICY
+ * @brief [en] Delivery policy of video frames to the application. <BR>
+ *        [ja] アプリケーションへの動画フレームの受け渡し方針
+ */
+enum CAM_DELIVERY_POLICY {
+  CAM_DELIVERY_QUEUE_ALL,   /**< [en] Deliver all frames in order. (Default)         <BR> [ja] 全フレームを順に渡す (デフォルト) */
+  CAM_DELIVERY_DROP_OLDEST, /**< [en] Keep the newest frames up to the queue depth   <BR> [ja] キューの深さまで最新のフレームを保持する */
+  CAM_DELIVERY_LATEST,      /**< [en] Deliver only the latest frame                  <BR> [ja] 最新のフレームのみを渡す */
+};
+
+/**
+ * @struct CamStreamStat
+ * @brief [en] Statistics of video streaming. <BR>
+ *        [ja] 動画ストリーミングの統計情報
+ */
+typedef struct {
+  uint32_t received;  /**< [en] Frames received from the driver          <BR> [ja] ドライバから受け取ったフレーム数 */
+  uint32_t delivered; /**< [en] Frames passed to the application         <BR> [ja] アプリケーションに渡したフレーム数 */
+  uint32_t dropped;   /**< [en] Frames dropped by the delivery policy    <BR> [ja] 受け渡し方針により破棄したフレーム数 */
+  uint32_t errors;    /**< [en] Frames with a capture error              <BR> [ja] キャプチャエラーのフレーム数 */
+  int      queued;    /**< [en] Frames waiting for the application now   <BR> [ja] 現在アプリケーション待ちのフレーム数 */
+  int      maxQueued; /**< [en] Maximum of queued                        <BR> [ja] queuedの最大値 */
+} CamStreamStat;
+
 /** @brief [en] Camera Callback type definition. <BR> [jp] Cameraからのコールバック関数の型定義 */
 typedef void (*camera_cb_t)(CamImage img);
 
@@ -315,6 +351,10 @@ private:
 
   bool check_hw_resize_param(int iw, int ih, int ow, int oh);
   bool check_resize_magnification(int in, int out);
+  bool check_clip_param(int lefttop_x, int lefttop_y, int rightbottom_x, int rightbottom_y);
+  CamErr resize_image(CamImage &img, int lefttop_x, int lefttop_y,
+                      int rightbottom_x, int rightbottom_y,
+                      int width, int height, CAM_RESIZE_METHOD method);
 
 
 public:
@@ -408,10 +448,17 @@ public:
    * @brief Convert Pixcelformat of the image.
    * @details [en] Convert own image's pixel format. Override Image data. So
    *               original image is discarded. If paramter is the same format
-   *               as current, no error and no operation. <BR>
+   *               as current, no error and no operation.
+   *               Conversions from YUV422 or RGB565 to RGB565, YUV422 or GRAY
+   *               use the HW, and the other conversions among YUV422, RGB565,
+   *               GRAY and RGB888 are done by software. If the converted image
+   *               does not fit in the buffer, a new buffer is allocated. <BR>
    *          [ja] ピクセルフォーマット変換を行う。画像データは上書きされ、元の
    *               ピクセルフォーマットの画像は破棄される。現在のフォーマットと
    *               同一のフォーマットが設定された場合、何も処理は行われず正常終了する。
+   *               YUV422、RGB565からRGB565、YUV422、GRAYへの変換はHWで、その他の
+   *               YUV422、RGB565、GRAY、RGB888間の変換はソフトウェアで行われる。
+   *               変換後の画像がバッファに入らない場合は、新しいバッファが確保される。
    * @return [en] Error codes in #CamErr <BR>
    *         [jp] #CamErr で定義されているエラーコード
    */
@@ -427,7 +474,10 @@ public:
    *               - Minimum width and height is 12 pixels.
    *               - Maximum width is 768 pixels.
    *               - Maximum height is 1024 pixels.
-   *               - Resizing magnification is 2^n or 1/2^n, and resized image size must be integer. <BR>
+   *               - Resizing magnification is 2^n or 1/2^n, and resized image size must be integer.
+   *               - Only YUV422 format is supported.
+   *               If the request is out of the limitation, the image is resized by software
+   *               as #resizeImage with #CAM_RESIZE_AUTO. <BR>
    *          [ja] CXD5602が持つ2Dアクセラレータを用いた画像のリサイズを行う。
    *               内部で新たにImage用のバッファを生成したうえで、第1引数に指定された
    *               CamImageインスタンスに結果を格納する。
@@ -437,7 +487,10 @@ public:
    *               イメージの幅、高さの最小ピクセル数は12ピクセル。
    *               イメージの幅の最大ピクセル数は768ピクセル。
    *               イメージの高さの最大ピクセル数は1024ピクセル。
-   *               リサイズする場合の倍率は2^n倍もしくは1/2^nとなり、リサイズ後のサイズは整数になる必要がある。 <BR>
+   *               リサイズする場合の倍率は2^n倍もしくは1/2^nとなり、リサイズ後のサイズは整数になる必要がある。
+   *               YUV422フォーマットのみ対応。
+   *               この制限を超える場合は、#CAM_RESIZE_AUTO を指定した #resizeImage と同様に
+   *               ソフトウェアでリサイズを行う。 <BR>
    * @return [en] Error codes in #CamErr <BR>
    *         [jp] #CamErr で定義されているエラーコード
    */
@@ -459,7 +512,10 @@ public:
    *               - Minimum width and height is 12 pixels.
    *               - Maximum width is 768 pixels.
    *               - Maximum height is 1024 pixels.
-   *               - Resizing magnification is 2^n or 1/2^n, and resized image size must be integer. <BR>
+   *               - Resizing magnification is 2^n or 1/2^n, and resized image size must be integer.
+   *               - Only YUV422 format is supported.
+   *               If the request is out of the limitation, the image is clipped and resized by
+   *               software as #clipAndResizeImage with #CAM_RESIZE_AUTO. <BR>
    *          [ja] CXD5602が持つ2Dアクセラレータを用いた画像のクリッピング及びリサイズを行う。
    *               まず、元画像に対して、引数 (#lefttop_x, #lefttop_y) - (#rightbottom_x, #rightbottom_y) で指定された領域をクリップし、
    *               クリップされた画像に対して引数 (#width, #height)で指定されたサイズにリサイズを行う。
@@ -469,7 +525,10 @@ public:
    *               　　イメージの幅、高さの最小ピクセル数は12ピクセル。<BR>
    *               　　イメージの幅の最大ピクセル数は768ピクセル。<BR>
    *               　　イメージの高さの最大ピクセル数は1024ピクセル。<BR>
-   *               　　リサイズする場合の倍率は2^n倍もしくは1/2^nとなり、リサイズ後のサイズは整数になる必要がある。 <BR>
+   *               　　リサイズする場合の倍率は2^n倍もしくは1/2^nとなり、リサイズ後のサイズは整数になる必要がある。<BR>
+   *               　　YUV422フォーマットのみ対応。<BR>
+   *               この制限を超える場合は、#CAM_RESIZE_AUTO を指定した #clipAndResizeImage と同様に
+   *               ソフトウェアでクリッピング及びリサイズを行う。 <BR>
    * @return [en] Error codes in #CamErr <BR>
    *         [jp] #CamErr で定義されているエラーコード
    */
@@ -483,6 +542,77 @@ public:
     int height         /**< [en] Height to resize from clipping image <BR> [ja] クリップされた画像に対して、リサイズする画像の縦サイズ */
   );
 
+  /**
+   * @brief Resize Image at any ratio.
+   * @details [en] Resize the image to any size. With #CAM_RESIZE_AUTO, the 2D accelerator
+   *               is used if the request is within its limitation (see #resizeImageByHW),
+   *               otherwise the image is resized by software. The other methods always
+   *               use software. YUV422, RGB565, GRAY and RGB888 formats are supported,
+   *               and the width must be even for YUV422. The result has the same format. <BR>
+   *          [ja] 任意のサイズに画像をリサイズする。#CAM_RESIZE_AUTO の場合、HWの制限内
+   *               (#resizeImageByHW 参照)であれば2Dアクセラレータを使い、それ以外は
+   *               ソフトウェアでリサイズする。その他の方法では常にソフトウェアを使う。
+   *               YUV422、RGB565、GRAY、RGB888フォーマットに対応し、YUV422の場合は幅が
+   *               偶数である必要がある。結果は同じフォーマットとなる。
+   * @return [en] Error codes in #CamErr <BR>
+   *         [jp] #CamErr で定義されているエラーコード
+   */
+  CamErr resizeImage(
+    CamImage &img, /**< [en] Instance of CamImage with result of resizing. <BR> [ja] リサイズ後の新しいCamImageが格納されるインスタンス */
+    int width,     /**< [en] Width to resize  <BR> [ja] リサイズする画像の横サイズ */
+    int height,    /**< [en] Height to resize <BR> [ja] リサイズする画像の縦サイズ */
+    CAM_RESIZE_METHOD method = CAM_RESIZE_AUTO /**< [en] Resize method <BR> [ja] リサイズ方法 */
+  );
+
+  /**
+   * @brief Clip and resize Image at any ratio.
+   * @details [en] Clip the area (#lefttop_x, #lefttop_y) - (#rightbottom_x, #rightbottom_y)
+   *               and resize it to (#width, #height) in one pass.
+   *               The HW is used in the same way as #resizeImage. <BR>
+   *          [ja] 領域 (#lefttop_x, #lefttop_y) - (#rightbottom_x, #rightbottom_y) を
+   *               クリップし、(#width, #height) へのリサイズを一度に行う。
+   *               HWは #resizeImage と同様に使われる。
+   * @return [en] Error codes in #CamErr <BR>
+   *         [jp] #CamErr で定義されているエラーコード
+   */
+  CamErr clipAndResizeImage(
+    CamImage &img,     /**< [en] Instance of CamImage with result of resizing. <BR> [ja] リサイズ後の新しいCamImageが格納されるインスタンス */
+    int lefttop_x,     /**< [en] Left top X coodinate in original image for clipping. <BR> [ja] 元画像に対して、クリップする左上のX座標 */
+    int lefttop_y,     /**< [en] Left top Y coodinate in original image for clipping. <BR> [ja] 元画像に対して、クリップする左上のY座標 */
+    int rightbottom_x, /**< [en] Right bottom X coodinate in original image for clipping. <BR> [ja] 元画像に対して、クリップする右下のX座標 */
+    int rightbottom_y, /**< [en] Right bottom Y coodinate in original image for clipping. <BR> [ja] 元画像に対して、クリップする右下のY座標 */
+    int width,         /**< [en] Width to resize from clipping image  <BR> [ja] クリップされた画像に対して、リサイズする画像の横サイズ */
+    int height,        /**< [en] Height to resize from clipping image <BR> [ja] クリップされた画像に対して、リサイズする画像の縦サイズ */
+    CAM_RESIZE_METHOD method = CAM_RESIZE_AUTO /**< [en] Resize method <BR> [ja] リサイズ方法 */
+  );
+
+  /**
+   * @brief Clip, resize and normalize Image into a float array.
+   * @details [en] Clip the area, resize it and write
+   *               (pixel - mean[c]) * scale[c] of each channel into #out in one pass,
+   *               without any intermediate image. The pixel value is 0 to 255.
+   *               Gray scale for 1 channel and R, G, B for 3 channels. <BR>
+   *          [ja] 領域をクリップ、リサイズし、各チャンネルの (画素値 - mean[c]) * scale[c] を
+   *               中間画像なしに一度に #out に書き込む。画素値は0から255。
+   *               1チャンネルはグレースケール、3チャンネルはR, G, Bとなる。
+   * @return [en] Error codes in #CamErr <BR>
+   *         [jp] #CamErr で定義されているエラーコード
+   */
+  CamErr clipAndResizeImageToFloat(
+    float *out,         /**< [en] Output of width * height * channels <BR> [ja] width * height * channels の出力先 */
+    int lefttop_x,      /**< [en] Left top X coodinate for clipping. <BR> [ja] クリップする左上のX座標 */
+    int lefttop_y,      /**< [en] Left top Y coodinate for clipping. <BR> [ja] クリップする左上のY座標 */
+    int rightbottom_x,  /**< [en] Right bottom X coodinate for clipping. <BR> [ja] クリップする右下のX座標 */
+    int rightbottom_y,  /**< [en] Right bottom Y coodinate for clipping. <BR> [ja] クリップする右下のY座標 */
+    int width,          /**< [en] Output width  <BR> [ja] 出力の横サイズ */
+    int height,         /**< [en] Output height <BR> [ja] 出力の縦サイズ */
+    int channels,       /**< [en] 1 or 3 <BR> [ja] 1 または 3 */
+    const float *mean,  /**< [en] Mean of each channel, or NULL for 0  <BR> [ja] 各チャンネルの平均値。NULLの場合は0 */
+    const float *scale, /**< [en] Scale of each channel, or NULL for 1 <BR> [ja] 各チャンネルの倍率。NULLの場合は1 */
+    bool planar = false, /**< [en] true for CHW, false for HWC layout <BR> [ja] trueでCHW、falseでHWC配置 */
+    CAM_RESIZE_METHOD method = CAM_RESIZE_AUTO /**< [en] Resize method (always by software) <BR> [ja] リサイズ方法 (常にソフトウェア) */
+  );
+
 
   /**
    * @brief Check valid image data.
@@ -554,8 +684,26 @@ private:
   static const int CAM_FRAME_THREAD_STACK_SIZE = 2048;
   static const int CAM_FRAME_THREAD_STACK_PRIO = 101;
 
-  mqd_t frame_exchange_mq;
-  static const int CAM_FRAME_MQ_SIZE = 1;
+  // Frames from dqbuf_thread to frame_handle_thread.
+  CamImage **frame_queue;
+  int frame_queue_head;
+  int frame_queue_num;
+  sem_t frame_queue_lock;
+  sem_t frame_queue_sem;
+  CAM_DELIVERY_POLICY delivery_policy;
+  int delivery_depth;
+  CamStreamStat stream_stat;
+
+  // Latest frame kept for tryGetLatestFrame() when no callback is set.
+  CamImage *latest_frame;
+  sem_t latest_frame_sem;
+
+  void lock_frame_queue()  { sem_wait(&frame_queue_lock); };
+  void unlock_frame_queue(){ sem_post(&frame_queue_lock); };
+  void push_frame(CamImage *img);
+  CamImage *pop_frame();
+  void keep_latest_frame(CamImage *img);
+  void flush_frames();
 
   pthread_t dq_tid;
   static void dqbuf_thread(void *);
@@ -785,6 +933,62 @@ public:
    */
   int getJPEGQuality(void);
 
+  /**
+   * @brief Set delivery policy of video frames.
+   * @details [en] Set how video frames are passed when the application is slower than
+   *               the frame rate. With #CAM_DELIVERY_QUEUE_ALL, all frames wait for
+   *               the application, so the sensor stops when all buffers are waiting.
+   *               With #CAM_DELIVERY_DROP_OLDEST, at most #depth frames wait and the
+   *               oldest one goes back to the sensor when a new frame comes.
+   *               #CAM_DELIVERY_LATEST is the same with depth 1, which gives the lowest
+   *               latency. <BR>
+   *          [ja] アプリケーションの処理がフレームレートに間に合わない場合の動画フレーム
+   *               の受け渡し方針を設定する。#CAM_DELIVERY_QUEUE_ALL では全フレームが
+   *               アプリケーションを待つため、全バッファが待ちになるとセンサが停止する。
+   *               #CAM_DELIVERY_DROP_OLDEST では最大 #depth フレームが待ち、新しい
+   *               フレームが来ると最も古いフレームをセンサに戻す。#CAM_DELIVERY_LATEST は
+   *               深さ1の場合と同じで、最も遅延が小さい。
+   * @return [en] Error code defined as #CamErr. <BR>
+   *         [ja] #CamErr で定義されているエラーコード
+   */
+  CamErr setDeliveryPolicy(
+    CAM_DELIVERY_POLICY policy, /**< [en] Delivery policy <BR> [ja] 受け渡し方針 */
+    int depth = 1               /**< [en] Queue depth for #CAM_DELIVERY_DROP_OLDEST <BR> [ja] #CAM_DELIVERY_DROP_OLDEST のキューの深さ */
+  );
+
+  /**
+   * @brief Get the latest video frame.
+   * @details [en] Get the latest video frame without callback. Start streaming with
+   *               NULL callback to use this. Only the latest frame is kept, and older
+   *               ones go back to the sensor. Release the returned image as soon as
+   *               possible, because its buffer is not used by the sensor until then. <BR>
+   *          [ja] コールバックを使わずに最新の動画フレームを取得する。コールバックに
+   *               NULLを指定してストリーミングを開始すること。最新のフレームのみが保持され、
+   *               古いフレームはセンサに戻される。返された画像を解放するまでそのバッファは
+   *               センサで使われないため、できるだけ早く解放すること。
+   * @return [en] Video frame. Empty object if no frame comes within the timeout. <BR>
+   *         [ja] 動画フレーム。タイムアウトまでにフレームが来なかった場合は空のオブジェクト。
+   */
+  CamImage tryGetLatestFrame(
+    int timeout_ms = 0 /**< [en] Timeout in milliseconds. 0 for no wait, negative for forever. <BR> [ja] タイムアウト(ミリ秒)。0で待たない、負の値で無期限 */
+  );
+
+  /**
+   * @brief Get statistics of video streaming.
+   * @details [en] Get counters of frames and the queue depth. <BR>
+   *          [ja] フレーム数とキューの深さの統計情報を取得する。
+   * @return [en] Error code defined as #CamErr. <BR>
+   *         [ja] #CamErr で定義されているエラーコード
+   */
+  CamErr getStreamStat(CamStreamStat *stat /**< [out] [en] Statistics <BR> [ja] 統計情報 */);
+
+  /**
+   * @brief Clear statistics of video streaming.
+   * @details [en] Clear the counters. The current queue depth is kept. <BR>
+   *          [ja] カウンタをクリアする。現在のキューの深さは保持される。
+   */
+  void clearStreamStat();
+
   /**
    * @brief Get frame interval
    * @details [en] Get frame interval in 100usec units.  <BR>
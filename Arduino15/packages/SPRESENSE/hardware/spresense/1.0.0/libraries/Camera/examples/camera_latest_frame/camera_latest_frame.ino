@@ -0,0 +1,93 @@
+/*
+ *  camera_latest_frame.ino - Camera example of the latest frame delivery
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  This example pulls the latest video frame from loop() without callback.
+ *  The processing in loop() takes longer than the frame interval on purpose,
+ *  and the frames in between go back to the sensor, so the latency of the
+ *  processed frame stays within one frame interval.
+ */
+
+#include <Camera.h>
+
+#define BAUDRATE        (115200)
+#define PROCESS_TIME_MS (100)   /* Slower than 30 fps */
+
+void setup()
+{
+  CamErr err;
+
+  Serial.begin(BAUDRATE);
+  while (!Serial)
+    {
+      ; /* wait for serial port to connect. Needed for native USB port only */
+    }
+
+  err = theCamera.begin(2, CAM_VIDEO_FPS_30, CAM_IMGSIZE_QVGA_H, CAM_IMGSIZE_QVGA_V,
+                        CAM_IMAGE_PIX_FMT_YUV422);
+  if (err != CAM_ERR_SUCCESS)
+    {
+      Serial.print("Camera begin error: ");
+      Serial.println(err);
+      return;
+    }
+
+  theCamera.setDeliveryPolicy(CAM_DELIVERY_LATEST);
+
+  /* NULL callback to pull the frames by tryGetLatestFrame() */
+
+  err = theCamera.startStreaming(true, NULL);
+  if (err != CAM_ERR_SUCCESS)
+    {
+      Serial.print("Start streaming error: ");
+      Serial.println(err);
+    }
+}
+
+void loop()
+{
+  static int count = 0;
+  CamStreamStat stat;
+
+  /* Scope the image so that its buffer goes back to the sensor soon */
+
+  {
+    CamImage img = theCamera.tryGetLatestFrame(1000);
+    if (!img.isAvailable())
+      {
+        Serial.println("No frame");
+        return;
+      }
+
+    delay(PROCESS_TIME_MS);
+  }
+
+  if (++count % 10 == 0)
+    {
+      theCamera.getStreamStat(&stat);
+      Serial.print("received ");
+      Serial.print(stat.received);
+      Serial.print(" delivered ");
+      Serial.print(stat.delivered);
+      Serial.print(" dropped ");
+      Serial.print(stat.dropped);
+      Serial.print(" errors ");
+      Serial.print(stat.errors);
+      Serial.print(" max queued ");
+      Serial.println(stat.maxQueued);
+    }
+}
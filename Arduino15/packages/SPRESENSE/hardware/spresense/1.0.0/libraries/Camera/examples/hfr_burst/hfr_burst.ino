@@ -0,0 +1,157 @@
+/*
+ *  hfr_burst.ino - Recording 5 seconds JPEG burst with QVGA 120FPS
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *  This is a test app for the camera library.
+ *  This library can only be used on the Spresense with the FCBGA chip package.
+ *
+ *  Unlike hfr_jpg, the callback only queues the frames, and a background
+ *  thread of CamBurstRecorder writes them into HFR.MJPG in large chunks.
+ *  The file is a Motion JPEG stream, which can be played by e.g.
+ *  "ffplay -f mjpeg HFR.MJPG" or split into JPEG files by FFD8 markers.
+ */
+
+#include <SDHCI.h>
+#include <Camera.h>
+#include <CamBurstRecorder.h>
+
+#define BAUDRATE                (115200)
+#define FRAMES_NUM              (600)   /* 120FPS * 5 seconds */
+#define VIDEO_BUFF_NUM          (4)
+#define QUEUE_DEPTH             (VIDEO_BUFF_NUM - 1)
+#define PREALLOC_SIZE           (16 * 1024 * 1024)
+
+SDClass  theSD;
+CamBurstRecorder recorder;
+volatile int frame_count = 0;
+
+/**
+ * Callback from Camera library when video frame is captured.
+ */
+
+void CamCB(CamImage img)
+{
+  if (img.isAvailable() && (frame_count < FRAMES_NUM))
+    {
+      /* Dropped frames are counted by the recorder */
+
+      recorder.push(img);
+      frame_count++;
+    }
+}
+
+void printStat()
+{
+  CamBurstStat stat;
+
+  recorder.getStat(&stat);
+  Serial.print("frames ");
+  Serial.print(stat.frames);
+  Serial.print(" dropped ");
+  Serial.print(stat.dropped);
+  Serial.print(" errors ");
+  Serial.print(stat.errors);
+  Serial.print(" fps ");
+  Serial.print(stat.fps);
+  Serial.print(" MB/s ");
+  Serial.print(stat.mbps);
+  Serial.print(" max queued ");
+  Serial.print(stat.maxQueued);
+  Serial.print(" max write ");
+  Serial.print(stat.maxWriteUs);
+  Serial.println(" us");
+}
+
+/**
+ * @brief Initialize camera and recorder
+ */
+void setup()
+{
+  CamErr err;
+
+  Serial.begin(BAUDRATE);
+  while (!Serial)
+    {
+      ; /* wait for serial port to connect. Needed for native USB port only */
+    }
+
+  while (!theSD.begin())
+    {
+      /* wait until SD card is mounted. */
+      Serial.println("Insert SD card.");
+    }
+
+  /* Buffers for the frames waiting for the writer and one for the sensor. */
+
+  err = theCamera.begin(VIDEO_BUFF_NUM,
+                        CAM_VIDEO_FPS_120,
+                        CAM_IMGSIZE_QVGA_H,
+                        CAM_IMGSIZE_QVGA_V,
+                        CAM_IMAGE_PIX_FMT_JPG);
+  if (err != CAM_ERR_SUCCESS)
+    {
+      Serial.print("Camera begin error: ");
+      Serial.println(err);
+      return;
+    }
+
+  err = recorder.begin("HFR.MJPG", PREALLOC_SIZE, QUEUE_DEPTH);
+  if (err != CAM_ERR_SUCCESS)
+    {
+      Serial.print("Recorder begin error: ");
+      Serial.println(err);
+      return;
+    }
+
+  err = theCamera.startStreaming(true, CamCB);
+  if (err != CAM_ERR_SUCCESS)
+    {
+      Serial.print("Start streaming error: ");
+      Serial.println(err);
+      return;
+    }
+
+  Serial.println("Start recording");
+}
+
+/**
+ * @brief Show the statistics, and finalize at the end.
+ */
+
+void loop()
+{
+  if (!recorder.isRecording())
+    {
+      return;
+    }
+
+  if (frame_count >= FRAMES_NUM)
+    {
+      theCamera.startStreaming(false);
+
+      CamErr err = recorder.end();
+      Serial.print("Stop recording: ");
+      Serial.println(err == CAM_ERR_SUCCESS ? "OK" : "write error");
+      printStat();
+
+      theCamera.end();
+      return;
+    }
+
+  printStat();
+  sleep(1);
+}
@@ -0,0 +1,396 @@
+/*
+ *  image_proc_bench.ino - Benchmark of the software image processing
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Checks and measures the software fallback of CamImage on a synthetic
+ * VGA YUV422 frame, and compares it with a straightforward per-pixel
+ * float implementation of the same preprocessing.
+ *
+ * The sketch can also be built and run on a PC:
+ *   g++ -O2 -DCAMIMAGE_PROC_HOST -I../.. -x c++ image_proc_bench.ino \
+ *       -x none ../../CamImageProc.cpp -o image_proc_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <CamImageProc.h>
+
+#ifdef CAMIMAGE_PROC_HOST
+#include <time.h>
+
+static unsigned long micros()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long)(ts.tv_sec * 1000000UL + ts.tv_nsec / 1000);
+}
+#define PRINTF printf
+#else
+#include <Arduino.h>
+#define PRINTF printf
+#endif
+
+static const int SRC_W = 640;
+static const int SRC_H = 480;
+static const int DNN_W = 28;
+static const int DNN_H = 28;
+static const int LOOPS = 10;
+
+static uint8_t *src;
+static uint8_t *dst;
+static float   *tensor;
+static int      failed;
+
+static void check(bool ok, const char *what)
+{
+  if (!ok)
+    {
+      PRINTF("  NG: %s\n", what);
+      failed++;
+    }
+}
+
+/* Gradient with some texture in both Y and chroma */
+
+static void make_frame(uint8_t *p, int w, int h)
+{
+  for (int y = 0; y < h; y++)
+    {
+      for (int x = 0; x < w; x += 2)
+        {
+          *p++ = (uint8_t)(64 + (x * 128) / w);             /* U */
+          *p++ = (uint8_t)((x + y) & 0xff);                 /* Y0 */
+          *p++ = (uint8_t)(192 - (y * 128) / h);            /* V */
+          *p++ = (uint8_t)((x + 1 + y + ((x >> 4) & 7)) & 0xff); /* Y1 */
+        }
+    }
+}
+
+/* Per-pixel reference of the same preprocessing: gray conversion of
+ * the whole frame, then box average and normalization in float
+ */
+
+static void naive_preprocess(const uint8_t *img, int w, int h, int x0, int y0,
+                             int cw, int ch, float *out, int ow, int oh)
+{
+  float *gray = (float *)malloc(w * h * sizeof(float));
+  if (gray == NULL)
+    {
+      return;
+    }
+
+  for (int i = 0; i < w * h; i++)
+    {
+      gray[i] = img[i * 2 + 1];
+    }
+
+  for (int y = 0; y < oh; y++)
+    {
+      for (int x = 0; x < ow; x++)
+        {
+          int sx0 = x0 + x * cw / ow;
+          int sx1 = x0 + (x + 1) * cw / ow;
+          int sy0 = y0 + y * ch / oh;
+          int sy1 = y0 + (y + 1) * ch / oh;
+          float sum = 0.0f;
+          for (int sy = sy0; sy < sy1; sy++)
+            {
+              for (int sx = sx0; sx < sx1; sx++)
+                {
+                  sum += gray[sy * w + sx];
+                }
+            }
+          sum /= (float)((sx1 - sx0) * (sy1 - sy0));
+          out[y * ow + x] = (sum - 127.5f) / 127.5f;
+        }
+    }
+
+  free(gray);
+}
+
+static void bench(const char *name, int (*fn)(void))
+{
+  unsigned long start = micros();
+  int ret = 0;
+
+  for (int i = 0; i < LOOPS; i++)
+    {
+      ret |= fn();
+    }
+
+  unsigned long us = (micros() - start) / LOOPS;
+  PRINTF("%-36s %8lu us%s\n", name, us, ret ? "  (error)" : "");
+  check(ret == 0, name);
+}
+
+static int yuv_to_rgb565()
+{
+  return swimg_convert(src, SWIMG_FMT_YUV422, dst, SWIMG_FMT_RGB565, SRC_W, SRC_H);
+}
+
+static int yuv_to_rgb888()
+{
+  return swimg_convert(src, SWIMG_FMT_YUV422, dst, SWIMG_FMT_RGB888, SRC_W, SRC_H);
+}
+
+static int yuv_to_gray()
+{
+  return swimg_convert(src, SWIMG_FMT_YUV422, dst, SWIMG_FMT_GRAY, SRC_W, SRC_H);
+}
+
+static int resize_bilinear_300x225()
+{
+  return swimg_clip_and_resize(src, SRC_W, SRC_H, SWIMG_FMT_YUV422, NULL,
+                               dst, 300, 225, SWIMG_FMT_YUV422, SWIMG_RESIZE_BILINEAR);
+}
+
+static int resize_area_100x75()
+{
+  return swimg_clip_and_resize(src, SRC_W, SRC_H, SWIMG_FMT_YUV422, NULL,
+                               dst, 100, 75, SWIMG_FMT_YUV422, SWIMG_RESIZE_AREA);
+}
+
+static int resize_up_1000x750()
+{
+  return swimg_clip_and_resize(src, SRC_W, SRC_H, SWIMG_FMT_YUV422, NULL,
+                               dst, 1000, 750, SWIMG_FMT_RGB565, SWIMG_RESIZE_BILINEAR);
+}
+
+static int fused_dnn_input()
+{
+  swimg_rect_t rect = { 80, 0, 559, 479 };
+  float mean = 127.5f;
+  float scale = 1.0f / 127.5f;
+
+  return swimg_clip_resize_normalize(src, SRC_W, SRC_H, SWIMG_FMT_YUV422, &rect,
+                                     tensor, DNN_W, DNN_H, 1, &mean, &scale,
+                                     false, SWIMG_RESIZE_AUTO);
+}
+
+static int naive_dnn_input()
+{
+  naive_preprocess(src, SRC_W, SRC_H, 80, 0, 480, 480, tensor, DNN_W, DNN_H);
+  return 0;
+}
+
+static void verify()
+{
+  int w = 64;
+  int h = 48;
+  uint8_t *a = (uint8_t *)malloc(w * h * 3);
+  uint8_t *b = (uint8_t *)malloc(w * h * 3);
+  uint8_t *c = (uint8_t *)malloc(w * h * 3);
+
+  PRINTF("verify\n");
+
+  /* RGB888 -> YUV422 -> RGB888 keeps flat colors */
+
+  for (int i = 0; i < w * h; i++)
+    {
+      a[i * 3 + 0] = (uint8_t)(((i / 8) * 37) & 0xff);
+      a[i * 3 + 1] = (uint8_t)(((i / 8) * 91) & 0xff);
+      a[i * 3 + 2] = (uint8_t)(((i / 8) * 53) & 0xff);
+    }
+  check(swimg_convert(a, SWIMG_FMT_RGB888, b, SWIMG_FMT_YUV422, w, h) == 0, "rgb888 to yuv422");
+  check(swimg_convert(b, SWIMG_FMT_YUV422, c, SWIMG_FMT_RGB888, w, h) == 0, "yuv422 to rgb888");
+  int maxerr = 0;
+  for (int i = 0; i < w * h * 3; i++)
+    {
+      int e = abs(a[i] - c[i]);
+      maxerr = (e > maxerr) ? e : maxerr;
+    }
+  check(maxerr <= 3, "yuv round trip error");
+
+  /* In place conversion in both directions */
+
+  memcpy(c, b, w * h * 2);
+  check(swimg_convert(c, SWIMG_FMT_YUV422, c, SWIMG_FMT_RGB888, w, h) == 0, "in place grow");
+  check(swimg_convert(b, SWIMG_FMT_YUV422, a, SWIMG_FMT_RGB888, w, h) == 0, "out of place");
+  check(memcmp(a, c, w * h * 3) == 0, "in place grow result");
+  check(swimg_convert(c, SWIMG_FMT_RGB888, c, SWIMG_FMT_GRAY, w, h) == 0, "in place shrink");
+  check(swimg_convert(a, SWIMG_FMT_RGB888, b, SWIMG_FMT_GRAY, w, h) == 0, "out of place gray");
+  check(memcmp(b, c, w * h) == 0, "in place shrink result");
+
+  /* Same size resize is a copy, and a flat image stays flat */
+
+  for (int i = 0; i < w * h; i++)
+    {
+      a[i] = (uint8_t)(i * 7);
+    }
+  check(swimg_clip_and_resize(a, w, h, SWIMG_FMT_GRAY, NULL, b, w, h,
+                              SWIMG_FMT_GRAY, SWIMG_RESIZE_BILINEAR) == 0, "identity");
+  check(memcmp(a, b, w * h) == 0, "identity result");
+
+  memset(a, 77, w * h);
+  check(swimg_clip_and_resize(a, w, h, SWIMG_FMT_GRAY, NULL, b, 17, 13,
+                              SWIMG_FMT_GRAY, SWIMG_RESIZE_AREA) == 0, "flat area");
+  check(swimg_clip_and_resize(a, w, h, SWIMG_FMT_GRAY, NULL, c, 101, 77,
+                              SWIMG_FMT_GRAY, SWIMG_RESIZE_BILINEAR) == 0, "flat bilinear");
+  bool flat = true;
+  for (int i = 0; i < 17 * 13; i++) flat &= (b[i] == 77);
+  for (int i = 0; i < 101 * 77; i++) flat &= (c[i] == 77);
+  check(flat, "flat result");
+
+  /* 1/2 area resize is the average of 2x2 blocks */
+
+  for (int i = 0; i < w * h; i++)
+    {
+      a[i] = (uint8_t)((i * 13) & 0xff);
+    }
+  swimg_clip_and_resize(a, w, h, SWIMG_FMT_GRAY, NULL, b, w / 2, h / 2,
+                        SWIMG_FMT_GRAY, SWIMG_RESIZE_AUTO);
+  bool avg = true;
+  for (int y = 0; y < h / 2; y++)
+    {
+      for (int x = 0; x < w / 2; x++)
+        {
+          int s = a[(2 * y) * w + 2 * x] + a[(2 * y) * w + 2 * x + 1] +
+                  a[(2 * y + 1) * w + 2 * x] + a[(2 * y + 1) * w + 2 * x + 1];
+          avg &= (b[y * (w / 2) + x] == (s + 2) / 4);
+        }
+    }
+  check(avg, "area average");
+
+  /* Clip is applied before the resize */
+
+  swimg_rect_t rect = { 10, 5, 19, 14 };
+  check(swimg_clip_and_resize(a, w, h, SWIMG_FMT_GRAY, &rect, b, 10, 10,
+                              SWIMG_FMT_GRAY, SWIMG_RESIZE_BILINEAR) == 0, "clip");
+  bool clip = true;
+  for (int y = 0; y < 10; y++)
+    {
+      clip &= (memcmp(b + y * 10, a + (y + 5) * w + 10, 10) == 0);
+    }
+  check(clip, "clip result");
+
+  /* Normalize in CHW layout */
+
+  float mean[3] = { 10.0f, 20.0f, 30.0f };
+  float scale[3] = { 1.0f, 0.5f, 0.25f };
+  float out[3 * 4];
+  for (int i = 0; i < 4; i++)
+    {
+      a[i * 3 + 0] = 110;
+      a[i * 3 + 1] = 120;
+      a[i * 3 + 2] = 130;
+    }
+  check(swimg_clip_resize_normalize(a, 2, 2, SWIMG_FMT_RGB888, NULL, out, 2, 2, 3,
+                                    mean, scale, true, SWIMG_RESIZE_AUTO) == 0, "normalize");
+  check((out[0] == 100.0f) && (out[4] == 50.0f) && (out[8] == 25.0f), "normalize result");
+
+  /* Quantized int8 in BGR order: x = (v - 128) / 128 in q7 */
+
+  swimg_tensor_t tensor;
+  int8_t q[3 * 4];
+  memset(&tensor, 0, sizeof(tensor));
+  tensor.data = q;
+  tensor.type = SWIMG_TENSOR_INT8;
+  tensor.channels = 3;
+  tensor.bgr = true;
+  tensor.qscale = 128.0f;
+  for (int i = 0; i < 3; i++)
+    {
+      tensor.mean[i] = 128.0f;
+      tensor.scale[i] = 1.0f / 128.0f;
+    }
+  a[0] = 0;
+  a[1] = 128;
+  a[2] = 255;
+  check(swimg_clip_resize_to_tensor(a, 1, 1, SWIMG_FMT_RGB888, NULL, &tensor,
+                                    2, 2, SWIMG_RESIZE_AUTO) == 0, "int8 tensor");
+  check((q[0] == 127) && (q[1] == 0) && (q[2] == -128) && (q[9] == 127), "int8 result");
+
+  /* Parameter checks */
+
+  check(swimg_convert(a, SWIMG_FMT_RGB888, b, SWIMG_FMT_YUV422, 3, 2) < 0, "odd yuv width");
+  rect.x2 = w;
+  check(swimg_clip_and_resize(a, w, h, SWIMG_FMT_GRAY, &rect, b, 8, 8,
+                              SWIMG_FMT_GRAY, SWIMG_RESIZE_AUTO) < 0, "clip out of image");
+
+  free(a);
+  free(b);
+  free(c);
+}
+
+void setup()
+{
+#ifndef CAMIMAGE_PROC_HOST
+  Serial.begin(115200);
+  while (!Serial) {};
+#endif
+
+  src = (uint8_t *)malloc(SRC_W * SRC_H * 2);
+  dst = (uint8_t *)malloc(1000 * 750 * 3);
+  tensor = (float *)malloc(DNN_W * DNN_H * sizeof(float));
+  if (!src || !dst || !tensor)
+    {
+      PRINTF("no memory\n");
+      return;
+    }
+
+  verify();
+
+  make_frame(src, SRC_W, SRC_H);
+
+  PRINTF("%dx%d YUV422, average of %d runs\n", SRC_W, SRC_H, LOOPS);
+  bench("convert YUV422 -> RGB565", yuv_to_rgb565);
+  bench("convert YUV422 -> RGB888", yuv_to_rgb888);
+  bench("convert YUV422 -> GRAY", yuv_to_gray);
+  bench("resize bilinear -> 300x225", resize_bilinear_300x225);
+  bench("resize area -> 100x75", resize_area_100x75);
+  bench("resize bilinear -> 1000x750 RGB565", resize_up_1000x750);
+  bench("clip+resize+normalize -> 28x28", fused_dnn_input);
+  bench("per-pixel float loop -> 28x28", naive_dnn_input);
+
+  /* Both give the same tensor within the 8bit rounding */
+
+  float *ref = (float *)malloc(DNN_W * DNN_H * sizeof(float));
+  if (ref != NULL)
+    {
+      memcpy(ref, tensor, DNN_W * DNN_H * sizeof(float));
+      fused_dnn_input();
+      float maxdiff = 0.0f;
+      for (int i = 0; i < DNN_W * DNN_H; i++)
+        {
+          maxdiff = fmaxf(maxdiff, fabsf(ref[i] - tensor[i]));
+        }
+      check(maxdiff <= 1.0f / 127.5f, "fused result");
+      free(ref);
+    }
+
+  PRINTF("%s\n", failed ? "FAIL" : "PASS");
+}
+
+void loop()
+{
+#ifndef CAMIMAGE_PROC_HOST
+  sleep(1);
+#endif
+}
+
+#ifdef CAMIMAGE_PROC_HOST
+int main()
+{
+  setup();
+  return failed ? 1 : 0;
+}
+#endif
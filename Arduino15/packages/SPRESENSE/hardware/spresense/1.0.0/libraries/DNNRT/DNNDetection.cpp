@@ -0,0 +1,163 @@
+/*
+ *  DNNDetection.cpp - Post-processing of object detection networks
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file DNNDetection.cpp
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Post-processing of object detection networks
+ */
+
+#include <stdlib.h>
+
+#include <DNNDetection.h>
+
+int
+DNNDetection::decode(const float *data, int num, int stride,
+                     float score_threshold, DNNBox *boxes, int max_boxes)
+{
+  int coords = _objectness ? 5 : 4;
+  int classes = stride - coords;
+  int n = 0;
+
+  if (data == NULL || boxes == NULL || num < 0 || classes < 0)
+    {
+      return -1;
+    }
+
+  for (int i = 0; i < num && n < max_boxes; i++)
+    {
+      const float *row = data + i * stride;
+      const float *cls = row + coords;
+
+      // Best class. Without class scores, the objectness is the score.
+
+      float score = 1.0f;
+      int label = 0;
+      if (classes > 0)
+        {
+          score = cls[0];
+          for (int c = 1; c < classes; c++)
+            {
+              if (cls[c] > score)
+                {
+                  score = cls[c];
+                  label = c;
+                }
+            }
+        }
+      if (_objectness)
+        {
+          score *= row[4];
+        }
+
+      if (score < score_threshold)
+        {
+          continue;
+        }
+
+      DNNBox *b = &boxes[n++];
+      if (_format == DNN_BOX_CENTER)
+        {
+          float hw = row[2] * 0.5f;
+          float hh = row[3] * 0.5f;
+          b->x1 = (row[0] - hw) * _scale_x;
+          b->y1 = (row[1] - hh) * _scale_y;
+          b->x2 = (row[0] + hw) * _scale_x;
+          b->y2 = (row[1] + hh) * _scale_y;
+        }
+      else
+        {
+          b->x1 = row[0] * _scale_x;
+          b->y1 = row[1] * _scale_y;
+          b->x2 = row[2] * _scale_x;
+          b->y2 = row[3] * _scale_y;
+        }
+      b->score = score;
+      b->label = label;
+    }
+
+  return n;
+}
+
+static int
+compare_score(const void *a, const void *b)
+{
+  float sa = ((const DNNBox *)a)->score;
+  float sb = ((const DNNBox *)b)->score;
+
+  return (sa < sb) ? 1 : ((sa > sb) ? -1 : 0);
+}
+
+static float
+box_iou(const DNNBox *a, const DNNBox *b)
+{
+  float w = ((a->x2 < b->x2) ? a->x2 : b->x2) - ((a->x1 > b->x1) ? a->x1 : b->x1);
+  float h = ((a->y2 < b->y2) ? a->y2 : b->y2) - ((a->y1 > b->y1) ? a->y1 : b->y1);
+
+  if (w <= 0.0f || h <= 0.0f)
+    {
+      return 0.0f;
+    }
+
+  float inter = w * h;
+  float area_a = (a->x2 - a->x1) * (a->y2 - a->y1);
+  float area_b = (b->x2 - b->x1) * (b->y2 - b->y1);
+
+  return inter / (area_a + area_b - inter);
+}
+
+int
+DNNDetection::nms(DNNBox *boxes, int num, float iou_threshold, bool class_aware)
+{
+  int kept = 0;
+
+  if (boxes == NULL || num < 0)
+    {
+      return -1;
+    }
+
+  qsort(boxes, num, sizeof(DNNBox), compare_score);
+
+  // A box is compared only with the kept ones, which are better than it.
+
+  for (int i = 0; i < num; i++)
+    {
+      bool keep = true;
+
+      for (int j = 0; j < kept; j++)
+        {
+          if (class_aware && boxes[j].label != boxes[i].label)
+            {
+              continue;
+            }
+          if (box_iou(&boxes[j], &boxes[i]) > iou_threshold)
+            {
+              keep = false;
+              break;
+            }
+        }
+
+      if (keep)
+        {
+          boxes[kept++] = boxes[i];
+        }
+    }
+
+  return kept;
+}
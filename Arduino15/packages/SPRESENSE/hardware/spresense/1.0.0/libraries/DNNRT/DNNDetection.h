@@ -0,0 +1,129 @@
+/*
+ *  DNNDetection.h - Post-processing of object detection networks
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef DNNDetection_h
+#define DNNDetection_h
+
+/**
+ * @file DNNDetection.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Post-processing of object detection networks
+ *
+ * @details Decodes the boxes from a network output and removes the
+ *          overlapped ones by non-maximum suppression.
+ */
+
+/**
+ * @ingroup dnnrt
+ * Detected box
+ */
+typedef struct {
+  float x1;     /**< Left */
+  float y1;     /**< Top */
+  float x2;     /**< Right */
+  float y2;     /**< Bottom */
+  float score;  /**< Confidence */
+  int   label;  /**< Class index */
+} DNNBox;
+
+/**
+ * @ingroup dnnrt
+ * Box coordinate format in the network output
+ */
+enum DNN_BOX_FORMAT {
+  DNN_BOX_CENTER, /**< Center x, center y, width, height */
+  DNN_BOX_CORNER, /**< Left, top, right, bottom */
+};
+
+/**
+ * @ingroup dnnrt
+ *
+ * Box decoding and non-maximum suppression
+ *
+ * The network output is num rows of stride elements. Each row is 4 box
+ * coordinates, an objectness score if it exists, and the class scores.
+ * The score of a box is the best class score, multiplied by the objectness.
+ */
+class DNNDetection {
+
+public:
+  DNNDetection() : _format(DNN_BOX_CENTER), _objectness(false),
+                   _scale_x(1.0f), _scale_y(1.0f) {};
+
+  /**
+   * Set layout of the network output
+   *
+   * @param [in] format     Box coordinate format
+   * @param [in] objectness true if each row has an objectness score
+   */
+  void setFormat(DNN_BOX_FORMAT format, bool objectness = false)
+  {
+    _format = format;
+    _objectness = objectness;
+  }
+
+  /**
+   * Set scale of the coordinates
+   *
+   * For example, set the image size for the normalized coordinates.
+   */
+  void setScale(float scale_x, float scale_y)
+  {
+    _scale_x = scale_x;
+    _scale_y = scale_y;
+  }
+
+  /**
+   * Decode boxes
+   *
+   * @param [in]  data            Network output
+   * @param [in]  num             Number of rows
+   * @param [in]  stride          Elements of a row
+   * @param [in]  score_threshold Boxes with lower score are skipped
+   * @param [out] boxes           Decoded boxes
+   * @param [in]  max_boxes       Size of boxes
+   * @return Number of boxes, or negative value on error.
+   */
+  int decode(const float *data, int num, int stride, float score_threshold,
+             DNNBox *boxes, int max_boxes);
+
+  /**
+   * Non-maximum suppression
+   *
+   * Boxes are sorted by score, and a box overlapping a better one of the
+   * same label more than iou_threshold is removed. The remaining boxes are
+   * packed at the beginning of the array.
+   *
+   * @param [in,out] boxes         Boxes
+   * @param [in]     num           Number of boxes
+   * @param [in]     iou_threshold Intersection over union to remove
+   * @param [in]     class_aware   false to suppress boxes of any label
+   * @return Number of remaining boxes, or negative value on error.
+   */
+  static int nms(DNNBox *boxes, int num, float iou_threshold,
+                 bool class_aware = true);
+
+private:
+  DNN_BOX_FORMAT _format;
+  bool           _objectness;
+  float          _scale_x;
+  float          _scale_y;
+};
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ *  DNNPreprocess.h - Camera image to DNN input conversion
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef DNNPreprocess_h
+#define DNNPreprocess_h
+
+/**
+ * @file DNNPreprocess.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Camera image to DNN input conversion
+ *
+ * @details Writes the network input straight from a CamImage. Clipping,
+ *          resizing, color conversion and normalization are done in one
+ *          pass over the image, so no intermediate image is made.
+ *          This header uses the Camera library, so include it only when
+ *          the camera is used.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <Camera.h>
+#include <CamImageProc.h>
+#include <DNNRT.h>
+
+/**
+ * @ingroup dnnrt
+ *
+ * Preprocessing from a camera image to a network input
+ *
+ * For each output channel c, the value is
+ * (pixel - mean[c]) * scale[c], where pixel is 0 to 255.
+ * The default is pixel / 255 in CHW layout, which is what the models of
+ * Neural Network Console expect.
+ */
+class DNNPreprocess {
+
+public:
+  DNNPreprocess() : _method(CAM_RESIZE_AUTO), _roi(false)
+  {
+    memset(&_tensor, 0, sizeof(_tensor));
+    begin(0, 0);
+  }
+
+  /**
+   * Set output shape
+   *
+   * @param [in] width    Width of the network input
+   * @param [in] height   Height of the network input
+   * @param [in] channels 1 for gray scale, 3 for color
+   * @param [in] planar   true for CHW layout, false for HWC layout
+   * @return 0 on success, otherwise error.
+   */
+  int begin(int width, int height, int channels = 1, bool planar = true)
+  {
+    if ((width < 0) || (height < 0) || ((channels != 1) && (channels != 3)))
+      {
+        return -EINVAL;
+      }
+
+    _width = width;
+    _height = height;
+    _tensor.channels = channels;
+    _tensor.planar = planar;
+    _tensor.bgr = false;
+    _tensor.qscale = 1.0f;
+    _tensor.zero_point = 0;
+    setNormalize(0.0f, 1.0f / 255.0f);
+    clearROI();
+
+    return 0;
+  }
+
+  /**
+   * Set the normalization of all channels
+   *
+   * @param [in] mean  Value subtracted from the pixel (0 to 255)
+   * @param [in] scale Factor multiplied after the subtraction
+   */
+  void setNormalize(float mean, float scale)
+  {
+    for (int c = 0; c < 3; c++)
+      {
+        _tensor.mean[c] = mean;
+        _tensor.scale[c] = scale;
+      }
+  }
+
+  /**
+   * Set the normalization of each channel
+   *
+   * @param [in] mean  Values subtracted from the pixel, in output channel order
+   * @param [in] scale Factors multiplied after the subtraction
+   */
+  void setNormalize(const float mean[3], const float scale[3])
+  {
+    for (int c = 0; c < 3; c++)
+      {
+        _tensor.mean[c] = mean[c];
+        _tensor.scale[c] = scale[c];
+      }
+  }
+
+  /**
+   * Set color channel order
+   *
+   * @param [in] bgr true for B, G, R order, false for R, G, B order
+   */
+  void setChannelOrder(bool bgr)
+  {
+    _tensor.bgr = bgr;
+  }
+
+  /**
+   * Set quantization of the integer outputs
+   *
+   * The integer value is round(value * qscale) + zero_point with
+   * saturation. For a q7 input with n fractional bits, use 2^n and 0.
+   *
+   * @param [in] qscale     Quantization scale
+   * @param [in] zero_point Quantization offset
+   */
+  void setQuantization(float qscale, int zero_point = 0)
+  {
+    _tensor.qscale = qscale;
+    _tensor.zero_point = zero_point;
+  }
+
+  /**
+   * Set the region of the image used as input
+   *
+   * Both corners are included. The region is resized to the output shape.
+   *
+   * @return 0 on success, otherwise error.
+   */
+  int setROI(int lefttop_x, int lefttop_y, int rightbottom_x, int rightbottom_y)
+  {
+    if ((lefttop_x < 0) || (lefttop_y < 0) ||
+        (rightbottom_x < lefttop_x) || (rightbottom_y < lefttop_y))
+      {
+        return -EINVAL;
+      }
+
+    _rect.x1 = lefttop_x;
+    _rect.y1 = lefttop_y;
+    _rect.x2 = rightbottom_x;
+    _rect.y2 = rightbottom_y;
+    _roi = true;
+
+    return 0;
+  }
+
+  /**
+   * Use the whole image as input
+   */
+  void clearROI()
+  {
+    _roi = false;
+  }
+
+  /**
+   * Set resize method
+   *
+   * @param [in] method #CAM_RESIZE_BILINEAR or #CAM_RESIZE_AREA.
+   *                    #CAM_RESIZE_AUTO selects area averaging for 1/2 or smaller.
+   */
+  void setResizeMethod(CAM_RESIZE_METHOD method)
+  {
+    _method = method;
+  }
+
+  /**
+   * Number of output elements
+   */
+  int size()
+  {
+    return _width * _height * _tensor.channels;
+  }
+
+  /**
+   * Convert the image into a DNNVariable
+   *
+   * @param [in]  img Camera image (YUV422, RGB565, GRAY or RGB888)
+   * @param [out] var Network input. It must have size() elements or more.
+   * @return 0 on success, otherwise error.
+   */
+  int run(CamImage &img, DNNVariable &var)
+  {
+    if (var.size() < (unsigned int)size())
+      {
+        return -EINVAL;
+      }
+
+    return run(img, var.data(), SWIMG_TENSOR_FLOAT32);
+  }
+
+  /**
+   * Convert the image into a float buffer of size() elements
+   *
+   * @return 0 on success, otherwise error.
+   */
+  int run(CamImage &img, float *buf)
+  {
+    return run(img, buf, SWIMG_TENSOR_FLOAT32);
+  }
+
+  /**
+   * Convert the image into a quantized int8 (q7) buffer of size() elements
+   *
+   * @return 0 on success, otherwise error.
+   */
+  int run(CamImage &img, int8_t *buf)
+  {
+    return run(img, buf, SWIMG_TENSOR_INT8);
+  }
+
+  /**
+   * Convert the image into a quantized uint8 buffer of size() elements
+   *
+   * @return 0 on success, otherwise error.
+   */
+  int run(CamImage &img, uint8_t *buf)
+  {
+    return run(img, buf, SWIMG_TENSOR_UINT8);
+  }
+
+private:
+  int run(CamImage &img, void *buf, SWIMG_TENSOR_TYPE type)
+  {
+    SWIMG_FMT fmt;
+
+    switch (img.getPixFormat())
+      {
+        case CAM_IMAGE_PIX_FMT_YUV422:
+          fmt = SWIMG_FMT_YUV422;
+          break;
+        case CAM_IMAGE_PIX_FMT_RGB565:
+          fmt = SWIMG_FMT_RGB565;
+          break;
+        case CAM_IMAGE_PIX_FMT_GRAY:
+          fmt = SWIMG_FMT_GRAY;
+          break;
+        case CAM_IMAGE_PIX_FMT_RGB888:
+          fmt = SWIMG_FMT_RGB888;
+          break;
+        default:
+          return -EINVAL;
+      }
+
+    if ((buf == NULL) || (size() == 0) || (img.getImgBuff() == NULL))
+      {
+        return -EINVAL;
+      }
+
+    _tensor.data = buf;
+    _tensor.type = type;
+
+    int ret = swimg_clip_resize_to_tensor(img.getImgBuff(), img.getWidth(), img.getHeight(),
+                                          fmt, _roi ? &_rect : NULL, &_tensor,
+                                          _width, _height, (SWIMG_RESIZE)_method);
+    _tensor.data = NULL;
+    return ret;
+  }
+
+  swimg_tensor_t    _tensor;
+  swimg_rect_t      _rect;
+  CAM_RESIZE_METHOD _method;
+  bool              _roi;
+  int               _width;
+  int               _height;
+};
+
+#endif
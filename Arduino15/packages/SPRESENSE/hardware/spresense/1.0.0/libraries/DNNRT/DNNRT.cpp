@@ -31,7 +31,11 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <errno.h>
+#include <math.h>
+#include <malloc.h>
+#include <string.h>
 
 #include <dnnrt/runtime.h>
 
@@ -39,12 +43,82 @@
 #include <DNNRT.h>
 #include <File.h>
 
+// The DNN runtime is shared by all of the DNNRT objects.
+
+static int dnn_users = 0;
+
+static int
+dnn_acquire(unsigned char cpu_num)
+{
+  dnn_config_t config;
+  int ret;
+
+  if (dnn_users == 0)
+    {
+      config.cpu_num = cpu_num;
+
+      ret = dnn_initialize(&config);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  dnn_users++;
+  return 0;
+}
+
+static void
+dnn_release(void)
+{
+  if (dnn_users > 0)
+    {
+      dnn_users--;
+      if (dnn_users == 0)
+        {
+          dnn_finalize();
+        }
+    }
+}
+
+#define DNNRT_WORKER_STACK_SIZE 2048
+#define DNNRT_WORKER_PRIO       100
+
+DNNRT::DNNRT() :
+  _rt(NULL),
+  _network(NULL),
+  _network_allocated(false),
+  _input(NULL),
+  _nr_inputs(0),
+  _output(NULL),
+  _nr_outputs(0),
+  _worker_running(false),
+  _busy(false),
+  _result(0),
+  _callback(NULL),
+  _callback_arg(NULL)
+{
+  sem_init(&_request, 0, 0);
+  sem_init(&_done, 0, 0);
+  memset(&_profile, 0, sizeof(_profile));
+  _total_us = 0;
+}
+
+DNNRT::~DNNRT()
+{
+  // Stop the thread of forwardAsync() before the object goes away.
+
+  end();
+  sem_destroy(&_request);
+  sem_destroy(&_done);
+}
+
 int
 DNNRT::begin(File& nnbfile, unsigned char cpu_num)
 {
   int ret;
   size_t size;
-  dnn_config_t config;
+  nn_network_t *network;
 
   // Specify the number of CPUs to be used by DNN runtime
 
@@ -53,51 +127,88 @@ DNNRT::begin(File& nnbfile, unsigned char cpu_num)
       return -EINVAL;
     }
 
-  config.cpu_num = cpu_num;
+  // Read whole data from network file
+
+  size = nnbfile.size();
+  network = (nn_network_t *)malloc(size);
+  if (!network)
+    {
+      return -1;
+    }
 
-  ret = dnn_initialize(&config);
+  ret = nnbfile.read(network, size);
   if (ret < 0)
     {
-      return ret;
+      free(network);
+      return -1;
     }
 
-  // Read whole data from network file
+  return setup(network, true, cpu_num);
+}
 
-  size = nnbfile.size();
-  _network = (nn_network_t *)malloc(size);
-  if (!_network)
+int
+DNNRT::begin(const void *network, unsigned char cpu_num)
+{
+  if ((cpu_num < 1) || (cpu_num > 5))
     {
-      return -1;
+      return -EINVAL;
+    }
+
+  if ((network == NULL) || ((uintptr_t)network & 3))
+    {
+      return -EINVAL;
     }
 
-  ret = nnbfile.read(_network, size);
+  // The runtime only reads the network data, so use it in place.
+
+  return setup((nn_network_t *)network, false, cpu_num);
+}
+
+int
+DNNRT::setup(nn_network_t *network, bool allocated, unsigned char cpu_num)
+{
+  int ret;
+
+  _network = network;
+  _network_allocated = allocated;
+
+  ret = dnn_acquire(cpu_num);
   if (ret < 0)
     {
-      free(_network);
-      _network = NULL;
-      return -1;
+      release();
+      return ret;
     }
 
   _rt = (dnn_runtime_t *)malloc(sizeof(dnn_runtime_t));
   if (!_rt)
     {
-      free(_network);
-      _network = NULL;
+      release();
+      dnn_release();
       return -1;
     }
 
+  // The runtime allocates the intermediate buffers here.
+
+  memset(&_profile, 0, sizeof(_profile));
+  _total_us = 0;
+  struct mallinfo before = mallinfo();
+
   ret = dnn_runtime_initialize(_rt, _network);
   if (ret < 0)
     {
-      free(_network);
       free(_rt);
-
-      _network = NULL;
       _rt = NULL;
-
+      release();
+      dnn_release();
       return -2;
     }
 
+  struct mallinfo after = mallinfo();
+  if (after.uordblks > before.uordblks)
+    {
+      _profile.memory = after.uordblks - before.uordblks;
+    }
+
   // Get number of input/output data defined by network model.
 
   _nr_inputs = dnn_runtime_input_num(_rt);
@@ -105,12 +216,8 @@ DNNRT::begin(File& nnbfile, unsigned char cpu_num)
 
   if (_nr_inputs <= 0 || _nr_outputs <= 0)
     {
-      free(_network);
-      free(_rt);
-
-      _network = NULL;
-      _rt = NULL;
-
+      release();
+      dnn_release();
       return -3;
     }
 
@@ -122,29 +229,50 @@ DNNRT::begin(File& nnbfile, unsigned char cpu_num)
   return 0;
 }
 
-int
-DNNRT::end()
+void
+DNNRT::release()
 {
-  dnn_runtime_finalize(_rt);
-  dnn_finalize();
+  stopWorker();
 
-  if (_network)
-    {
-      free(_network);
-    }
   if (_rt)
     {
+      dnn_runtime_finalize(_rt);
       free(_rt);
+      _rt = NULL;
+    }
+  if (_network && _network_allocated)
+    {
+      free(_network);
     }
+  _network = NULL;
+  _network_allocated = false;
+
   if (_input)
     {
       free(_input);
+      _input = NULL;
     }
   if (_output)
     {
       delete[] _output;
+      _output = NULL;
+    }
+
+  _nr_inputs = 0;
+  _nr_outputs = 0;
+}
+
+int
+DNNRT::end()
+{
+  if (!_rt)
+    {
+      return 0;
     }
 
+  release();
+  dnn_release();
+
   return 0;
 }
 
@@ -170,12 +298,45 @@ DNNRT::outputVariable(unsigned int index)
 int
 DNNRT::forward(void)
 {
+  if (_busy)
+    {
+      return -EBUSY;
+    }
+
+  return run();
+}
+
+int
+DNNRT::run(void)
+{
+  if (!_rt)
+    {
+      return -EPERM;
+    }
+
+  unsigned long start = micros();
+
   int ret = dnn_runtime_forward(_rt, (const void **)_input, _nr_inputs);
   if (ret < 0)
     {
       return ret;
     }
 
+  unsigned long us = micros() - start;
+
+  _profile.count++;
+  _profile.last_us = us;
+  if ((_profile.count == 1) || (us < _profile.min_us))
+    {
+      _profile.min_us = us;
+    }
+  if (us > _profile.max_us)
+    {
+      _profile.max_us = us;
+    }
+  _total_us += us;
+  _profile.avg_us = (unsigned long)(_total_us / _profile.count);
+
   for (int i = 0; i < _nr_outputs; i++)
     {
       _output[i]._data = (float *)dnn_runtime_output_buffer(_rt, i);
@@ -185,6 +346,195 @@ DNNRT::forward(void)
   return ret;
 }
 
+void *
+DNNRT::worker(void *arg)
+{
+  DNNRT *dnn = (DNNRT *)arg;
+
+  while (1)
+    {
+      sem_wait(&dnn->_request);
+      if (!dnn->_worker_running)
+        {
+          break;
+        }
+
+      int ret = dnn->run();
+      dnn->_result = ret;
+
+      // Output data is valid in the callback.
+
+      if (dnn->_callback)
+        {
+          dnn->_callback(*dnn, ret, dnn->_callback_arg);
+        }
+
+      dnn->_busy = false;
+      sem_post(&dnn->_done);
+    }
+
+  return NULL;
+}
+
+int
+DNNRT::forwardAsync(dnnrt_callback_t callback, void *arg)
+{
+  if (!_rt)
+    {
+      return -EPERM;
+    }
+
+  if (_busy)
+    {
+      return -EBUSY;
+    }
+
+  // The thread is created at the first use, and kept until end().
+
+  if (!_worker_running)
+    {
+      pthread_attr_t attr;
+      struct sched_param param;
+
+      pthread_attr_init(&attr);
+      pthread_attr_setstacksize(&attr, DNNRT_WORKER_STACK_SIZE);
+      param.sched_priority = DNNRT_WORKER_PRIO;
+      pthread_attr_setschedparam(&attr, &param);
+
+      _worker_running = true;
+      if (pthread_create(&_worker, &attr, DNNRT::worker, this) != 0)
+        {
+          _worker_running = false;
+          return -EAGAIN;
+        }
+      pthread_setname_np(_worker, "dnnrt_worker");
+    }
+
+  // Forget the completion which nobody waited for.
+
+  while (sem_trywait(&_done) == 0);
+
+  _callback = callback;
+  _callback_arg = arg;
+  _busy = true;
+  sem_post(&_request);
+
+  return 0;
+}
+
+bool
+DNNRT::isBusy()
+{
+  return _busy;
+}
+
+int
+DNNRT::wait()
+{
+  while (_busy)
+    {
+      sem_wait(&_done);
+    }
+
+  return _result;
+}
+
+void
+DNNRT::stopWorker()
+{
+  if (_worker_running)
+    {
+      wait();
+      _worker_running = false;
+      sem_post(&_request);
+      pthread_join(_worker, NULL);
+    }
+}
+
+int
+DNNRT::forwardBatch(DNNVariable *inputs, int num,
+                    dnnrt_batch_callback_t callback, void *arg)
+{
+  void **saved;
+  int n;
+  int ret = 0;
+
+  if ((inputs == NULL) || (num <= 0) || (callback == NULL))
+    {
+      return -EINVAL;
+    }
+
+  if (!_rt)
+    {
+      return -EPERM;
+    }
+
+  if (_busy)
+    {
+      return -EBUSY;
+    }
+
+  // The inputs given by inputVariable() are restored at the end.
+
+  saved = (void **)malloc(sizeof(void *) * _nr_inputs);
+  if (!saved)
+    {
+      return -ENOMEM;
+    }
+  memcpy(saved, _input, sizeof(void *) * _nr_inputs);
+
+  // Same runtime and output buffers for all of the data.
+
+  for (n = 0; n < num; n++)
+    {
+      for (int i = 0; i < _nr_inputs; i++)
+        {
+          _input[i] = inputs[n * _nr_inputs + i].data();
+        }
+
+      ret = run();
+      if (ret < 0)
+        {
+          break;
+        }
+
+      callback(*this, n, arg);
+    }
+
+  memcpy(_input, saved, sizeof(void *) * _nr_inputs);
+  free(saved);
+
+  return ((ret < 0) && (n == 0)) ? ret : n;
+}
+
+int
+DNNRT::getProfile(DNNProfile *profile)
+{
+  if (profile == NULL)
+    {
+      return -EINVAL;
+    }
+
+  *profile = _profile;
+  return 0;
+}
+
+void
+DNNRT::clearProfile()
+{
+  size_t memory = _profile.memory;
+
+  memset(&_profile, 0, sizeof(_profile));
+  _total_us = 0;
+
+  // Memory of the runtime does not change until end().
+
+  if (_rt)
+    {
+      _profile.memory = memory;
+    }
+}
+
 int
 DNNRT::numOfInput(void)
 {
@@ -276,16 +626,17 @@ DNNVariable::~DNNVariable()
 int
 DNNVariable::maxIndex()
 {
-  float max = __FLT_MIN__;
-  int index;
-
-  if (_data == NULL)
+  if (_data == NULL || _size == 0)
     {
       return -1;
     }
 
-  index = -1;
-  for (int i = 0; i < (int)_size; i++)
+  // Start from the first element, so that all negative data works.
+
+  float max = _data[0];
+  int index = 0;
+
+  for (int i = 1; i < (int)_size; i++)
     {
       if (max < _data[i])
         {
@@ -295,3 +646,182 @@ DNNVariable::maxIndex()
     }
   return index;
 }
+
+int
+DNNVariable::topK(int k, int *index, float *value)
+{
+  int n = 0;
+
+  if (_data == NULL || index == NULL || value == NULL || k <= 0)
+    {
+      return -1;
+    }
+
+  if (k > (int)_size)
+    {
+      k = _size;
+    }
+
+  // Keep k candidates in descending order. Most elements are smaller than
+  // the last candidate, so the loop is almost only one comparison.
+
+  float *val = value;
+
+  for (int i = 0; i < (int)_size; i++)
+    {
+      float v = _data[i];
+      if (n == k && !(v > val[k - 1]))
+        {
+          continue;
+        }
+
+      int j = (n < k) ? n++ : k - 1;
+      while (j > 0 && val[j - 1] < v)
+        {
+          val[j] = val[j - 1];
+          index[j] = index[j - 1];
+          j--;
+        }
+      val[j] = v;
+      index[j] = i;
+    }
+
+  return n;
+}
+
+// Split shape at axis into outer * len * inner.
+
+static int
+split_axis(const int *shape, int ndim, int axis, unsigned int size,
+           int *outer, int *len, int *inner)
+{
+  if (shape == NULL || axis < 0 || axis >= ndim)
+    {
+      return -1;
+    }
+
+  unsigned int total = 1;
+  *outer = 1;
+  *inner = 1;
+  for (int i = 0; i < ndim; i++)
+    {
+      if (shape[i] <= 0)
+        {
+          return -1;
+        }
+      if (i < axis)
+        {
+          *outer *= shape[i];
+        }
+      else if (i > axis)
+        {
+          *inner *= shape[i];
+        }
+      total *= shape[i];
+    }
+  *len = shape[axis];
+
+  return (total <= size) ? 0 : -1;
+}
+
+// Softmax of len elements at the interval of stride.
+
+static void
+softmax_strided(float *p, int len, int stride)
+{
+  float max = p[0];
+  for (int i = 1; i < len; i++)
+    {
+      float v = p[i * stride];
+      max = (v > max) ? v : max;
+    }
+
+  float sum = 0.0f;
+  for (int i = 0; i < len; i++)
+    {
+      float e = expf(p[i * stride] - max);
+      p[i * stride] = e;
+      sum += e;
+    }
+
+  float inv = 1.0f / sum;
+  for (int i = 0; i < len; i++)
+    {
+      p[i * stride] *= inv;
+    }
+}
+
+int
+DNNVariable::softmax()
+{
+  if (_data == NULL || _size == 0)
+    {
+      return -1;
+    }
+
+  softmax_strided(_data, _size, 1);
+  return 0;
+}
+
+int
+DNNVariable::softmax(const int *shape, int ndim, int axis)
+{
+  int outer, len, inner;
+
+  if (_data == NULL ||
+      split_axis(shape, ndim, axis, _size, &outer, &len, &inner) < 0)
+    {
+      return -1;
+    }
+
+  for (int o = 0; o < outer; o++)
+    {
+      float *p = _data + o * len * inner;
+      for (int i = 0; i < inner; i++)
+        {
+          softmax_strided(p + i, len, inner);
+        }
+    }
+
+  return 0;
+}
+
+int
+DNNVariable::argmax(const int *shape, int ndim, int axis, int *result)
+{
+  int outer, len, inner;
+
+  if (_data == NULL || result == NULL ||
+      split_axis(shape, ndim, axis, _size, &outer, &len, &inner) < 0)
+    {
+      return -1;
+    }
+
+  // Walk the data in memory order. For the inner axes, compare whole rows
+  // of inner elements, which is contiguous and easy to vectorize.
+
+  for (int o = 0; o < outer; o++)
+    {
+      const float *p = _data + o * len * inner;
+      int *r = result + o * inner;
+
+      for (int i = 0; i < inner; i++)
+        {
+          r[i] = 0;
+        }
+
+      for (int l = 1; l < len; l++)
+        {
+          const float *row = p + l * inner;
+          for (int i = 0; i < inner; i++)
+            {
+              if (row[i] > p[r[i] * inner + i])
+                {
+                  r[i] = l;
+                }
+            }
+        }
+    }
+
+  return 0;
+}
@@ -31,12 +31,46 @@
  */
 
 #include <Arduino.h>
+#include <pthread.h>
+#include <semaphore.h>
 
 #include <dnnrt/runtime.h>
 
 class DNNVariable; // forward reference
+class DNNRT;
 class File;
 
+/**
+ * Completion callback of DNNRT::forwardAsync()
+ *
+ * @param rt     Runtime object which has finished
+ * @param result Return value of the forward propagation
+ * @param arg    Argument given to DNNRT::forwardAsync()
+ */
+typedef void (*dnnrt_callback_t)(DNNRT &rt, int result, void *arg);
+
+/**
+ * Callback of DNNRT::forwardBatch() for each input
+ *
+ * @param rt    Runtime object. outputVariable() has the result of the input.
+ * @param n     Index of the input in the batch
+ * @param arg   Argument given to DNNRT::forwardBatch()
+ */
+typedef void (*dnnrt_batch_callback_t)(DNNRT &rt, int n, void *arg);
+
+/**
+ * Profile of the forward propagation
+ */
+typedef struct {
+  unsigned long count;    /**< Number of forward propagations */
+  unsigned long last_us;  /**< Time of the last one in microseconds */
+  unsigned long min_us;   /**< Shortest time in microseconds */
+  unsigned long max_us;   /**< Longest time in microseconds */
+  unsigned long avg_us;   /**< Average time in microseconds */
+  size_t        memory;   /**< Heap used by the runtime for the network, including the
+                               intermediate buffers, in bytes */
+} DNNProfile;
+
 /**
  * @file DNNRT.h
  * @author Sony Semiconductor Solutions Corporation
@@ -50,8 +84,8 @@ class File;
 class DNNRT {
 
 public:
-  DNNRT() {};
-  ~DNNRT() {};
+  DNNRT();
+  ~DNNRT();
 
   /**
    * Initialize runtime object from .nnb file
@@ -74,6 +108,24 @@ public:
    */  
   int begin(File &nnbfile, unsigned char cpu_num = 1);
 
+  /**
+   * Initialize runtime object from network model data in memory
+   *
+   * The data is used in place without copy, so it must be kept until end().
+   * It can be a const array of the .nnb file built into the sketch, or a
+   * buffer which the application has loaded in advance.
+   *
+   * Several DNNRT objects can be initialized at the same time, and each of
+   * them keeps its network resident, so the networks can be switched without
+   * loading again. The DNN runtime is shared by them, and the cpu_num of the
+   * first begin() is used until all of them are finalized.
+   *
+   * @param network nnb network model data, aligned to 4 bytes
+   * @param cpu_num the number of CPUs to be used by DNN runtime (default 1)
+   * @return 0 on success, otherwise error. Same as begin(File&).
+   */
+  int begin(const void *network, unsigned char cpu_num = 1);
+
   /**
    * Finalize runtime object
    *
@@ -107,6 +159,69 @@ public:
    */
   int forward();
 
+  /**
+   * Start forward propagation in background
+   *
+   * The forward propagation runs in a thread of this object, so the caller
+   * can do other work, e.g. capture the next frame, in the meantime. The
+   * input data must be kept until the completion. The callback is called
+   * from the thread, and the output data is valid in it. Don't start the
+   * next one from the callback.
+   *
+   * @param [in] callback Completion callback, or NULL to use wait()
+   * @param [in] arg      Argument of the callback
+   * @return 0 on success, otherwise error.
+   * @retval -16(-EBUSY) the previous one is running
+   */
+  int forwardAsync(dnnrt_callback_t callback = NULL, void *arg = NULL);
+
+  /**
+   * Check forward propagation in background
+   *
+   * @return true while running
+   */
+  bool isBusy();
+
+  /**
+   * Wait for forward propagation in background
+   *
+   * @return Result of the forward propagation
+   */
+  int wait();
+
+  /**
+   * Execute forward propagation for several inputs
+   *
+   * The inputs are processed one by one with the same runtime and output
+   * buffers. After each of them, the callback is called with the output data.
+   * The inputs set by inputVariable() are kept for the next forward().
+   *
+   * @param [in] inputs   num * numOfInput() variables. inputs[n * numOfInput() + i]
+   *                      is the input i of the n-th data.
+   * @param [in] num      Number of data
+   * @param [in] callback Called for each data
+   * @param [in] arg      Argument of the callback
+   * @return Number of processed data, or error if none is processed.
+   */
+  int forwardBatch(DNNVariable *inputs, int num,
+                   dnnrt_batch_callback_t callback, void *arg = NULL);
+
+  /**
+   * Get profile of the forward propagation
+   *
+   * The DNN runtime does not tell the time of each layer, so compare the
+   * total time with the different cpu_num of begin() to tune it.
+   *
+   * @param [out] profile Profile
+   * @return 0 on success, otherwise error.
+   */
+  int getProfile(DNNProfile *profile);
+
+  /**
+   * Clear profile of the forward propagation
+   */
+  void clearProfile();
+
   /**
    * Get number of network inputs
    *
@@ -172,13 +287,32 @@ public:
   int outputShapeSize(unsigned int index, unsigned int shapeindex);
 
 private:
+  int setup(nn_network_t *network, bool allocated, unsigned char cpu_num);
+  void release();
+  int run();
+  void stopWorker();
+  static void *worker(void *arg);
+
   dnn_runtime_t *_rt;            // DNN runtime context
   nn_network_t  *_network;       // Network data from .nnb file
+  bool           _network_allocated; // _network is allocated by begin()
 
   void         **_input;         // Input data array
   int            _nr_inputs;     // Number of input data
   DNNVariable   *_output;        // Output data array
   int            _nr_outputs;    // Number of output data
+
+  pthread_t        _worker;      // Thread of forwardAsync()
+  bool             _worker_running;
+  volatile bool    _busy;        // forwardAsync() is running
+  int              _result;      // Result of forwardAsync()
+  dnnrt_callback_t _callback;
+  void            *_callback_arg;
+  sem_t            _request;
+  sem_t            _done;
+
+  DNNProfile          _profile;
+  unsigned long long  _total_us;
 };
 
 class DNNVariable {
@@ -220,6 +354,50 @@ public:
    */
   int maxIndex();
 
+  /**
+   * Get the k largest elements
+   *
+   * The value array is also the work area of the search, so topK() does
+   * not allocate memory.
+   *
+   * @param [in]  k     Number of elements to get
+   * @param [out] index Array indexes of k elements in descending order of value
+   * @param [out] value Values of them, k elements
+   * @return Number of elements got, which is less than k if the size is smaller.
+   */
+  int topK(int k, int *index, float *value);
+
+  /**
+   * Apply softmax to the whole data in place
+   *
+   * @return 0 on success, otherwise error.
+   */
+  int softmax();
+
+  /**
+   * Apply softmax along an axis in place
+   *
+   * @param [in] shape Shape of the data, e.g. from DNNRT::outputShapeSize()
+   * @param [in] ndim  Number of dimensions
+   * @param [in] axis  Axis to normalize
+   * @return 0 on success, otherwise error.
+   */
+  int softmax(const int *shape, int ndim, int axis);
+
+  /**
+   * Get array indexes of the maximum values along an axis
+   *
+   * For example, for the shape (C, H, W) and axis 0, result has H * W
+   * elements, each of them is the channel of the maximum value.
+   *
+   * @param [in]  shape  Shape of the data, e.g. from DNNRT::outputShapeSize()
+   * @param [in]  ndim   Number of dimensions
+   * @param [in]  axis   Axis to reduce
+   * @param [out] result Index along the axis, size / shape[axis] elements
+   * @return 0 on success, otherwise error.
+   */
+  int argmax(const int *shape, int ndim, int axis, int *result);
+
 private:
   DNNVariable();
   float *_data;
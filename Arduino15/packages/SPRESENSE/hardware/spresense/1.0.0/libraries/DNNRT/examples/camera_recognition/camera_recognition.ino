@@ -0,0 +1,121 @@
+/*
+ *  camera_recognition.ino - hand written number recognition from camera
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file camera_recognition.ino
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief DNNRT sample application with the camera.
+ *
+ * This sample recognizes a number written on paper in the center of the
+ * camera preview. It uses `network.nnb` of the number_recognition sample,
+ * which should be placed at the SD card.
+ *
+ * The square at the center of the QVGA frame is clipped, resized to
+ * 28 x 28 and normalized directly into the input DNNVariable by
+ * DNNPreprocess, without any intermediate image.
+ */
+
+#include <SDHCI.h>
+#include <Camera.h>
+#include <DNNRT.h>
+#include <DNNPreprocess.h>
+
+#define DNN_WIDTH  28
+#define DNN_HEIGHT 28
+
+DNNRT dnnrt;
+DNNPreprocess preprocess;
+DNNVariable input(DNN_WIDTH * DNN_HEIGHT);
+SDClass SD;
+
+void CamCB(CamImage img)
+{
+  if (!img.isAvailable())
+    {
+      return;
+    }
+
+  unsigned long start = micros();
+
+  if (preprocess.run(img, input) < 0)
+    {
+      Serial.println("Preprocess error");
+      return;
+    }
+
+  unsigned long prep = micros() - start;
+
+  dnnrt.inputVariable(input, 0);
+  dnnrt.forward();
+  DNNVariable output = dnnrt.outputVariable(0);
+
+  int index = output.maxIndex();
+  Serial.print("Image is ");
+  Serial.print(index);
+  Serial.print(" value ");
+  Serial.print(output[index]);
+  Serial.print(" preprocess ");
+  Serial.print(prep);
+  Serial.println(" us");
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial)
+    {
+      ; // wait for serial port to connect. Needed for native USB port only
+    }
+
+  File nnbfile = SD.open("network.nnb");
+  if (!nnbfile)
+    {
+      Serial.print("nnb not found");
+      return;
+    }
+
+  int ret = dnnrt.begin(nnbfile);
+  if (ret < 0)
+    {
+      Serial.print("Runtime initialization failure. ");
+      Serial.println(ret);
+      return;
+    }
+
+  /*
+   * The model is trained with white numbers on black, while a number
+   * written on paper is black on white. So invert the gray scale
+   * with (pixel - 255) * (-1 / 255).
+   */
+
+  preprocess.begin(DNN_WIDTH, DNN_HEIGHT, 1);
+  preprocess.setNormalize(255.0f, -1.0f / 255.0f);
+  preprocess.setROI((CAM_IMGSIZE_QVGA_H - CAM_IMGSIZE_QVGA_V) / 2, 0,
+                    (CAM_IMGSIZE_QVGA_H + CAM_IMGSIZE_QVGA_V) / 2 - 1,
+                    CAM_IMGSIZE_QVGA_V - 1);
+
+  theCamera.begin(1, CAM_VIDEO_FPS_5, CAM_IMGSIZE_QVGA_H, CAM_IMGSIZE_QVGA_V,
+                  CAM_IMAGE_PIX_FMT_YUV422);
+  theCamera.startStreaming(true, CamCB);
+}
+
+void loop()
+{
+  sleep(1);
+}
@@ -0,0 +1,186 @@
+/*
+ *  postprocess.ino - DNNRT post-processing sample application
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file postprocess.ino
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief DNNRT post-processing sample application.
+ *
+ * This sample runs the post-processing of DNNVariable and DNNDetection on
+ * fixed data instead of a network output, so no network model nor SD card
+ * is needed. Each step is checked against the expected result and
+ * "PASS" or "FAIL" is printed.
+ */
+
+#include <DNNRT.h>
+#include <DNNDetection.h>
+
+#define NUM_CLASSES (6)
+#define NUM_ROWS    (5)
+#define ROW_STRIDE  (4 + 1 + 2)
+
+static int errors = 0;
+
+static void check(const char *name, bool ok) {
+  Serial.print(ok ? "PASS: " : "FAIL: ");
+  Serial.println(name);
+  if (!ok) {
+    errors++;
+  }
+}
+
+static bool near(float a, float b) {
+  return fabsf(a - b) < 1e-4f;
+}
+
+void check_classification() {
+  static const float logits[NUM_CLASSES] = {
+    0.5f, 2.0f, -1.0f, 3.0f, 1.0f, 2.5f
+  };
+  DNNVariable var(NUM_CLASSES);
+  float *data = var.data();
+
+  for (int i = 0; i < NUM_CLASSES; i++) {
+    data[i] = logits[i];
+  }
+
+  check("maxIndex", var.maxIndex() == 3);
+
+  // The value array is also the work area of topK().
+  int index[3];
+  float value[3];
+  int n = var.topK(3, index, value);
+  check("topK", (n == 3) &&
+        (index[0] == 3) && (index[1] == 5) && (index[2] == 1) &&
+        near(value[0], 3.0f) && near(value[1], 2.5f) && near(value[2], 2.0f));
+
+  // Larger k than the size gets all of the elements.
+  int all_index[NUM_CLASSES + 2];
+  float all_value[NUM_CLASSES + 2];
+  check("topK all", var.topK(NUM_CLASSES + 2, all_index, all_value) == NUM_CLASSES);
+
+  // Softmax keeps the order, and the sum is 1.
+  var.softmax();
+  float sum = 0.0f;
+  for (int i = 0; i < NUM_CLASSES; i++) {
+    sum += data[i];
+  }
+  check("softmax", near(sum, 1.0f) && (var.maxIndex() == 3) &&
+        near(data[3] / data[5], expf(0.5f)));
+}
+
+void check_segmentation() {
+  // Shape (C, H, W) = (3, 2, 2). The winner of each pixel is known.
+  static const int shape[3] = {3, 2, 2};
+  static const float score[12] = {
+    9.0f, 0.0f, 0.0f, 1.0f,   // Channel 0
+    0.0f, 9.0f, 0.0f, 2.0f,   // Channel 1
+    0.0f, 0.0f, 9.0f, 3.0f,   // Channel 2
+  };
+  DNNVariable var(12);
+  int result[4];
+
+  for (int i = 0; i < 12; i++) {
+    var.data()[i] = score[i];
+  }
+
+  int ret = var.argmax(shape, 3, 0, result);
+  check("argmax", (ret == 0) &&
+        (result[0] == 0) && (result[1] == 1) && (result[2] == 2) && (result[3] == 2));
+
+  // Each pixel sums to 1 over the channels.
+  ret = var.softmax(shape, 3, 0);
+  bool ok = (ret == 0);
+  for (int i = 0; i < 4; i++) {
+    float sum = var.data()[i] + var.data()[4 + i] + var.data()[8 + i];
+    ok = ok && near(sum, 1.0f);
+  }
+  check("softmax axis", ok);
+}
+
+void check_detection() {
+  // Rows of center x, center y, width, height, objectness and 2 classes
+  // in the normalized coordinates.
+  static const float output[NUM_ROWS * ROW_STRIDE] = {
+    0.50f, 0.50f, 0.20f, 0.20f,  0.9f,  0.9f, 0.1f,  // Label 0
+    0.51f, 0.50f, 0.20f, 0.20f,  0.8f,  0.9f, 0.1f,  // Overlaps the first
+    0.51f, 0.51f, 0.20f, 0.20f,  0.9f,  0.2f, 0.8f,  // Same place, label 1
+    0.20f, 0.20f, 0.10f, 0.10f,  0.9f,  0.7f, 0.3f,  // Apart from the others
+    0.80f, 0.80f, 0.10f, 0.10f,  0.1f,  0.9f, 0.1f,  // Low score
+  };
+  DNNDetection detection;
+  DNNBox boxes[NUM_ROWS];
+
+  detection.setFormat(DNN_BOX_CENTER, true);
+  detection.setScale(320.0f, 240.0f);
+
+  int n = detection.decode(output, NUM_ROWS, ROW_STRIDE, 0.5f, boxes, NUM_ROWS);
+  check("decode", (n == 4) &&
+        near(boxes[0].x1, 128.0f) && near(boxes[0].y1, 96.0f) &&
+        near(boxes[0].x2, 192.0f) && near(boxes[0].y2, 144.0f) &&
+        near(boxes[0].score, 0.81f) && (boxes[2].label == 1));
+
+  // The second box is removed by the first one of the same label.
+  DNNBox aware[NUM_ROWS];
+  memcpy(aware, boxes, sizeof(DNNBox) * n);
+  int kept = DNNDetection::nms(aware, n, 0.5f);
+  check("nms", (kept == 3) &&
+        near(aware[0].score, 0.81f) && (aware[0].label == 0) &&
+        near(aware[1].score, 0.72f) && (aware[1].label == 1) &&
+        near(aware[2].score, 0.63f));
+
+  // Without labels, the box of label 1 is also removed.
+  kept = DNNDetection::nms(boxes, n, 0.5f, false);
+  check("nms any label", (kept == 2) &&
+        near(boxes[0].score, 0.81f) && near(boxes[1].score, 0.63f));
+
+  for (int i = 0; i < kept; i++) {
+    Serial.print("box ");
+    Serial.print(i);
+    Serial.print(": label ");
+    Serial.print(boxes[i].label);
+    Serial.print(" score ");
+    Serial.print(boxes[i].score);
+    Serial.print(" (");
+    Serial.print(boxes[i].x1);
+    Serial.print(", ");
+    Serial.print(boxes[i].y1);
+    Serial.print(") - (");
+    Serial.print(boxes[i].x2);
+    Serial.print(", ");
+    Serial.print(boxes[i].y2);
+    Serial.println(")");
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {
+    ; // wait for serial port to connect. Needed for native USB port only
+  }
+
+  check_classification();
+  check_segmentation();
+  check_detection();
+
+  Serial.println(errors ? "Result: FAIL" : "Result: PASS");
+}
+
+void loop() {
+}
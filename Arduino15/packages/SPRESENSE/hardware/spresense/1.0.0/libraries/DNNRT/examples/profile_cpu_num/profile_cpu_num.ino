@@ -0,0 +1,119 @@
+/*
+ *  profile_cpu_num.ino - DNNRT profiling sample application
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file profile_cpu_num.ino
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief DNNRT profiling sample application.
+ *
+ * This sample measures the forward propagation time of `network.nnb` on
+ * the SD card with each number of CPUs, and shows how much of the time is
+ * hidden by forwardAsync(). Use it to decide cpu_num of DNNRT::begin()
+ * for your network model.
+ */
+
+#include <SDHCI.h>
+#include <DNNRT.h>
+
+#define REPEAT  (20)
+
+SDClass SD;
+
+void profile(File &nnbfile, unsigned char cpu_num) {
+  DNNRT dnnrt;
+  DNNProfile prof;
+
+  nnbfile.seek(0);
+  int ret = dnnrt.begin(nnbfile, cpu_num);
+  if (ret < 0) {
+    Serial.print("cpu_num ");
+    Serial.print(cpu_num);
+    Serial.print(" initialization failure ");
+    Serial.println(ret);
+    return;
+  }
+
+  DNNVariable input(dnnrt.inputSize(0));
+  memset(input.data(), 0, input.size() * sizeof(float));
+  dnnrt.inputVariable(input, 0);
+
+  // Warm up once, and measure.
+
+  dnnrt.forward();
+  dnnrt.clearProfile();
+  for (int i = 0; i < REPEAT; i++) {
+    dnnrt.forward();
+  }
+  dnnrt.getProfile(&prof);
+
+  Serial.print("cpu_num ");
+  Serial.print(cpu_num);
+  Serial.print(": avg ");
+  Serial.print(prof.avg_us);
+  Serial.print(" us, min ");
+  Serial.print(prof.min_us);
+  Serial.print(" us, max ");
+  Serial.print(prof.max_us);
+  Serial.print(" us, memory ");
+  Serial.print(prof.memory);
+  Serial.println(" bytes");
+
+  // The main loop can work while the network runs.
+
+  unsigned long start = micros();
+  unsigned long work = 0;
+  dnnrt.forwardAsync();
+  while (dnnrt.isBusy()) {
+    work++;   // e.g. capture and preprocess the next frame here
+    usleep(100);
+  }
+  dnnrt.wait();
+  Serial.print("  async ");
+  Serial.print(micros() - start);
+  Serial.print(" us with ");
+  Serial.print(work);
+  Serial.println(" loops of other work");
+
+  dnnrt.end();
+}
+
+void setup() {
+
+  Serial.begin(115200);
+  while (!Serial) {
+    ; // wait for serial port to connect. Needed for native USB port only
+  }
+
+  File nnbfile = SD.open("network.nnb");
+  if (!nnbfile) {
+    Serial.print("nnb not found");
+    return;
+  }
+
+  for (unsigned char cpu_num = 1; cpu_num <= 5; cpu_num++) {
+    profile(nnbfile, cpu_num);
+  }
+
+  nnbfile.close();
+}
+
+void loop() {
+  // put your main code here, to run repeatedly:
+
+}
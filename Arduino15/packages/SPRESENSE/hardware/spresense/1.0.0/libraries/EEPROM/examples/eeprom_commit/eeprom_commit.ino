@@ -0,0 +1,84 @@
+/*
+ *  eeprom_commit.ino - Example of grouped EEPROM writes
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Saves a configuration field by field with setAutoCommit(false), and
+ * stores all the changes to the emulation file with one commit().
+ * The boot counter in the configuration is incremented on every reset,
+ * so the contents kept over a reset or a power cycle can be checked.
+ */
+
+#include <EEPROM.h>
+
+struct Config {
+  uint32_t boots;
+  uint16_t rate;
+  uint8_t  channels;
+  char     name[16];
+};
+
+static const int CONFIG_ADDRESS = 0;
+
+void setup() {
+  Config config;
+
+  Serial.begin(115200);
+  while (!Serial) {
+    ; // wait for serial port to connect. Needed for native USB port only
+  }
+
+  /* Reads are served from RAM. A new emulation file is zero-filled. */
+  EEPROM.get(CONFIG_ADDRESS, config);
+  Serial.print("Boots so far: ");
+  Serial.println(config.boots);
+
+  /* Keep the following writes in RAM */
+  EEPROM.setAutoCommit(false);
+
+  EEPROM.put(CONFIG_ADDRESS + offsetof(Config, boots), config.boots + 1);
+  EEPROM.put(CONFIG_ADDRESS + offsetof(Config, rate), (uint16_t)48000);
+  EEPROM.put(CONFIG_ADDRESS + offsetof(Config, channels), (uint8_t)2);
+
+  char name[sizeof(config.name)] = "spresense";
+  EEPROM.put(CONFIG_ADDRESS + offsetof(Config, name), name);
+
+  /* Store all the changed bytes in one journal record */
+  if (EEPROM.commit()) {
+    Serial.println("Committed");
+  } else {
+    Serial.println("Commit failed");
+  }
+
+  /* Back to the default, every write is stored immediately */
+  EEPROM.setAutoCommit(true);
+
+  EEPROM.get(CONFIG_ADDRESS, config);
+  Serial.print("Boots: ");
+  Serial.print(config.boots);
+  Serial.print(", rate: ");
+  Serial.print(config.rate);
+  Serial.print(", channels: ");
+  Serial.print(config.channels);
+  Serial.print(", name: ");
+  Serial.println(config.name);
+}
+
+void loop() {
+  /* Empty loop */
+}
@@ -19,65 +19,406 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
 #include "EEPROM.h"
 
+/*
+ * Layout of the eeprom emulation file
+ *
+ *   [copy 0: header | image (E2END) | journal (EEPROM_LOG_SIZE)]
+ *   [copy 1: header | image (E2END) | journal (EEPROM_LOG_SIZE)]
+ *
+ * The copy with the valid header and the larger sequence number is used.
+ * A commit appends a record of the changed bytes to its journal. When the
+ * journal is full, the whole image is written to the other copy with the
+ * next sequence number, so the copies are written alternately.
+ *
+ * Every header and record has a CRC, and a record also covers the sequence
+ * number of its copy. If the power is lost during a commit, the broken
+ * record or copy is ignored and the previous contents are used.
+ */
+
+#define EEPROM_TMP    EEPROM_EMU ".tmp"
+#define EEPROM_MAGIC  0x4a504545 /* "EEPJ" */
+
+struct EEHeader {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t size;
+  uint32_t crc;   /* CRC of the image */
+};
+
+struct EERecord {
+  uint16_t offset;
+  uint16_t length;
+  uint32_t crc;   /* CRC of the sequence number, offset, length and data */
+};
+
+#define REGION_SIZE   (sizeof(EEHeader) + E2END + EEPROM_LOG_SIZE)
+#define REGION(n)     ((long)(n) * REGION_SIZE)
+#define LOG_OFFSET(n) (REGION(n) + sizeof(EEHeader) + E2END)
+#define ALIGN4(n)     (((n) + 3) & ~3)
+
+static uint32_t crc32(uint32_t crc, const void *buf, int size)
+{
+  const uint8_t *p = (const uint8_t *)buf;
+
+  crc = ~crc;
+  while (size--) {
+    crc ^= *p++;
+    for (int i = 0; i < 8; i++) {
+      crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+  }
+  return ~crc;
+}
+
+static uint32_t record_crc(uint32_t seq, const EERecord *rec, const uint8_t *data)
+{
+  uint32_t crc = crc32(0, &seq, sizeof(seq));
+  crc = crc32(crc, rec, offsetof(EERecord, crc));
+  return crc32(crc, data, rec->length);
+}
+
 // Read a byte from the address specified by index on a eeprom emulation file
 uint8_t EERef::operator*() const
 {
-  int ret;
-  FILE *fp = NULL;
   uint8_t value = 0;
+  EEPROM.readBlock(index, &value, 1);
+  return value;
+}
+
+// Write a byte to the address specified by index on a eeprom emulation file
+EERef& EERef::operator=( uint8_t in )
+{
+  EEPROM.writeBlock(index, &in, 1);
+  return *this;
+}
+
+void EEPROMClass::init()
+{
+  if (initialized != 0) {
+    /* Already initialized */
+    return;
+  }
+
+  image = (uint8_t*)zalloc(E2END);
+  if (!image) {
+    printf("ERROR: eeprom out of memory\n");
+    return;
+  }
+
+  if (!load()) {
+    printf("ERROR: eeprom init failure\n");
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+    free(image);
+    image = NULL;
+    return;
+  }
+
+  dirtyStart = E2END;
+  dirtyEnd = 0;
+  initialized = 1;
+}
+
+void EEPROMClass::clear()
+{
+  if (fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+  free(image);
+  image = NULL;
+  unlink(EEPROM_EMU);
+  initialized = 0;
+  init();
+}
+
+void EEPROMClass::readBlock( int idx, uint8_t *buf, int size )
+{
+  init();
+
+  if (!image || (idx < 0) || (size < 0) || (idx + size > E2END)) {
+    printf("ERROR: eeprom read failure (%d)\n", idx);
+    return;
+  }
+
+  memcpy(buf, &image[idx], size);
+}
+
+void EEPROMClass::writeBlock( int idx, const uint8_t *buf, int size )
+{
+  init();
+
+  if (!image || (idx < 0) || (size < 0) || (idx + size > E2END)) {
+    printf("ERROR: eeprom write failure (%d)\n", idx);
+    return;
+  }
+
+  /* Only the bytes actually changed are marked dirty */
+  int first = 0;
+  int last = size;
+  while ((first < last) && (image[idx + first] == buf[first])) {
+    first++;
+  }
+  while ((last > first) && (image[idx + last - 1] == buf[last - 1])) {
+    last--;
+  }
+  if (first == last) {
+    return;
+  }
+
+  memcpy(&image[idx + first], &buf[first], last - first);
+
+  if (idx + first < dirtyStart) {
+    dirtyStart = idx + first;
+  }
+  if (idx + last > dirtyEnd) {
+    dirtyEnd = idx + last;
+  }
+
+  if (autoCommit) {
+    commit();
+  }
+}
+
+bool EEPROMClass::commit()
+{
+  if (!initialized) {
+    return false;
+  }
+  if (dirtyStart >= dirtyEnd) {
+    /* Nothing to write */
+    return true;
+  }
+
+  EERecord rec;
+  rec.offset = dirtyStart;
+  rec.length = dirtyEnd - dirtyStart;
+  int recsize = ALIGN4(sizeof(EERecord) + rec.length);
+
+  bool ret;
+  if (logpos + recsize > EEPROM_LOG_SIZE) {
+    ret = compact();
+  } else {
+    rec.crc = record_crc(seq, &rec, &image[rec.offset]);
+
+    /* Write the record in one write */
+    uint8_t *buf = (uint8_t*)zalloc(recsize);
+    if (!buf) {
+      printf("ERROR: eeprom out of memory\n");
+      return false;
+    }
+    memcpy(buf, &rec, sizeof(EERecord));
+    memcpy(&buf[sizeof(EERecord)], &image[rec.offset], rec.length);
+
+    ret = writeAt(LOG_OFFSET(region) + logpos, buf, recsize);
+    free(buf);
+
+    if (ret) {
+      fsync(fd);
+      logpos += recsize;
+    }
+  }
 
-  if ((fp = fopen(EEPROM_EMU, "rb")) == NULL) {
+  if (!ret) {
+    printf("ERROR: eeprom commit failure\n");
+    return false;
+  }
+
+  dirtyStart = E2END;
+  dirtyEnd = 0;
+  return true;
+}
+
+bool EEPROMClass::load()
+{
+  struct stat statBuf;
+  long filesize = -1;
+
+  /* Check whether the eeprom emulation file has already existed or not */
+  if (0 == stat(EEPROM_EMU, &statBuf)) {
+    filesize = statBuf.st_size;
+  }
+
+  if (filesize == E2END) {
+    /* Convert the raw image written by the old version */
+    FILE *fp = fopen(EEPROM_EMU, "rb");
+    if (fp) {
+      if (fread(image, 1, E2END, fp) != E2END) {
+        printf("ERROR: eeprom read failure\n");
+      }
+      fclose(fp);
+    }
+    if (!format(EEPROM_TMP) || (rename(EEPROM_TMP, EEPROM_EMU) < 0)) {
+      return false;
+    }
+  } else if (filesize != (long)(2 * REGION_SIZE)) {
+    /* Create a new zero-filled file */
+    if (!format(EEPROM_TMP) || (rename(EEPROM_TMP, EEPROM_EMU) < 0)) {
+      return false;
+    }
+  }
+
+  fd = open(EEPROM_EMU, O_RDWR);
+  if (fd < 0) {
     printf("ERROR: eeprom open failure\n");
-    goto errout;
+    return false;
   }
 
-  ret = fseek(fp, index, SEEK_SET);
-  if (ret) {
-    printf("ERROR: eeprom seek failure\n");
-    goto errout_with_close;
+  EEHeader hdr[2];
+  bool valid[2];
+  for (int i = 0; i < 2; i++) {
+    valid[i] = readAt(REGION(i), &hdr[i], sizeof(EEHeader)) &&
+               (hdr[i].magic == EEPROM_MAGIC) && (hdr[i].size == E2END);
   }
 
-  ret = fread(&value, 1, 1, fp);
-  if (ret != 1) {
-    printf("ERROR: eeprom read failure (%d)\n", ret);
+  /* Try the newer copy first */
+  int order[2] = {0, 1};
+  if (valid[0] && valid[1] && ((int32_t)(hdr[1].seq - hdr[0].seq) > 0)) {
+    order[0] = 1;
+    order[1] = 0;
+  } else if (!valid[0]) {
+    order[0] = 1;
+    order[1] = 0;
   }
-errout_with_close:
-  fclose(fp);
-errout:
-  return value;
+
+  for (int i = 0; i < 2; i++) {
+    int n = order[i];
+    if (!valid[n] ||
+        !readAt(REGION(n) + sizeof(EEHeader), image, E2END) ||
+        (crc32(0, image, E2END) != hdr[n].crc)) {
+      continue;
+    }
+
+    region = n;
+    seq = hdr[n].seq;
+    logpos = 0;
+
+    /* Replay the journal until the first broken record */
+    uint8_t *log = (uint8_t*)malloc(EEPROM_LOG_SIZE);
+    if (!log) {
+      printf("ERROR: eeprom out of memory\n");
+      return false;
+    }
+    if (readAt(LOG_OFFSET(n), log, EEPROM_LOG_SIZE)) {
+      while (logpos + (int)sizeof(EERecord) <= EEPROM_LOG_SIZE) {
+        EERecord rec;
+        memcpy(&rec, &log[logpos], sizeof(EERecord));
+        int recsize = ALIGN4(sizeof(EERecord) + rec.length);
+        if ((rec.length == 0) || (rec.offset + rec.length > E2END) ||
+            (logpos + recsize > EEPROM_LOG_SIZE) ||
+            (record_crc(seq, &rec, &log[logpos + sizeof(EERecord)]) != rec.crc)) {
+          break;
+        }
+        memcpy(&image[rec.offset], &log[logpos + sizeof(EERecord)], rec.length);
+        logpos += recsize;
+      }
+    }
+    free(log);
+    return true;
+  }
+
+  /* No valid copy is left, so start from a zero-filled image */
+  printf("ERROR: eeprom is broken, and initialized\n");
+  memset(image, 0, E2END);
+  region = 1;
+  seq = 0;
+  return compact();
 }
 
-// Write a byte to the address specified by index on a eeprom emulation file
-EERef& EERef::operator=( uint8_t in )
+// Create a new file which has the current image in copy 0
+bool EEPROMClass::format( const char *path )
 {
   int ret;
   FILE *fp = NULL;
 
-  if ((fp = fopen(EEPROM_EMU, "rb+")) == NULL) {
+  if ((fp = fopen(path, "wb")) == NULL) {
     printf("ERROR: eeprom open failure\n");
-    goto errout;
+    return false;
   }
 
-  ret = fseek(fp, index, SEEK_SET);
-  if (ret) {
-    printf("ERROR: eeprom seek failure\n");
-    goto errout_with_close;
+  uint8_t *buf = (uint8_t*)zalloc(REGION_SIZE);
+  if (!buf) {
+    printf("ERROR: eeprom out of memory\n");
+    fclose(fp);
+    return false;
   }
 
-  ret = fwrite(&in, 1, 1, fp);
-  if (ret != 1) {
-    printf("ERROR: eeprom write failure (%d)\n", ret);
-  }
+  EEHeader hdr = { EEPROM_MAGIC, 1, E2END, crc32(0, image, E2END) };
+  memcpy(buf, &hdr, sizeof(EEHeader));
+  memcpy(&buf[sizeof(EEHeader)], image, E2END);
+  ret = fwrite(buf, 1, REGION_SIZE, fp);
 
-errout_with_close:
+  /* Copy 1 is empty (invalid header) */
+  memset(buf, 0, REGION_SIZE);
+  ret += fwrite(buf, 1, REGION_SIZE, fp);
+
+  free(buf);
+  fflush(fp);
+  fsync(fileno(fp));
   fclose(fp);
-errout:
-  return *this;
+
+  if (ret != (int)(2 * REGION_SIZE)) {
+    printf("ERROR: eeprom init failure (%d)\n", ret);
+    unlink(path);
+    return false;
+  }
+  return true;
+}
+
+// Write the whole image to the other copy and switch to it
+bool EEPROMClass::compact()
+{
+  int next = region ^ 1;
+  EEHeader hdr = { EEPROM_MAGIC, seq + 1, E2END, crc32(0, image, E2END) };
+
+  /* Invalidate the copy first, so that a torn write is never taken as valid */
+  EEHeader none;
+  memset(&none, 0, sizeof(none));
+  if (!writeAt(REGION(next), &none, sizeof(none)) ||
+      !writeAt(REGION(next) + sizeof(EEHeader), image, E2END)) {
+    return false;
+  }
+  fsync(fd);
+
+  if (!writeAt(REGION(next), &hdr, sizeof(hdr))) {
+    return false;
+  }
+  fsync(fd);
+
+  region = next;
+  seq = hdr.seq;
+  logpos = 0;
+  return true;
+}
+
+bool EEPROMClass::writeAt( long offset, const void *buf, int size )
+{
+  if ((lseek(fd, offset, SEEK_SET) != offset) ||
+      (::write(fd, buf, size) != size)) {
+    printf("ERROR: eeprom write failure\n");
+    return false;
+  }
+  return true;
+}
+
+bool EEPROMClass::readAt( long offset, void *buf, int size )
+{
+  if ((lseek(fd, offset, SEEK_SET) != offset) ||
+      (::read(fd, buf, size) != size)) {
+    printf("ERROR: eeprom read failure\n");
+    return false;
+  }
+  return true;
 }
 
 EEPROMClass EEPROM;
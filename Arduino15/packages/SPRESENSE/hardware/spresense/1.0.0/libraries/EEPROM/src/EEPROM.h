@@ -44,6 +44,11 @@
 // If you want the large capacity EEPROM, you can specify a larger size.
 #define E2END 4000
 
+// Size of the journal following each of the two copies of the image in the
+// emulation file. A commit appends only the changed bytes to the journal,
+// and the whole image is written to the other copy when the journal is full.
+#define EEPROM_LOG_SIZE 4096
+
 /***
     EERef class.
     
@@ -135,53 +140,15 @@ struct EEPtr{
 
 struct EEPROMClass{
 
-    EEPROMClass() : initialized(0) {}
-    //Create a eeprom emulation file if it doesn't exist
-    void init() {
-        int ret;
-        FILE *fp = NULL;
-        struct stat statBuf;
-        long filesize = -1;
-        long eepromsize = E2END;
-
-        if (initialized != 0) {
-            /* Already initialized */
-            return;
-        }
-
-        /* Check whether the eeprom emulation file has already existed or not */
-        if (0 == stat(EEPROM_EMU, &statBuf)) {
-            filesize = statBuf.st_size;
-        }
-
-        if (eepromsize == filesize) {
-            /* Already existed if the file size is equal to the eeprom size */
-            initialized = 1;
-            return;
-        }
-
-        /* Create a new file */
-        if ((fp = fopen(EEPROM_EMU, "wb")) == NULL) {
-            printf("ERROR: eeprom open failure\n");
-        }
-
-        uint8_t *ptr = (uint8_t*)zalloc(eepromsize);
-        ret = fwrite(ptr, 1, eepromsize, fp);
-        if (ret != eepromsize) {
-            printf("ERROR: eeprom init failure (%d)\n", ret);
-        }
-
-        fclose(fp);
-
-        initialized = 1;
-        return;
-    }
+    EEPROMClass()
+        : initialized(0), autoCommit(true), fd(-1), image(NULL),
+          region(0), seq(0), logpos(0), dirtyStart(0), dirtyEnd(0) {}
+
+    //Load the eeprom image into RAM. The eeprom emulation file is created
+    //if it doesn't exist, and an old raw image file is converted.
+    void init();
     //Remove the eeprom file and create the a zero-filled eeprom file
-    void clear() {
-        unlink(EEPROM_EMU);
-        initialized = 0;
-        init();
-    }
+    void clear();
 
     //Basic user access methods.
     EERef operator[]( const int idx )    { init(); return idx; }
@@ -196,62 +163,44 @@ struct EEPROMClass{
     
     //Functionality to 'get' and 'put' objects to and from EEPROM.
     template< typename T > T &get( int idx, T &t ){
-        int ret;
-        FILE *fp = NULL;
-
-        init();
-
-        if ((fp = fopen(EEPROM_EMU, "rb")) == NULL) {
-            printf("ERROR: eeprom open failure\n");
-            goto errout;
-        }
-
-        ret = fseek(fp, idx, SEEK_SET);
-        if (ret) {
-            printf("ERROR: eeprom seek failure\n");
-            goto errout_with_close;
-        }
-
-        ret = fread((uint8_t*)&t, 1, sizeof(T), fp);
-        if (ret != sizeof(T)) {
-            printf("ERROR: eeprom read failure (%d)\n", ret);
-        }
-
-    errout_with_close:
-        fclose(fp);
-    errout:
+        readBlock(idx, (uint8_t*)&t, sizeof(T));
         return t;
     }
 
     template< typename T > const T &put( int idx, const T &t ){
-        int ret;
-        FILE *fp = NULL;
-
-        init();
-
-        if ((fp = fopen(EEPROM_EMU, "rb+")) == NULL) {
-            printf("ERROR: eeprom open failure\n");
-            goto errout;
-        }
-
-        ret = fseek(fp, idx, SEEK_SET);
-        if (ret) {
-            printf("ERROR: eeprom seek failure\n");
-            goto errout_with_close;
-        }
-
-        ret = fwrite((uint8_t*)&t, 1, sizeof(T), fp);
-        if (ret != sizeof(T)) {
-            printf("ERROR: eeprom write failure (%d)\n", ret);
-        }
-
-    errout_with_close:
-        fclose(fp);
-    errout:
+        writeBlock(idx, (const uint8_t*)&t, sizeof(T));
         return t;
     }
 
+    //Write the changes cached in RAM to the eeprom emulation file.
+    //It returns false on failure.
+    bool commit();
+
+    //If enabled (default), every write is committed immediately.
+    //Otherwise the changes are kept in RAM until commit().
+    void setAutoCommit( bool enable )    { autoCommit = enable; }
+
+    //Block access to the RAM image.
+    void readBlock( int idx, uint8_t *buf, int size );
+    void writeBlock( int idx, const uint8_t *buf, int size );
+
     int initialized;
+    bool autoCommit;
+
+private:
+    bool load();
+    bool format( const char *path );
+    bool compact();
+    bool writeAt( long offset, const void *buf, int size );
+    bool readAt( long offset, void *buf, int size );
+
+    int fd;
+    uint8_t *image;
+    int region;      //Copy of the image in use (0 or 1)
+    uint32_t seq;    //Sequence number of the copy in use
+    int logpos;      //Next write position in the journal
+    int dirtyStart;  //Range of bytes changed since the last commit
+    int dirtyEnd;
 };
 
 extern EEPROMClass EEPROM;
@@ -0,0 +1,179 @@
+/*
+ *  RawFile.cpp - Spresense Arduino File library
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file RawFile.cpp
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief SPRESENSE Arduino file library
+ *
+ * @details Unbuffered file for the block transfers of a background thread
+ */
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <malloc.h>
+
+#include "RawFile.h"
+
+#define MAXFILELEN 128
+
+RawFile::RawFile()
+: m_fd(-1), m_pos(0), m_size(0), m_preallocated(false) {
+}
+
+char *RawFile::fullPath(char *buf, size_t len, const char *path) {
+  int ret;
+
+  if (0 != strncmp(path, "/mnt/", 5)) {
+    /* Treat a path without '/mnt/' as a file on SD card */
+    ret = snprintf(buf, len, "/mnt/sd0/%s", path);
+  } else {
+    ret = snprintf(buf, len, "%s", path);
+  }
+
+  return ((ret < 0) || ((size_t)ret >= len)) ? NULL : buf;
+}
+
+uint8_t *RawFile::allocBuffer(size_t size) {
+  return (uint8_t *)memalign(DMA_ALIGN, size);
+}
+
+bool RawFile::create(const char *path, size_t prealloc_size) {
+  char fpbuf[MAXFILELEN];
+
+  if (!path || !fullPath(fpbuf, sizeof(fpbuf), path)) {
+    return false;
+  }
+
+  m_fd = ::open(fpbuf, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (m_fd < 0) {
+    return false;
+  }
+
+  m_pos = 0;
+  m_size = 0;
+  m_preallocated = false;
+  if (prealloc_size > 0) {
+    if (::ftruncate(m_fd, (off_t)prealloc_size) == 0) {
+      m_preallocated = true;
+    }
+    ::lseek(m_fd, 0, SEEK_SET);
+  }
+
+  return true;
+}
+
+bool RawFile::openRead(const char *path, uint32_t offset) {
+  char fpbuf[MAXFILELEN];
+
+  if (!path || !fullPath(fpbuf, sizeof(fpbuf), path)) {
+    return false;
+  }
+
+  m_fd = ::open(fpbuf, O_RDONLY);
+  if (m_fd < 0) {
+    return false;
+  }
+
+  if (::lseek(m_fd, offset, SEEK_SET) != (off_t)offset) {
+    close();
+    return false;
+  }
+
+  m_pos = offset;
+  m_size = 0;
+  m_preallocated = false;
+
+  return true;
+}
+
+bool RawFile::write(const void *data, size_t len, uint32_t *us) {
+  const uint8_t *p = (const uint8_t *)data;
+  uint32_t start = micros();
+  bool ok = true;
+
+  while (len > 0) {
+    ssize_t ret = ::write(m_fd, p, len);
+    if (ret <= 0) {
+      ok = false;
+      break;
+    }
+    p += ret;
+    len -= ret;
+    m_pos += ret;
+  }
+
+  if (m_pos > m_size) {
+    m_size = m_pos;
+  }
+
+  if (us) {
+    *us = micros() - start;
+  }
+
+  return ok;
+}
+
+ssize_t RawFile::read(void *buf, size_t len, uint32_t *us) {
+  uint32_t start = micros();
+  ssize_t ret = ::read(m_fd, buf, len);
+
+  if (us) {
+    *us = micros() - start;
+  }
+
+  if (ret > 0) {
+    m_pos += ret;
+  }
+
+  return ret;
+}
+
+bool RawFile::seek(off_t pos) {
+  if (::lseek(m_fd, pos, SEEK_SET) != pos) {
+    return false;
+  }
+
+  m_pos = pos;
+  return true;
+}
+
+bool RawFile::finish() {
+  bool ok = true;
+
+  if (m_preallocated && (::ftruncate(m_fd, m_size) != 0)) {
+    ok = false;
+  }
+
+  if (::fsync(m_fd) != 0) {
+    ok = false;
+  }
+
+  return ok;
+}
+
+void RawFile::close() {
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
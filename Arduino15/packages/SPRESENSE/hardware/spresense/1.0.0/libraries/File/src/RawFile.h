@@ -0,0 +1,173 @@
+/*
+ *  RawFile.h - Spresense Arduino File library
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __RAWFILE_H__
+#define __RAWFILE_H__
+
+#ifdef SUBCORE
+#error "File library is NOT supported by SubCore."
+#endif
+
+/**
+ * @file RawFile.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief SPRESENSE Arduino File library
+ *
+ * @details RawFile reads and writes a file by blocks from a background
+ *          thread, as the recorders and the players of the libraries do.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+/**
+ * @class RawFile
+ * @brief Unbuffered file for the block transfers of a background thread.
+ *
+ * @details Each read and write goes to the storage directly, and its time is
+ *          measured for the statistics of the caller. The class does not
+ *          print, so it can be used from a thread with a small stack.
+ *          It is a plain descriptor. Copy it to hand over the file, and
+ *          close it explicitly.
+ */
+class RawFile {
+public:
+  static const int SECTOR_SIZE = 512; /**< Sector size of the storage */
+
+ /**
+  * @brief Construct a closed RawFile object
+  */
+  RawFile();
+
+ /**
+  * @brief Get the full path of a file.
+  *
+  * @details Same as the File library, a path without "/mnt/" is treated as
+  *          a file on the SD card.
+  *
+  * @param [out] buf Buffer of the full path.
+  * @param [in] len The size of buf.
+  * @param [in] path The name of the file.
+  * @return buf, or NULL if the full path does not fit.
+  */
+  static char *fullPath(char *buf, size_t len, const char *path);
+
+ /**
+  * @brief Allocate a buffer for the transfers.
+  *
+  * @details The buffer is aligned for the DMA of the storage. Free it with free().
+  *
+  * @param [in] size The size of the buffer.
+  * @return The buffer, or NULL if no memory.
+  */
+  static uint8_t *allocBuffer(size_t size);
+
+ /**
+  * @brief Create a file to write.
+  *
+  * @details An existing file is truncated. If prealloc_size is given, the
+  *          file is extended in advance so that the storage does not
+  *          allocate clusters while writing, and finish() truncates it to
+  *          the written size. Writing continues without it if the file
+  *          system does not support it.
+  *
+  * @param [in] path The name of the file.
+  * @param [in] prealloc_size Preallocated bytes (0 for none).
+  * @return true for success, false for failure
+  */
+  bool create(const char *path, size_t prealloc_size = 0);
+
+ /**
+  * @brief Open a file to read.
+  *
+  * @param [in] path The name of the file.
+  * @param [in] offset The position to start reading.
+  * @return true for success, false for failure
+  */
+  bool openRead(const char *path, uint32_t offset = 0);
+
+ /**
+  * @brief Write all data.
+  *
+  * @param [in] data Array of bytes.
+  * @param [in] len The number of bytes.
+  * @param [out] us The time of the write in microseconds, or NULL.
+  * @return true for success, false if a write failed. The bytes before the
+  *         failure stay in the file and in size().
+  */
+  bool write(const void *data, size_t len, uint32_t *us = NULL);
+
+ /**
+  * @brief Read data.
+  *
+  * @param [out] buf Array of bytes.
+  * @param [in] len The size of buf.
+  * @param [out] us The time of the read in microseconds, or NULL.
+  * @return The number of bytes read, 0 at the end of the file, or -1 for failure.
+  */
+  ssize_t read(void *buf, size_t len, uint32_t *us = NULL);
+
+ /**
+  * @brief Seek to a new position in the file.
+  *
+  * @param [in] pos The position from the beginning of the file.
+  * @return true for success, false for failure
+  */
+  bool seek(off_t pos);
+
+ /**
+  * @brief Truncate the preallocated area and save the written data.
+  *
+  * @details The file is truncated to size() if it was preallocated.
+  *
+  * @return true for success, false for failure
+  */
+  bool finish();
+
+ /**
+  * @brief Close the file.
+  */
+  void close();
+
+ /**
+  * @brief Check if the file is open.
+  */
+  bool isOpen() const { return m_fd >= 0; };
+
+ /**
+  * @brief Get the current position within the file.
+  */
+  off_t position() const { return m_pos; };
+
+ /**
+  * @brief Get the end of the data written since create().
+  */
+  off_t size() const { return m_size; };
+
+private:
+  static const int DMA_ALIGN = 32;
+
+  int   m_fd;
+  off_t m_pos;
+  off_t m_size;
+  bool  m_preallocated;
+};
+
+#endif /* __RAWFILE_H__ */
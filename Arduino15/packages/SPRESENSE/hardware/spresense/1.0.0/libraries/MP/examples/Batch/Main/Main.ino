@@ -0,0 +1,92 @@
+/*
+ *  Main.ino - MP Example for batched and coalesced messages
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifdef SUBCORE
+#error "Core selection is wrong!!"
+#endif
+
+#include <MP.h>
+
+#define MSGID_SAMPLE  1
+#define MSGID_NOTIFY  2
+#define MSGID_ACK     3
+
+#define BATCH_NUM     16
+
+int subcore = 1;
+
+void setup()
+{
+  int ret;
+
+  Serial.begin(115200);
+  while (!Serial);
+
+  /* Boot SubCore */
+  ret = MP.begin(subcore);
+  if (ret < 0) {
+    printf("MP.begin error = %d\n", ret);
+  }
+
+  /* Count the messages and the round-trip time for GetStat() */
+  MP.EnableStat(true);
+
+  /* Repeated notifications collapse into one until Flush() */
+  MP.Coalesce(MSGID_NOTIFY, true, subcore);
+
+  MP.RecvTimeout(1000);
+}
+
+void loop()
+{
+  static uint32_t value = 0;
+  int8_t   msgid[BATCH_NUM];
+  uint32_t msgdata[BATCH_NUM];
+  int ret;
+
+  /* Send a block of samples by one call */
+  for (int i = 0; i < BATCH_NUM; i++) {
+    msgid[i] = MSGID_SAMPLE;
+    msgdata[i] = value++;
+
+    /* Only the latest notification is delivered */
+    MP.Send(MSGID_NOTIFY, value, subcore);
+  }
+
+  ret = MP.SendBatch(msgid, msgdata, BATCH_NUM, subcore);
+  if (ret != BATCH_NUM) {
+    printf("SendBatch error = %d\n", ret);
+  }
+  MP.Flush(subcore);
+
+  /* Wait for the reply of SubCore */
+  ret = MP.Recv(&msgid[0], &msgdata[0], subcore);
+  if (ret < 0) {
+    printf("Recv error = %d\n", ret);
+  }
+
+  if ((value % (BATCH_NUM * 1000)) == 0) {
+    MPStat stat;
+    MP.GetStat(stat, subcore);
+    printf("sent=%ld coalesced=%ld dropped=%ld received=%ld batch=%ld rtt(us) min=%ld avg=%ld max=%ld\n",
+           stat.sent, stat.coalesced, stat.dropped, stat.received, stat.maxBatch,
+           stat.rttMin, stat.rttCount ? (stat.rttTotal / stat.rttCount) : 0, stat.rttMax);
+    MP.ClearStat(subcore);
+  }
+}
@@ -0,0 +1,62 @@
+/*
+ *  Sub1.ino - MP Example for batched and coalesced messages
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#if (SUBCORE != 1)
+#error "Core selection is wrong!!"
+#endif
+
+#include <MP.h>
+
+#define MSGID_SAMPLE  1
+#define MSGID_NOTIFY  2
+#define MSGID_ACK     3
+
+#define BATCH_NUM     16
+
+void setup()
+{
+  MP.begin();
+  MP.RecvTimeout(MP_RECV_BLOCKING);
+}
+
+void loop()
+{
+  static uint32_t expect = 0;
+  int8_t   msgid[BATCH_NUM + 1];
+  uint32_t msgdata[BATCH_NUM + 1];
+  int num;
+
+  /* Take all queued messages at once */
+  num = MP.RecvBatch(msgid, msgdata, BATCH_NUM + 1);
+  if (num < 0) {
+    return;
+  }
+
+  for (int i = 0; i < num; i++) {
+    if (msgid[i] == MSGID_SAMPLE) {
+      if (msgdata[i] != expect) {
+        MPLog("lost sample: %ld (expected %ld)\n", msgdata[i], expect);
+      }
+      expect = msgdata[i] + 1;
+    } else if (msgid[i] == MSGID_NOTIFY) {
+      /* Reply once per notification */
+      MP.Send(MSGID_ACK, msgdata[i]);
+    }
+  }
+}
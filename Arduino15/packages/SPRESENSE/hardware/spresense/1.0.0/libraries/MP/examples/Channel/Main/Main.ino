@@ -0,0 +1,90 @@
+/*
+ *  Main.ino - MP Example for MP zero-copy Channel
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifdef SUBCORE
+#error "Core selection is wrong!!"
+#endif
+
+#include <MP.h>
+#include <MPChannel.h>
+
+#define FRAME_SAMPLES 768
+#define FRAME_SLOTS   4
+
+/* Shared frame structure */
+struct Frame {
+  uint32_t seq;
+  int16_t  pcm[FRAME_SAMPLES];
+};
+
+int subcore = 1;
+
+MPDoorbell doorbell(subcore);
+MPChannel<Frame, FRAME_SLOTS> channel;
+
+void setup()
+{
+  int ret;
+
+  Serial.begin(115200);
+  while (!Serial);
+
+  /* Boot SubCore */
+  MP.begin(subcore);
+
+  /* Allocate the channel in Shared Memory */
+  void *shm = MP.AllocSharedMemory(channel.sharedSize());
+  if (!shm) {
+    printf("Error: out of memory\n");
+    return;
+  }
+
+  ret = channel.create(shm, doorbell);
+  if (ret < 0) {
+    printf("channel.create error = %d\n", ret);
+    return;
+  }
+
+  /* Tell SubCore where the channel is (once) */
+  int8_t msgid = 10;
+  MP.Send(msgid, shm, subcore);
+}
+
+void loop()
+{
+  static uint32_t seq = 0;
+
+  /* Fill a slot in place. Up to FRAME_SLOTS frames can be in flight. */
+  Frame *frame = channel.acquire(1000);
+  if (!frame) {
+    printf("SubCore does not release frames\n");
+    return;
+  }
+
+  frame->seq = seq++;
+  for (int i = 0; i < FRAME_SAMPLES; i++) {
+    frame->pcm[i] = (int16_t)(i + frame->seq);
+  }
+
+  channel.send(frame);
+
+  if ((seq % 1000) == 0) {
+    printf("sent %ld frames, doorbells %ld\n", channel.sent(), channel.doorbells());
+  }
+}
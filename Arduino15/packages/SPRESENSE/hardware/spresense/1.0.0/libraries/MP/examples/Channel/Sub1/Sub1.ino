@@ -0,0 +1,71 @@
+/*
+ *  Sub1.ino - MP Example for MP zero-copy Channel
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#if (SUBCORE != 1)
+#error "Core selection is wrong!!"
+#endif
+
+#include <MP.h>
+#include <MPChannel.h>
+
+#define FRAME_SAMPLES 768
+#define FRAME_SLOTS   4
+
+/* Shared frame structure */
+struct Frame {
+  uint32_t seq;
+  int16_t  pcm[FRAME_SAMPLES];
+};
+
+MPDoorbell doorbell;
+MPChannel<Frame, FRAME_SLOTS> channel;
+
+void setup()
+{
+  int8_t msgid;
+  void *shm;
+
+  MP.begin();
+
+  /* Receive the channel address from MainCore */
+  MP.RecvTimeout(MP_RECV_BLOCKING);
+  MP.Recv(&msgid, &shm);
+
+  if (channel.attach(shm, doorbell) < 0) {
+    MPLog("channel.attach error\n");
+  }
+}
+
+void loop()
+{
+  static uint32_t expect = 0;
+
+  /* Read the frame in place, then give the slot back */
+  Frame *frame = channel.receive();
+  if (!frame) {
+    return;
+  }
+
+  if (frame->seq != expect) {
+    MPLog("lost frame: %ld (expected %ld)\n", frame->seq, expect);
+  }
+  expect = frame->seq + 1;
+
+  channel.release(frame);
+}
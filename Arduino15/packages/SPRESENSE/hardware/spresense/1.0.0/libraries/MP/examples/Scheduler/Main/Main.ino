@@ -0,0 +1,149 @@
+/*
+ *  Main.ino - MP Example to distribute FFT jobs to SubCores
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * The workload of the AudioFFT example (FFT and peak detection of 4ch
+ * blocks) is distributed to 1..SUBCORE_NUM SubCores by MPScheduler,
+ * and the speedup vs. the number of cores is printed.
+ * Build SubWorker for each of SubCore 1..SUBCORE_NUM.
+ */
+
+#ifdef SUBCORE
+#error "Core selection is wrong!!"
+#endif
+
+#include <MP.h>
+#include <MPScheduler.h>
+
+#define SUBCORE_NUM  4
+#define DEPTH        4
+#define FFTLEN       1024
+#define CHNUM        4
+#define BLOCKS       32
+
+#define JOB_FFT      1
+
+#define MSGID_SHM    10
+
+MPDoorbell doorbell[SUBCORE_NUM] = { 1, 2, 3, 4 };
+MPScheduler<SUBCORE_NUM, DEPTH> scheduler;
+
+/* Interleaved 4ch PCM as captured by the AudioFFT example */
+static int16_t pcm[BLOCKS][FFTLEN * CHNUM];
+
+/* Peak frequency of each channel of each block */
+static float peak[BLOCKS][CHNUM];
+
+static void fill_pcm()
+{
+  for (int b = 0; b < BLOCKS; b++) {
+    for (int i = 0; i < FFTLEN; i++) {
+      for (int ch = 0; ch < CHNUM; ch++) {
+        float freq = 1000.0f * (ch + 1);
+        pcm[b][i * CHNUM + ch] = (int16_t)(16000.0f * sinf(2.0f * PI * freq * i / 48000.0f));
+      }
+    }
+  }
+}
+
+/* Run all blocks and return the elapsed time [usec] */
+static uint32_t measure(int cores)
+{
+  MPFuture future[BLOCKS * CHNUM];
+  int submitted = 0;
+  int collected = 0;
+
+  scheduler.setWorkers(cores);
+
+  uint32_t start = micros();
+  while (collected < BLOCKS * CHNUM) {
+    while (submitted < BLOCKS * CHNUM) {
+      int b = submitted / CHNUM;
+      int ch = submitted % CHNUM;
+      future[submitted] = scheduler.submit(JOB_FFT, MP.Virt2Phys(pcm[b]), ch, CHNUM,
+                                           MP.Virt2Phys(&peak[b][ch]));
+      if (!future[submitted].valid()) {
+        break;
+      }
+      submitted++;
+    }
+    scheduler.wait(future[collected++]);
+  }
+  return micros() - start;
+}
+
+void setup()
+{
+  int ret;
+
+  Serial.begin(115200);
+  while (!Serial);
+
+  /* Boot SubCores */
+  for (int subid = 1; subid <= SUBCORE_NUM; subid++) {
+    ret = MP.begin(subid);
+    if (ret < 0) {
+      printf("MP.begin(%d) error = %d\n", subid, ret);
+      return;
+    }
+  }
+
+  void *shm = MP.AllocSharedMemory(scheduler.sharedSize());
+  if (!shm) {
+    printf("Error: out of memory\n");
+    return;
+  }
+
+  /* Idle SubCores steal jobs from the busy ones */
+  ret = scheduler.begin(shm, doorbell, SUBCORE_NUM, true);
+  if (ret < 0) {
+    printf("scheduler.begin error = %d\n", ret);
+    return;
+  }
+
+  /* Tell SubCores where the scheduler is */
+  for (int subid = 1; subid <= SUBCORE_NUM; subid++) {
+    MP.Send(MSGID_SHM, shm, subid);
+  }
+
+  fill_pcm();
+
+  /* Warm up */
+  measure(SUBCORE_NUM);
+
+  uint32_t base = 0;
+  printf("cores,usec,speedup\n");
+  for (int cores = 1; cores <= SUBCORE_NUM; cores++) {
+    uint32_t usec = measure(cores);
+    if (cores == 1) {
+      base = usec;
+    }
+    printf("%d,%ld,%.2f\n", cores, usec, (float)base / usec);
+  }
+
+  printf("peak: %8.3f %8.3f %8.3f %8.3f\n", peak[0][0], peak[0][1], peak[0][2], peak[0][3]);
+  for (int subid = 1; subid <= SUBCORE_NUM; subid++) {
+    printf("Sub%d executed %ld stolen %ld\n", subid,
+           scheduler.executed(subid), scheduler.stolen(subid));
+  }
+}
+
+void loop()
+{
+}
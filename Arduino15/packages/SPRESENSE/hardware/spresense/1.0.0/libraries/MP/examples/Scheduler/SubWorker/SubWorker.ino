@@ -0,0 +1,98 @@
+/*
+ *  SubWorker.ino - MP Example to distribute FFT jobs to SubCores
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef SUBCORE
+#error "Core selection is wrong!!"
+#endif
+
+#include <MP.h>
+#include <MPScheduler.h>
+
+/* Use CMSIS library */
+#define ARM_MATH_CM4
+#define __FPU_PRESENT 1U
+#include <arm_math.h>
+
+#define SUBCORE_NUM  4
+#define DEPTH        4
+#define FFTLEN       1024
+
+#define JOB_FFT      1
+
+MPDoorbell doorbell;
+MPMutex mutex(MP_MUTEX_ID10);
+MPWorker<SUBCORE_NUM, DEPTH> worker;
+
+arm_rfft_fast_instance_f32 S;
+
+float pSrc[FFTLEN];
+float tmpBuf[FFTLEN];
+float pDst[FFTLEN / 2];
+
+/* arg: interleaved PCM, channel, number of channels, peak output */
+int32_t fft_job(const MPJob &job)
+{
+  int16_t *pcm = (int16_t *)job.arg[0];
+  int ch = job.arg[1];
+  int chnum = job.arg[2];
+  float *peak = (float *)job.arg[3];
+
+  for (int i = 0; i < FFTLEN; i++) {
+    pSrc[i] = pcm[i * chnum + ch] / 32768.0f;
+  }
+
+  arm_rfft_fast_f32(&S, pSrc, tmpBuf, 0);
+  arm_cmplx_mag_f32(&tmpBuf[2], &pDst[1], FFTLEN / 2 - 1);
+  pDst[0] = tmpBuf[0];
+
+  uint32_t index;
+  float maxValue;
+  arm_max_f32(&pDst[1], FFTLEN / 2 - 2, &maxValue, &index);
+  index++;
+
+  float delta = 0.5 * (pDst[index - 1] - pDst[index + 1])
+    / (pDst[index - 1] + pDst[index + 1] - (2.0f * pDst[index]));
+  *peak = (index + delta) * 48000.0f / FFTLEN;
+
+  return 0;
+}
+
+void setup()
+{
+  int8_t msgid;
+  void *shm;
+
+  MP.begin();
+
+  arm_rfft_1024_fast_init_f32(&S);
+
+  /* Receive the scheduler address from MainCore */
+  MP.RecvTimeout(MP_RECV_BLOCKING);
+  MP.Recv(&msgid, &shm);
+
+  if (worker.attach(shm, doorbell, SUBCORE, &mutex) < 0) {
+    MPLog("worker.attach error\n");
+  }
+  worker.handle(JOB_FFT, fft_job);
+}
+
+void loop()
+{
+  worker.run();
+}
@@ -0,0 +1,201 @@
+/*
+ *  SchedulerThreads.ino - Test of MP Scheduler with threads
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Worker threads run jobs submitted through MPScheduler with
+ * MPThreadDoorbell and MPSpinLock. The scheduler code is the same as
+ * between cores, so this sketch checks job distribution, results and
+ * work stealing, and prints the speedup vs. the number of workers.
+ * The same source builds on a PC with -DMP_CHANNEL_HOST and -pthread,
+ * where the workers run in parallel.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <MPScheduler.h>
+
+#define WORKERS  4
+#define DEPTH    8
+#define JOBS     400
+#define SAMPLES  256
+
+#define JOB_DFT  1
+#define JOB_QUIT 2
+
+typedef MPScheduler<WORKERS, DEPTH, MPThreadDoorbell, MPSpinLock> Scheduler;
+typedef MPWorker<WORKERS, DEPTH, MPThreadDoorbell, MPSpinLock> Worker;
+
+static void *shm;
+
+static MPThreadDoorbell main_bell[WORKERS];
+static MPThreadDoorbell worker_bell[WORKERS];
+static MPSpinLock lock;
+static Scheduler scheduler;
+static Worker worker[WORKERS];
+static volatile bool quit[WORKERS];
+
+static float input[JOBS][SAMPLES];
+
+/* The peak bin of a naive DFT, as a stand-in for the AudioFFT workload */
+static int32_t dft_peak(const MPJob &job)
+{
+  /* Pass an index, as pointers of a PC do not fit in 32bit */
+  const float *x = input[job.arg[0]];
+  float max = 0.0f;
+  int32_t peak = 0;
+
+  for (int k = 1; k < SAMPLES / 2; k++) {
+    float re = 0.0f;
+    float im = 0.0f;
+    for (int n = 0; n < SAMPLES; n++) {
+      float t = 2.0f * (float)M_PI * k * n / SAMPLES;
+      re += x[n] * cosf(t);
+      im -= x[n] * sinf(t);
+    }
+    float p = re * re + im * im;
+    if (p > max) {
+      max = p;
+      peak = k;
+    }
+  }
+  return peak;
+}
+
+static int32_t stop(const MPJob &job)
+{
+  quit[job.arg[0]] = true;
+  return 0;
+}
+
+static void *worker_main(void *arg)
+{
+  int id = (int)(intptr_t)arg;
+
+  while (!quit[id]) {
+    worker[id].run(MP_RECV_BLOCKING);
+  }
+  return NULL;
+}
+
+/* Run all jobs with the workers and return the elapsed time [msec] */
+static double measure(int workers, bool stealing, int *errors, uint32_t *stolen)
+{
+  pthread_t thread[WORKERS];
+  MPFuture  future[JOBS];
+  struct timespec t0, t1;
+
+  scheduler.begin(shm, main_bell, workers, stealing);
+  for (int i = 0; i < WORKERS; i++) {
+    quit[i] = false;
+    worker[i].attach(shm, worker_bell[i], i + 1, &lock);
+    worker[i].handle(JOB_DFT, dft_peak);
+    worker[i].handle(JOB_QUIT, stop);
+    pthread_create(&thread[i], NULL, worker_main, (void *)(intptr_t)i);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+
+  int submitted = 0;
+  int collected = 0;
+  while (collected < JOBS) {
+    /* Keep the queues filled */
+    while (submitted < JOBS) {
+      future[submitted] = scheduler.submit(JOB_DFT, submitted);
+      if (!future[submitted].valid()) {
+        break;
+      }
+      submitted++;
+    }
+
+    int32_t result = -1;
+    if (scheduler.wait(future[collected], &result) < 0) {
+      (*errors)++;
+    }
+    /* Job n has a tone at the bin (n % 100) + 10 */
+    if (result != (collected % 100) + 10) {
+      (*errors)++;
+    }
+    collected++;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  *stolen = 0;
+  for (int i = 0; i < WORKERS; i++) {
+    *stolen += scheduler.stolen(i + 1);
+    MPFuture f = scheduler.submit(JOB_QUIT, i, 0, 0, 0, i + 1, true);
+    scheduler.wait(f);
+    pthread_join(thread[i], NULL);
+  }
+
+  return (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1000000.0;
+}
+
+void setup()
+{
+  int errors = 0;
+  double base = 0.0;
+
+  shm = malloc(Scheduler::sharedSize());
+  if (!shm) {
+    printf("Error: out of memory\n");
+    return;
+  }
+
+  for (int i = 0; i < WORKERS; i++) {
+    main_bell[i].connect(&worker_bell[i]);
+  }
+
+  for (int j = 0; j < JOBS; j++) {
+    int bin = (j % 100) + 10;
+    for (int n = 0; n < SAMPLES; n++) {
+      input[j][n] = sinf(2.0f * (float)M_PI * bin * n / SAMPLES) +
+                    0.1f * sinf(2.0f * (float)M_PI * 3 * n / SAMPLES);
+    }
+  }
+
+  printf("workers,stealing,msec,speedup,stolen\n");
+  for (int s = 0; s < 2; s++) {
+    for (int w = 1; w <= WORKERS; w++) {
+      uint32_t stolen;
+      double msec = measure(w, s, &errors, &stolen);
+      if ((w == 1) && (s == 0)) {
+        base = msec;
+      }
+      printf("%d,%d,%.1f,%.2f,%u\n", w, s, msec, base / msec, (unsigned)stolen);
+    }
+  }
+
+  printf("Result: %s (errors %d)\n", (errors == 0) ? "PASS" : "FAIL", errors);
+}
+
+void loop()
+{
+}
+
+#ifdef MP_CHANNEL_HOST
+int main()
+{
+  setup();
+  return 0;
+}
+#endif
@@ -29,6 +29,7 @@
 #include <armv7-m/nvic.h>
 #include <assert.h>
 #include <nuttx/arch.h>
+#include <nuttx/irq.h>
 #include "MP.h"
 
 /****************************************************************************
@@ -42,6 +43,30 @@
 #define SET_CPU(subid, cpu) (((cpu) & 7) << ((subid) * 3))
 #define CLR_CPU(subid)      (7 << ((subid) * 3))
 
+/* The statistics are updated by the threads calling Send()/Recv(), so the
+ * updates are done in a critical section. They are only updated after
+ * EnableStat(true), so that Send() and Recv() do not pay for them by
+ * default.
+ */
+
+#define STAT_LOCK()   irqstate_t statflags = enter_critical_section()
+#define STAT_UNLOCK() leave_critical_section(statflags)
+
+/* The coalesced messages can be sent and flushed by several threads, so
+ * the lookup, the append and the flush of the pending list are done in
+ * one critical section.
+ */
+
+#define PEND_LOCK()   irqstate_t pendflags = enter_critical_section()
+#define PEND_UNLOCK() leave_critical_section(pendflags)
+
+#define IS_COALESCED(msgid, subid) \
+  (_coalesce[subid][(msgid) / 32] & (1u << ((msgid) % 32)))
+
+/* count of a batch block taken by a sender and not posted yet */
+
+#define BATCH_CLAIMED 0xffffffffu
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -52,9 +77,16 @@ MPClass MP;
  * Public Functions
  ****************************************************************************/
 
-MPClass::MPClass() : _recvTimeout(MP_RECV_BLOCKING)
+MPClass::MPClass() : _recvTimeout(MP_RECV_BLOCKING), _statEnable(false)
 {
   memset(_mq, 0, sizeof(_mq));
+  memset(_coalesce, 0, sizeof(_coalesce));
+  memset(_pendnum, 0, sizeof(_pendnum));
+  memset(_txbatch, 0, sizeof(_txbatch));
+  memset(_rxbatch, 0, sizeof(_rxbatch));
+  memset(_rxpos, 0, sizeof(_rxpos));
+  memset(_stat, 0, sizeof(_stat));
+  memset(_rttWait, 0, sizeof(_rttWait));
   _rmng = (struct ResourceManagement*)BACKUP_MEM;
 #ifndef SUBCORE
   memset(_rmng, 0, sizeof(ResourceManagement));
@@ -133,40 +165,220 @@ int MPClass::Send(int8_t msgid, uint32_t msgdata, int subid)
     return ret;
   }
 
-  /* msgid must be 0 or positive value */
-  assert(0 <= msgid);
+  /* msgid must be 0 or positive value, and not the batch message */
+  assert((0 <= msgid) && (msgid < MP_BATCH_MSGID));
 
-  ret = mpmq_send(&_mq[subid], msgid, msgdata);
+  return send(msgid, msgdata, subid);
+}
 
-  if (ret < 0){
-    MPDBG("mpmq_send() failure. %d\n", ret);
+int MPClass::Recv(int8_t *msgid, uint32_t *msgdata, int subid)
+{
+  int ret;
+
+  ret = checkid(subid);
+  if (ret) {
     return ret;
   }
 
+  ret = recv(msgid, msgdata, subid, _recvTimeout);
+
+  if (ret < 0) {
+    //MPDBG("mpmq_timedreceive() failure. %d\n", ret);
+    return ret;
+  }
+
+  received(subid, 1);
+
   return ret;
 }
 
-int MPClass::Recv(int8_t *msgid, uint32_t *msgdata, int subid)
+// send/receive multiple messages
+int MPClass::SendBatch(const int8_t *msgid, const uint32_t *msgdata, int num, int subid)
 {
   int ret;
+  int i;
+  int first = 0;
+  int n = 0;
+  batch_block *blk = NULL;
 
   ret = checkid(subid);
   if (ret) {
     return ret;
   }
 
-  ret = mpmq_timedreceive(&_mq[subid], msgdata, _recvTimeout);
+  for (i = 0; i < num; i++) {
+    /* msgid must be 0 or positive value, and not the batch message */
+    assert((0 <= msgid[i]) && (msgid[i] < MP_BATCH_MSGID));
+
+    if (IS_COALESCED(msgid[i], subid)) {
+      ret = send(msgid[i], msgdata[i], subid);
+      if (ret < 0) {
+        break;
+      }
+      continue;
+    }
+
+    if (!blk) {
+      blk = claim(subid);
+      first = i;
+      n = 0;
+    }
+
+    if (!blk) {
+      /* All the blocks are in flight, so send it alone. The order is kept,
+       * because the receiver takes all of a block before the next message.
+       */
+      ret = send(msgid[i], msgdata[i], subid);
+      if (ret < 0) {
+        break;
+      }
+      continue;
+    }
+
+    blk->msg[n].msgid = msgid[i];
+    blk->msg[n].msgdata = msgdata[i];
+    n++;
+
+    if (n == MP_BATCH_MAX) {
+      ret = post(blk, n, subid);
+      blk = NULL;
+      if (ret < 0) {
+        i = first;
+        break;
+      }
+    }
+  }
+
+  if (blk) {
+    ret = post(blk, n, subid);
+    if (ret < 0) {
+      i = first;
+    }
+  }
 
   if (ret < 0) {
-    //MPDBG("mpmq_timedreceive() failure. %d\n", ret);
+    return (i > 0) ? i : ret;
+  }
+
+  return num;
+}
+
+int MPClass::RecvBatch(int8_t *msgid, uint32_t *msgdata, int num, int subid)
+{
+  int ret;
+  int i;
+
+  ret = checkid(subid);
+  if (ret) {
     return ret;
   }
 
-  *msgid = (int8_t)ret;
+  if (num <= 0) {
+    return -EINVAL;
+  }
+
+  /* Wait for the first message only */
+  ret = recv(&msgid[0], &msgdata[0], subid, _recvTimeout);
+  if (ret < 0) {
+    return ret;
+  }
+
+  /* Take the rest of the batch and the messages already queued */
+  for (i = 1; i < num; i++) {
+    ret = recv(&msgid[i], &msgdata[i], subid, MP_RECV_POLLING);
+    if (ret < 0) {
+      break;
+    }
+  }
+
+  received(subid, i);
+
+  if (_statEnable) {
+    STAT_LOCK();
+    if (_stat[subid].maxBatch < (uint32_t)i) {
+      _stat[subid].maxBatch = i;
+    }
+    STAT_UNLOCK();
+  }
+
+  return i;
+}
+
+// coalesce messages
+int MPClass::Coalesce(int8_t msgid, bool enable, int subid)
+{
+  int ret;
+
+  ret = checkid(subid);
+  if (ret) {
+    return ret;
+  }
+
+  if ((msgid < 0) || (MP_BATCH_MSGID <= msgid)) {
+    return -EINVAL;
+  }
+
+  PEND_LOCK();
+  if (enable) {
+    _coalesce[subid][msgid / 32] |= (1u << (msgid % 32));
+    ret = 0;
+  } else {
+    _coalesce[subid][msgid / 32] &= ~(1u << (msgid % 32));
+    ret = flush(subid);
+  }
+  PEND_UNLOCK();
+
+  return (ret < 0) ? ret : 0;
+}
+
+int MPClass::Flush(int subid)
+{
+  int ret;
+
+  ret = checkid(subid);
+  if (ret) {
+    return ret;
+  }
+
+  PEND_LOCK();
+  ret = flush(subid);
+  PEND_UNLOCK();
 
   return ret;
 }
 
+// statistics
+int MPClass::GetStat(MPStat &stat, int subid)
+{
+  if ((subid < 0) || (MP_MAX_SUBID <= subid)) {
+    return -EINVAL;
+  }
+
+  STAT_LOCK();
+  stat = _stat[subid];
+  stat.pending = _pendnum[subid];
+  STAT_UNLOCK();
+
+  return 0;
+}
+
+void MPClass::EnableStat(bool enable)
+{
+  _statEnable = enable;
+}
+
+void MPClass::ClearStat(int subid)
+{
+  if ((subid < 0) || (MP_MAX_SUBID <= subid)) {
+    return;
+  }
+
+  STAT_LOCK();
+  memset(&_stat[subid], 0, sizeof(MPStat));
+  _rttWait[subid] = false;
+  STAT_UNLOCK();
+}
+
 // send/receive message address
 int MPClass::Send(int8_t msgid, void *msgaddr, int subid)
 {
@@ -343,6 +555,243 @@ void MPClass::FreeSharedMemory(void *addr)
  * Private Functions
  ****************************************************************************/
 
+int MPClass::send(int8_t msgid, uint32_t msgdata, int subid)
+{
+  int ret;
+
+  if (IS_COALESCED(msgid, subid)) {
+    PEND_LOCK();
+
+    /* Check again, Coalesce() may have disabled it meanwhile */
+    if (IS_COALESCED(msgid, subid)) {
+      ret = pend(msgid, msgdata, subid);
+      PEND_UNLOCK();
+      return ret;
+    }
+
+    PEND_UNLOCK();
+  }
+
+  ret = mpmq_send(&_mq[subid], msgid, msgdata);
+
+  if (ret < 0) {
+    MPDBG("mpmq_send() failure. %d\n", ret);
+    dropped(subid, 1);
+    return ret;
+  }
+
+  transmitted(subid, 1);
+
+  return ret;
+}
+
+/* Called with PEND_LOCK() */
+int MPClass::pend(int8_t msgid, uint32_t msgdata, int subid)
+{
+  int ret;
+  int i;
+
+  /* Overwrite the pending message of the same ID */
+  for (i = 0; i < _pendnum[subid]; i++) {
+    if (_pending[subid][i].msgid == msgid) {
+      _pending[subid][i].msgdata = msgdata;
+      if (_statEnable) {
+        _stat[subid].coalesced++;
+      }
+      return 0;
+    }
+  }
+
+  if (_pendnum[subid] == MP_COALESCE_MAX) {
+    ret = flush(subid);
+    if (_pendnum[subid] == MP_COALESCE_MAX) {
+      return ret;
+    }
+  }
+
+  _pending[subid][_pendnum[subid]].msgid = msgid;
+  _pending[subid][_pendnum[subid]].msgdata = msgdata;
+  _pendnum[subid]++;
+  return 0;
+}
+
+/* Called with PEND_LOCK(). The messages which could not be sent stay
+ * pending for the next flush.
+ */
+int MPClass::flush(int subid)
+{
+  int ret;
+  int i;
+  int num = _pendnum[subid];
+
+  for (i = 0; i < num; i++) {
+    ret = mpmq_send(&_mq[subid], _pending[subid][i].msgid, _pending[subid][i].msgdata);
+    if (ret < 0) {
+      MPDBG("mpmq_send() failure. %d\n", ret);
+      break;
+    }
+  }
+
+  if (i < num) {
+    memmove(&_pending[subid][0], &_pending[subid][i], (num - i) * sizeof(pending_msg));
+  }
+  _pendnum[subid] = num - i;
+
+  transmitted(subid, i);
+
+  return (i < num) ? ret : num;
+}
+
+/* Take a free batch block of the destination. The blocks are allocated on
+ * the first use, in the memory of this core. The other core reads them
+ * by the physical address, as RecvObject() does.
+ */
+MPClass::batch_block *MPClass::claim(int subid)
+{
+  batch_block *blocks = __atomic_load_n(&_txbatch[subid], __ATOMIC_ACQUIRE);
+  int i;
+
+  if (!blocks) {
+    batch_block *alloc = (batch_block *)calloc(MP_BATCH_BLOCKS, sizeof(batch_block));
+    if (!alloc) {
+      return NULL;
+    }
+    if (__atomic_compare_exchange_n(&_txbatch[subid], &blocks, alloc, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      blocks = alloc;
+    } else {
+      free(alloc);
+    }
+  }
+
+  for (i = 0; i < MP_BATCH_BLOCKS; i++) {
+    uint32_t expected = 0;
+    if (__atomic_compare_exchange_n(&blocks[i].count, &expected, BATCH_CLAIMED, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      return &blocks[i];
+    }
+  }
+
+  return NULL;
+}
+
+/* Pass num messages in the block to the other core with one message */
+int MPClass::post(batch_block *blk, int num, int subid)
+{
+  int ret;
+
+  __atomic_store_n(&blk->count, (uint32_t)num, __ATOMIC_RELEASE);
+
+  ret = mpmq_send(&_mq[subid], MP_BATCH_MSGID, Virt2Phys(blk));
+
+  if (ret < 0) {
+    MPDBG("mpmq_send() failure. %d\n", ret);
+    __atomic_store_n(&blk->count, 0, __ATOMIC_RELEASE);
+    dropped(subid, num);
+    return ret;
+  }
+
+  transmitted(subid, num);
+
+  return num;
+}
+
+/* Take the next message, from the batch block being received first */
+int MPClass::recv(int8_t *msgid, uint32_t *msgdata, int subid, uint32_t timeout)
+{
+  int ret;
+
+  for (;;) {
+    batch_block *blk = _rxbatch[subid];
+
+    if (blk) {
+      int pos = _rxpos[subid];
+
+      *msgid = blk->msg[pos].msgid;
+      *msgdata = blk->msg[pos].msgdata;
+
+      if (++pos < (int)blk->count) {
+        _rxpos[subid] = pos;
+      } else {
+        /* Give the block back to the sender */
+        _rxbatch[subid] = NULL;
+        __atomic_store_n(&blk->count, 0, __ATOMIC_RELEASE);
+      }
+      return *msgid;
+    }
+
+    ret = mpmq_timedreceive(&_mq[subid], msgdata, timeout);
+    if (ret < 0) {
+      return ret;
+    }
+
+    if (ret != MP_BATCH_MSGID) {
+      *msgid = (int8_t)ret;
+      return ret;
+    }
+
+    blk = (batch_block *)*msgdata;
+    if (__atomic_load_n(&blk->count, __ATOMIC_ACQUIRE) > 0) {
+      _rxbatch[subid] = blk;
+      _rxpos[subid] = 0;
+    }
+  }
+}
+
+void MPClass::transmitted(int subid, int num)
+{
+  if (!_statEnable) {
+    return;
+  }
+
+  STAT_LOCK();
+  _stat[subid].sent += num;
+  if ((num > 0) && !_rttWait[subid]) {
+    _rttStart[subid] = micros();
+    _rttWait[subid] = true;
+  }
+  STAT_UNLOCK();
+}
+
+void MPClass::dropped(int subid, int num)
+{
+  if (!_statEnable) {
+    return;
+  }
+
+  STAT_LOCK();
+  _stat[subid].dropped += num;
+  STAT_UNLOCK();
+}
+
+void MPClass::received(int subid, int num)
+{
+  if (!_statEnable) {
+    return;
+  }
+
+  STAT_LOCK();
+
+  _stat[subid].received += num;
+
+  if (_rttWait[subid]) {
+    uint32_t rtt = micros() - _rttStart[subid];
+    MPStat *st = &_stat[subid];
+
+    if ((st->rttCount == 0) || (rtt < st->rttMin)) {
+      st->rttMin = rtt;
+    }
+    if (rtt > st->rttMax) {
+      st->rttMax = rtt;
+    }
+    st->rttTotal += rtt;
+    st->rttCount++;
+    _rttWait[subid] = false;
+  }
+
+  STAT_UNLOCK();
+}
+
 #ifdef SUBCORE
 int MPClass::checkid(int subid)
 {
@@ -453,6 +902,13 @@ int MPClass::unload(int subid)
   mpmq_destroy(&_mq[subid]);
   memset(&_mq[subid], 0, sizeof(mpmq_t));
 
+  /* Forget the batches in flight with the SubCore */
+
+  _rxbatch[subid] = NULL;
+  if (_txbatch[subid]) {
+    memset(_txbatch[subid], 0, MP_BATCH_BLOCKS * sizeof(batch_block));
+  }
+
   /* Unregister cpuid assignment */
 
   _rmng->cpu_assign &= ~CLR_CPU(subid);
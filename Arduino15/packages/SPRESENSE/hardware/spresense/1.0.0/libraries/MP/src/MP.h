@@ -73,6 +73,17 @@
 
 #define MP_MAX_SUBID 6
 
+#define MP_MAX_MSGID        (128)
+#define MP_COALESCE_MAX     (8)
+
+/* SendBatch() passes up to MP_BATCH_MAX messages with one message of
+ * MP_BATCH_MSGID, so this ID is reserved. MP_BATCH_BLOCKS batches can be
+ * in flight to each core.
+ */
+#define MP_BATCH_MSGID      (127)
+#define MP_BATCH_MAX        (32)
+#define MP_BATCH_BLOCKS     (2)
+
 /* MP Log utility */
 #if   (SUBCORE == 1)
 #define MPLOG_PREFIX "[Sub1] "
@@ -95,6 +106,29 @@
     printunlock(flags); \
 } while (0)
 
+/****************************************************************************
+ * Type Definitions
+ ****************************************************************************/
+
+/**
+ * @struct MPStat
+ * @brief Statistics of the communication with one of the other processors
+ */
+struct MPStat {
+  uint32_t sent;      /**< Number of messages sent to the queue */
+  uint32_t received;  /**< Number of messages received */
+  uint32_t coalesced; /**< Number of notifications merged into a pending one */
+  uint32_t dropped;   /**< Number of messages failed to send */
+  uint32_t pending;   /**< Number of notifications waiting for Flush() */
+  uint32_t maxBatch;  /**< Largest number of messages taken by one RecvBatch().
+                           The mailbox has no depth count, so this is the
+                           deepest backlog seen by the receiver. */
+  uint32_t rttCount;  /**< Number of round-trip samples */
+  uint32_t rttMin;    /**< Minimum round-trip time [usec] */
+  uint32_t rttMax;    /**< Maximum round-trip time [usec] */
+  uint32_t rttTotal;  /**< Sum of round-trip time [usec] */
+};
+
 /****************************************************************************
  * class declaration
  ****************************************************************************/
@@ -144,7 +178,7 @@ public:
 
   /**
    * @brief Send any 32bit-data to the other processor
-   * @param [in] msgid - user-defined message ID (0~127)
+   * @param [in] msgid - user-defined message ID (0~126)
    *                     It must be zero or positive value.
    * @param [in] msgdata - user-defined message data (32bit)
    * @param [in] subid - SubCore number(1~5) to send any message.
@@ -178,7 +212,7 @@ public:
 
   /**
    * @brief Send the address of any message to the other processor
-   * @param [in] msgid - user-defined message ID (0~127)
+   * @param [in] msgid - user-defined message ID (0~126)
    *                     It must be zero or positive value.
    * @param [in] msgaddr - pointer to user-defined message address
    * @param [in] subid - SubCore number(1~5) to send any message.
@@ -218,7 +252,7 @@ public:
    * @return error code. It returns minus value on failure.
    * @retval -22(-EINVAL) Invalid argument
    * @retval -19(-ENODEV) No such SubCore program
-   * @details The size of object must be 128 bytes or less.
+   * @details The size of object must be 126 bytes or less.
    */
 #ifdef SUBCORE
   template <typename T> int SendObject(T &t, int subid = 0);
@@ -235,7 +269,7 @@ public:
    * @retval -22(-EINVAL) Invalid argument
    * @retval -19(-ENODEV) No such SubCore program
    * @retval -116(-ETIMEDOUT) Timeout to receive from other core
-   * @details The size of object must be 128 bytes or less.
+   * @details The size of object must be 126 bytes or less.
    */
 #ifdef SUBCORE
   template <typename T> int RecvObject(T &t, int subid = 0);
@@ -259,6 +293,126 @@ public:
   int SendWaitComplete(int subid);
 #endif
 
+  /**
+   * @brief Send multiple 32bit-data to the other processor
+   * @param [in] msgid - array of user-defined message ID (0~126)
+   * @param [in] msgdata - array of user-defined message data (32bit)
+   * @param [in] num - number of messages
+   * @param [in] subid - SubCore number(1~5) to send any message.
+   *                     If core is SubCore, send to MainCore by default.
+   * @return number of messages sent, or error code on failure of the first
+   * @retval -22(-EINVAL) Invalid argument
+   * @retval -19(-ENODEV) No such SubCore program
+   * @details Up to MP_BATCH_MAX messages are copied to a block in the memory
+   *          of this core, and the other core is notified of the block with
+   *          one message. Recv() and RecvBatch() on the other core take the
+   *          messages from the block in order. When MP_BATCH_BLOCKS blocks
+   *          are not taken yet, the messages are sent one by one instead.
+   *          Messages enabled by Coalesce() are merged as Send().
+   */
+#ifdef SUBCORE
+  int SendBatch(const int8_t *msgid, const uint32_t *msgdata, int num, int subid = 0);
+#else
+  int SendBatch(const int8_t *msgid, const uint32_t *msgdata, int num, int subid);
+#endif
+
+  /**
+   * @brief Receive multiple 32bit-data from the other processor
+   * @param [out] msgid - array of user-defined message ID
+   * @param [out] msgdata - array of user-defined message data (32bit)
+   * @param [in] num - maximum number of messages
+   * @param [in] subid - SubCore number(1~5) to receive any message.
+   *                     If core is SubCore, receive from MainCore by default.
+   * @return number of messages received or error code on failure
+   * @retval -22(-EINVAL) Invalid argument
+   * @retval -19(-ENODEV) No such SubCore program
+   * @retval -116(-ETIMEDOUT) Timeout to receive from other core
+   * @details The first message is waited for with the timeout of
+   *          RecvTimeout(), and then the rest of its batch and the messages
+   *          already queued are taken without blocking.
+   */
+#ifdef SUBCORE
+  int RecvBatch(int8_t *msgid, uint32_t *msgdata, int num, int subid = 0);
+#else
+  int RecvBatch(int8_t *msgid, uint32_t *msgdata, int num, int subid);
+#endif
+
+  /**
+   * @brief Enable or disable coalescing of the message ID
+   * @param [in] msgid - user-defined message ID (0~126)
+   * @param [in] enable - true to coalesce, false to send immediately
+   * @param [in] subid - SubCore number(1~5) to send any message.
+   *                     If core is SubCore, send to MainCore by default.
+   * @return error code. It returns minus value on failure.
+   * @retval -22(-EINVAL) Invalid argument
+   * @retval -19(-ENODEV) No such SubCore program
+   * @details While coalescing is enabled, Send() of the message ID only
+   *          records the message, and repeated messages of the same ID
+   *          collapse into one with the latest data. The recorded messages
+   *          are sent by Flush(), or when MP_COALESCE_MAX different IDs are
+   *          pending. The order between different IDs is not kept.
+   *          Disabling sends the pending messages.
+   */
+#ifdef SUBCORE
+  int Coalesce(int8_t msgid, bool enable, int subid = 0);
+#else
+  int Coalesce(int8_t msgid, bool enable, int subid);
+#endif
+
+  /**
+   * @brief Send the pending coalesced messages
+   * @param [in] subid - SubCore number(1~5) to send any message.
+   *                     If core is SubCore, send to MainCore by default.
+   * @return number of messages sent, or error code on failure
+   * @retval -22(-EINVAL) Invalid argument
+   * @retval -19(-ENODEV) No such SubCore program
+   * @details On a failure, the messages not sent stay pending and are sent
+   *          by the next Flush().
+   */
+#ifdef SUBCORE
+  int Flush(int subid = 0);
+#else
+  int Flush(int subid);
+#endif
+
+  /**
+   * @brief Get the statistics of the communication
+   * @param [out] stat - statistics
+   * @param [in] subid - SubCore number(1~5).
+   *                     If core is SubCore, MainCore by default.
+   * @return error code. It returns minus value on failure.
+   * @retval -22(-EINVAL) Invalid argument
+   * @details The statistics are counted after EnableStat(true).
+   *          The round-trip time is measured from the oldest Send() which
+   *          is not answered yet to the next message received from the
+   *          same core, which fits request/response exchanges.
+   */
+#ifdef SUBCORE
+  int GetStat(MPStat &stat, int subid = 0);
+#else
+  int GetStat(MPStat &stat, int subid);
+#endif
+
+  /**
+   * @brief Enable or disable the statistics of the communication
+   * @param [in] enable - true to count the messages and the round-trip time
+   * @details The statistics are disabled by default, so that Send() and
+   *          Recv() neither enter a critical section nor read the timer
+   *          for them.
+   */
+  void EnableStat(bool enable);
+
+  /**
+   * @brief Clear the statistics of the communication
+   * @param [in] subid - SubCore number(1~5).
+   *                     If core is SubCore, MainCore by default.
+   */
+#ifdef SUBCORE
+  void ClearStat(int subid = 0);
+#else
+  void ClearStat(int subid);
+#endif
+
   /**
    * @brief Set timeout of receiver
    * @param [in] timeout - waiting time [msec] for reception.
@@ -327,7 +481,36 @@ private:
     uint32_t resource[4];
   } *_rmng;
 
+  struct pending_msg {
+    int8_t   msgid;
+    uint32_t msgdata;
+  };
+  uint32_t    _coalesce[MP_MAX_SUBID][MP_MAX_MSGID / 32];
+  pending_msg _pending[MP_MAX_SUBID][MP_COALESCE_MAX];
+  int         _pendnum[MP_MAX_SUBID];
+  struct batch_block {
+    volatile uint32_t count; /* Set by the sender, cleared by the receiver */
+    pending_msg       msg[MP_BATCH_MAX];
+  };
+  batch_block *_txbatch[MP_MAX_SUBID]; /* MP_BATCH_BLOCKS blocks to send */
+  batch_block *_rxbatch[MP_MAX_SUBID]; /* Block being received */
+  int          _rxpos[MP_MAX_SUBID];
+
+  bool        _statEnable;
+  MPStat      _stat[MP_MAX_SUBID];
+  uint32_t    _rttStart[MP_MAX_SUBID];
+  bool        _rttWait[MP_MAX_SUBID];
+
   int checkid(int subid);
+  int send(int8_t msgid, uint32_t msgdata, int subid);
+  int pend(int8_t msgid, uint32_t msgdata, int subid);
+  int flush(int subid);
+  batch_block *claim(int subid);
+  int post(batch_block *blk, int num, int subid);
+  int recv(int8_t *msgid, uint32_t *msgdata, int subid, uint32_t timeout);
+  void transmitted(int subid, int num);
+  void dropped(int subid, int num);
+  void received(int subid, int num);
 #ifndef SUBCORE
   mptask_t _mptask[MP_MAX_SUBID];
   int load(int subid);
@@ -355,7 +538,7 @@ template <typename T> int MPClass::SendObject(T &t, int subid)
   }
 
   size_t msgsz = sizeof(T);
-  if (msgsz > 127) {
+  if (msgsz >= MP_BATCH_MSGID) {
     return -EINVAL;
   }
 
@@ -380,7 +563,7 @@ template <typename T> int MPClass::RecvObject(T &t, int subid)
   }
 
   size_t msgsz = sizeof(T);
-  if (msgsz > 127) {
+  if (msgsz >= MP_BATCH_MSGID) {
     return -EINVAL;
   }
 
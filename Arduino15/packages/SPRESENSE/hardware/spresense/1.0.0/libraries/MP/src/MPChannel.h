@@ -0,0 +1,417 @@
+/*
+ *  MPChannel.h - Spresense Arduino Multi-Processer zero-copy channel
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _MPCHANNEL_H_
+#define _MPCHANNEL_H_
+
+/**
+ * @file MPChannel.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Spresense Arduino Multi-Processer zero-copy channel
+ *
+ * @details A typed ring of slots placed in shared memory. The producer
+ *          fills a slot in place and the consumer reads it in place, so
+ *          no data is copied between cores. Messages are sent only to
+ *          wake up a peer that is waiting (doorbell).
+ *
+ *          The channel does not depend on the MP message queue itself.
+ *          Only the doorbell does, so the channel can also connect
+ *          threads with MPThreadDoorbell. Define MP_CHANNEL_HOST to build
+ *          it without the Spresense SDK (e.g. stress test on a PC).
+ */
+
+/**
+ * @defgroup mpchannel MP Channel Library API
+ * @brief MP zero-copy channel API
+ * @{
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <semaphore.h>
+
+#ifndef MP_CHANNEL_HOST
+#include "MP.h"
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef MP_RECV_BLOCKING
+#define MP_RECV_BLOCKING    (0)
+#endif
+#ifndef MP_RECV_POLLING
+#define MP_RECV_POLLING     ((uint32_t)-1)
+#endif
+
+#define MP_CHANNEL_MAGIC    0x4d504348 /* "MPCH" */
+
+/* Default message IDs of doorbells */
+#define MP_CHANNEL_MSGID_DATA  (120)
+#define MP_CHANNEL_MSGID_SLOT  (121)
+
+/****************************************************************************
+ * Doorbells
+ ****************************************************************************/
+
+#ifndef MP_CHANNEL_HOST
+/**
+ * @class MPDoorbell
+ * @brief Doorbell over the MP message queue
+ *
+ * @details Wakes up the other core with MP.Send(). A doorbell uses the
+ *          message queue of the core pair, so other messages must not be
+ *          received from the same core while a channel is waiting.
+ */
+class MPDoorbell
+{
+public:
+  /**
+   * @param [in] subid - SubCore number(1~5) of the other side.
+   *                     If core is SubCore, 0 means MainCore.
+   */
+  MPDoorbell(int subid = 0) : _subid(subid) {}
+
+  int ring(int8_t msgid) {
+    return MP.Send(msgid, (uint32_t)0, _subid);
+  }
+
+  int wait(int8_t /* msgid */, uint32_t timeout) {
+    int8_t   rcvid;
+    uint32_t data;
+    uint32_t saved = MP.GetRecvTimeout();
+
+    MP.RecvTimeout(timeout);
+    int ret = MP.Recv(&rcvid, &data, _subid);
+    MP.RecvTimeout(saved);
+
+    return (ret < 0) ? ret : 0;
+  }
+
+private:
+  int _subid;
+};
+#endif
+
+/**
+ * @class MPThreadDoorbell
+ * @brief Doorbell between threads (on one core, or on a host PC)
+ *
+ * @details Create one doorbell for each side and connect them.
+ */
+class MPThreadDoorbell
+{
+public:
+  MPThreadDoorbell() : _peer(NULL) {
+    sem_init(&_sem, 0, 0);
+  }
+  ~MPThreadDoorbell() {
+    sem_destroy(&_sem);
+  }
+
+  void connect(MPThreadDoorbell *peer) {
+    _peer = peer;
+    peer->_peer = this;
+  }
+
+  int ring(int8_t /* msgid */) {
+    return sem_post(&_peer->_sem);
+  }
+
+  int wait(int8_t /* msgid */, uint32_t timeout) {
+    if (timeout == MP_RECV_BLOCKING) {
+      while (sem_wait(&_sem) < 0) {
+        if (errno != EINTR) return -errno;
+      }
+      return 0;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout / 1000;
+    ts.tv_nsec += (timeout % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000;
+    }
+    while (sem_timedwait(&_sem, &ts) < 0) {
+      if (errno != EINTR) return -errno;
+    }
+    return 0;
+  }
+
+private:
+  sem_t _sem;
+  MPThreadDoorbell *_peer;
+};
+
+/****************************************************************************
+ * class declaration
+ ****************************************************************************/
+
+/**
+ * @class MPChannel
+ * @brief Typed single-producer/single-consumer zero-copy channel
+ *
+ * @details T must be a plain structure because it is shared between
+ *          cores. SLOTS buffers can be in flight at the same time.
+ *          Slots are sent and released in the order they were acquired
+ *          and received.
+ */
+template <typename T, int SLOTS, typename DOORBELL
+#ifndef MP_CHANNEL_HOST
+          = MPDoorbell
+#endif
+          >
+class MPChannel
+{
+public:
+  /**
+   * @brief Size of the shared memory needed by the channel
+   */
+  static size_t sharedSize() {
+    return sizeof(Header) + sizeof(T) * SLOTS;
+  }
+
+  MPChannel() : _shm(NULL), _slot(NULL), _doorbell(NULL), _acquired(0), _received(0),
+                _datamsg(MP_CHANNEL_MSGID_DATA), _slotmsg(MP_CHANNEL_MSGID_SLOT) {}
+
+  /**
+   * @brief Initialize a channel in the shared memory (one side only)
+   * @param [in] shm - address of the shared memory (sharedSize() bytes or more)
+   * @param [in] doorbell - doorbell to the other side (kept referenced)
+   * @return error code. It returns minus value on failure.
+   * @details Pass the same address to attach() on the other side,
+   *          e.g. with MP.Send().
+   */
+  int create(void *shm, DOORBELL &doorbell) {
+    if (!shm) {
+      return -EINVAL;
+    }
+    _shm = (Header *)shm;
+    memset(_shm, 0, sizeof(Header));
+    _shm->slots = SLOTS;
+    _shm->slotsize = sizeof(T);
+    __atomic_store_n(&_shm->magic, MP_CHANNEL_MAGIC, __ATOMIC_RELEASE);
+    return init(doorbell);
+  }
+
+  /**
+   * @brief Attach to a channel created by the other side
+   * @param [in] shm - address given to create()
+   * @param [in] doorbell - doorbell to the other side (kept referenced)
+   * @return error code. It returns minus value on failure.
+   * @retval -22(-EINVAL) Not a channel, or a channel of another type
+   */
+  int attach(void *shm, DOORBELL &doorbell) {
+    if (!shm) {
+      return -EINVAL;
+    }
+    _shm = (Header *)shm;
+    if ((__atomic_load_n(&_shm->magic, __ATOMIC_ACQUIRE) != MP_CHANNEL_MAGIC) ||
+        (_shm->slots != SLOTS) || (_shm->slotsize != sizeof(T))) {
+      _shm = NULL;
+      return -EINVAL;
+    }
+    return init(doorbell);
+  }
+
+  /**
+   * @brief Set message IDs used for doorbells
+   */
+  void setMsgId(int8_t datamsg, int8_t slotmsg) {
+    _datamsg = datamsg;
+    _slotmsg = slotmsg;
+  }
+
+  /*------------------------------------------------------------------*/
+  /* Producer side                                                    */
+  /*------------------------------------------------------------------*/
+
+  /**
+   * @brief Get the next free slot to fill
+   * @param [in] timeout - MP_RECV_BLOCKING, MP_RECV_POLLING or [msec]
+   * @return pointer to the slot. NULL on timeout.
+   */
+  T *acquire(uint32_t timeout = MP_RECV_BLOCKING) {
+    for (;;) {
+      uint32_t tail = load(&_shm->tail);
+      if ((_acquired - tail) < (uint32_t)SLOTS) {
+        return &_slot[(_acquired++) % SLOTS];
+      }
+      if (!wait(&_shm->producer_waiting, &_shm->tail, tail, _slotmsg, timeout)) {
+        return NULL;
+      }
+    }
+  }
+
+  /**
+   * @brief Pass the oldest acquired slot to the consumer
+   * @param [in] slot - the oldest slot returned by acquire()
+   * @return error code. It returns minus value on failure.
+   */
+  int send(T *slot) {
+    uint32_t head = _shm->head;
+    if ((head == _acquired) || (slot != &_slot[head % SLOTS])) {
+      return -EINVAL;
+    }
+    __atomic_store_n(&_shm->head, head + 1, __ATOMIC_SEQ_CST);
+    _shm->sent++;
+    return notify(&_shm->consumer_waiting, _datamsg);
+  }
+
+  /*------------------------------------------------------------------*/
+  /* Consumer side                                                    */
+  /*------------------------------------------------------------------*/
+
+  /**
+   * @brief Get the next filled slot
+   * @param [in] timeout - MP_RECV_BLOCKING, MP_RECV_POLLING or [msec]
+   * @return pointer to the slot. NULL on timeout.
+   */
+  T *receive(uint32_t timeout = MP_RECV_BLOCKING) {
+    for (;;) {
+      uint32_t head = load(&_shm->head);
+      if (_received != head) {
+        return &_slot[(_received++) % SLOTS];
+      }
+      if (!wait(&_shm->consumer_waiting, &_shm->head, head, _datamsg, timeout)) {
+        return NULL;
+      }
+    }
+  }
+
+  /**
+   * @brief Give the oldest received slot back to the producer
+   * @param [in] slot - the oldest slot returned by receive()
+   * @return error code. It returns minus value on failure.
+   */
+  int release(T *slot) {
+    uint32_t tail = _shm->tail;
+    if ((tail == _received) || (slot != &_slot[tail % SLOTS])) {
+      return -EINVAL;
+    }
+    __atomic_store_n(&_shm->tail, tail + 1, __ATOMIC_SEQ_CST);
+    return notify(&_shm->producer_waiting, _slotmsg);
+  }
+
+  /*------------------------------------------------------------------*/
+  /* Status                                                           */
+  /*------------------------------------------------------------------*/
+
+  /**
+   * @brief Number of slots sent and not released yet
+   */
+  int inflight() {
+    return load(&_shm->head) - load(&_shm->tail);
+  }
+
+  /**
+   * @brief Number of doorbells rung on this channel (both directions)
+   */
+  uint32_t doorbells() {
+    return load(&_shm->doorbells);
+  }
+
+  /**
+   * @brief Number of slots sent on this channel
+   */
+  uint32_t sent() {
+    return load(&_shm->sent);
+  }
+
+private:
+  struct Header {
+    volatile uint32_t magic;
+    uint32_t slots;
+    uint32_t slotsize;
+    uint32_t reserved;
+    /* Written by the producer */
+    volatile uint32_t head;
+    volatile uint32_t sent;
+    /* Written by the consumer */
+    volatile uint32_t tail;
+    /* Set by the waiting side, cleared by the notifying side */
+    volatile uint32_t consumer_waiting;
+    volatile uint32_t producer_waiting;
+    volatile uint32_t doorbells;
+  } __attribute__((aligned(8)));
+
+  Header  *_shm;
+  T       *_slot;
+  DOORBELL *_doorbell;
+  uint32_t _acquired; /* producer local */
+  uint32_t _received; /* consumer local */
+  int8_t   _datamsg;
+  int8_t   _slotmsg;
+
+  int init(DOORBELL &doorbell) {
+    _doorbell = &doorbell;
+    _slot = (T *)((uint8_t *)_shm + sizeof(Header));
+    _acquired = load(&_shm->head);
+    _received = load(&_shm->tail);
+    return 0;
+  }
+
+  static uint32_t load(volatile uint32_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+  }
+
+  /* Ring the doorbell only when the other side is waiting */
+  int notify(volatile uint32_t *waiting, int8_t msgid) {
+    if (__atomic_exchange_n(waiting, 0, __ATOMIC_SEQ_CST)) {
+      __atomic_add_fetch(&_shm->doorbells, 1, __ATOMIC_RELAXED);
+      return _doorbell->ring(msgid);
+    }
+    return 0;
+  }
+
+  /* Wait until *index changes from seen. Returns false on timeout. */
+  bool wait(volatile uint32_t *waiting, volatile uint32_t *index, uint32_t seen,
+            int8_t msgid, uint32_t timeout) {
+    if (timeout == MP_RECV_POLLING) {
+      return false;
+    }
+
+    /* Publish the flag before checking again, so that the other side
+     * either sees the flag or this side sees the new index.
+     */
+    __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(index, __ATOMIC_SEQ_CST) != seen) {
+      __atomic_store_n(waiting, 0, __ATOMIC_SEQ_CST);
+      return true;
+    }
+
+    int ret = _doorbell->wait(msgid, timeout);
+    __atomic_store_n(waiting, 0, __ATOMIC_SEQ_CST);
+
+    return (ret == 0) || (__atomic_load_n(index, __ATOMIC_SEQ_CST) != seen);
+  }
+};
+
+/** @} mpchannel */
+
+#endif /* _MPCHANNEL_H_ */
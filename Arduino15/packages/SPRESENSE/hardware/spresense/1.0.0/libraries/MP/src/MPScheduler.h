@@ -0,0 +1,769 @@
+/*
+ *  MPScheduler.h - Spresense Arduino Multi-Processer work distribution
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _MPSCHEDULER_H_
+#define _MPSCHEDULER_H_
+
+/**
+ * @file MPScheduler.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Spresense Arduino Multi-Processer work distribution
+ *
+ * @details MainCore submits jobs to the work queues of SubCores and
+ *          collects the results with futures. A job is a small descriptor
+ *          (type and 4 arguments) placed in shared memory, and each
+ *          SubCore runs the handler registered for the type.
+ *
+ *          Optionally, an idle SubCore steals jobs from the queues of the
+ *          busy ones. Stealing needs a lock shared by all cores (MPMutex),
+ *          because the queues then have more than one consumer.
+ *
+ *          As MPChannel, the doorbell and the lock are template
+ *          parameters, and the scheduler can run on threads with
+ *          MPThreadDoorbell and MPSpinLock. Define MP_CHANNEL_HOST to
+ *          build it without the Spresense SDK.
+ */
+
+/**
+ * @defgroup mpscheduler MP Scheduler Library API
+ * @brief MP work distribution API
+ * @{
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <sched.h>
+#include "MPChannel.h"
+
+#ifndef MP_CHANNEL_HOST
+#include "MPMutex.h"
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MP_SCHED_MAGIC      0x4d505343 /* "MPSC" */
+
+/* Default message ID of doorbells */
+#define MP_SCHED_MSGID_WORK (122)
+
+/* Maximum number of job types a worker can handle */
+#define MP_SCHED_MAX_TYPES  (16)
+
+/* Interval [msec] to look for a thief while MainCore waits for a queued job */
+#define MP_SCHED_WAIT_SLICE (10)
+
+/****************************************************************************
+ * Type Definitions
+ ****************************************************************************/
+
+/**
+ * @struct MPJob
+ * @brief Job descriptor
+ *
+ * @details Pointers in arg must be physical addresses (MP.Virt2Phys()),
+ *          so that the other cores can access them.
+ */
+struct MPJob {
+  uint32_t type;    /**< User-defined job type */
+  uint32_t arg[4];  /**< User-defined arguments */
+  int32_t  result;  /**< Return value of the handler */
+};
+
+/**
+ * @brief Job handler running on a worker
+ * @return result of the job given to the future
+ */
+typedef int32_t (*MPJobHandler)(const MPJob &job);
+
+/**
+ * @class MPFuture
+ * @brief Handle of a submitted job
+ */
+class MPFuture
+{
+public:
+  MPFuture() : _id(-1), _gen(0) {}
+
+  /**
+   * @brief Whether the job was submitted and not collected yet
+   */
+  bool valid() const {
+    return _id >= 0;
+  }
+
+private:
+  template <int, int, typename, typename> friend class MPScheduler;
+  int      _id;
+  uint32_t _gen;
+};
+
+/**
+ * @class MPSpinLock
+ * @brief Lock between threads with the same interface as MPMutex
+ */
+class MPSpinLock
+{
+public:
+  MPSpinLock() : _flag(0) {}
+
+  int Trylock() {
+    return __atomic_test_and_set(&_flag, __ATOMIC_ACQUIRE) ? -EBUSY : 0;
+  }
+  int Unlock() {
+    __atomic_clear(&_flag, __ATOMIC_RELEASE);
+    return 0;
+  }
+
+private:
+  volatile char _flag;
+};
+
+/****************************************************************************
+ * class declaration
+ ****************************************************************************/
+
+/**
+ * @class MPSchedShared
+ * @brief Shared memory layout of MPScheduler and MPWorker
+ */
+template <int WORKERS, int DEPTH> class MPSchedShared
+{
+public:
+  /**
+   * @brief Size of the shared memory needed by the scheduler
+   */
+  static size_t sharedSize() {
+    return sizeof(Shared);
+  }
+
+protected:
+  enum {
+    JOB_FREE = 0,
+    JOB_QUEUED,
+    JOB_DONE,
+    POOL = WORKERS * DEPTH
+  };
+
+  /* Flag of a queue entry which only the owner of the queue can take */
+  static const uint32_t PINNED = 0x80000000u;
+
+  struct Queue {
+    /* Written by MainCore */
+    volatile uint32_t tail;
+    /* Written by the consumers (under the lock if stealing) */
+    volatile uint32_t head;
+    /* Set by the worker, cleared by MainCore */
+    volatile uint32_t waiting;
+    /* Written by the worker */
+    volatile uint32_t executed;
+    volatile uint32_t stolen;
+    uint32_t reserved[3];
+    volatile uint32_t entry[DEPTH];
+  };
+
+  struct Slot {
+    MPJob job;
+    volatile uint32_t state;
+    /* Set by the worker when it takes the job */
+    volatile int32_t  worker;
+    /* Set by MainCore while waiting, cleared by the worker which rings */
+    volatile uint32_t notify;
+  };
+
+  struct Shared {
+    volatile uint32_t magic;
+    uint32_t workers;
+    uint32_t depth;
+    uint32_t stealing;
+    volatile uint32_t active;
+    uint32_t reserved[3];
+    Queue queue[WORKERS];
+    Slot  slot[POOL];
+  } __attribute__((aligned(8)));
+
+  Shared *_shm;
+
+  MPSchedShared() : _shm(NULL) {}
+
+  static uint32_t load(volatile uint32_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+  }
+
+  static void store(volatile uint32_t *p, uint32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+  }
+
+  int queued(int w) {
+    return load(&_shm->queue[w].tail) - load(&_shm->queue[w].head);
+  }
+
+  /* Whether a worker other than the owner can take the next job */
+  bool stealable(int w) {
+    typename MPSchedShared::Queue *q = &_shm->queue[w];
+    uint32_t head = load(&q->head);
+    return (head != load(&q->tail)) && !(q->entry[head % DEPTH] & PINNED);
+  }
+};
+
+/**
+ * @class MPScheduler
+ * @brief Job submitter on MainCore
+ *
+ * @details WORKERS is the maximum number of workers (SubCore 1 to
+ *          WORKERS), and DEPTH is the number of jobs each work queue can
+ *          hold. Up to WORKERS * DEPTH jobs can be in flight.
+ */
+template <int WORKERS, int DEPTH, typename DOORBELL
+#ifndef MP_CHANNEL_HOST
+          = MPDoorbell
+#endif
+          , typename LOCK
+#ifndef MP_CHANNEL_HOST
+          = MPMutex
+#endif
+          >
+class MPScheduler : public MPSchedShared<WORKERS, DEPTH>
+{
+  typedef MPSchedShared<WORKERS, DEPTH> base;
+  using base::_shm;
+  using base::load;
+  using base::store;
+  using base::queued;
+
+public:
+  MPScheduler() : _doorbell(NULL), _freenum(0), _next(0), _msgid(MP_SCHED_MSGID_WORK) {}
+
+  /**
+   * @brief Initialize the scheduler in the shared memory
+   * @param [in] shm - address of the shared memory (sharedSize() bytes or more)
+   * @param [in] doorbell - array of WORKERS doorbells to each worker
+   * @param [in] workers - number of active workers (1~WORKERS)
+   * @param [in] stealing - allow idle workers to steal jobs
+   * @return error code. It returns minus value on failure.
+   * @details Pass the same address to MPWorker::attach() on each worker.
+   */
+  int begin(void *shm, DOORBELL *doorbell, int workers = WORKERS, bool stealing = false) {
+    if (!shm || !doorbell || (workers < 1) || (workers > WORKERS)) {
+      return -EINVAL;
+    }
+    _shm = (typename base::Shared *)shm;
+    _doorbell = doorbell;
+    memset(_shm, 0, sizeof(typename base::Shared));
+    _shm->workers = WORKERS;
+    _shm->depth = DEPTH;
+    _shm->stealing = stealing;
+    _shm->active = workers;
+
+    _freenum = 0;
+    for (int i = base::POOL - 1; i >= 0; i--) {
+      _free[_freenum++] = i;
+      _gen[i] = 0;
+    }
+    _next = 0;
+
+    store(&_shm->magic, MP_SCHED_MAGIC);
+    return 0;
+  }
+
+  /**
+   * @brief Change the number of workers which receive jobs
+   * @param [in] workers - number of active workers (1~WORKERS)
+   */
+  int setWorkers(int workers) {
+    if ((workers < 1) || (workers > WORKERS)) {
+      return -EINVAL;
+    }
+    store(&_shm->active, workers);
+    return 0;
+  }
+
+  /**
+   * @brief Set message ID used for doorbells
+   */
+  void setMsgId(int8_t msgid) {
+    _msgid = msgid;
+  }
+
+  /**
+   * @brief Submit a job
+   * @param [in] job - job descriptor (result is ignored)
+   * @param [in] worker - worker to run the job (1~WORKERS),
+   *                      or 0 to select the least loaded active worker
+   * @param [in] pinned - the job is not stolen by the other workers, e.g.
+   *                      a job to stop the worker
+   * @return future of the job. It is not valid() if no room is left.
+   */
+  MPFuture submit(const MPJob &job, int worker = 0, bool pinned = false) {
+    MPFuture future;
+    int w = (worker > 0) ? (worker - 1) : select();
+
+    if ((_freenum == 0) || (w < 0) || (w >= WORKERS) || (queued(w) >= DEPTH)) {
+      return future;
+    }
+
+    int id = _free[--_freenum];
+    typename base::Slot *slot = &_shm->slot[id];
+    slot->job = job;
+    slot->worker = -1;
+    slot->notify = 0;
+    slot->state = base::JOB_QUEUED;
+    _owner[id] = w;
+
+    typename base::Queue *q = &_shm->queue[w];
+    uint32_t tail = q->tail;
+    q->entry[tail % DEPTH] = id | (pinned ? base::PINNED : 0);
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_SEQ_CST);
+
+    if (!wake(w) && _shm->stealing && !pinned) {
+      /* The worker is busy, so let an idle one steal the job */
+      int active = load(&_shm->active);
+      for (int i = 0; i < active; i++) {
+        if ((i != w) && wake(i)) {
+          break;
+        }
+      }
+    }
+
+    future._id = id;
+    future._gen = _gen[id];
+    return future;
+  }
+
+  /**
+   * @brief Submit a job
+   * @param [in] type - user-defined job type
+   * @param [in] arg0..arg3 - user-defined arguments
+   * @param [in] worker - worker to run the job (1~WORKERS),
+   *                      or 0 to select the least loaded active worker
+   * @param [in] pinned - the job is not stolen by the other workers
+   * @return future of the job. It is not valid() if no room is left.
+   */
+  MPFuture submit(uint32_t type, uint32_t arg0, uint32_t arg1 = 0,
+                  uint32_t arg2 = 0, uint32_t arg3 = 0, int worker = 0,
+                  bool pinned = false) {
+    MPJob job;
+    job.type = type;
+    job.arg[0] = arg0;
+    job.arg[1] = arg1;
+    job.arg[2] = arg2;
+    job.arg[3] = arg3;
+    job.result = 0;
+    return submit(job, worker, pinned);
+  }
+
+  /**
+   * @brief Whether the job is completed
+   */
+  bool ready(const MPFuture &future) {
+    if (!check(future)) {
+      return false;
+    }
+    return load(&_shm->slot[future._id].state) == base::JOB_DONE;
+  }
+
+  /**
+   * @brief Wait for the job and collect the result
+   * @param [in,out] future - future returned by submit(). It becomes
+   *                          invalid when the result is collected.
+   * @param [out] result - result of the job (can be NULL)
+   * @param [in] timeout - MP_RECV_BLOCKING, MP_RECV_POLLING or [msec]
+   * @return error code. It returns minus value on failure.
+   * @retval -22(-EINVAL) Invalid future
+   * @retval -116(-ETIMEDOUT) The job is not completed
+   * @details MainCore sleeps on the doorbell of the worker running the
+   *          job, and the worker rings it when the job is completed.
+   *          While the job is still queued and stealing is enabled,
+   *          MainCore wakes up every MP_SCHED_WAIT_SLICE msec to look for
+   *          the worker which took it.
+   */
+  int wait(MPFuture &future, int32_t *result = NULL, uint32_t timeout = MP_RECV_BLOCKING) {
+    if (!check(future)) {
+      return -EINVAL;
+    }
+
+    typename base::Slot *slot = &_shm->slot[future._id];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (load(&slot->state) != base::JOB_DONE) {
+      if (timeout == MP_RECV_POLLING) {
+        return -ETIMEDOUT;
+      }
+
+      /* Publish the flag before checking again, so that the worker either
+       * sees the flag and rings, or this side sees the completion.
+       */
+      __atomic_store_n(&slot->notify, 1, __ATOMIC_SEQ_CST);
+      if (load(&slot->state) == base::JOB_DONE) {
+        settle(slot);
+        break;
+      }
+
+      int32_t  taken = load((volatile uint32_t *)&slot->worker);
+      int      w = (taken > 0) ? (taken - 1) : _owner[future._id];
+      uint32_t slice = timeout;
+
+      if (timeout != MP_RECV_BLOCKING) {
+        uint32_t spent = elapsed(&start);
+        slice = (spent < timeout) ? (timeout - spent) : 0;
+      }
+      if ((taken <= 0) && _shm->stealing &&
+          ((slice == MP_RECV_BLOCKING) || (slice > MP_SCHED_WAIT_SLICE))) {
+        slice = MP_SCHED_WAIT_SLICE;
+      }
+
+      if ((slice != 0) && (_doorbell[w].wait(_msgid, slice) == 0)) {
+        /* The worker cleared the flag, and the job is done */
+        continue;
+      }
+
+      settle(slot);
+      if ((timeout != MP_RECV_BLOCKING) && (elapsed(&start) >= timeout) &&
+          (load(&slot->state) != base::JOB_DONE)) {
+        return -ETIMEDOUT;
+      }
+    }
+
+    if (result) {
+      *result = slot->job.result;
+    }
+    slot->state = base::JOB_FREE;
+    _gen[future._id]++;
+    _free[_freenum++] = future._id;
+    future._id = -1;
+    return 0;
+  }
+
+  /**
+   * @brief Worker which ran the completed job (1~WORKERS), or -1
+   */
+  int workerOf(const MPFuture &future) {
+    if (!ready(future)) {
+      return -1;
+    }
+    return _shm->slot[future._id].worker;
+  }
+
+  /**
+   * @brief Number of jobs submitted and not collected yet
+   */
+  int inflight() {
+    return base::POOL - _freenum;
+  }
+
+  /**
+   * @brief Number of jobs executed by the worker (1~WORKERS)
+   */
+  uint32_t executed(int worker) {
+    return load(&_shm->queue[worker - 1].executed);
+  }
+
+  /**
+   * @brief Number of jobs the worker (1~WORKERS) stole from the others
+   */
+  uint32_t stolen(int worker) {
+    return load(&_shm->queue[worker - 1].stolen);
+  }
+
+private:
+  DOORBELL *_doorbell;
+  int       _free[base::POOL];
+  uint32_t  _gen[base::POOL];
+  int       _owner[base::POOL];
+  int       _freenum;
+  int       _next;
+  int8_t    _msgid;
+
+  bool check(const MPFuture &future) {
+    return (future._id >= 0) && (future._id < base::POOL) &&
+           (future._gen == _gen[future._id]);
+  }
+
+  /* The least loaded active worker, starting after the last one */
+  int select() {
+    int active = load(&_shm->active);
+    int best = -1;
+    int min = DEPTH;
+
+    for (int i = 0; i < active; i++) {
+      int w = (_next + i) % active;
+      int n = queued(w);
+      if (n < min) {
+        min = n;
+        best = w;
+      }
+    }
+    if (best >= 0) {
+      _next = best + 1;
+    }
+    return best;
+  }
+
+  /* Stop waiting for the job. If the worker has already cleared the flag,
+   * its ring is on the way, so take it not to leave it to the next wait.
+   */
+  void settle(typename base::Slot *slot) {
+    if (__atomic_exchange_n(&slot->notify, 0, __ATOMIC_SEQ_CST) == 0) {
+      _doorbell[slot->worker - 1].wait(_msgid, MP_RECV_BLOCKING);
+    }
+  }
+
+  /* Ring the doorbell only when the worker is waiting */
+  bool wake(int w) {
+    if (__atomic_exchange_n(&_shm->queue[w].waiting, 0, __ATOMIC_SEQ_CST)) {
+      _doorbell[w].ring(_msgid);
+      return true;
+    }
+    return false;
+  }
+
+  static uint32_t elapsed(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000 +
+           (now.tv_nsec - start->tv_nsec) / 1000000;
+  }
+};
+
+/**
+ * @class MPWorker
+ * @brief Job executor on SubCore
+ *
+ * @details The template parameters must be the same as MPScheduler.
+ */
+template <int WORKERS, int DEPTH, typename DOORBELL
+#ifndef MP_CHANNEL_HOST
+          = MPDoorbell
+#endif
+          , typename LOCK
+#ifndef MP_CHANNEL_HOST
+          = MPMutex
+#endif
+          >
+class MPWorker : public MPSchedShared<WORKERS, DEPTH>
+{
+  typedef MPSchedShared<WORKERS, DEPTH> base;
+  using base::_shm;
+  using base::load;
+  using base::store;
+  using base::queued;
+
+public:
+  MPWorker() : _doorbell(NULL), _lock(NULL), _id(-1), _typenum(0),
+               _msgid(MP_SCHED_MSGID_WORK) {}
+
+  /**
+   * @brief Attach to the scheduler created by MainCore
+   * @param [in] shm - address given to MPScheduler::begin()
+   * @param [in] doorbell - doorbell to MainCore
+   * @param [in] worker - worker number (1~WORKERS), e.g. SUBCORE
+   * @param [in] lock - lock shared by all cores. Required if stealing.
+   * @return error code. It returns minus value on failure.
+   * @retval -22(-EINVAL) Not a scheduler, or a scheduler of another type
+   */
+  int attach(void *shm, DOORBELL &doorbell, int worker, LOCK *lock = NULL) {
+    if (!shm || (worker < 1) || (worker > WORKERS)) {
+      return -EINVAL;
+    }
+    typename base::Shared *s = (typename base::Shared *)shm;
+    if ((load(&s->magic) != MP_SCHED_MAGIC) ||
+        (s->workers != WORKERS) || (s->depth != DEPTH) ||
+        (s->stealing && !lock)) {
+      return -EINVAL;
+    }
+    _shm = s;
+    _doorbell = &doorbell;
+    _lock = s->stealing ? lock : NULL;
+    _id = worker - 1;
+    return 0;
+  }
+
+  /**
+   * @brief Register the handler of a job type
+   * @return error code. It returns minus value on failure.
+   */
+  int handle(uint32_t type, MPJobHandler handler) {
+    for (int i = 0; i < _typenum; i++) {
+      if (_type[i] == type) {
+        _handler[i] = handler;
+        return 0;
+      }
+    }
+    if (_typenum == MP_SCHED_MAX_TYPES) {
+      return -ENOMEM;
+    }
+    _type[_typenum] = type;
+    _handler[_typenum] = handler;
+    _typenum++;
+    return 0;
+  }
+
+  /**
+   * @brief Set message ID used for doorbells
+   */
+  void setMsgId(int8_t msgid) {
+    _msgid = msgid;
+  }
+
+  /**
+   * @brief Run the queued jobs
+   * @param [in] timeout - MP_RECV_BLOCKING, MP_RECV_POLLING or [msec]
+   *                       to wait for the first job
+   * @return number of executed jobs (0 on timeout), or error code
+   * @details Returns when no job is left to run.
+   */
+  int run(uint32_t timeout = MP_RECV_BLOCKING) {
+    int done = 0;
+
+    for (;;) {
+      if (execute()) {
+        done++;
+        continue;
+      }
+      if ((done > 0) || (timeout == MP_RECV_POLLING)) {
+        return done;
+      }
+
+      /* Publish the flag before checking again, so that MainCore either
+       * sees the flag or this side sees the new job.
+       */
+      volatile uint32_t *waiting = &_shm->queue[_id].waiting;
+      __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+      if (available()) {
+        __atomic_store_n(waiting, 0, __ATOMIC_SEQ_CST);
+        continue;
+      }
+
+      int ret = _doorbell->wait(_msgid, timeout);
+      __atomic_store_n(waiting, 0, __ATOMIC_SEQ_CST);
+      if ((ret < 0) && !available()) {
+        return (ret == -ETIMEDOUT) ? 0 : ret;
+      }
+    }
+  }
+
+private:
+  DOORBELL    *_doorbell;
+  LOCK        *_lock;
+  int          _id;
+  int          _typenum;
+  uint32_t     _type[MP_SCHED_MAX_TYPES];
+  MPJobHandler _handler[MP_SCHED_MAX_TYPES];
+  int8_t       _msgid;
+
+  bool available() {
+    if (queued(_id) > 0) {
+      return true;
+    }
+    if (_lock && (_id < (int)load(&_shm->active))) {
+      for (int w = 0; w < WORKERS; w++) {
+        if ((w != _id) && base::stealable(w)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  /* Take a job from the queue. The owner waits for the lock, while a
+   * thief gives up if the lock is busy or the job is pinned.
+   */
+  bool take(int w, uint32_t *id) {
+    typename base::Queue *q = &_shm->queue[w];
+
+    if (_lock) {
+      while (_lock->Trylock() != 0) {
+        if (w != _id) {
+          return false;
+        }
+      }
+    }
+
+    uint32_t head = q->head;
+    bool found = (head != load(&q->tail)) &&
+                 ((w == _id) || !(q->entry[head % DEPTH] & base::PINNED));
+    if (found) {
+      *id = q->entry[head % DEPTH] & ~base::PINNED;
+      store(&q->head, head + 1);
+    }
+
+    if (_lock) {
+      _lock->Unlock();
+    }
+    return found;
+  }
+
+  /* Run one job of its own queue, or steal one from the busiest queue */
+  bool execute() {
+    uint32_t id = 0;
+    bool stolen = false;
+
+    if (!take(_id, &id)) {
+      if (!_lock || (_id >= (int)load(&_shm->active))) {
+        return false;
+      }
+      int victim = -1;
+      int max = 0;
+      for (int w = 0; w < WORKERS; w++) {
+        int n = queued(w);
+        if ((w != _id) && (n > max) && base::stealable(w)) {
+          max = n;
+          victim = w;
+        }
+      }
+      if ((victim < 0) || !take(victim, &id)) {
+        return false;
+      }
+      stolen = true;
+    }
+
+    typename base::Slot *slot = &_shm->slot[id];
+    MPJobHandler handler = NULL;
+    for (int i = 0; i < _typenum; i++) {
+      if (_type[i] == slot->job.type) {
+        handler = _handler[i];
+        break;
+      }
+    }
+
+    slot->worker = _id + 1;
+    slot->job.result = handler ? handler(slot->job) : -ENOSYS;
+    __atomic_store_n(&slot->state, (uint32_t)base::JOB_DONE, __ATOMIC_SEQ_CST);
+
+    /* Wake MainCore only when it waits for this job */
+    if (__atomic_exchange_n(&slot->notify, 0, __ATOMIC_SEQ_CST)) {
+      _doorbell->ring(_msgid);
+    }
+
+    typename base::Queue *own = &_shm->queue[_id];
+    store(&own->executed, own->executed + 1);
+    if (stolen) {
+      store(&own->stolen, own->stolen + 1);
+    }
+    return true;
+  }
+};
+
+/** @} mpscheduler */
+
+#endif /* _MPSCHEDULER_H_ */
@@ -25,6 +25,30 @@
 #include <Arduino.h>
 #include <NetPBM.h>
 
+static int
+file_read(void *ctx, void *buf, size_t size)
+{
+  return ((File *)ctx)->read(buf, size);
+}
+
+static int
+file_write(void *ctx, const void *buf, size_t size)
+{
+  return ((File *)ctx)->write((const uint8_t *)buf, size);
+}
+
+int
+NetPBMReader::begin(File &file)
+{
+  return begin(file_read, &file);
+}
+
+int
+NetPBMWriter::begin(File &file, int width, int height, int channels, bool ascii)
+{
+  return begin(file_write, &file, width, height, channels, ascii);
+}
+
 NetPBM::NetPBM(File& file) :
   _pixbuf(0),
   _width(0),
@@ -33,132 +57,46 @@ NetPBM::NetPBM(File& file) :
   _maxvalue(0),
   _isascii(false)
 {
+  NetPBMReader reader;
 
-  uint32_t size = file.size() + 1;
-
-  _filebuf = (unsigned char *)malloc(size);
-  if (_filebuf == NULL)
+  if (reader.begin(file) < 0)
     {
       return;
     }
 
-  file.read(_filebuf, size);
-  _filebuf[size - 1] = '\0';
+  // Only the pixel data is kept, in 8 bits per sample.
 
-  int ret = this->parse();
-  if (ret < 0)
+  if (reader.maxValue() > 255)
     {
       return;
     }
 
-  if (_isascii)
-    {
-      // Sorry, now ASCII format is not supported.
-    }
-  else
-    {
-      _pixbuf = _filebuf + ret;
-    }
-}
-
-NetPBM::~NetPBM()
-{
-  if (_filebuf)
-    {
-      free(_filebuf);
-    }
-}
-
-char *
-NetPBM::getline(char *buf)
-{
-  char *p = buf;
-
-  do
-    {
-      p = strchr(p, '\n');
-      if (!p)
-        {
-          break;
-        }
-      *p++ = '\0';
-    }
-  while (*p == '#');
-
-  return p;
-}
-
-int
-NetPBM::parse()
-{
-  int ret;
-  char *cur = (char *)_filebuf;
-  char *next;
-
-  // Read 3 lines for determine map type, width x line and maxvalie
-
-  next = this->getline(cur);
-  ret = this->parse_type(cur);
-  if (ret < 0)
-    {
-      return -1;
-    }
-  cur = next;
-
-  next = this->getline(cur);
-  ret = sscanf(cur, "%hd %hd", &_width, &_height);
-  if (ret < 2)
+  _pixbuf = (unsigned char *)malloc(reader.rowSize() * reader.height());
+  if (_pixbuf == NULL)
     {
-      return -1;
+      return;
     }
-  cur = next;
 
-  if (_bpp != 1)
+  if (reader.readRows(_pixbuf, reader.height()) != reader.height())
     {
-      next = this->getline(cur);
-      _maxvalue = atoi(cur);
-      cur = next;
+      free(_pixbuf);
+      _pixbuf = NULL;
+      return;
     }
 
-  // Return start offset of pixel data
-
-  return (unsigned char *)cur - _filebuf;
+  _width = reader.width();
+  _height = reader.height();
+  _maxvalue = reader.maxValue();
+  _isascii = reader.isAscii();
+  _bpp = (reader.channels() == 3) ? 24 : ((_maxvalue == 1) ? 1 : 8);
 }
 
-int
-NetPBM::parse_type(char *buf)
+NetPBM::~NetPBM()
 {
-  if (buf[0] != 'P')
-    {
-      return -1;
-    }
-  switch (buf[1])
+  if (_pixbuf)
     {
-      case '1':
-        _isascii = true;
-        // FALLTHRU
-      case '4':
-        _bpp = 1;
-        break;
-
-      case '2':
-        _isascii = true;
-        // FALLTHRU
-      case '5':
-        _bpp = 8;
-        break;
-
-      case '3':
-        _isascii = true;
-        // FALLTHRU
-      case '6':
-        _bpp = 24;
-        break;
-      default:
-        return -2;
+      free(_pixbuf);
     }
-
-  return 0;
 }
 
 size_t
@@ -179,13 +117,18 @@ NetPBM::getpixel(unsigned short row, unsigned short col)
 {
   size_t offset = (row * _width) + col;
 
-  if (_pixbuf)
+  if (_pixbuf == NULL || row >= _height || col >= _width)
     {
-      // XXX: 8 bpp gray map only
-      return (unsigned int)_pixbuf[offset];
+      return 0;
     }
-  else
+
+  // PPM pixel is 0xRRGGBB. PBM pixel is 0 (black) or 255 (white).
+
+  if (_bpp == 24)
     {
-      return 0;
+      unsigned char *p = _pixbuf + offset * 3;
+      return ((unsigned int)p[0] << 16) | ((unsigned int)p[1] << 8) | p[2];
     }
+
+  return (unsigned int)_pixbuf[offset];
 }
@@ -21,6 +21,12 @@
 #define Netpbm_h
 
 #include <File.h>
+#include <NetPBMStream.h>
+
+/*
+ * NetPBM reads the whole pixel data into RAM for getpixel(). To read large
+ * images, use NetPBMReader, which reads a row at a time.
+ */
 
 class NetPBM {
 public:
@@ -33,12 +39,7 @@ public:
 
 private:
 
-  int parse();
-  int parse_type(char *buf);
-  char *getline(char *buf);
-
   unsigned char *_pixbuf;
-  unsigned char *_filebuf;
   unsigned short _width;
   unsigned short _height;
   unsigned char  _bpp;
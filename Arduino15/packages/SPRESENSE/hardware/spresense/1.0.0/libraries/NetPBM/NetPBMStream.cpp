@@ -0,0 +1,714 @@
+/*
+ *  NetPBMStream.cpp - Streaming NetPBM reader and writer for the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "NetPBMStream.h"
+
+#define ASCII_LINE_MAX 70  // Recommended line length of the ASCII formats
+
+static bool
+is_space(int c)
+{
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') ||
+         (c == '\v') || (c == '\f');
+}
+
+static uint8_t
+clamp8(int v)
+{
+  return (v < 0) ? 0 : ((v > 255) ? 255 : (uint8_t)v);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// NetPBMReader
+////////////////////////////////////////////////////////////////////////////
+
+NetPBMReader::NetPBMReader() :
+  _read(NULL),
+  _ctx(NULL),
+  _pos(0),
+  _len(0),
+  _width(0),
+  _height(0),
+  _channels(0),
+  _maxvalue(0),
+  _type(0),
+  _isascii(false),
+  _row(0)
+{
+}
+
+int
+NetPBMReader::fill()
+{
+  int ret = _read(_ctx, _buf, sizeof(_buf));
+  if (ret <= 0)
+    {
+      _pos = _len = 0;
+      return -1;
+    }
+
+  _pos = 0;
+  _len = ret;
+  return 0;
+}
+
+int
+NetPBMReader::getch()
+{
+  if (_pos >= _len && fill() < 0)
+    {
+      return -1;
+    }
+
+  return _buf[_pos++];
+}
+
+// Skip white spaces and comments. The next character is left in the buffer.
+
+int
+NetPBMReader::skip_space()
+{
+  int c;
+
+  while ((c = getch()) >= 0)
+    {
+      if (c == '#')
+        {
+          while ((c = getch()) >= 0 && c != '\n' && c != '\r');
+        }
+      else if (!is_space(c))
+        {
+          _pos--;
+          return 0;
+        }
+    }
+
+  return -1;
+}
+
+int
+NetPBMReader::read_number(unsigned int *val)
+{
+  unsigned int v = 0;
+  int digits = 0;
+  int c;
+
+  if (skip_space() < 0)
+    {
+      return -1;
+    }
+
+  while ((c = getch()) >= '0' && c <= '9')
+    {
+      v = v * 10 + (c - '0');
+      digits++;
+    }
+
+  // Leave the delimiter.
+
+  if (c >= 0)
+    {
+      _pos--;
+    }
+
+  *val = v;
+  return (digits > 0 && digits <= 5) ? 0 : -1;
+}
+
+// Copy the buffered data, and read the rest directly into dst.
+
+int
+NetPBMReader::read_bytes(uint8_t *dst, size_t size)
+{
+  size_t n = _len - _pos;
+  if (n > size)
+    {
+      n = size;
+    }
+  memcpy(dst, _buf + _pos, n);
+  _pos += n;
+  dst += n;
+  size -= n;
+
+  while (size >= sizeof(_buf))
+    {
+      int ret = _read(_ctx, dst, size);
+      if (ret <= 0)
+        {
+          return -1;
+        }
+      dst += ret;
+      size -= ret;
+    }
+
+  if (size > 0)
+    {
+      if (fill() < 0 || _len < size)
+        {
+          // Short read of the buffer is possible. Take one by one.
+
+          while (size > 0)
+            {
+              int c = getch();
+              if (c < 0)
+                {
+                  return -1;
+                }
+              *dst++ = c;
+              size--;
+            }
+          return 0;
+        }
+      memcpy(dst, _buf, size);
+      _pos = size;
+    }
+
+  return 0;
+}
+
+int
+NetPBMReader::begin(netpbm_read_t read, void *ctx)
+{
+  unsigned int w;
+  unsigned int h;
+  unsigned int maxval = 1;
+
+  if (read == NULL)
+    {
+      return -1;
+    }
+
+  _read = read;
+  _ctx = ctx;
+  _pos = _len = 0;
+  _row = 0;
+  _width = _height = _channels = 0;
+
+  if (getch() != 'P')
+    {
+      return -1;
+    }
+
+  _type = getch();
+  switch (_type)
+    {
+      case '1':
+      case '2':
+      case '3':
+        _isascii = true;
+        break;
+      case '4':
+      case '5':
+      case '6':
+        _isascii = false;
+        break;
+      default:
+        return -2;
+    }
+
+  _channels = (_type == '3' || _type == '6') ? 3 : 1;
+
+  if (read_number(&w) < 0 || read_number(&h) < 0 || w == 0 || h == 0)
+    {
+      return -1;
+    }
+
+  if (_type != '1' && _type != '4')
+    {
+      if (read_number(&maxval) < 0 || maxval == 0 || maxval > 65535)
+        {
+          return -1;
+        }
+    }
+
+  // Binary data starts after one white space.
+
+  if (!_isascii && !is_space(getch()))
+    {
+      return -1;
+    }
+
+  _width = w;
+  _height = h;
+  _maxvalue = maxval;
+
+  return 0;
+}
+
+size_t
+NetPBMReader::rowSize()
+{
+  return (size_t)_width * _channels * ((_maxvalue > 255) ? 2 : 1);
+}
+
+int
+NetPBMReader::readRow(void *buf)
+{
+  uint8_t *dst = (uint8_t *)buf;
+  int samples = _width * _channels;
+
+  if (_read == NULL || buf == NULL || _row >= _height)
+    {
+      return -1;
+    }
+
+  switch (_type)
+    {
+      case '4':
+        {
+          // Unpack the bits through a small buffer. 1 is black.
+
+          uint8_t packed[32];
+          int x = 0;
+
+          while (x < _width)
+            {
+              int n = (_width - x + 7) / 8;
+              if (n > (int)sizeof(packed))
+                {
+                  n = sizeof(packed);
+                }
+              if (read_bytes(packed, n) < 0)
+                {
+                  return -1;
+                }
+              for (int i = 0; i < n * 8 && x < _width; i++, x++)
+                {
+                  dst[x] = (packed[i >> 3] & (0x80 >> (i & 7))) ? 0 : 255;
+                }
+            }
+        }
+        break;
+
+      case '1':
+        // Digits may have no space between them.
+
+        for (int x = 0; x < _width; x++)
+          {
+            int c;
+            if (skip_space() < 0 || ((c = getch()) != '0' && c != '1'))
+              {
+                return -1;
+              }
+            dst[x] = (c == '1') ? 0 : 255;
+          }
+        break;
+
+      case '2':
+      case '3':
+        for (int i = 0; i < samples; i++)
+          {
+            unsigned int v;
+            if (read_number(&v) < 0 || v > _maxvalue)
+              {
+                return -1;
+              }
+            if (_maxvalue > 255)
+              {
+                ((uint16_t *)dst)[i] = v;
+              }
+            else
+              {
+                dst[i] = v;
+              }
+          }
+        break;
+
+      default:
+        if (read_bytes(dst, rowSize()) < 0)
+          {
+            return -1;
+          }
+
+        // 16bit samples are big endian in the file.
+
+        if (_maxvalue > 255)
+          {
+            for (int i = 0; i < samples; i++)
+              {
+                uint16_t v = (dst[i * 2] << 8) | dst[i * 2 + 1];
+                memcpy(dst + i * 2, &v, 2);
+              }
+          }
+        break;
+    }
+
+  _row++;
+  return 0;
+}
+
+int
+NetPBMReader::readRows(void *buf, int rows)
+{
+  uint8_t *dst = (uint8_t *)buf;
+  size_t size = rowSize();
+  int n;
+
+  for (n = 0; n < rows; n++)
+    {
+      if (readRow(dst) < 0)
+        {
+          return (n > 0) ? n : -1;
+        }
+      dst += size;
+    }
+
+  return n;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// NetPBMWriter
+////////////////////////////////////////////////////////////////////////////
+
+NetPBMWriter::NetPBMWriter() :
+  _write(NULL),
+  _ctx(NULL),
+  _len(0),
+  _width(0),
+  _height(0),
+  _channels(0),
+  _isascii(false),
+  _row(0),
+  _column(0),
+  _error(false)
+{
+}
+
+int
+NetPBMWriter::flush()
+{
+  if (_len > 0 && !_error)
+    {
+      if (_write(_ctx, _buf, _len) != (int)_len)
+        {
+          _error = true;
+        }
+    }
+  _len = 0;
+
+  return _error ? -1 : 0;
+}
+
+int
+NetPBMWriter::put(const void *data, size_t size)
+{
+  if (_len + size > sizeof(_buf))
+    {
+      flush();
+    }
+
+  // Large data goes directly.
+
+  if (size >= sizeof(_buf))
+    {
+      if (!_error && _write(_ctx, data, size) != (int)size)
+        {
+          _error = true;
+        }
+    }
+  else
+    {
+      memcpy(_buf + _len, data, size);
+      _len += size;
+    }
+
+  return _error ? -1 : 0;
+}
+
+int
+NetPBMWriter::putch(uint8_t c)
+{
+  if (_len >= sizeof(_buf) && flush() < 0)
+    {
+      return -1;
+    }
+
+  _buf[_len++] = c;
+  return 0;
+}
+
+int
+NetPBMWriter::put_sample(uint8_t v)
+{
+  if (!_isascii)
+    {
+      return putch(v);
+    }
+
+  char num[4];
+  int n = 0;
+
+  if (v >= 100)
+    {
+      num[n++] = '0' + v / 100;
+    }
+  if (v >= 10)
+    {
+      num[n++] = '0' + (v / 10) % 10;
+    }
+  num[n++] = '0' + v % 10;
+
+  if (_column > 0)
+    {
+      if (_column + 1 + n > ASCII_LINE_MAX)
+        {
+          putch('\n');
+          _column = 0;
+        }
+      else
+        {
+          putch(' ');
+          _column++;
+        }
+    }
+
+  _column += n;
+  return put(num, n);
+}
+
+int
+NetPBMWriter::begin(netpbm_write_t write, void *ctx,
+                    int width, int height, int channels, bool ascii)
+{
+  char header[32];
+
+  if (write == NULL || width <= 0 || height <= 0 ||
+      (channels != 1 && channels != 3))
+    {
+      return -1;
+    }
+
+  _write = write;
+  _ctx = ctx;
+  _len = 0;
+  _width = width;
+  _height = height;
+  _channels = channels;
+  _isascii = ascii;
+  _row = 0;
+  _column = 0;
+  _error = false;
+
+  char type = (channels == 1) ? (ascii ? '2' : '5') : (ascii ? '3' : '6');
+  int n = snprintf(header, sizeof(header), "P%c\n%d %d\n255\n", type, width, height);
+
+  return put(header, n);
+}
+
+int
+NetPBMWriter::writeRow(const uint8_t *row)
+{
+  int samples = _width * _channels;
+
+  if (_write == NULL || row == NULL || _row >= _height)
+    {
+      return -1;
+    }
+
+  if (!_isascii)
+    {
+      put(row, samples);
+    }
+  else
+    {
+      for (int i = 0; i < samples; i++)
+        {
+          put_sample(row[i]);
+        }
+      putch('\n');
+      _column = 0;
+    }
+
+  _row++;
+  return _error ? -1 : 0;
+}
+
+int
+NetPBMWriter::writeRow(const float *row, float scale, float offset,
+                       size_t plane)
+{
+  if (_write == NULL || row == NULL || _row >= _height)
+    {
+      return -1;
+    }
+
+  for (int x = 0; x < _width; x++)
+    {
+      for (int c = 0; c < _channels; c++)
+        {
+          float v = plane ? row[c * plane + x] : row[x * _channels + c];
+          v = v * scale + offset;
+          put_sample((v <= 0.0f) ? 0 : ((v >= 255.0f) ? 255 : (uint8_t)(v + 0.5f)));
+        }
+    }
+
+  if (_isascii)
+    {
+      putch('\n');
+      _column = 0;
+    }
+
+  _row++;
+  return _error ? -1 : 0;
+}
+
+int
+NetPBMWriter::writeImage(const uint8_t *img, NETPBM_PIXFMT fmt)
+{
+  if (_write == NULL || img == NULL)
+    {
+      return -1;
+    }
+
+  // Same layout. No conversion is needed.
+
+  if ((fmt == NETPBM_PIXFMT_GRAY && _channels == 1) ||
+      (fmt == NETPBM_PIXFMT_RGB888 && _channels == 3))
+    {
+      for (int y = _row; y < _height; y++)
+        {
+          if (writeRow(img + (size_t)y * _width * _channels) < 0)
+            {
+              return -1;
+            }
+        }
+      return 0;
+    }
+
+  int bpp = (fmt == NETPBM_PIXFMT_GRAY) ? 1 : ((fmt == NETPBM_PIXFMT_RGB888) ? 3 : 2);
+
+  for (int y = _row; y < _height; y++)
+    {
+      const uint8_t *p = img + (size_t)y * _width * bpp;
+
+      for (int x = 0; x < _width; x++)
+        {
+          int r;
+          int g;
+          int b;
+          int gray;
+
+          switch (fmt)
+            {
+              case NETPBM_PIXFMT_GRAY:
+                r = g = b = gray = p[x];
+                break;
+
+              case NETPBM_PIXFMT_RGB888:
+                r = p[x * 3];
+                g = p[x * 3 + 1];
+                b = p[x * 3 + 2];
+                gray = (77 * r + 150 * g + 29 * b) >> 8;
+                break;
+
+              case NETPBM_PIXFMT_RGB565:
+                {
+                  int w = p[x * 2] | (p[x * 2 + 1] << 8);
+                  r = (w >> 11) & 0x1f;
+                  g = (w >> 5) & 0x3f;
+                  b = w & 0x1f;
+                  r = (r << 3) | (r >> 2);
+                  g = (g << 2) | (g >> 4);
+                  b = (b << 3) | (b >> 2);
+                  gray = (77 * r + 150 * g + 29 * b) >> 8;
+                }
+                break;
+
+              default:
+                {
+                  // BT.601 full range in Q16.
+
+                  const uint8_t *pair = p + (x & ~1) * 2;
+                  int u = pair[0] - 128;
+                  int v = pair[2] - 128;
+                  gray = pair[(x & 1) ? 3 : 1];
+                  r = clamp8(gray + ((91881 * v) >> 16));
+                  g = clamp8(gray - ((22554 * u + 46802 * v) >> 16));
+                  b = clamp8(gray + ((116130 * u) >> 16));
+                }
+                break;
+            }
+
+          if (_channels == 1)
+            {
+              put_sample(gray);
+            }
+          else
+            {
+              put_sample(r);
+              put_sample(g);
+              put_sample(b);
+            }
+        }
+
+      if (_isascii)
+        {
+          putch('\n');
+          _column = 0;
+        }
+
+      _row++;
+      if (_error)
+        {
+          return -1;
+        }
+    }
+
+  return 0;
+}
+
+int
+NetPBMWriter::writeImage(const float *data, bool planar, float scale,
+                         float offset)
+{
+  if (_write == NULL || data == NULL)
+    {
+      return -1;
+    }
+
+  size_t plane = planar ? (size_t)_width * _height : 0;
+
+  for (int y = _row; y < _height; y++)
+    {
+      const float *row = data + (size_t)y * _width * (planar ? 1 : _channels);
+      if (writeRow(row, scale, offset, (_channels > 1) ? plane : 0) < 0)
+        {
+          return -1;
+        }
+    }
+
+  return 0;
+}
+
+int
+NetPBMWriter::end()
+{
+  if (_write == NULL)
+    {
+      return -1;
+    }
+
+  int ret = flush();
+  _write = NULL;
+
+  return (ret == 0 && _row == _height) ? 0 : -1;
+}
@@ -0,0 +1,167 @@
+/*
+ *  NetPBMStream.h - Streaming NetPBM reader and writer for the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef NetpbmStream_h
+#define NetpbmStream_h
+
+/*
+ * The reader and the writer work a row at a time through a small buffer,
+ * so the image does not have to fit in RAM. They access the data through
+ * read/write functions, and NetPBM.cpp connects them to File. This file
+ * does not depend on the Spresense SDK, so it can be built on a PC.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+class File;
+
+#define NETPBM_IOBUF_SIZE 512
+
+/* Read or write size bytes. Return the bytes done, 0 at the end, or negative on error. */
+
+typedef int (*netpbm_read_t)(void *ctx, void *buf, size_t size);
+typedef int (*netpbm_write_t)(void *ctx, const void *buf, size_t size);
+
+/* Pixel formats of NetPBMWriter::writeImage() */
+
+enum NETPBM_PIXFMT {
+  NETPBM_PIXFMT_GRAY,   /* 8bit gray scale */
+  NETPBM_PIXFMT_RGB888, /* R, G, B */
+  NETPBM_PIXFMT_RGB565, /* 16bit word per pixel, e.g. CamImage RGB565 */
+  NETPBM_PIXFMT_YUV422, /* U, Y0, V, Y1, e.g. CamImage YUV422 */
+};
+
+class NetPBMReader {
+public:
+  NetPBMReader();
+  ~NetPBMReader() {};
+
+  /* Read the header. Return 0 on success, otherwise error. */
+
+  int begin(File &file);
+  int begin(netpbm_read_t read, void *ctx);
+
+  int width()    { return _width; };
+  int height()   { return _height; };
+  int channels() { return _channels; };
+  int maxValue() { return _maxvalue; };
+  bool isAscii() { return _isascii; };
+
+  /* Bytes of a row from readRow(). Samples are 8bit, or 16bit in host byte
+   * order if maxValue() is over 255. PBM pixels are 0 (black) or 255 (white).
+   */
+
+  size_t rowSize();
+
+  /* Read the next row into buf of rowSize() bytes. Return 0 on success. */
+
+  int readRow(void *buf);
+
+  /* Read rows. Return the number of rows read, or negative on error. */
+
+  int readRows(void *buf, int rows);
+
+  /* Index of the next row */
+
+  int row()      { return _row; };
+
+private:
+  int fill();
+  int getch();
+  int skip_space();
+  int read_number(unsigned int *val);
+  int read_bytes(uint8_t *dst, size_t size);
+
+  netpbm_read_t _read;
+  void         *_ctx;
+  uint8_t       _buf[NETPBM_IOBUF_SIZE];
+  size_t        _pos;
+  size_t        _len;
+
+  int           _width;
+  int           _height;
+  int           _channels;
+  unsigned int  _maxvalue;
+  char          _type;
+  bool          _isascii;
+  int           _row;
+};
+
+class NetPBMWriter {
+public:
+  NetPBMWriter();
+  ~NetPBMWriter() {};
+
+  /* Write the header of PGM (channels 1) or PPM (channels 3) with maxval 255.
+   * Return 0 on success, otherwise error.
+   */
+
+  int begin(File &file, int width, int height, int channels, bool ascii = false);
+  int begin(netpbm_write_t write, void *ctx,
+            int width, int height, int channels, bool ascii = false);
+
+  /* Write a row of width * channels samples */
+
+  int writeRow(const uint8_t *row);
+
+  /* Write a row of float samples as round(value * scale + offset) clamped to
+   * 0 to 255. Samples of a pixel are at the interval of plane for CHW layout,
+   * or next to each other if plane is 0.
+   */
+
+  int writeRow(const float *row, float scale = 255.0f, float offset = 0.0f,
+               size_t plane = 0);
+
+  /* Write the whole image, e.g. CamImage::getImgBuff(). It is converted to
+   * gray scale or RGB of the output.
+   */
+
+  int writeImage(const uint8_t *img, NETPBM_PIXFMT fmt);
+
+  /* Write the whole float image, e.g. DNNVariable::data(). */
+
+  int writeImage(const float *data, bool planar = true,
+                 float scale = 255.0f, float offset = 0.0f);
+
+  /* Flush the data. Return 0 if the whole image is written. */
+
+  int end();
+
+private:
+  int put(const void *data, size_t size);
+  int putch(uint8_t c);
+  int put_sample(uint8_t v);
+  int flush();
+
+  netpbm_write_t _write;
+  void          *_ctx;
+  uint8_t        _buf[NETPBM_IOBUF_SIZE];
+  size_t         _len;
+
+  int            _width;
+  int            _height;
+  int            _channels;
+  bool           _isascii;
+  int            _row;
+  int            _column;
+  bool           _error;
+};
+
+#endif // NetpbmStream_h
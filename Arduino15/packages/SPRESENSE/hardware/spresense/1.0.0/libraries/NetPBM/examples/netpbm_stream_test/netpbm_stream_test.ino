@@ -0,0 +1,350 @@
+/*
+ *  netpbm_stream_test.ino - Test and benchmark of the streaming NetPBM codec
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Checks NetPBMReader and NetPBMWriter with images in memory, and measures
+ * reading a VGA PGM by rows against reading the whole file at once as
+ * NetPBM does.
+ *
+ * The sketch can also be built and run on a PC:
+ *   g++ -O2 -DNETPBM_HOST -I../.. -x c++ netpbm_stream_test.ino \
+ *       -x none ../../NetPBMStream.cpp -o netpbm_stream_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <NetPBMStream.h>
+
+#ifdef NETPBM_HOST
+#include <time.h>
+
+static unsigned long micros()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long)(ts.tv_sec * 1000000UL + ts.tv_nsec / 1000);
+}
+#else
+#include <Arduino.h>
+#endif
+
+static const int BENCH_W = 640;
+static const int BENCH_H = 480;
+static const int LOOPS = 10;
+
+static int failed;
+
+static void check(bool ok, const char *what)
+{
+  if (!ok)
+    {
+      printf("  NG: %s\n", what);
+      failed++;
+    }
+}
+
+/* Memory file. chunk limits the bytes of a read to test the buffering. */
+
+struct memfile {
+  uint8_t *data;
+  size_t   size;
+  size_t   pos;
+  size_t   chunk;
+};
+
+static int mem_read(void *ctx, void *buf, size_t size)
+{
+  memfile *f = (memfile *)ctx;
+  size_t n = f->size - f->pos;
+  if (n > size)
+    {
+      n = size;
+    }
+  if (f->chunk && n > f->chunk)
+    {
+      n = f->chunk;
+    }
+  memcpy(buf, f->data + f->pos, n);
+  f->pos += n;
+  return n;
+}
+
+static int mem_write(void *ctx, const void *buf, size_t size)
+{
+  memfile *f = (memfile *)ctx;
+  if (f->pos + size > f->size)
+    {
+      return -1;
+    }
+  memcpy(f->data + f->pos, buf, size);
+  f->pos += size;
+  return size;
+}
+
+static memfile open_text(const char *text, size_t chunk)
+{
+  memfile f = { (uint8_t *)text, strlen(text), 0, chunk };
+  return f;
+}
+
+static void test_roundtrip(int channels, bool ascii, size_t chunk)
+{
+  const int w = 37;
+  const int h = 5;
+  uint8_t img[w * h * 3];
+  uint8_t row[w * 3];
+  static uint8_t file[16384];
+
+  for (int i = 0; i < w * h * channels; i++)
+    {
+      img[i] = (uint8_t)(i * 37 + 11);
+    }
+
+  memfile f = { file, sizeof(file), 0, 0 };
+  NetPBMWriter writer;
+  check(writer.begin(mem_write, &f, w, h, channels, ascii) == 0, "writer begin");
+  for (int y = 0; y < h; y++)
+    {
+      check(writer.writeRow(img + y * w * channels) == 0, "writeRow");
+    }
+  check(writer.end() == 0, "writer end");
+
+  memfile r = { file, f.pos, 0, chunk };
+  NetPBMReader reader;
+  check(reader.begin(mem_read, &r) == 0, "reader begin");
+  check(reader.width() == w && reader.height() == h, "size");
+  check(reader.channels() == channels && reader.isAscii() == ascii, "type");
+  for (int y = 0; y < h; y++)
+    {
+      check(reader.readRow(row) == 0, "readRow");
+      check(memcmp(row, img + y * w * channels, w * channels) == 0, "pixels");
+    }
+  check(reader.readRow(row) < 0, "no more rows");
+
+  /* ASCII lines should not be too long */
+
+  if (ascii)
+    {
+      int col = 0;
+      for (size_t i = 0; i < f.pos; i++)
+        {
+          col = (file[i] == '\n') ? 0 : col + 1;
+          check(col <= 70, "line length");
+        }
+    }
+}
+
+static void test_headers()
+{
+  uint8_t row[16];
+  uint16_t row16[4];
+
+  /* Comments anywhere in the header, and several values in a line */
+
+  memfile f = open_text("P2\n# comment\n3 # width\n 2\n#c\n255\n0 1 2\n3\n4 255\n", 3);
+  NetPBMReader r1;
+  check(r1.begin(mem_read, &f) == 0, "P2 comments");
+  check(r1.readRow(row) == 0 && row[0] == 0 && row[1] == 1 && row[2] == 2, "P2 row 0");
+  check(r1.readRow(row) == 0 && row[0] == 3 && row[1] == 4 && row[2] == 255, "P2 row 1");
+
+  /* PBM digits without spaces. 1 is black. */
+
+  f = open_text("P1 4 2 0101\n1 0 1 0\n", 0);
+  NetPBMReader r2;
+  check(r2.begin(mem_read, &f) == 0, "P1 header");
+  check(r2.readRow(row) == 0 && row[0] == 255 && row[1] == 0 && row[3] == 0, "P1 row 0");
+  check(r2.readRow(row) == 0 && row[0] == 0 && row[1] == 255, "P1 row 1");
+
+  /* Packed PBM with a width which is not a multiple of 8 */
+
+  static char p4[] = "P4\n10 2\n\xC0\x40\x01\xFF";
+  f = open_text(p4, 1);
+  f.size = 8 + 4;
+  NetPBMReader r3;
+  check(r3.begin(mem_read, &f) == 0, "P4 header");
+  check(r3.readRow(row) == 0 && row[0] == 0 && row[1] == 0 && row[2] == 255 &&
+        row[9] == 0 && row[8] == 255, "P4 row 0");
+  check(r3.readRow(row) == 0 && row[6] == 255 && row[7] == 0 && row[9] == 0, "P4 row 1");
+
+  /* 16bit samples are big endian */
+
+  static char p5[] = "P5 2 1 1000\n\x03\xE8\x00\x01";
+  f = open_text(p5, 0);
+  f.size = 12 + 4;
+  NetPBMReader r4;
+  check(r4.begin(mem_read, &f) == 0 && r4.rowSize() == 4, "P5 16bit header");
+  check(r4.readRow(row16) == 0 && row16[0] == 1000 && row16[1] == 1, "P5 16bit row");
+
+  /* Errors */
+
+  f = open_text("P7 1 1 255\n", 0);
+  NetPBMReader r5;
+  check(r5.begin(mem_read, &f) < 0, "unknown type");
+  f = open_text("P2 2 1 255 1", 0);
+  NetPBMReader r6;
+  check(r6.begin(mem_read, &f) == 0 && r6.readRow(row) < 0, "truncated data");
+}
+
+static void test_convert()
+{
+  static uint8_t file[1024];
+  uint8_t row[8 * 3];
+
+  /* Gray YUV422 gives the same gray in PPM */
+
+  uint8_t yuv[8 * 2];
+  for (int i = 0; i < 8; i += 2)
+    {
+      yuv[i * 2] = 128;
+      yuv[i * 2 + 1] = 10 * i;
+      yuv[i * 2 + 2] = 128;
+      yuv[i * 2 + 3] = 10 * i + 5;
+    }
+
+  memfile f = { file, sizeof(file), 0, 0 };
+  NetPBMWriter w1;
+  w1.begin(mem_write, &f, 8, 1, 3);
+  check(w1.writeImage(yuv, NETPBM_PIXFMT_YUV422) == 0 && w1.end() == 0, "write YUV422");
+
+  memfile r = { file, f.pos, 0, 0 };
+  NetPBMReader r1;
+  r1.begin(mem_read, &r);
+  r1.readRow(row);
+  check(row[0] == 0 && row[3] == 5 && row[21] == 65 && row[22] == 65 && row[23] == 65,
+        "YUV422 to RGB");
+
+  /* Float CHW with normalization of 0 to 1 */
+
+  float chw[3 * 2 * 1] = { 0.0f, 1.0f, 0.5f, 2.0f, -1.0f, 0.25f };
+  f.pos = 0;
+  NetPBMWriter w2;
+  w2.begin(mem_write, &f, 2, 1, 3, true);
+  check(w2.writeImage(chw, true) == 0 && w2.end() == 0, "write float");
+
+  r.size = f.pos;
+  r.pos = 0;
+  NetPBMReader r2;
+  r2.begin(mem_read, &r);
+  r2.readRow(row);
+  check(row[0] == 0 && row[1] == 128 && row[2] == 0 &&
+        row[3] == 255 && row[4] == 255 && row[5] == 64, "float to PPM");
+
+  /* Writing less rows is an error */
+
+  f.pos = 0;
+  NetPBMWriter w3;
+  w3.begin(mem_write, &f, 2, 2, 1);
+  w3.writeRow(row);
+  check(w3.end() < 0, "missing rows");
+}
+
+static void bench()
+{
+  size_t size = BENCH_W * BENCH_H + 32;
+  uint8_t *file = (uint8_t *)malloc(size);
+  uint8_t *row = (uint8_t *)malloc(BENCH_W);
+  unsigned long sum = 0;
+
+  memfile f = { file, size, 0, 0 };
+  NetPBMWriter writer;
+  writer.begin(mem_write, &f, BENCH_W, BENCH_H, 1);
+  for (int y = 0; y < BENCH_H; y++)
+    {
+      memset(row, y, BENCH_W);
+      writer.writeRow(row);
+    }
+  writer.end();
+  size = f.pos;
+
+  /* Whole file in RAM, as NetPBM(File&) did */
+
+  unsigned long start = micros();
+  for (int i = 0; i < LOOPS; i++)
+    {
+      memfile r = { file, size, 0, 0 };
+      uint8_t *whole = (uint8_t *)malloc(size + 1);
+      mem_read(&r, whole, size);
+      sum += whole[size - 1];
+      free(whole);
+    }
+  unsigned long whole_us = (micros() - start) / LOOPS;
+
+  /* Rows through NetPBMReader */
+
+  start = micros();
+  for (int i = 0; i < LOOPS; i++)
+    {
+      memfile r = { file, size, 0, 0 };
+      NetPBMReader reader;
+      reader.begin(mem_read, &r);
+      while (reader.readRow(row) == 0)
+        {
+          sum += row[0];
+        }
+    }
+  unsigned long stream_us = (micros() - start) / LOOPS;
+
+  printf("VGA PGM read: whole file %lu us with %u bytes heap, "
+         "rows %lu us with %u bytes (%lu)\n",
+         whole_us, (unsigned)(size + 1), stream_us,
+         (unsigned)(sizeof(NetPBMReader) + BENCH_W), sum);
+
+  free(row);
+  free(file);
+}
+
+void setup()
+{
+#ifndef NETPBM_HOST
+  Serial.begin(115200);
+  while (!Serial) {};
+#endif
+
+  for (int ascii = 0; ascii < 2; ascii++)
+    {
+      for (size_t chunk = 0; chunk < 8; chunk += 7)
+        {
+          test_roundtrip(1, ascii, chunk);
+          test_roundtrip(3, ascii, chunk);
+        }
+    }
+  test_headers();
+  test_convert();
+
+  printf("%s\n", failed ? "FAILED" : "All checks passed");
+
+  bench();
+}
+
+void loop()
+{
+#ifndef NETPBM_HOST
+  sleep(1);
+#endif
+}
+
+#ifdef NETPBM_HOST
+int main()
+{
+  setup();
+  return failed ? 1 : 0;
+}
+#endif
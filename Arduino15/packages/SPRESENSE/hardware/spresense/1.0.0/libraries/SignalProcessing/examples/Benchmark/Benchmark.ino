@@ -0,0 +1,642 @@
+/*
+ *  Benchmark.ino - Throughput benchmark of SignalProcessing Library
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * This sketch measures the hot paths of the SignalProcessing library
+ * (FFTClass::put/get, IIRClass::put/get and RingBuff::put/get) for every
+ * FFT length from 32 to 4096, 1 to 8 channels and all window types.
+ *
+ * Each case is printed as one CSV line:
+ *
+ *   name, fftlen/framesize, channel, window, samples/sec, ns/frame, bytes
+ *
+ * "bytes" is the heap consumed by the instance after begin().
+ * The fixed-point FFT lines (FFTq15/FFTq31) are followed by the SNR [dB] of
+ * their amplitude against the float FFTClass.
+ *
+ * The time of each case is the best of g_repeat runs, and each run is
+ * repeated until it lasts g_min_usec, so that the resolution of micros()
+ * and an interrupt do not change the result. It is divided by a baseline
+ * measured at the start of the same run, a plain C biquad, to follow the
+ * clock of the board. The ratio is compared with the number recorded in
+ * reference.h for the same name, length and channels. When it exceeds the
+ * reference by more than g_tolerance, the line is marked as "FAIL", and the
+ * summary at the end reports the regression.
+ *
+ * Set g_record to true to print a new table for reference.h at the end
+ * instead, for a new board, toolchain or an intended change of the speed.
+ *
+ * The sketch can also be built and run on a PC with the CMSIS-DSP shim in
+ * tools/dsp_host. The host has its own table in reference.h, and
+ * "out/Benchmark -r" records it:
+ *   make -C tools/dsp_host bench
+ */
+
+#include <stdlib.h>
+#include <limits.h>
+
+#include "FFT.h"
+#include "FFTFixed.h"
+#include "IIR.h"
+
+#include "reference.h"
+
+/* Allowed ratio of a case to its reference */
+const float g_tolerance = 1.25f;
+
+/* Print a new reference table instead of checking */
+static bool g_record = false;
+
+/* Timing: the best of g_repeat runs, each of at least g_min_usec */
+const int g_repeat = 5;
+const unsigned long g_min_usec = 5000;
+
+/* Samples of the baseline */
+const int g_base_sample = 4096;
+
+/* Number of frames executed in each run */
+const int g_iteration = 32;
+
+/* Sampling rate of the generated input signal */
+const float g_fs = 48000.0f;
+
+USER_HEAP_SIZE(512 * 1024);
+
+static const char *g_window_name[] = {
+  "Hamming", "Hanning", "Flattop", "Rectangle", "BlackmanHarris", "Kaiser"
+};
+
+static int g_fail_count = 0;
+static int g_skip_count = 0;
+static int g_noref_count = 0;
+
+/* Baseline [ns/sample] of the last measure() */
+static float g_base_ns = 0.0f;
+
+/* Ratios measured in the record mode, the largest of the windows */
+#define MAX_RECORD 256
+static Reference g_recorded[MAX_RECORD];
+static int g_recorded_num = 0;
+
+/*-----------------------------------------------------------------*/
+/* Utilities                                                       */
+/*-----------------------------------------------------------------*/
+static int heap_used()
+{
+  struct mallinfo info = mallinfo();
+  return info.uordblks;
+}
+
+static int heap_largest()
+{
+#ifdef SIGNALPROCESSING_HOST
+  /* The heap of the host grows, and glibc does not report this */
+  return INT_MAX;
+#else
+  struct mallinfo info = mallinfo();
+  return info.mxordblk;
+#endif
+}
+
+static void make_signal(q15_t *buf, int sample, int chnum)
+{
+  for (int i = 0; i < sample; i++) {
+    for (int ch = 0; ch < chnum; ch++) {
+      float freq = 1000.0f * (ch + 1);
+      buf[i * chnum + ch] =
+        (q15_t)(16384.0f * arm_sin_f32(2 * PI * freq * i / g_fs));
+    }
+  }
+}
+
+/* Time of one call of run() [usec], repeated until it lasts g_min_usec */
+template <typename F> static float time_run(F run)
+{
+  int count = 0;
+  unsigned long usec;
+  unsigned long start = micros();
+
+  do {
+    run();
+    count++;
+    usec = micros() - start;
+  } while (usec < g_min_usec);
+
+  return (float)usec / count;
+}
+
+static void run_baseline();
+
+/* Time of one call of run() [usec], the fastest of g_repeat runs.
+ * The baseline is run in turn with the case, and g_base_ns is updated with
+ * its fastest run, so that a change of the clock while the case runs
+ * changes both of them.
+ */
+template <typename F> static float measure(F run)
+{
+  float best = 0.0f;
+  float base = 0.0f;
+
+  for (int r = 0; r < g_repeat; r++) {
+    float b = time_run(run_baseline);
+    float t = time_run(run);
+    if ((r == 0) || (b < base)) {
+      base = b;
+    }
+    if ((r == 0) || (t < best)) {
+      best = t;
+    }
+  }
+
+  g_base_ns = base * 1000.0f / g_base_sample;
+  return best;
+}
+
+static const Reference *find_reference(const char *name, int len, int chnum)
+{
+  for (size_t i = 0; i < sizeof(g_reference) / sizeof(g_reference[0]); i++) {
+    const Reference *ref = &g_reference[i];
+    if (ref->name && (strcmp(ref->name, name) == 0) &&
+        (ref->len == len) && (ref->chnum == chnum)) {
+      return ref;
+    }
+  }
+  return NULL;
+}
+
+static void record(const char *name, int len, int chnum, float ratio)
+{
+  for (int i = 0; i < g_recorded_num; i++) {
+    Reference *rec = &g_recorded[i];
+    if ((strcmp(rec->name, name) == 0) && (rec->len == len) && (rec->chnum == chnum)) {
+      if (ratio > rec->ratio) {
+        rec->ratio = ratio;
+      }
+      return;
+    }
+  }
+
+  if (g_recorded_num < MAX_RECORD) {
+    Reference rec = { name, len, chnum, ratio };
+    g_recorded[g_recorded_num++] = rec;
+  }
+}
+
+static void print_recorded()
+{
+  puts("/* Recorded by Benchmark.ino with g_record = true */");
+  puts("static const Reference g_reference[] = {");
+  for (int i = 0; i < g_recorded_num; i++) {
+    const Reference *rec = &g_recorded[i];
+    printf("  { \"%s\", %d, %d, %.2ff },\n", rec->name, rec->len, rec->chnum, rec->ratio);
+  }
+  puts("};");
+}
+
+/* sample and frame are per run, usec is the time of one run */
+static void report(const char *name, int len, int chnum, const char *window,
+                   int sample, float usec, int frame, int bytes)
+{
+  float sps = (usec == 0.0f) ? 0 : (float)sample * 1000000.0f / usec;
+  float ns_frame = usec * 1000.0f / frame;
+  float ns_sample = usec * 1000.0f / sample / chnum;
+  float ratio = ns_sample / g_base_ns;
+
+  if (g_record) {
+    record(name, len, chnum, ratio);
+    printf("%s, %d, %d, %s, %.0f, %.0f, %d, ratio %.2f\n",
+           name, len, chnum, window, sps, ns_frame, bytes, ratio);
+    return;
+  }
+
+  const Reference *ref = find_reference(name, len, chnum);
+  if (!ref) {
+    g_noref_count++;
+    printf("%s, %d, %d, %s, %.0f, %.0f, %d, ratio %.2f, no reference\n",
+           name, len, chnum, window, sps, ns_frame, bytes, ratio);
+  } else if (ratio > ref->ratio * g_tolerance) {
+    g_fail_count++;
+    printf("%s, %d, %d, %s, %.0f, %.0f, %d, FAIL (ratio %.2f, reference %.2f)\n",
+           name, len, chnum, window, sps, ns_frame, bytes, ratio, ref->ratio);
+  } else {
+    printf("%s, %d, %d, %s, %.0f, %.0f, %d, ratio %.2f\n",
+           name, len, chnum, window, sps, ns_frame, bytes, ratio);
+  }
+}
+
+/*-----------------------------------------------------------------*/
+/* Baseline                                                        */
+/*-----------------------------------------------------------------*/
+static q15_t *g_base_in;
+static q15_t *g_base_out;
+
+static void init_baseline()
+{
+  g_base_in  = (q15_t*)malloc(g_base_sample * sizeof(q15_t));
+  g_base_out = (q15_t*)malloc(g_base_sample * sizeof(q15_t));
+  if (!g_base_in || !g_base_out) {
+    puts("Baseline memory error");
+    exit(1);
+  }
+
+  make_signal(g_base_in, g_base_sample, 1);
+}
+
+/* A plain C biquad in float on q15 input */
+static void run_baseline()
+{
+  /* Butterworth LPF at fs/48 */
+  const float b0 = 0.0039160f, b1 = 0.0078320f, b2 = 0.0039160f;
+  const float a1 = 1.8153396f, a2 = -0.8310036f;
+
+  float x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+  for (int i = 0; i < g_base_sample; i++) {
+    float x = (float)g_base_in[i];
+    float y = b0 * x + b1 * x1 + b2 * x2 + a1 * y1 + a2 * y2;
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    g_base_out[i] = (q15_t)y;
+  }
+}
+
+static void skip(const char *name, int len, int chnum)
+{
+  g_skip_count++;
+  printf("%s, %d, %d, -, skipped (not enough memory)\n", name, len, chnum);
+}
+
+/*-----------------------------------------------------------------*/
+/* FFTClass                                                        */
+/*-----------------------------------------------------------------*/
+template <int CHNUM, int LEN> void bench_fft(windowType_t type)
+{
+  typedef FFTClass<CHNUM, LEN> fft_t;
+
+  /* The ring buffers are allocated by begin() */
+  int required = sizeof(fft_t) + (CHNUM * CHNUM * LEN * sizeof(q15_t) * sizeof(q15_t));
+  if (heap_largest() < required) {
+    skip("FFT", LEN, CHNUM);
+    return;
+  }
+
+  int base = heap_used();
+  fft_t *fft = new fft_t;
+  q15_t *in  = (q15_t*)malloc(LEN * CHNUM * sizeof(q15_t));
+  float *out = (float*)malloc(LEN * sizeof(float));
+
+  if (!fft || !in || !out) {
+    delete fft;
+    free(in);
+    free(out);
+    skip("FFT", LEN, CHNUM);
+    return;
+  }
+
+  if (!fft->begin(type, CHNUM, LEN / 2)) {
+    puts("FFT begin error");
+    exit(1);
+  }
+  int bytes = heap_used() - base - (LEN * CHNUM * sizeof(q15_t)) - (LEN * sizeof(float));
+
+  make_signal(in, LEN, CHNUM);
+
+  int frame = 0;
+  int sample = 0;
+  float usec = measure([&]() {
+    frame = 0;
+    sample = 0;
+    for (int n = 0; n < g_iteration; n++) {
+      fft->put(in, LEN);
+      while (!fft->empty(0)) {
+        for (int ch = 0; ch < CHNUM; ch++) {
+          int ret = fft->get(out, ch);
+          if (ch == 0) {
+            sample += ret;
+          }
+        }
+        frame++;
+      }
+    }
+  });
+
+  report("FFT", LEN, CHNUM, g_window_name[type], sample, usec, frame, bytes);
+
+  fft->end();
+  delete fft;
+  free(in);
+  free(out);
+}
+
+template <int CHNUM, int LEN> void bench_fft_windows()
+{
+  bench_fft<CHNUM, LEN>(WindowHamming);
+  bench_fft<CHNUM, LEN>(WindowHanning);
+  bench_fft<CHNUM, LEN>(WindowFlattop);
+  bench_fft<CHNUM, LEN>(WindowRectangle);
+  bench_fft<CHNUM, LEN>(WindowBlackmanHarris);
+  bench_fft<CHNUM, LEN>(WindowKaiser);
+}
+
+template <int CHNUM> void bench_fft_lengths()
+{
+  bench_fft_windows<CHNUM, 32>();
+  bench_fft_windows<CHNUM, 64>();
+  bench_fft_windows<CHNUM, 128>();
+  bench_fft_windows<CHNUM, 256>();
+  bench_fft_windows<CHNUM, 512>();
+  bench_fft_windows<CHNUM, 1024>();
+  bench_fft_windows<CHNUM, 2048>();
+  bench_fft_windows<CHNUM, 4096>();
+}
+
+/*-----------------------------------------------------------------*/
+/* FFTFixedClass (compared with FFTClass)                          */
+/*-----------------------------------------------------------------*/
+template <int CHNUM, int LEN, typename T> void bench_fft_fixed(const char *name)
+{
+  typedef FFTFixedClass<CHNUM, LEN, T> fixed_t;
+  typedef FFTClass<CHNUM, LEN> ref_t;
+
+  int required = sizeof(fixed_t) + sizeof(ref_t) +
+                 2 * (CHNUM * CHNUM * LEN * sizeof(q15_t) * sizeof(q15_t));
+  if (heap_largest() < required) {
+    skip(name, LEN, CHNUM);
+    return;
+  }
+
+  int base = heap_used();
+  fixed_t *fft = new fixed_t;
+  if (!fft || !fft->begin(WindowHanning, CHNUM, LEN / 2)) {
+    delete fft;
+    skip(name, LEN, CHNUM);
+    return;
+  }
+  int bytes = heap_used() - base;
+
+  ref_t *ref = new ref_t;
+  q15_t *in   = (q15_t*)malloc(LEN * CHNUM * sizeof(q15_t));
+  T     *out  = (T*)malloc(LEN / 2 * sizeof(T));
+  float *fout = (float*)malloc(LEN / 2 * sizeof(float));
+  if (!ref || !in || !out || !fout || !ref->begin(WindowHanning, CHNUM, LEN / 2)) {
+    delete fft;
+    delete ref;
+    free(in);
+    free(out);
+    free(fout);
+    skip(name, LEN, CHNUM);
+    return;
+  }
+
+  make_signal(in, LEN, CHNUM);
+
+  /* Speed */
+  int frame = 0;
+  int sample = 0;
+  float usec = measure([&]() {
+    frame = 0;
+    sample = 0;
+    for (int n = 0; n < g_iteration; n++) {
+      fft->put(in, LEN);
+      while (!fft->empty(0)) {
+        for (int ch = 0; ch < CHNUM; ch++) {
+          int ret = fft->get(out, ch);
+          if (ch == 0) {
+            sample += ret;
+          }
+        }
+        frame++;
+      }
+    }
+  });
+
+  /* Accuracy of the last frame of channel 0 against the float path */
+  fft->begin(WindowHanning, CHNUM, LEN / 2);
+  fft->put(in, LEN);
+  ref->put(in, LEN);
+  fft->get(out, 0);
+  ref->get(fout, 0);
+
+  float signal = 0.0f;
+  float noise = 0.0f;
+  for (int i = 0; i < LEN / 2; i++) {
+    float diff = (float)out[i] * fixed_t::scale() - fout[i];
+    signal += fout[i] * fout[i];
+    noise += diff * diff;
+  }
+  float snr = (noise == 0.0f) ? 999.0f : 10.0f * log10f(signal / noise);
+
+  report(name, LEN, CHNUM, "Hanning", sample, usec, frame, bytes);
+  printf("  SNR against float: %.1f dB\n", snr);
+
+  delete fft;
+  delete ref;
+  free(in);
+  free(out);
+  free(fout);
+}
+
+template <int CHNUM> void bench_fft_fixed_lengths()
+{
+  bench_fft_fixed<CHNUM, 32,   q15_t>("FFTq15");
+  bench_fft_fixed<CHNUM, 32,   q31_t>("FFTq31");
+  bench_fft_fixed<CHNUM, 64,   q15_t>("FFTq15");
+  bench_fft_fixed<CHNUM, 64,   q31_t>("FFTq31");
+  bench_fft_fixed<CHNUM, 128,  q15_t>("FFTq15");
+  bench_fft_fixed<CHNUM, 128,  q31_t>("FFTq31");
+  bench_fft_fixed<CHNUM, 256,  q15_t>("FFTq15");
+  bench_fft_fixed<CHNUM, 256,  q31_t>("FFTq31");
+  bench_fft_fixed<CHNUM, 512,  q15_t>("FFTq15");
+  bench_fft_fixed<CHNUM, 512,  q31_t>("FFTq31");
+  bench_fft_fixed<CHNUM, 1024, q15_t>("FFTq15");
+  bench_fft_fixed<CHNUM, 1024, q31_t>("FFTq31");
+  bench_fft_fixed<CHNUM, 2048, q15_t>("FFTq15");
+  bench_fft_fixed<CHNUM, 2048, q31_t>("FFTq31");
+  bench_fft_fixed<CHNUM, 4096, q15_t>("FFTq15");
+  bench_fft_fixed<CHNUM, 4096, q31_t>("FFTq31");
+}
+
+/*-----------------------------------------------------------------*/
+/* IIRClass                                                        */
+/*-----------------------------------------------------------------*/
+static void bench_iir(int chnum, int framesize)
+{
+  IIRClass iir;
+
+  q15_t *in  = (q15_t*)malloc(framesize * chnum * sizeof(q15_t));
+  q15_t *out = (q15_t*)malloc(framesize * sizeof(q15_t));
+  if (!in || !out) {
+    free(in);
+    free(out);
+    skip("IIR", framesize, chnum);
+    return;
+  }
+
+  int base = heap_used();
+  if (!iir.begin(TYPE_LPF, chnum, 1000, sqrt(0.5), framesize)) {
+    free(in);
+    free(out);
+    skip("IIR", framesize, chnum);
+    return;
+  }
+  int bytes = heap_used() - base;
+
+  make_signal(in, framesize, chnum);
+
+  int frame = 0;
+  int sample = 0;
+  float usec = measure([&]() {
+    frame = 0;
+    sample = 0;
+    for (int n = 0; n < g_iteration; n++) {
+      iir.put(in, framesize);
+      while (!iir.empty(0)) {
+        for (int ch = 0; ch < chnum; ch++) {
+          int ret = iir.get(out, ch);
+          if (ch == 0) {
+            sample += ret;
+          }
+        }
+        frame++;
+      }
+    }
+  });
+
+  report("IIR", framesize, chnum, "-", sample, usec, frame, bytes);
+
+  iir.end();
+  free(in);
+  free(out);
+}
+
+/*-----------------------------------------------------------------*/
+/* RingBuff                                                        */
+/*-----------------------------------------------------------------*/
+static void bench_ringbuff(int chnum, int sample)
+{
+  q15_t *in  = (q15_t*)malloc(sample * chnum * sizeof(q15_t));
+  float *out = (float*)malloc(sample * sizeof(float));
+  if (!in || !out) {
+    free(in);
+    free(out);
+    skip("RingBuff", sample, chnum);
+    return;
+  }
+
+  int base = heap_used();
+  RingBuff *ring[IIRClass::MAX_CHANNEL_NUM];
+  for (int ch = 0; ch < chnum; ch++) {
+    ring[ch] = new RingBuff(sample * 2);
+  }
+  int bytes = heap_used() - base;
+
+  make_signal(in, sample, chnum);
+
+  float usec = measure([&]() {
+    for (int n = 0; n < g_iteration; n++) {
+      for (int ch = 0; ch < chnum; ch++) {
+        if (chnum == 1) {
+          ring[ch]->put(in, sample);
+        } else {
+          ring[ch]->put(in, sample, chnum, ch);
+        }
+      }
+      for (int ch = 0; ch < chnum; ch++) {
+        ring[ch]->get(out, sample);
+      }
+    }
+  });
+
+  report("RingBuff", sample, chnum, "-", sample * g_iteration, usec,
+         g_iteration, bytes);
+
+  for (int ch = 0; ch < chnum; ch++) {
+    delete ring[ch];
+  }
+  free(in);
+  free(out);
+}
+
+/*-----------------------------------------------------------------*/
+/* Main                                                            */
+/*-----------------------------------------------------------------*/
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  init_baseline();
+  measure(run_baseline);
+  printf("Baseline: %.2f ns/sample\n", g_base_ns);
+
+  puts("name, len, channel, window, samples/sec, ns/frame, bytes, ratio");
+
+  bench_fft_lengths<1>();
+  bench_fft_lengths<2>();
+  bench_fft_lengths<3>();
+  bench_fft_lengths<4>();
+  bench_fft_lengths<5>();
+  bench_fft_lengths<6>();
+  bench_fft_lengths<7>();
+  bench_fft_lengths<8>();
+
+  bench_fft_fixed_lengths<1>();
+  bench_fft_fixed_lengths<4>();
+
+  for (int ch = 1; ch <= IIRClass::MAX_CHANNEL_NUM; ch++) {
+    for (int size = IIRClass::MIN_FRAMESIZE; size <= 4 * IIRClass::DEFAULT_FRAMESIZE; size *= 2) {
+      bench_iir(ch, size);
+    }
+  }
+
+  for (int ch = 1; ch <= IIRClass::MAX_CHANNEL_NUM; ch++) {
+    for (int size = 32; size <= 4096; size *= 2) {
+      bench_ringbuff(ch, size);
+    }
+  }
+
+  if (g_record) {
+    print_recorded();
+    return;
+  }
+
+  printf("Result: %s (fail %d, skip %d, no reference %d)\n",
+         (g_fail_count == 0) ? "PASS" : "FAIL", g_fail_count, g_skip_count,
+         g_noref_count);
+
+  if (g_fail_count > 0) {
+    ledOn(LED3);
+  } else {
+    ledOn(LED0);
+  }
+}
+
+void loop()
+{
+}
+
+#ifdef SIGNALPROCESSING_HOST
+int main(int argc, char *argv[])
+{
+  g_record = (argc > 1) && (strcmp(argv[1], "-r") == 0);
+  setup();
+  return (g_fail_count > 0) ? 1 : 0;
+}
+#endif
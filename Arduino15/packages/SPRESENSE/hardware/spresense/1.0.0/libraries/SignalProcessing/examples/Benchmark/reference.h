@@ -0,0 +1,241 @@
+/*
+ *  reference.h - Reference numbers of the SignalProcessing benchmark
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _BENCHMARK_REFERENCE_H_
+#define _BENCHMARK_REFERENCE_H_
+
+/* Time per sample and channel of a case, as a ratio to the baseline.
+ * The window does not change the cost, so FFT has one entry for all of them.
+ */
+struct Reference {
+  const char *name;
+  int len;
+  int chnum;
+  float ratio;
+};
+
+#ifdef SIGNALPROCESSING_HOST
+/* tools/dsp_host with g++ 12 -O2 on x86-64, the largest of 3 recorded runs.
+ * The time on a PC depends on the machine and its load, so record a table
+ * on the machine used for the comparison.
+ */
+static const Reference g_reference[] = {
+  { "FFT", 32, 1, 9.54f },
+  { "FFT", 64, 1, 12.01f },
+  { "FFT", 128, 1, 13.19f },
+  { "FFT", 256, 1, 14.18f },
+  { "FFT", 512, 1, 15.54f },
+  { "FFT", 1024, 1, 16.88f },
+  { "FFT", 2048, 1, 18.66f },
+  { "FFT", 4096, 1, 19.55f },
+  { "FFT", 32, 2, 11.35f },
+  { "FFT", 64, 2, 12.48f },
+  { "FFT", 128, 2, 13.14f },
+  { "FFT", 256, 2, 15.11f },
+  { "FFT", 512, 2, 15.73f },
+  { "FFT", 1024, 2, 15.94f },
+  { "FFT", 2048, 2, 17.89f },
+  { "FFT", 4096, 2, 22.27f },
+  { "FFT", 32, 3, 12.47f },
+  { "FFT", 64, 3, 12.85f },
+  { "FFT", 128, 3, 13.52f },
+  { "FFT", 256, 3, 14.43f },
+  { "FFT", 512, 3, 15.74f },
+  { "FFT", 1024, 3, 15.95f },
+  { "FFT", 2048, 3, 19.05f },
+  { "FFT", 4096, 3, 22.58f },
+  { "FFT", 32, 4, 11.74f },
+  { "FFT", 64, 4, 12.87f },
+  { "FFT", 128, 4, 13.68f },
+  { "FFT", 256, 4, 14.53f },
+  { "FFT", 512, 4, 15.79f },
+  { "FFT", 1024, 4, 18.60f },
+  { "FFT", 2048, 4, 18.38f },
+  { "FFT", 4096, 4, 19.55f },
+  { "FFT", 32, 5, 11.20f },
+  { "FFT", 64, 5, 14.24f },
+  { "FFT", 128, 5, 13.12f },
+  { "FFT", 256, 5, 15.48f },
+  { "FFT", 512, 5, 16.68f },
+  { "FFT", 1024, 5, 17.70f },
+  { "FFT", 2048, 5, 18.94f },
+  { "FFT", 4096, 5, 18.99f },
+  { "FFT", 32, 6, 11.15f },
+  { "FFT", 64, 6, 12.65f },
+  { "FFT", 128, 6, 14.05f },
+  { "FFT", 256, 6, 14.91f },
+  { "FFT", 512, 6, 16.95f },
+  { "FFT", 1024, 6, 17.22f },
+  { "FFT", 2048, 6, 18.38f },
+  { "FFT", 4096, 6, 30.39f },
+  { "FFT", 32, 7, 11.15f },
+  { "FFT", 64, 7, 11.53f },
+  { "FFT", 128, 7, 13.28f },
+  { "FFT", 256, 7, 15.38f },
+  { "FFT", 512, 7, 17.57f },
+  { "FFT", 1024, 7, 17.78f },
+  { "FFT", 2048, 7, 18.17f },
+  { "FFT", 4096, 7, 20.09f },
+  { "FFT", 32, 8, 10.26f },
+  { "FFT", 64, 8, 12.07f },
+  { "FFT", 128, 8, 13.20f },
+  { "FFT", 256, 8, 14.29f },
+  { "FFT", 512, 8, 15.35f },
+  { "FFT", 1024, 8, 16.75f },
+  { "FFT", 2048, 8, 18.75f },
+  { "FFT", 4096, 8, 22.39f },
+  { "FFTq15", 32, 1, 16.03f },
+  { "FFTq31", 32, 1, 16.66f },
+  { "FFTq15", 64, 1, 17.53f },
+  { "FFTq31", 64, 1, 17.87f },
+  { "FFTq15", 128, 1, 18.75f },
+  { "FFTq31", 128, 1, 19.33f },
+  { "FFTq15", 256, 1, 20.12f },
+  { "FFTq31", 256, 1, 20.95f },
+  { "FFTq15", 512, 1, 21.76f },
+  { "FFTq31", 512, 1, 22.75f },
+  { "FFTq15", 1024, 1, 22.73f },
+  { "FFTq31", 1024, 1, 23.04f },
+  { "FFTq15", 2048, 1, 23.19f },
+  { "FFTq31", 2048, 1, 23.39f },
+  { "FFTq15", 4096, 1, 25.87f },
+  { "FFTq31", 4096, 1, 26.32f },
+  { "FFTq15", 32, 4, 16.04f },
+  { "FFTq31", 32, 4, 16.49f },
+  { "FFTq15", 64, 4, 16.76f },
+  { "FFTq31", 64, 4, 18.19f },
+  { "FFTq15", 128, 4, 19.12f },
+  { "FFTq31", 128, 4, 19.28f },
+  { "FFTq15", 256, 4, 20.21f },
+  { "FFTq31", 256, 4, 21.05f },
+  { "FFTq15", 512, 4, 21.73f },
+  { "FFTq31", 512, 4, 22.17f },
+  { "FFTq15", 1024, 4, 23.05f },
+  { "FFTq31", 1024, 4, 23.18f },
+  { "FFTq15", 2048, 4, 24.79f },
+  { "FFTq31", 2048, 4, 24.60f },
+  { "FFTq15", 4096, 4, 26.65f },
+  { "FFTq31", 4096, 4, 26.86f },
+  { "IIR", 240, 1, 2.00f },
+  { "IIR", 480, 1, 2.05f },
+  { "IIR", 960, 1, 1.98f },
+  { "IIR", 1920, 1, 1.94f },
+  { "IIR", 240, 2, 2.17f },
+  { "IIR", 480, 2, 2.12f },
+  { "IIR", 960, 2, 2.15f },
+  { "IIR", 1920, 2, 2.20f },
+  { "IIR", 240, 3, 2.26f },
+  { "IIR", 480, 3, 2.28f },
+  { "IIR", 960, 3, 2.25f },
+  { "IIR", 1920, 3, 2.29f },
+  { "IIR", 240, 4, 2.23f },
+  { "IIR", 480, 4, 2.16f },
+  { "IIR", 960, 4, 2.11f },
+  { "IIR", 1920, 4, 2.07f },
+  { "IIR", 240, 5, 2.24f },
+  { "IIR", 480, 5, 2.27f },
+  { "IIR", 960, 5, 2.22f },
+  { "IIR", 1920, 5, 2.30f },
+  { "IIR", 240, 6, 2.25f },
+  { "IIR", 480, 6, 2.20f },
+  { "IIR", 960, 6, 2.25f },
+  { "IIR", 1920, 6, 2.17f },
+  { "IIR", 240, 7, 2.27f },
+  { "IIR", 480, 7, 2.28f },
+  { "IIR", 960, 7, 2.20f },
+  { "IIR", 1920, 7, 2.27f },
+  { "IIR", 240, 8, 2.24f },
+  { "IIR", 480, 8, 2.22f },
+  { "IIR", 960, 8, 2.23f },
+  { "IIR", 1920, 8, 2.26f },
+  { "RingBuff", 32, 1, 0.37f },
+  { "RingBuff", 64, 1, 0.31f },
+  { "RingBuff", 128, 1, 0.29f },
+  { "RingBuff", 256, 1, 0.27f },
+  { "RingBuff", 512, 1, 0.27f },
+  { "RingBuff", 1024, 1, 0.28f },
+  { "RingBuff", 2048, 1, 0.27f },
+  { "RingBuff", 4096, 1, 0.27f },
+  { "RingBuff", 32, 2, 0.49f },
+  { "RingBuff", 64, 2, 0.47f },
+  { "RingBuff", 128, 2, 0.48f },
+  { "RingBuff", 256, 2, 0.48f },
+  { "RingBuff", 512, 2, 0.47f },
+  { "RingBuff", 1024, 2, 0.45f },
+  { "RingBuff", 2048, 2, 0.46f },
+  { "RingBuff", 4096, 2, 0.30f },
+  { "RingBuff", 32, 3, 0.51f },
+  { "RingBuff", 64, 3, 0.45f },
+  { "RingBuff", 128, 3, 0.48f },
+  { "RingBuff", 256, 3, 0.48f },
+  { "RingBuff", 512, 3, 0.46f },
+  { "RingBuff", 1024, 3, 0.44f },
+  { "RingBuff", 2048, 3, 0.43f },
+  { "RingBuff", 4096, 3, 0.43f },
+  { "RingBuff", 32, 4, 0.49f },
+  { "RingBuff", 64, 4, 0.51f },
+  { "RingBuff", 128, 4, 0.48f },
+  { "RingBuff", 256, 4, 0.49f },
+  { "RingBuff", 512, 4, 0.50f },
+  { "RingBuff", 1024, 4, 0.45f },
+  { "RingBuff", 2048, 4, 0.41f },
+  { "RingBuff", 4096, 4, 0.45f },
+  { "RingBuff", 32, 5, 0.52f },
+  { "RingBuff", 64, 5, 0.49f },
+  { "RingBuff", 128, 5, 0.48f },
+  { "RingBuff", 256, 5, 0.42f },
+  { "RingBuff", 512, 5, 0.37f },
+  { "RingBuff", 1024, 5, 0.43f },
+  { "RingBuff", 2048, 5, 0.42f },
+  { "RingBuff", 4096, 5, 0.42f },
+  { "RingBuff", 32, 6, 0.49f },
+  { "RingBuff", 64, 6, 0.38f },
+  { "RingBuff", 128, 6, 0.42f },
+  { "RingBuff", 256, 6, 0.40f },
+  { "RingBuff", 512, 6, 0.41f },
+  { "RingBuff", 1024, 6, 0.36f },
+  { "RingBuff", 2048, 6, 0.39f },
+  { "RingBuff", 4096, 6, 0.43f },
+  { "RingBuff", 32, 7, 0.48f },
+  { "RingBuff", 64, 7, 0.44f },
+  { "RingBuff", 128, 7, 0.40f },
+  { "RingBuff", 256, 7, 0.45f },
+  { "RingBuff", 512, 7, 0.42f },
+  { "RingBuff", 1024, 7, 0.43f },
+  { "RingBuff", 2048, 7, 0.44f },
+  { "RingBuff", 4096, 7, 0.43f },
+  { "RingBuff", 32, 8, 0.47f },
+  { "RingBuff", 64, 8, 0.38f },
+  { "RingBuff", 128, 8, 0.42f },
+  { "RingBuff", 256, 8, 0.46f },
+  { "RingBuff", 512, 8, 0.37f },
+  { "RingBuff", 1024, 8, 0.39f },
+  { "RingBuff", 2048, 8, 0.40f },
+  { "RingBuff", 4096, 8, 0.41f },
+};
+#else
+/* Not recorded yet. Run the sketch with g_record = true on the board, and
+ * replace this table with the printed one.
+ */
+static const Reference g_reference[] = {
+  { NULL, 0, 0, 0.0f },
+};
+#endif
+
+#endif /* _BENCHMARK_REFERENCE_H_ */
@@ -0,0 +1,246 @@
+/*
+ *  IIRCascadeCheck.ino - Response check of the IIR cascade filter
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * This sketch checks IIRCascadeClass against a reference biquad in direct
+ * form I, designed by the bilinear transform with the Audio EQ Cookbook
+ * formulas. The impulse and step responses must match within g_tolerance
+ * of full scale, for the float path, the q15 path (within 1 LSB) and
+ * several interleaved channels.
+ *
+ * The sketch can also be built and run on a PC with the CMSIS-DSP shim in
+ * tools/dsp_host:
+ *   make -C tools/dsp_host check
+ */
+
+#include "IIRCascade.h"
+
+/* Parameters */
+const int   g_fs        = 48000;
+const float g_cutoff    = 1000.0f;
+const int   g_length    = 512;  /* Samples of each response */
+const float g_tolerance = 1e-4f;
+
+static int g_fail_count = 0;
+
+/*-----------------------------------------------------------------*/
+/* Reference biquad                                                */
+/*-----------------------------------------------------------------*/
+struct RefBiquad {
+  float b0, b1, b2, a1, a2;
+  float x1, x2, y1, y2;
+
+  void design(filterType_t type, float cutoff, float q)
+  {
+    float w0 = 2.0f * PI * cutoff / g_fs;
+    float cs = cos(w0);
+    float alpha = sin(w0) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+
+    if (type == TYPE_LPF) {
+      b0 = (1.0f - cs) / 2.0f / a0;
+      b1 = (1.0f - cs) / a0;
+    } else {
+      b0 = (1.0f + cs) / 2.0f / a0;
+      b1 = -(1.0f + cs) / a0;
+    }
+    b2 = b0;
+    a1 = -2.0f * cs / a0;
+    a2 = (1.0f - alpha) / a0;
+    x1 = x2 = y1 = y2 = 0.0f;
+  }
+
+  float process(float x)
+  {
+    float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    return y;
+  }
+};
+
+/* Input of the response: impulse or step, delayed by delay samples */
+static float input(bool step, int i, int delay)
+{
+  if (i < delay) {
+    return 0.0f;
+  }
+  return (step || (i == delay)) ? 1.0f : 0.0f;
+}
+
+static void result(const char *name, float error, float limit)
+{
+  bool fail = !(error <= limit);
+
+  if (fail) {
+    g_fail_count++;
+  }
+
+  printf("%-28s max error %.2e %s\n", name, error, fail ? "FAIL" : "OK");
+}
+
+/*-----------------------------------------------------------------*/
+/* Checks                                                          */
+/*-----------------------------------------------------------------*/
+/* Float path of a Butterworth filter against cascaded reference
+ * biquads with the Q of each pole pair.
+ */
+static void check_float(const char *name, filterType_t type, int order,
+                        bool step, int channel)
+{
+  static float buf[g_length * IIRCascadeClass::MAX_CHANNEL_NUM];
+  IIRCascadeClass iir;
+  RefBiquad ref[IIRCascadeClass::MAX_STAGE_NUM];
+
+  if (!iir.begin(type, DESIGN_BUTTERWORTH, order, channel, g_cutoff, g_fs)) {
+    printf("%-28s begin error %d FAIL\n", name, iir.getErrorCause());
+    g_fail_count++;
+    return;
+  }
+
+  for (int i = 0; i < g_length; i++) {
+    for (int ch = 0; ch < channel; ch++) {
+      buf[i * channel + ch] = input(step, i, ch);
+    }
+  }
+
+  /* Process in two parts to check that the state is kept between calls */
+  iir.process(buf, g_length / 3);
+  iir.process(&buf[(g_length / 3) * channel], g_length - g_length / 3);
+
+  float error = 0.0f;
+  for (int ch = 0; ch < channel; ch++) {
+    for (int s = 0; s < order / 2; s++) {
+      float theta = PI * (2 * s + 1) / (2 * order);
+      ref[s].design(type, g_cutoff, 1.0f / (2.0f * sin(theta)));
+    }
+
+    for (int i = 0; i < g_length; i++) {
+      float y = input(step, i, ch);
+      for (int s = 0; s < order / 2; s++) {
+        y = ref[s].process(y);
+      }
+      float diff = fabs(buf[i * channel + ch] - y);
+      error = (diff > error) ? diff : error;
+    }
+  }
+
+  result(name, error, g_tolerance);
+}
+
+/* q15 path of a 2nd order filter on a step of half scale */
+static void check_q15(const char *name, filterType_t type)
+{
+  static q15_t buf[g_length];
+  IIRCascadeClass iir;
+  RefBiquad ref;
+
+  if (!iir.begin(type, DESIGN_BUTTERWORTH, 2, 1, g_cutoff, g_fs)) {
+    printf("%-28s begin error %d FAIL\n", name, iir.getErrorCause());
+    g_fail_count++;
+    return;
+  }
+
+  for (int i = 0; i < g_length; i++) {
+    buf[i] = 16384;
+  }
+  iir.process(buf, g_length);
+
+  ref.design(type, g_cutoff, sqrt(0.5f));
+
+  float error = 0.0f;
+  for (int i = 0; i < g_length; i++) {
+    float diff = fabs(buf[i] - ref.process(16384.0f));
+    error = (diff > error) ? diff : error;
+  }
+
+  /* Rounding of the output, plus the float error at the q15 scale */
+  result(name, error, 1.0f);
+}
+
+/* Coefficients given by the application, same as the reference */
+static void check_coef(const char *name)
+{
+  static float buf[g_length];
+  IIRCascadeClass iir;
+  RefBiquad ref;
+
+  ref.design(TYPE_LPF, g_cutoff, 0.7f);
+
+  /* IIRCascadeClass uses the CMSIS sign of a1 and a2 */
+  float coef[IIRCascadeClass::COEF_NUM] = { ref.b0, ref.b1, ref.b2, -ref.a1, -ref.a2 };
+
+  if (!iir.begin(coef, 1, 1)) {
+    printf("%-28s begin error %d FAIL\n", name, iir.getErrorCause());
+    g_fail_count++;
+    return;
+  }
+
+  for (int i = 0; i < g_length; i++) {
+    buf[i] = input(false, i, 0);
+  }
+  iir.process(buf, g_length);
+
+  float error = 0.0f;
+  for (int i = 0; i < g_length; i++) {
+    float diff = fabs(buf[i] - ref.process(input(false, i, 0)));
+    error = (diff > error) ? diff : error;
+  }
+
+  result(name, error, g_tolerance);
+}
+
+/*-----------------------------------------------------------------*/
+/* Main                                                            */
+/*-----------------------------------------------------------------*/
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial);
+
+  printf("Butterworth %d Hz at %d Hz, %d samples\n", (int)g_cutoff, g_fs, g_length);
+
+  check_float("LPF order 2 impulse",        TYPE_LPF, 2, false, 1);
+  check_float("LPF order 2 step",           TYPE_LPF, 2, true,  1);
+  check_float("HPF order 2 impulse",        TYPE_HPF, 2, false, 1);
+  check_float("HPF order 2 step",           TYPE_HPF, 2, true,  1);
+  check_float("LPF order 4 impulse",        TYPE_LPF, 4, false, 1);
+  check_float("HPF order 8 step",           TYPE_HPF, 8, true,  1);
+  check_float("LPF order 4 impulse, 3ch",   TYPE_LPF, 4, false, 3);
+  check_float("HPF order 2 step, 8ch",      TYPE_HPF, 2, true,  8);
+  check_q15("LPF q15 step",                 TYPE_LPF);
+  check_q15("HPF q15 step",                 TYPE_HPF);
+  check_coef("Coefficients impulse");
+
+  printf("Result: %s (fail %d)\n", (g_fail_count == 0) ? "PASS" : "FAIL", g_fail_count);
+}
+
+void loop()
+{
+}
+
+#ifdef SIGNALPROCESSING_HOST
+int main()
+{
+  setup();
+  return (g_fail_count > 0) ? 1 : 0;
+}
+#endif
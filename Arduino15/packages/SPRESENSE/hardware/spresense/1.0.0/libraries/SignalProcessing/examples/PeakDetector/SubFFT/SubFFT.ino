@@ -19,7 +19,7 @@
 
 #include <MP.h>
 
-#include "FFT.h"
+#include "STFT.h"
 
 /*-----------------------------------------------------------------*/
 /*
@@ -41,7 +41,7 @@
 //#define MAX_CHANNEL_NUM 2
 #define MAX_CHANNEL_NUM 4
 
-FFTClass<MAX_CHANNEL_NUM, FFT_LEN> FFT;
+STFTClass<MAX_CHANNEL_NUM, FFT_LEN> FFT;
 
 /* Allocate the larger heap size than default */
 
@@ -81,7 +81,8 @@ void setup()
   /* receive with non-blocking */
   MP.RecvTimeout(MP_RECV_POLLING);
 
-  FFT.begin();
+  /* Hanning window, 50% overlap, spectrum in dB for accurate peak interpolation */
+  FFT.begin(WindowHanning, MAX_CHANNEL_NUM, FFT_LEN / 2, SpectrumDecibel);
 }
 
 #define RESULT_SIZE 4
@@ -95,6 +96,7 @@ void loop()
   static int pos = 0;
 
   static float pDst[FFT_LEN / 2];
+  spectrumPeak_t peak;
 
   /* Receive PCM captured buffer from MainCore */
   ret = MP.Recv(&rcvid, &request);
@@ -106,8 +108,9 @@ void loop()
     result[pos].clear();
     result[pos].channel = MAX_CHANNEL_NUM;
     for (int i = 0; i < MAX_CHANNEL_NUM; i++) {
-      FFT.get(pDst, i);
-      result[pos].peak[i] = get_peak_frequency(pDst, FFT_LEN);
+      /* The peak is detected while calculating the spectrum */
+      FFT.get(pDst, i, &peak, 1);
+      result[pos].peak[i] = peak.freq;
 //    printf("%8.3f, ", result[pos].peak[i]);
     }
 //  printf("\n");
@@ -120,23 +123,6 @@ void loop()
   }
 }
 
-float get_peak_frequency(float *pData, int fftLen)
-{
-  float g_fs = 48000.0f;
-  uint32_t index;
-  float maxValue;
-  float delta;
-  float peakFs;
-
-  arm_max_f32(pData, fftLen / 2, &maxValue, &index);
-
-  delta = 0.5 * (pData[index - 1] - pData[index + 1])
-    / (pData[index - 1] + pData[index + 1] - (2.0f * pData[index]));
-  peakFs = (index + delta) * g_fs / (fftLen - 1);
-
-  return peakFs;
-}
-
 void errorLoop(int num)
 {
   int i;
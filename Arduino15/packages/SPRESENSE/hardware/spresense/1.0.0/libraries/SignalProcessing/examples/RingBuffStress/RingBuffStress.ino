@@ -0,0 +1,128 @@
+/*
+ *  RingBuffStress.ino - Stress test of the lock-free SPSC Ring Buffer
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * A producer thread writes an incrementing sequence with reserve/commit
+ * in random batch sizes, and a consumer thread reads it back with
+ * peek/release and checks that no sample is lost or duplicated.
+ */
+
+#include <pthread.h>
+
+/* Use CMSIS library */
+#define ARM_MATH_CM4
+#define __FPU_PRESENT 1U
+#include <cmsis/arm_math.h>
+
+#include "SpscRingBuff.h"
+
+/* Parameters */
+const int      g_buffer_size = 1000; /* Rounded up to 1024 */
+const int      g_max_batch   = 300;
+const uint32_t g_total       = 4 * 1024 * 1024; /* Samples to transfer */
+
+SpscRingBuff g_ring(g_buffer_size);
+
+static volatile uint32_t g_errors = 0;
+static volatile uint32_t g_full_count = 0;
+static volatile uint32_t g_empty_count = 0;
+
+static void *producer(void *arg)
+{
+  uint32_t seq = 0;
+  uint32_t seed = 1;
+
+  while (seq < g_total) {
+    seed = seed * 1103515245 + 12345;
+    int batch = 1 + (seed >> 16) % g_max_batch;
+
+    q15_t *span;
+    int len = g_ring.reserve(&span, batch);
+    if (len == 0) {
+      g_full_count++;
+      sched_yield();
+      continue;
+    }
+    for (int i = 0; i < len; i++) {
+      span[i] = (q15_t)(seq + i);
+    }
+    g_ring.commit(len);
+    seq += len;
+  }
+  return NULL;
+}
+
+static void *consumer(void *arg)
+{
+  uint32_t seq = 0;
+  uint32_t seed = 7;
+
+  while (seq < g_total) {
+    seed = seed * 1103515245 + 12345;
+    int batch = 1 + (seed >> 16) % g_max_batch;
+
+    q15_t *span;
+    int len = g_ring.peek(&span, batch);
+    if (len == 0) {
+      g_empty_count++;
+      sched_yield();
+      continue;
+    }
+    for (int i = 0; i < len; i++) {
+      if (span[i] != (q15_t)(seq + i)) {
+        g_errors++;
+      }
+    }
+    g_ring.release(len);
+    seq += len;
+  }
+  return NULL;
+}
+
+void setup()
+{
+  pthread_t prod;
+  pthread_t cons;
+
+  Serial.begin(115200);
+  while (!Serial);
+
+  printf("Transfer %d samples through %d samples buffer\n",
+         (int)g_total, g_ring.capacity());
+
+  unsigned long start = millis();
+
+  pthread_create(&cons, NULL, consumer, NULL);
+  pthread_create(&prod, NULL, producer, NULL);
+
+  pthread_join(prod, NULL);
+  pthread_join(cons, NULL);
+
+  unsigned long msec = millis() - start;
+
+  printf("Elapsed %lu ms, full %d, empty %d, remaining %d\n",
+         msec, (int)g_full_count, (int)g_empty_count, g_ring.stored());
+  printf("Result: %s (errors %d)\n",
+         ((g_errors == 0) && (g_ring.stored() == 0)) ? "PASS" : "FAIL",
+         (int)g_errors);
+}
+
+void loop()
+{
+}
@@ -35,15 +35,108 @@ typedef enum e_windowType {
   WindowHamming,
   WindowHanning,
   WindowFlattop,
-  WindowRectangle
+  WindowRectangle,
+  WindowBlackmanHarris,
+  WindowKaiser
 } windowType_t;
 
+/* Default beta of the Kaiser window (about -90dB side lobes) */
+#define WINDOW_KAISER_BETA 8.6f
+
+/*------------------------------------------------------------------*/
+/* Common functions                                                 */
+/*------------------------------------------------------------------*/
+/* Zeroth order modified Bessel function of the first kind */
+static inline float fft_bessel_i0(float x) {
+  float sum = 1.0f;
+  float term = 1.0f;
+  for (int k = 1; k < 32; k++) {
+    term *= (x / (2.0f * k)) * (x / (2.0f * k));
+    sum += term;
+    if (term < (sum * 1e-8f)) break;
+  }
+  return sum;
+}
+
+/* Create symmetric window coefficients.
+ * param is beta for WindowKaiser and is ignored by the other windows.
+ */
+static inline void fft_create_window(float *coef, int len, windowType_t type, float param) {
+  for (int i = 0; i < len / 2; i++) {
+    float x = 2 * PI * (float)i / (len - 1);
+    if (type == WindowHamming) {
+      coef[i] = 0.54f - (0.46f * arm_cos_f32(x));
+    } else if (type == WindowHanning) {
+      coef[i] = 0.5f - (0.5f * arm_cos_f32(x));
+    } else if (type == WindowFlattop) {
+      coef[i] = 0.21557895f - (0.41663158f  * arm_cos_f32(x))
+                            + (0.277263158f * arm_cos_f32(2 * x))
+                            - (0.083578947f * arm_cos_f32(3 * x))
+                            + (0.006947368f * arm_cos_f32(4 * x));
+    } else if (type == WindowBlackmanHarris) {
+      coef[i] = 0.35875f - (0.48829f * arm_cos_f32(x))
+                         + (0.14128f * arm_cos_f32(2 * x))
+                         - (0.01168f * arm_cos_f32(3 * x));
+    } else if (type == WindowKaiser) {
+      float r = (2.0f * i / (len - 1)) - 1.0f;
+      coef[i] = fft_bessel_i0(param * sqrtf(1.0f - r * r)) / fft_bessel_i0(param);
+    } else {
+      coef[i] = 1;
+    }
+    coef[len - 1 - i] = coef[i];
+  }
+}
+
+static inline bool fft_init_f32(arm_rfft_fast_instance_f32 *S, int len) {
+  switch (len){
+    case 32:
+      arm_rfft_32_fast_init_f32(S);
+      break;
+    case 64:
+      arm_rfft_64_fast_init_f32(S);
+      break;
+    case 128:
+      arm_rfft_128_fast_init_f32(S);
+      break;
+    case 256:
+      arm_rfft_256_fast_init_f32(S);
+      break;
+    case 512:
+      arm_rfft_512_fast_init_f32(S);
+      break;
+    case 1024:
+      arm_rfft_1024_fast_init_f32(S);
+      break;
+    case 2048:
+      arm_rfft_2048_fast_init_f32(S);
+      break;
+    case 4096:
+      arm_rfft_4096_fast_init_f32(S);
+      break;
+    default:
+      puts("error!");
+      return false;
+      break;
+  }
+  return true;
+}
+
 /*------------------------------------------------------------------*/
 /* Input buffer                                                      */
 /*------------------------------------------------------------------*/
 template <int MAX_CHNUM, int FFTLEN> class FFTClass
 {
 public:
+  FFTClass() {
+    for (int i = 0; i < MAX_CHNUM; i++) {
+      ringbuf_fft[i] = NULL;
+    }
+  }
+
+  ~FFTClass() {
+    end();
+  }
+
   void begin(){
       begin(WindowHamming, MAX_CHNUM, (FFTLEN / 2));
   }
@@ -55,6 +148,7 @@ public:
     m_overlap = overlap;
     m_channel = channel;
 
+    end();
     clear();
     create_coef(type);
     if (!fft_init()) {
@@ -77,9 +171,8 @@ public:
       /* the faster optimization */
       ringbuf_fft[0]->put((q15_t*)pSrc, sample);
     } else {
-      for (int i = 0; i < m_channel; i++) {
-        ringbuf_fft[i]->put(pSrc, sample, m_channel, i);
-      }
+      /* Split all channels in one pass */
+      RingBuff::put(ringbuf_fft, pSrc, sample, m_channel);
     }
     return  true;
   }
@@ -94,11 +187,16 @@ public:
 
   void clear() {
     for (int i = 0; i < MAX_CHNUM; i++) {
-      memset(tmpInBuf[i], 0, FFTLEN);
+      memset(tmpInBuf[i], 0, sizeof(tmpInBuf[i]));
     }
   }
 
-  void end(){}
+  void end(){
+    for (int i = 0; i < MAX_CHNUM; i++) {
+      delete ringbuf_fft[i];
+      ringbuf_fft[i] = NULL;
+    }
+  }
 
 
   bool empty(int channel){
@@ -117,57 +215,14 @@ private:
   float tmpInBuf[MAX_CHNUM][FFTLEN];
   float coef[FFTLEN];
   float tmpOutBuf[FFTLEN];
+  float tmpFft[FFTLEN];
 
   void create_coef(windowType_t type) {
-    for (int i = 0; i < FFTLEN / 2; i++) {
-      if (type == WindowHamming) {
-        coef[i] = 0.54f - (0.46f * arm_cos_f32(2 * PI * (float)i / (FFTLEN - 1)));
-      } else if (type == WindowHanning) {
-        coef[i] = 0.54f - (1.0f * arm_cos_f32(2 * PI * (float)i / (FFTLEN - 1)));
-      } else if (type == WindowFlattop) {
-        coef[i] = 0.21557895f - (0.41663158f  * arm_cos_f32(2 * PI * (float)i / (FFTLEN - 1)))
-                              + (0.277263158f * arm_cos_f32(4 * PI * (float)i / (FFTLEN - 1)))
-                              - (0.083578947f * arm_cos_f32(6 * PI * (float)i / (FFTLEN - 1)))
-                              + (0.006947368f * arm_cos_f32(8 * PI * (float)i / (FFTLEN - 1)));
-      } else {
-        coef[i] = 1;
-      }
-      coef[FFTLEN -1 - i] = coef[i];
-    }
+    fft_create_window(coef, FFTLEN, type, WINDOW_KAISER_BETA);
   }
 
   bool fft_init(){
-    switch (FFTLEN){
-      case 32:
-        arm_rfft_32_fast_init_f32(&S);
-        break;
-      case 64:
-        arm_rfft_64_fast_init_f32(&S);
-        break;
-      case 128:
-        arm_rfft_128_fast_init_f32(&S);
-        break;
-      case 256:
-        arm_rfft_256_fast_init_f32(&S);
-        break;
-      case 512:
-        arm_rfft_512_fast_init_f32(&S);
-        break;
-      case 1024:
-        arm_rfft_1024_fast_init_f32(&S);
-        break;
-      case 2048:
-        arm_rfft_2048_fast_init_f32(&S);
-        break;
-      case 4096:
-        arm_rfft_4096_fast_init_f32(&S);
-        break;
-      default:
-        puts("error!");
-        return false;
-        break;
-    }
-    return true;
+    return fft_init_f32(&S, FFTLEN);
   }
 
   void fft(float *pSrc, float *pDst) {
@@ -181,21 +236,15 @@ private:
   }
 
   int get_raw(float* out, int channel, int raw) {
-    static float tmpFft[FFTLEN];
-
     if(channel >= m_channel) return false;
     if (ringbuf_fft[channel]->stored() < FFTLEN) return 0;
 
-    for (int i=0;i<m_overlap;i++) {
-      tmpInBuf[channel][i] = tmpInBuf[channel][FFTLEN - m_overlap + i];
-    }
+    arm_copy_f32(&tmpInBuf[channel][FFTLEN - m_overlap], tmpInBuf[channel], m_overlap);
 
     /* Read from the ring buffer */
     ringbuf_fft[channel]->get(&tmpInBuf[channel][m_overlap], FFTLEN - m_overlap);
 
-    for (int i = 0; i < FFTLEN; i++) {
-      tmpFft[i] = tmpInBuf[channel][i] * coef[i];
-    }
+    arm_mult_f32(tmpInBuf[channel], coef, tmpFft, FFTLEN);
 
     if(raw){
       /* Calculate only FFT */
@@ -0,0 +1,243 @@
+/*
+ *  FFTFixed.h - Fixed-point FFT Library
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _FFTFIXED_H_
+#define _FFTFIXED_H_
+
+#include "FFT.h"
+
+/*------------------------------------------------------------------*/
+/* Fixed-point type traits                                          */
+/*------------------------------------------------------------------*/
+template <typename T> struct FFTFixedTraits;
+
+template <> struct FFTFixedTraits<q15_t>
+{
+  typedef arm_rfft_instance_q15 instance_t;
+  static const int FRACTION_BITS = 15;
+
+  static bool init(instance_t *S, int len) {
+    return (arm_rfft_init_q15(S, len, 0, 1) == ARM_MATH_SUCCESS);
+  }
+  static void rfft(instance_t *S, q15_t *pSrc, q15_t *pDst) {
+    arm_rfft_q15(S, pSrc, pDst);
+  }
+  static void mult(q15_t *pSrcA, q15_t *pSrcB, q15_t *pDst, int len) {
+    arm_mult_q15(pSrcA, pSrcB, pDst, len);
+  }
+  static void mag(q15_t *pSrc, q15_t *pDst, int len) {
+    arm_cmplx_mag_q15(pSrc, pDst, len);
+  }
+  static void from_float(float *pSrc, q15_t *pDst, int len) {
+    arm_float_to_q15(pSrc, pDst, len);
+  }
+  static void read(RingBuff *ring, q15_t *pDst, int len) {
+    ring->get(pDst, len);
+  }
+};
+
+template <> struct FFTFixedTraits<q31_t>
+{
+  typedef arm_rfft_instance_q31 instance_t;
+  static const int FRACTION_BITS = 31;
+
+  static bool init(instance_t *S, int len) {
+    return (arm_rfft_init_q31(S, len, 0, 1) == ARM_MATH_SUCCESS);
+  }
+  static void rfft(instance_t *S, q31_t *pSrc, q31_t *pDst) {
+    arm_rfft_q31(S, pSrc, pDst);
+  }
+  static void mult(q31_t *pSrcA, q31_t *pSrcB, q31_t *pDst, int len) {
+    arm_mult_q31(pSrcA, pSrcB, pDst, len);
+  }
+  static void mag(q31_t *pSrc, q31_t *pDst, int len) {
+    arm_cmplx_mag_q31(pSrc, pDst, len);
+  }
+  static void from_float(float *pSrc, q31_t *pDst, int len) {
+    arm_float_to_q31(pSrc, pDst, len);
+  }
+  static void read(RingBuff *ring, q31_t *pDst, int len) {
+    /* The ring buffer holds q15, so convert in small blocks */
+    q15_t tmp[64];
+    while (len > 0) {
+      int part = (len < 64) ? len : 64;
+      ring->get(tmp, part);
+      arm_q15_to_q31(tmp, pDst, part);
+      pDst += part;
+      len -= part;
+    }
+  }
+};
+
+/*------------------------------------------------------------------*/
+/* Fixed-point FFT                                                  */
+/*------------------------------------------------------------------*/
+/*
+ * FFTClass without any float conversion. T is q15_t or q31_t.
+ *
+ * Scaling:
+ *  arm_rfft_q15/q31 scale the result down by FFTLEN/2 to avoid
+ *  saturation, and arm_cmplx_mag_q15/q31 output in 2.14/2.30 format.
+ *  So the amplitude of get() is
+ *
+ *    |X[k]| = out[k] * scale()  (scale() = FFTLEN / 2^15 or FFTLEN / 2^31)
+ *
+ *  where |X[k]| is the amplitude given by FFTClass::get() for the same
+ *  input. get_raw() writes 2 * FFTLEN values (complex spectrum), where
+ *  re/im = out * scale() / 2.
+ */
+template <int MAX_CHNUM, int FFTLEN, typename T = q15_t> class FFTFixedClass
+{
+public:
+  typedef FFTFixedTraits<T> traits_t;
+
+  FFTFixedClass() {
+    for (int i = 0; i < MAX_CHNUM; i++) {
+      ringbuf_fft[i] = NULL;
+    }
+  }
+
+  ~FFTFixedClass() {
+    end();
+  }
+
+  void begin(){
+      begin(WindowHamming, MAX_CHNUM, (FFTLEN / 2));
+  }
+
+  bool begin(windowType_t type, int channel, int overlap){
+    if (channel > MAX_CHNUM) return false;
+    if (overlap > (FFTLEN / 2)) return false;
+
+    m_overlap = overlap;
+    m_channel = channel;
+
+    end();
+    clear();
+    if (!create_coef(type)) {
+      return false;
+    }
+    if (!traits_t::init(&S, FFTLEN)) {
+       return false;
+    }
+
+    for(int i = 0; i < MAX_CHNUM; i++) {
+      ringbuf_fft[i] = new RingBuff(MAX_CHNUM * FFTLEN * sizeof(q15_t));
+    }
+
+    return true;
+  }
+
+  bool put(q15_t* pSrc, int sample) {
+    /* Ringbuf size check */
+    if(m_channel > MAX_CHNUM) return false;
+    if(sample > ringbuf_fft[0]->remain()) return false;
+
+    if (m_channel == 1) {
+      /* the faster optimization */
+      ringbuf_fft[0]->put((q15_t*)pSrc, sample);
+    } else {
+      /* Split all channels in one pass */
+      RingBuff::put(ringbuf_fft, pSrc, sample, m_channel);
+    }
+    return  true;
+  }
+
+  /* out needs 2 * FFTLEN elements */
+  int  get_raw(T* out, int channel) {
+    return get_raw(out, channel, true);
+  }
+
+  /* out needs FFTLEN / 2 elements */
+  int  get(T* out, int channel) {
+    return get_raw(out, channel, false);
+  }
+
+  /* Factor to convert the output of get() to the amplitude of FFTClass */
+  static float scale() {
+    return ldexpf((float)FFTLEN, -traits_t::FRACTION_BITS);
+  }
+
+  void clear() {
+    for (int i = 0; i < MAX_CHNUM; i++) {
+      memset(tmpInBuf[i], 0, sizeof(tmpInBuf[i]));
+    }
+  }
+
+  void end(){
+    for (int i = 0; i < MAX_CHNUM; i++) {
+      delete ringbuf_fft[i];
+      ringbuf_fft[i] = NULL;
+    }
+  }
+
+  bool empty(int channel){
+    return (ringbuf_fft[channel]->stored() < FFTLEN);
+  }
+
+private:
+
+  RingBuff* ringbuf_fft[MAX_CHNUM];
+
+  int m_channel;
+  int m_overlap;
+  typename traits_t::instance_t S;
+
+  /* Temporary buffer */
+  T tmpInBuf[MAX_CHNUM][FFTLEN];
+  T coef[FFTLEN];
+  T tmpFft[FFTLEN];
+  T tmpOutBuf[FFTLEN * 2];
+
+  bool create_coef(windowType_t type) {
+    float *tmp = new float[FFTLEN];
+    if (!tmp) {
+      return false;
+    }
+    fft_create_window(tmp, FFTLEN, type, WINDOW_KAISER_BETA);
+    traits_t::from_float(tmp, coef, FFTLEN);
+    delete[] tmp;
+    return true;
+  }
+
+  int get_raw(T* out, int channel, int raw) {
+    if(channel >= m_channel) return false;
+    if (ringbuf_fft[channel]->stored() < FFTLEN) return 0;
+
+    memcpy(tmpInBuf[channel], &tmpInBuf[channel][FFTLEN - m_overlap], m_overlap * sizeof(T));
+
+    /* Read from the ring buffer */
+    traits_t::read(ringbuf_fft[channel], &tmpInBuf[channel][m_overlap], FFTLEN - m_overlap);
+
+    traits_t::mult(tmpInBuf[channel], coef, tmpFft, FFTLEN);
+
+    if(raw){
+      /* Calculate only FFT */
+      traits_t::rfft(&S, tmpFft, out);
+    }else{
+      /* Calculate FFT for convert to amplitude */
+      traits_t::rfft(&S, tmpFft, tmpOutBuf);
+      traits_t::mag(tmpOutBuf, out, FFTLEN / 2);
+    }
+    return (FFTLEN - m_overlap);
+  }
+
+};
+
+#endif /*_FFTFIXED_H_*/
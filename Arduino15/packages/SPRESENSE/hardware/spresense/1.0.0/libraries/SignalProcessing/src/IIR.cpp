@@ -178,9 +178,8 @@ bool IIRClass::put(q15_t* pSrc, int sample)
     /* the faster optimization */
     m_ringbuff[0]->put((q15_t*)pSrc, sample);
   } else {
-    for (int i = 0; i < m_channel; i++) {
-      m_ringbuff[i]->put(pSrc, sample, m_channel, i);
-    }
+    /* Split all channels in one pass */
+    RingBuff::put(m_ringbuff, pSrc, sample, m_channel);
   }
 
   m_err = ERR_OK;
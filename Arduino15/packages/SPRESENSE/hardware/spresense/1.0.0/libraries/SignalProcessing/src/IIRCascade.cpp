@@ -0,0 +1,289 @@
+/*
+ *  IIRCascade.cpp - Multi-stage/Multi-channel IIR(biquad cascade) Library
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "IIRCascade.h"
+
+#include <stdio.h>
+#include <string.h>
+
+bool IIRCascadeClass::begin(filterType_t type, designType_t design, int order, int channel, float cutoff, int fs, float ripple)
+{
+  if ((cutoff <= 0) || (cutoff >= (fs / 2))) {
+    m_err = IIRClass::ERR_FS;
+    return false;
+  }
+
+  if ((channel <= 0) || (channel > MAX_CHANNEL_NUM)) {
+    m_err = IIRClass::ERR_CH_NUM;
+    return false;
+  }
+
+  if ((type != TYPE_LPF) && (type != TYPE_HPF)) {
+    m_err = IIRClass::ERR_FILTER_TYPE;
+    return false;
+  }
+
+  m_channel = channel;
+  m_stage = 0;
+
+  /* Pre-warped frequency for the bilinear transform */
+  float k = tan(PI * cutoff / fs);
+  bool ret;
+
+  switch (design) {
+  case DESIGN_BUTTERWORTH:
+    ret = design_butterworth(type, order, k);
+    break;
+  case DESIGN_CHEBYSHEV:
+    ret = design_chebyshev(type, order, k, ripple);
+    break;
+  case DESIGN_LINKWITZ_RILEY:
+    /* Two cascaded Butterworth filters of the half order */
+    ret = ((order % 2) == 0) &&
+          design_butterworth(type, order / 2, k) &&
+          design_butterworth(type, order / 2, k);
+    break;
+  default:
+    ret = false;
+    break;
+  }
+
+  if (!ret) {
+    m_stage = 0;
+    m_err = IIRClass::ERR_FILTER_TYPE;
+    return false;
+  }
+
+  reset();
+
+  m_err = IIRClass::ERR_OK;
+  return true;
+}
+
+bool IIRCascadeClass::begin(const float* coef, int stage, int channel)
+{
+  if ((channel <= 0) || (channel > MAX_CHANNEL_NUM)) {
+    m_err = IIRClass::ERR_CH_NUM;
+    return false;
+  }
+
+  if ((stage <= 0) || (stage > MAX_STAGE_NUM)) {
+    m_err = IIRClass::ERR_FILTER_TYPE;
+    return false;
+  }
+
+  m_channel = channel;
+  m_stage = stage;
+  memcpy(m_coef, coef, sizeof(float32_t) * COEF_NUM * stage);
+
+  reset();
+
+  m_err = IIRClass::ERR_OK;
+  return true;
+}
+
+void IIRCascadeClass::reset()
+{
+  memset(m_state, 0, sizeof(m_state));
+}
+
+void IIRCascadeClass::end()
+{
+  m_channel = 0;
+  m_stage = 0;
+  m_err = IIRClass::ERR_OK;
+}
+
+/* Second order section w0^2 / (s^2 + (w0/q)s + w0^2) of the normalized
+ * analog prototype. An HPF uses the LPF to HPF transform s -> 1/s.
+ */
+bool IIRCascadeClass::add_stage(filterType_t type, float k, float w0, float q)
+{
+  if (m_stage >= MAX_STAGE_NUM) {
+    return false;
+  }
+
+  float kw = (type == TYPE_LPF) ? (k * w0) : (k / w0);
+  float kw2 = kw * kw;
+  float norm = 1.0f / (1.0f + kw / q + kw2);
+  float b0 = (type == TYPE_LPF) ? (kw2 * norm) : norm;
+  float *c = m_coef[m_stage++];
+
+  c[0] = b0;
+  c[1] = (type == TYPE_LPF) ? (2.0f * b0) : (-2.0f * b0);
+  c[2] = b0;
+  c[3] = -(2.0f * (kw2 - 1.0f) * norm);
+  c[4] = -((1.0f - kw / q + kw2) * norm);
+
+  return true;
+}
+
+/* First order section w0 / (s + w0) of the normalized analog prototype */
+bool IIRCascadeClass::add_first_order(filterType_t type, float k, float w0)
+{
+  if (m_stage >= MAX_STAGE_NUM) {
+    return false;
+  }
+
+  float kw = (type == TYPE_LPF) ? (k * w0) : (k / w0);
+  float norm = 1.0f / (1.0f + kw);
+  float b0 = (type == TYPE_LPF) ? (kw * norm) : norm;
+  float *c = m_coef[m_stage++];
+
+  c[0] = b0;
+  c[1] = (type == TYPE_LPF) ? b0 : -b0;
+  c[2] = 0.0f;
+  c[3] = -((kw - 1.0f) * norm);
+  c[4] = 0.0f;
+
+  return true;
+}
+
+bool IIRCascadeClass::design_butterworth(filterType_t type, int order, float k)
+{
+  if (order <= 0) {
+    return false;
+  }
+
+  for (int i = 0; i < order / 2; i++) {
+    float theta = PI * (2 * i + 1) / (2 * order);
+    if (!add_stage(type, k, 1.0f, 1.0f / (2.0f * sin(theta)))) {
+      return false;
+    }
+  }
+
+  if (order % 2) {
+    return add_first_order(type, k, 1.0f);
+  }
+
+  return true;
+}
+
+bool IIRCascadeClass::design_chebyshev(filterType_t type, int order, float k, float ripple)
+{
+  if ((order <= 0) || (ripple <= 0.0f)) {
+    return false;
+  }
+
+  float eps = sqrt(pow(10.0f, ripple / 10.0f) - 1.0f);
+  float mu = asinh(1.0f / eps) / order;
+  int   first = m_stage;
+
+  for (int i = 0; i < order / 2; i++) {
+    float theta = PI * (2 * i + 1) / (2 * order);
+    float re = sinh(mu) * sin(theta);
+    float im = cosh(mu) * cos(theta);
+    float w0 = sqrt(re * re + im * im);
+    if (!add_stage(type, k, w0, w0 / (2.0f * re))) {
+      return false;
+    }
+  }
+
+  if (order % 2) {
+    return add_first_order(type, k, sinh(mu));
+  }
+
+  /* An even order filter has the ripple bottom at DC (LPF) or Nyquist (HPF) */
+  float gain = pow(10.0f, -ripple / 20.0f);
+  m_coef[first][0] *= gain;
+  m_coef[first][1] *= gain;
+  m_coef[first][2] *= gain;
+
+  return true;
+}
+
+int IIRCascadeClass::process(float* pBuf, int sample)
+{
+  if (m_stage == 0) {
+    m_err = IIRClass::ERR_FILTER_TYPE;
+    return IIRClass::ERR_FILTER_TYPE;
+  }
+
+  for (int i = 0; i < sample; i++) {
+    float *frame = &pBuf[i * m_channel];
+
+    for (int s = 0; s < m_stage; s++) {
+      const float b0 = m_coef[s][0];
+      const float b1 = m_coef[s][1];
+      const float b2 = m_coef[s][2];
+      const float a1 = m_coef[s][3];
+      const float a2 = m_coef[s][4];
+      float *d1 = m_state[s][0];
+      float *d2 = m_state[s][1];
+
+      for (int ch = 0; ch < m_channel; ch++) {
+        float x = frame[ch];
+        float y = b0 * x + d1[ch];
+        d1[ch] = b1 * x + a1 * y + d2[ch];
+        d2[ch] = b2 * x + a2 * y;
+        frame[ch] = y;
+      }
+    }
+  }
+
+  m_err = IIRClass::ERR_OK;
+  return sample;
+}
+
+int IIRCascadeClass::process(q15_t* pBuf, int sample)
+{
+  if (m_stage == 0) {
+    m_err = IIRClass::ERR_FILTER_TYPE;
+    return IIRClass::ERR_FILTER_TYPE;
+  }
+
+  float frame[MAX_CHANNEL_NUM];
+
+  for (int i = 0; i < sample; i++) {
+    q15_t *src = &pBuf[i * m_channel];
+
+    /* The filter is linear, so work in the q15 scale directly */
+    for (int ch = 0; ch < m_channel; ch++) {
+      frame[ch] = src[ch];
+    }
+
+    for (int s = 0; s < m_stage; s++) {
+      const float b0 = m_coef[s][0];
+      const float b1 = m_coef[s][1];
+      const float b2 = m_coef[s][2];
+      const float a1 = m_coef[s][3];
+      const float a2 = m_coef[s][4];
+      float *d1 = m_state[s][0];
+      float *d2 = m_state[s][1];
+
+      for (int ch = 0; ch < m_channel; ch++) {
+        float x = frame[ch];
+        float y = b0 * x + d1[ch];
+        d1[ch] = b1 * x + a1 * y + d2[ch];
+        d2[ch] = b2 * x + a2 * y;
+        frame[ch] = y;
+      }
+    }
+
+    for (int ch = 0; ch < m_channel; ch++) {
+      float y = frame[ch];
+      src[ch] = (y >= 32767.0f) ? 32767 :
+                (y <= -32768.0f) ? -32768 :
+                (q15_t)((y >= 0) ? (y + 0.5f) : (y - 0.5f));
+    }
+  }
+
+  m_err = IIRClass::ERR_OK;
+  return sample;
+}
@@ -0,0 +1,185 @@
+/*
+ *  IIRCascade.h - Multi-stage/Multi-channel IIR(biquad cascade) Library Header
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _IIRCASCADE_H_
+#define _IIRCASCADE_H_
+
+/**
+ * @file IIRCascade.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief SignalProcessing Library for Arduino
+ */
+
+#include "IIR.h"
+
+/*------------------------------------------------------------------*/
+/* Type Definition                                                  */
+/*------------------------------------------------------------------*/
+/**
+ * @enum designType_t
+ * The definition of filter design methods
+ */
+typedef enum e_designType {
+  //! Butterworth (maximally flat)
+  DESIGN_BUTTERWORTH,
+  //! Chebyshev type I (passband ripple)
+  DESIGN_CHEBYSHEV,
+  //! Linkwitz-Riley (two cascaded Butterworth, even order only)
+  DESIGN_LINKWITZ_RILEY
+} designType_t;
+
+/*------------------------------------------------------------------*/
+/* IIR Cascade Class                                                */
+/*------------------------------------------------------------------*/
+/**
+ * @class IIRCascadeClass
+ *
+ * @brief N-stage biquad IIR filter for all channels of an interleaved frame
+ *
+ * @details Unlike IIRClass, this class has no input ring buffer.
+ *          process() filters an interleaved buffer of all channels in
+ *          place, so chains of filters do not copy the data between
+ *          stages. The filter state of all channels is stored next to
+ *          each other per stage.
+ */
+class IIRCascadeClass
+{
+public:
+
+  /**
+   * The Maximum number of channels
+   */
+  static const int MAX_CHANNEL_NUM = IIRClass::MAX_CHANNEL_NUM;
+
+  /**
+   * The Maximum number of biquad stages (filter order up to 2 times this)
+   */
+  static const int MAX_STAGE_NUM = 8;
+
+  /**
+   * The number of coefficients in a stage {b0, b1, b2, a1, a2}
+   */
+  static const int COEF_NUM = 5;
+
+  typedef IIRClass::error_t error_t;
+
+  IIRCascadeClass() : m_channel(0), m_stage(0), m_err(IIRClass::ERR_OK) {}
+
+  /**
+   * @brief   Design and initialize the filter.
+   *
+   * @return  OK(true) or Failure(false)
+   * @details Only TYPE_LPF and TYPE_HPF are supported.
+   *          DESIGN_LINKWITZ_RILEY requires an even order.
+   *
+   */
+  bool begin(
+    filterType_t type,     /**< The execution filter type (TYPE_LPF/TYPE_HPF) */
+    designType_t design,   /**< The design method */
+    int order,             /**< The filter order (1 to MAX_STAGE_NUM * 2) */
+    int channel,           /**< The number of channels */
+    float cutoff,          /**< The cutoff frequency */
+    int fs = 48000,        /**< The Sampling rate */
+    float ripple = 1.0f    /**< The passband ripple[dB] (DESIGN_CHEBYSHEV only) */
+  );
+
+  /**
+   * @brief   Initialize the filter with coefficients designed elsewhere.
+   *
+   * @return  OK(true) or Failure(false)
+   * @details coef has {b0, b1, b2, a1, a2} for each stage in the CMSIS
+   *          convention, i.e. y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2]
+   *          + a1*y[n-1] + a2*y[n-2].
+   *
+   */
+  bool begin(
+    const float* coef, /**< The coefficients of all stages */
+    int stage,         /**< The number of stages */
+    int channel        /**< The number of channels */
+  );
+
+  /**
+   * @brief   Filter interleaved q15 data of all channels in place
+   *
+   * @return  The number of processed samples per channel(Error code when negative numbers)
+   *
+   */
+  int process(
+    q15_t* pBuf, /**< The interleaved data of all channels */
+    int sample   /**< The number of samples per channel */
+  );
+
+  /**
+   * @brief   Filter interleaved float data of all channels in place
+   *
+   * @return  The number of processed samples per channel(Error code when negative numbers)
+   *
+   */
+  int process(
+    float* pBuf, /**< The interleaved data of all channels */
+    int sample   /**< The number of samples per channel */
+  );
+
+  /**
+   * @brief Clear the filter state of all channels
+   */
+  void reset();
+
+  /**
+   * @brief Finalize the filter.
+   */
+  void end();
+
+  /**
+   * @brief Get the number of biquad stages
+   */
+  int getStageNum() { return m_stage; }
+
+  /**
+   * @brief Get the coefficients {b0, b1, b2, a1, a2} of a stage
+   */
+  const float* getCoef(int stage) { return m_coef[stage]; }
+
+  /**
+   * @brief Get error information
+   *
+   * @return  Error code[IIRClass::error_t]
+   *
+   */
+  error_t getErrorCause() { return m_err; }
+
+private:
+
+  int     m_channel;
+  int     m_stage;
+  error_t m_err;
+
+  float32_t m_coef[MAX_STAGE_NUM][COEF_NUM];
+
+  /* Transposed direct form II state, channel interleaved per stage */
+  float32_t m_state[MAX_STAGE_NUM][2][MAX_CHANNEL_NUM];
+
+  bool add_stage(filterType_t type, float k, float w0, float q);
+  bool add_first_order(filterType_t type, float k, float w0);
+  bool design_butterworth(filterType_t type, int order, float k);
+  bool design_chebyshev(filterType_t type, int order, float k, float ripple);
+
+};
+
+#endif /*_IIRCASCADE_H_*/
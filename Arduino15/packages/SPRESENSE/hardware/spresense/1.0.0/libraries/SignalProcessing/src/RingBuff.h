@@ -70,6 +70,44 @@ public:
     return sample;
   };
 
+  /* Split the interleaved data of all channels in one pass.
+   * ring[ch] receives the channel ch of buf. The caller must check
+   * remain() of each ring buffer in advance.
+   */
+  static int put(RingBuff **ring, q15_t *buf, int sample, int chnum) {
+    for (int ch = 0; ch < chnum; ch += MAX_SPLIT_CHNUM) {
+      int num = ((chnum - ch) < MAX_SPLIT_CHNUM) ? (chnum - ch) : MAX_SPLIT_CHNUM;
+      int done = 0;
+
+      while (done < sample) {
+        /* The largest span that is contiguous in all ring buffers */
+        int part = sample - done;
+        for (int i = 0; i < num; i++) {
+          int space = ring[ch + i]->_bottom - ring[ch + i]->_wptr;
+          if (space < part) {
+            part = space;
+          }
+        }
+
+        q15_t *dst[MAX_SPLIT_CHNUM];
+        for (int i = 0; i < num; i++) {
+          dst[i] = ring[ch + i]->_wptr;
+        }
+
+        split(dst, &buf[(done * chnum) + ch], part, chnum, num);
+
+        for (int i = 0; i < num; i++) {
+          ring[ch + i]->_wptr += part;
+          if (ring[ch + i]->_wptr == ring[ch + i]->_bottom) {
+            ring[ch + i]->_wptr = ring[ch + i]->_top;
+          }
+        }
+        done += part;
+      }
+    }
+    return sample;
+  };
+
   int get(float *buf, int sample) {
     if ((_rptr + sample) < _bottom) {
       arm_q15_to_float(_rptr, buf, sample);
@@ -98,6 +136,15 @@ public:
     return sample;
   };
 
+  int skip(int sample) {
+    if ((_rptr + sample) < _bottom) {
+      _rptr += sample;
+    } else {
+      _rptr = _top + sample - (_bottom - _rptr);
+    }
+    return sample;
+  };
+
   int remain() {
     return (_bottom - _top) - stored();
   };
@@ -107,6 +154,70 @@ public:
   };
 
 private:
+  /* Number of channels split at once by the multi-channel put */
+  static const int MAX_SPLIT_CHNUM = 8;
+
+  static void split(q15_t **dst, q15_t *src, int sample, int stride, int num) {
+    int i = 0;
+
+    switch (num) {
+    case 1:
+      for (; i < sample; i++) {
+        dst[0][i] = src[0];
+        src += stride;
+      }
+      break;
+    case 2:
+      /* Unrolled by 4 samples */
+      for (; i + 4 <= sample; i += 4) {
+        dst[0][i]     = src[0];
+        dst[1][i]     = src[1];
+        dst[0][i + 1] = src[stride];
+        dst[1][i + 1] = src[stride + 1];
+        dst[0][i + 2] = src[2 * stride];
+        dst[1][i + 2] = src[2 * stride + 1];
+        dst[0][i + 3] = src[3 * stride];
+        dst[1][i + 3] = src[3 * stride + 1];
+        src += 4 * stride;
+      }
+      for (; i < sample; i++) {
+        dst[0][i] = src[0];
+        dst[1][i] = src[1];
+        src += stride;
+      }
+      break;
+    case 4:
+      /* Unrolled by 2 samples */
+      for (; i + 2 <= sample; i += 2) {
+        dst[0][i]     = src[0];
+        dst[1][i]     = src[1];
+        dst[2][i]     = src[2];
+        dst[3][i]     = src[3];
+        dst[0][i + 1] = src[stride];
+        dst[1][i + 1] = src[stride + 1];
+        dst[2][i + 1] = src[stride + 2];
+        dst[3][i + 1] = src[stride + 3];
+        src += 2 * stride;
+      }
+      for (; i < sample; i++) {
+        dst[0][i] = src[0];
+        dst[1][i] = src[1];
+        dst[2][i] = src[2];
+        dst[3][i] = src[3];
+        src += stride;
+      }
+      break;
+    default:
+      for (; i < sample; i++) {
+        for (int ch = 0; ch < num; ch++) {
+          dst[ch][i] = src[ch];
+        }
+        src += stride;
+      }
+      break;
+    }
+  };
+
   q15_t *_top;
   q15_t *_bottom;
   q15_t *_wptr;
@@ -0,0 +1,341 @@
+/*
+ *  STFT.h - Streaming STFT Library
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _STFT_H_
+#define _STFT_H_
+
+#include "FFT.h"
+
+/*------------------------------------------------------------------*/
+/* Type Definition                                                  */
+/*------------------------------------------------------------------*/
+/* OUTPUT TYPE */
+typedef enum e_spectrumType {
+  SpectrumMagnitude,
+  SpectrumPower,
+  SpectrumDecibel,
+  SpectrumLogMel
+} spectrumType_t;
+
+/* PEAK INFORMATION */
+typedef struct {
+  float freq;  /* Interpolated frequency [Hz] */
+  float value; /* Interpolated value in the output unit */
+  int   bin;   /* Bin index of the local maximum (-1 if not found) */
+} spectrumPeak_t;
+
+/*------------------------------------------------------------------*/
+/* STFT                                                             */
+/*------------------------------------------------------------------*/
+/*
+ * Streaming STFT on top of the FFTClass building blocks.
+ * Each frame is produced after "hop" new samples, where the hop can be
+ * any size (a hop larger than FFTLEN skips samples between frames).
+ * The spectrum and its top-K peaks are computed in one pass over the
+ * FFT result.
+ */
+template <int MAX_CHNUM, int FFTLEN> class STFTClass
+{
+public:
+  /* Default number of mel bands for SpectrumLogMel */
+  static const int DEFAULT_MEL_BANDS = 40;
+
+  STFTClass() {
+    for (int i = 0; i < MAX_CHNUM; i++) {
+      m_ring[i] = NULL;
+    }
+    m_melnum = 0;
+    m_melStart = NULL;
+    m_melLen = NULL;
+    m_melWeight = NULL;
+  }
+
+  ~STFTClass() {
+    end();
+  }
+
+  bool begin(windowType_t type, int channel, int hop,
+             spectrumType_t output = SpectrumMagnitude, int fs = 48000,
+             float param = WINDOW_KAISER_BETA) {
+    if ((channel <= 0) || (channel > MAX_CHNUM)) return false;
+    if (hop <= 0) return false;
+
+    end();
+
+    m_channel = channel;
+    m_hop = hop;
+    m_output = output;
+    m_fs = fs;
+
+    clear();
+    fft_create_window(m_coef, FFTLEN, type, param);
+    if (!fft_init_f32(&S, FFTLEN)) {
+      return false;
+    }
+
+    for (int i = 0; i < m_channel; i++) {
+      m_ring[i] = new RingBuff(2 * (FFTLEN + hop));
+      if (!m_ring[i]) {
+        end();
+        return false;
+      }
+    }
+
+    if (m_output == SpectrumLogMel) {
+      if (!setMelBands(DEFAULT_MEL_BANDS, 0.0f, fs / 2.0f)) {
+        end();
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /* Change the mel filter bank used by SpectrumLogMel */
+  bool setMelBands(int bands, float fmin, float fmax) {
+    if ((bands <= 0) || (fmin < 0) || (fmax <= fmin) || (fmax > m_fs / 2.0f)) {
+      return false;
+    }
+
+    free_mel();
+
+    /* Band edges in bins, equally spaced on the mel scale */
+    float *edge = new float[bands + 2];
+    if (!edge) {
+      return false;
+    }
+    float mmin = hz_to_mel(fmin);
+    float mmax = hz_to_mel(fmax);
+    for (int i = 0; i < bands + 2; i++) {
+      float hz = mel_to_hz(mmin + (mmax - mmin) * i / (bands + 1));
+      edge[i] = hz * FFTLEN / m_fs;
+    }
+
+    m_melStart = new int[bands];
+    m_melLen = new int[bands];
+    if (!m_melStart || !m_melLen) {
+      delete[] edge;
+      free_mel();
+      return false;
+    }
+
+    int total = 0;
+    for (int b = 0; b < bands; b++) {
+      int start = (int)ceilf(edge[b]);
+      int last = (int)floorf(edge[b + 2]);
+      if (last > (FFTLEN / 2 - 1)) {
+        last = FFTLEN / 2 - 1;
+      }
+      m_melStart[b] = start;
+      m_melLen[b] = (last >= start) ? (last - start + 1) : 0;
+      total += m_melLen[b];
+    }
+
+    m_melWeight = new float[total ? total : 1];
+    if (!m_melWeight) {
+      delete[] edge;
+      free_mel();
+      return false;
+    }
+
+    float *w = m_melWeight;
+    for (int b = 0; b < bands; b++) {
+      for (int j = 0; j < m_melLen[b]; j++) {
+        float k = m_melStart[b] + j;
+        *w++ = (k <= edge[b + 1]) ?
+          (k - edge[b]) / (edge[b + 1] - edge[b]) :
+          (edge[b + 2] - k) / (edge[b + 2] - edge[b + 1]);
+      }
+    }
+
+    delete[] edge;
+
+    m_melnum = bands;
+    return true;
+  }
+
+  bool put(q15_t* pSrc, int sample) {
+    if (sample > m_ring[0]->remain()) return false;
+
+    if (m_channel == 1) {
+      m_ring[0]->put(pSrc, sample);
+    } else {
+      RingBuff::put(m_ring, pSrc, sample, m_channel);
+    }
+    return true;
+  }
+
+  bool empty(int channel) {
+    return (m_ring[channel]->stored() < m_hop);
+  }
+
+  /* Number of values written to "out" by get() */
+  int outputSize() {
+    return (m_output == SpectrumLogMel) ? m_melnum : (FFTLEN / 2);
+  }
+
+  /*
+   * Compute the spectrum of the next frame of the channel.
+   * When peaks is given, the peaknum largest local maxima are written in
+   * descending order (unused entries have bin = -1).
+   * Returns the number of consumed samples (hop), or 0 if not ready.
+   */
+  int get(float* out, int channel, spectrumPeak_t* peaks = NULL, int peaknum = 0) {
+    if (channel >= m_channel) return 0;
+    if (empty(channel)) return 0;
+
+    float *frame = m_frame[channel];
+
+    if (m_hop < FFTLEN) {
+      memmove(frame, &frame[m_hop], (FFTLEN - m_hop) * sizeof(float));
+      m_ring[channel]->get(&frame[FFTLEN - m_hop], m_hop);
+    } else {
+      m_ring[channel]->skip(m_hop - FFTLEN);
+      m_ring[channel]->get(frame, FFTLEN);
+    }
+
+    arm_mult_f32(frame, m_coef, m_work, FFTLEN);
+    arm_rfft_fast_f32(&S, m_work, m_fftout, 0);
+
+    for (int i = 0; i < peaknum; i++) {
+      peaks[i].freq = 0.0f;
+      peaks[i].value = 0.0f;
+      peaks[i].bin = -1;
+    }
+
+    float *dst = (m_output == SpectrumLogMel) ? m_spec : out;
+
+    for (int i = 0; i < FFTLEN / 2; i++) {
+      float re = m_fftout[2 * i];
+      float im = (i == 0) ? 0.0f : m_fftout[2 * i + 1];
+      float p = re * re + im * im;
+
+      if (m_output == SpectrumMagnitude) {
+        arm_sqrt_f32(p, &dst[i]);
+      } else if (m_output == SpectrumDecibel) {
+        dst[i] = 10.0f * log10f(p + 1e-20f);
+      } else {
+        dst[i] = p;
+      }
+
+      /* dst[i - 1] is a local maximum */
+      if ((peaknum > 0) && (i >= 2) &&
+          (dst[i - 1] > dst[i - 2]) && (dst[i - 1] >= dst[i])) {
+        add_peak(dst, i - 1, peaks, peaknum);
+      }
+    }
+
+    if (m_output == SpectrumLogMel) {
+      const float *w = m_melWeight;
+      for (int b = 0; b < m_melnum; b++) {
+        float sum = 0.0f;
+        for (int j = 0; j < m_melLen[b]; j++) {
+          sum += w[j] * m_spec[m_melStart[b] + j];
+        }
+        w += m_melLen[b];
+        out[b] = logf(sum + 1e-10f);
+      }
+    }
+
+    return m_hop;
+  }
+
+  void clear() {
+    for (int i = 0; i < MAX_CHNUM; i++) {
+      memset(m_frame[i], 0, sizeof(m_frame[i]));
+    }
+  }
+
+  void end() {
+    for (int i = 0; i < MAX_CHNUM; i++) {
+      delete m_ring[i];
+      m_ring[i] = NULL;
+    }
+    free_mel();
+  }
+
+private:
+
+  RingBuff* m_ring[MAX_CHNUM];
+
+  int m_channel;
+  int m_hop;
+  int m_fs;
+  spectrumType_t m_output;
+  arm_rfft_fast_instance_f32 S;
+
+  /* Per-instance buffers */
+  float m_frame[MAX_CHNUM][FFTLEN];
+  float m_coef[FFTLEN];
+  float m_work[FFTLEN];
+  float m_fftout[FFTLEN];
+  float m_spec[FFTLEN / 2];
+
+  /* Sparse mel filter bank */
+  int    m_melnum;
+  int*   m_melStart;
+  int*   m_melLen;
+  float* m_melWeight;
+
+  static float hz_to_mel(float hz) {
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+  }
+
+  static float mel_to_hz(float mel) {
+    return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+  }
+
+  void free_mel() {
+    delete[] m_melStart;
+    m_melStart = NULL;
+    delete[] m_melLen;
+    m_melLen = NULL;
+    delete[] m_melWeight;
+    m_melWeight = NULL;
+    m_melnum = 0;
+  }
+
+  /* Parabolic interpolation and insertion into the sorted peak list */
+  void add_peak(const float *spec, int bin, spectrumPeak_t* peaks, int peaknum) {
+    float l = spec[bin - 1];
+    float c = spec[bin];
+    float r = spec[bin + 1];
+    float denom = l - 2.0f * c + r;
+    float delta = (denom == 0.0f) ? 0.0f : 0.5f * (l - r) / denom;
+    float value = c - 0.25f * (l - r) * delta;
+
+    if ((peaks[peaknum - 1].bin >= 0) && (value <= peaks[peaknum - 1].value)) {
+      return;
+    }
+
+    int pos = peaknum - 1;
+    while ((pos > 0) &&
+           ((peaks[pos - 1].bin < 0) || (peaks[pos - 1].value < value))) {
+      peaks[pos] = peaks[pos - 1];
+      pos--;
+    }
+
+    peaks[pos].freq = (bin + delta) * m_fs / FFTLEN;
+    peaks[pos].value = value;
+    peaks[pos].bin = bin;
+  }
+
+};
+
+#endif /*_STFT_H_*/
@@ -0,0 +1,255 @@
+/*
+ *  SpscRingBuff.h - Lock-free single-producer/single-consumer Ring Buffer
+ *  Copyright 2021 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _SPSCRINGBUFF_H_
+#define _SPSCRINGBUFF_H_
+
+/**
+ * @file SpscRingBuff.h
+ * @author Sony Semiconductor Solutions Corporation
+ * @brief Lock-free ring buffer for one producer thread and one consumer thread
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/**
+ * @class SpscRingBuff
+ *
+ * @brief q15 ring buffer that can be written and read from different threads
+ *
+ * @details Exactly one thread may call the producer functions
+ *          (put, reserve, commit) and exactly one thread may call the
+ *          consumer functions (get, peek, release) at the same time.
+ *          No lock is needed between them. The capacity is rounded up to
+ *          a power of two. The head and tail indices run freely and are
+ *          masked on access, so a full buffer can use every sample.
+ */
+class SpscRingBuff
+{
+public:
+  SpscRingBuff(int sample) {
+    _size = 1;
+    while (_size < (uint32_t)sample) {
+      _size <<= 1;
+    }
+    _mask = _size - 1;
+    _buf = (q15_t*)malloc(_size * sizeof(q15_t));
+    _head = _tail = 0;
+  };
+  ~SpscRingBuff() {
+    free(_buf);
+  };
+
+  /**
+   * @brief Number of samples that can be stored
+   */
+  int capacity() {
+    return _size;
+  };
+
+  /**
+   * @brief Number of samples ready to read (callable from both sides)
+   */
+  int stored() {
+    return load_acquire(&_head) - load_acquire(&_tail);
+  };
+
+  /**
+   * @brief Number of samples that can be written (callable from both sides)
+   */
+  int remain() {
+    return _size - stored();
+  };
+
+  /*------------------------------------------------------------------*/
+  /* Producer side                                                    */
+  /*------------------------------------------------------------------*/
+
+  /**
+   * @brief Get a contiguous span to write into
+   *
+   * @return Length of the span (0 when full). It can be shorter than
+   *         requested at the end of the buffer; call reserve() again
+   *         after commit() to get the remaining part.
+   */
+  int reserve(q15_t **span, int sample) {
+    uint32_t head = _head;
+    uint32_t free_size = _size - (head - load_acquire(&_tail));
+    uint32_t contiguous = _size - (head & _mask);
+    uint32_t len = (uint32_t)sample;
+
+    if (len > free_size) {
+      len = free_size;
+    }
+    if (len > contiguous) {
+      len = contiguous;
+    }
+
+    *span = &_buf[head & _mask];
+    return len;
+  };
+
+  /**
+   * @brief Publish samples written into the span of reserve()
+   */
+  void commit(int sample) {
+    store_release(&_head, _head + sample);
+  };
+
+  /**
+   * @brief Write samples
+   *
+   * @return Number of written samples. 0 when there is not enough space.
+   */
+  int put(q15_t *buf, int sample) {
+    if (sample > remain()) {
+      return 0;
+    }
+
+    int done = 0;
+    while (done < sample) {
+      q15_t *span;
+      int len = reserve(&span, sample - done);
+      arm_copy_q15(&buf[done], span, len);
+      commit(len);
+      done += len;
+    }
+    return sample;
+  };
+
+  /**
+   * @brief Write one channel of interleaved samples
+   *
+   * @return Number of written samples. 0 when there is not enough space.
+   */
+  int put(q15_t *buf, int sample, int chnum, int ch) {
+    if (sample > remain()) {
+      return 0;
+    }
+
+    int done = 0;
+    while (done < sample) {
+      q15_t *span;
+      int len = reserve(&span, sample - done);
+      for (int i = 0; i < len; i++) {
+        span[i] = buf[chnum * (done + i) + ch];
+      }
+      commit(len);
+      done += len;
+    }
+    return sample;
+  };
+
+  /*------------------------------------------------------------------*/
+  /* Consumer side                                                    */
+  /*------------------------------------------------------------------*/
+
+  /**
+   * @brief Get a contiguous span to read from
+   *
+   * @return Length of the span (0 when empty). It can be shorter than
+   *         requested at the end of the buffer; call peek() again after
+   *         release() to get the remaining part.
+   */
+  int peek(q15_t **span, int sample) {
+    uint32_t tail = _tail;
+    uint32_t used = load_acquire(&_head) - tail;
+    uint32_t contiguous = _size - (tail & _mask);
+    uint32_t len = (uint32_t)sample;
+
+    if (len > used) {
+      len = used;
+    }
+    if (len > contiguous) {
+      len = contiguous;
+    }
+
+    *span = &_buf[tail & _mask];
+    return len;
+  };
+
+  /**
+   * @brief Give back samples read from the span of peek()
+   */
+  void release(int sample) {
+    store_release(&_tail, _tail + sample);
+  };
+
+  /**
+   * @brief Read samples as float
+   *
+   * @return Number of read samples. 0 when not enough samples are stored.
+   */
+  int get(float *buf, int sample) {
+    if (sample > stored()) {
+      return 0;
+    }
+
+    int done = 0;
+    while (done < sample) {
+      q15_t *span;
+      int len = peek(&span, sample - done);
+      arm_q15_to_float(span, &buf[done], len);
+      release(len);
+      done += len;
+    }
+    return sample;
+  };
+
+  /**
+   * @brief Read samples
+   *
+   * @return Number of read samples. 0 when not enough samples are stored.
+   */
+  int get(q15_t *buf, int sample) {
+    if (sample > stored()) {
+      return 0;
+    }
+
+    int done = 0;
+    while (done < sample) {
+      q15_t *span;
+      int len = peek(&span, sample - done);
+      arm_copy_q15(span, &buf[done], len);
+      release(len);
+      done += len;
+    }
+    return sample;
+  };
+
+private:
+  static uint32_t load_acquire(volatile uint32_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+  };
+  static void store_release(volatile uint32_t *p, uint32_t val) {
+    __atomic_store_n(p, val, __ATOMIC_RELEASE);
+  };
+
+  q15_t   *_buf;
+  uint32_t _size;
+  uint32_t _mask;
+
+  /* Written only by the producer */
+  volatile uint32_t _head;
+  /* Written only by the consumer */
+  volatile uint32_t _tail;
+};
+
+#endif /*_SPSCRINGBUFF_H_*/
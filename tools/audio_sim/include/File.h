@@ -0,0 +1,130 @@
+/*
+ *  File.h - Host stand-in of the File library of Spresense
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * The methods used by the Audio library, on a file descriptor of the host.
+ * A name without "/mnt/" is a file on the SD card, as in the File library,
+ * and the SD card is mapped by audiosim_nuttx.h.
+ */
+
+#ifndef __FILE_H__
+#define __FILE_H__
+
+#include <Arduino.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* O_RDONLY | O_WRONLY of NuttX is read and write. */
+
+#define FILE_READ  O_RDONLY
+#define FILE_WRITE (O_RDWR | O_CREAT)
+
+class File
+{
+public:
+  File(const char *name, uint8_t mode = FILE_READ)
+    : _fd(-1)
+  {
+    char path[128];
+
+    if (name == NULL)
+      {
+        return;
+      }
+
+    if (strncmp(name, "/mnt/", 5) != 0)
+      {
+        snprintf(path, sizeof(path), "/mnt/sd0/%s", name);
+        name = path;
+      }
+
+    _fd = ::open(name, mode, 0644);
+    if ((_fd >= 0) && (mode == FILE_WRITE))
+      {
+        ::lseek(_fd, 0, SEEK_END);
+      }
+  }
+
+  File() : _fd(-1) {}
+  ~File() {}
+
+  size_t write(uint8_t data) { return write(&data, 1); }
+
+  size_t write(const uint8_t *buf, size_t size)
+  {
+    ssize_t ret = (_fd >= 0) ? ::write(_fd, buf, size) : -1;
+    return (ret < 0) ? 0 : (size_t)ret;
+  }
+
+  int read(void *buf, size_t nbyte)
+  {
+    return (_fd >= 0) ? (int)::read(_fd, buf, nbyte) : -1;
+  }
+
+  int available()
+  {
+    uint32_t pos = position();
+    uint32_t sz = size();
+    return (pos < sz) ? (int)(sz - pos) : 0;
+  }
+
+  bool seek(uint32_t pos)
+  {
+    return (_fd >= 0) && (::lseek(_fd, pos, SEEK_SET) == (off_t)pos);
+  }
+
+  uint32_t position()
+  {
+    return (_fd >= 0) ? (uint32_t)::lseek(_fd, 0, SEEK_CUR) : 0;
+  }
+
+  uint32_t size()
+  {
+    struct stat st;
+    return ((_fd >= 0) && (fstat(_fd, &st) == 0)) ? (uint32_t)st.st_size : 0;
+  }
+
+  void flush()
+  {
+    if (_fd >= 0)
+      {
+        fsync(_fd);
+      }
+  }
+
+  void close()
+  {
+    if (_fd >= 0)
+      {
+        ::close(_fd);
+        _fd = -1;
+      }
+  }
+
+  operator bool() { return _fd >= 0; }
+
+private:
+  int _fd;
+};
+
+#endif /* __FILE_H__ */
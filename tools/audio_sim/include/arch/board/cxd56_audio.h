@@ -0,0 +1,103 @@
+/*
+ *  cxd56_audio.h - Host stand-in of the audio driver of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * The baseband is not simulated. The functions keep the power state and
+ * the clock mode, so that the checks of the library work, and return OK.
+ */
+
+#ifndef __ARCH_BOARD_CXD56_AUDIO_H
+#define __ARCH_BOARD_CXD56_AUDIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CXD56_AUDIO_MIC_CH_MAX 8
+
+typedef enum {
+  CXD56_AUDIO_ECODE_OK = 0,
+  CXD56_AUDIO_ECODE_POW_STATE,
+  CXD56_AUDIO_ECODE_PARAM
+} CXD56_AUDIO_ECODE;
+
+typedef enum {
+  CXD56_AUDIO_POWER_STATE_OFF = 0,
+  CXD56_AUDIO_POWER_STATE_ON
+} cxd56_audio_state_t;
+
+typedef enum {
+  CXD56_AUDIO_CLKMODE_NORMAL = 0,
+  CXD56_AUDIO_CLKMODE_HIRES
+} cxd56_audio_clkmode_t;
+
+typedef enum {
+  CXD56_AUDIO_VOLID_MIXER_IN1 = 0,
+  CXD56_AUDIO_VOLID_MIXER_IN2,
+  CXD56_AUDIO_VOLID_MIXER_OUT
+} cxd56_audio_volid_t;
+
+typedef enum {
+  CXD56_AUDIO_SIG_MIC1 = 0,
+  CXD56_AUDIO_SIG_MIC2,
+  CXD56_AUDIO_SIG_MIC3,
+  CXD56_AUDIO_SIG_MIC4,
+  CXD56_AUDIO_SIG_I2S0,
+  CXD56_AUDIO_SIG_I2S1,
+  CXD56_AUDIO_SIG_MIX
+} cxd56_audio_signal_t;
+
+typedef struct {
+  bool au_dat_sel1;
+  bool au_dat_sel2;
+  bool cod_insel2;
+  bool cod_insel3;
+  bool src1in_sel;
+  bool src2in_sel;
+} cxd56_audio_sel_t;
+
+typedef struct {
+  int32_t gain[CXD56_AUDIO_MIC_CH_MAX];
+} cxd56_audio_mic_gain_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+CXD56_AUDIO_ECODE cxd56_audio_poweron(void);
+CXD56_AUDIO_ECODE cxd56_audio_poweroff(void);
+cxd56_audio_state_t cxd56_audio_get_status(void);
+CXD56_AUDIO_ECODE cxd56_audio_en_input(void);
+CXD56_AUDIO_ECODE cxd56_audio_dis_input(void);
+CXD56_AUDIO_ECODE cxd56_audio_en_output(void);
+CXD56_AUDIO_ECODE cxd56_audio_dis_output(void);
+CXD56_AUDIO_ECODE cxd56_audio_set_spout(bool sp_out);
+CXD56_AUDIO_ECODE cxd56_audio_set_vol(cxd56_audio_volid_t id, int16_t vol);
+CXD56_AUDIO_ECODE cxd56_audio_set_micgain(cxd56_audio_mic_gain_t *gain);
+CXD56_AUDIO_ECODE cxd56_audio_set_micmap(uint32_t map);
+CXD56_AUDIO_ECODE cxd56_audio_set_clkmode(cxd56_audio_clkmode_t mode);
+cxd56_audio_clkmode_t cxd56_audio_get_clkmode(void);
+CXD56_AUDIO_ECODE cxd56_audio_set_datapath(cxd56_audio_signal_t sig,
+                                           cxd56_audio_sel_t sel);
+CXD56_AUDIO_ECODE cxd56_audio_en_i2s_io(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ARCH_BOARD_CXD56_AUDIO_H */
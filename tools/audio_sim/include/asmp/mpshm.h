@@ -0,0 +1,53 @@
+/*
+ *  mpshm.h - Host stand-in of the shared memory API of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * The shared memory is host memory. The address given by mpshm_remap() is
+ * kept, to map the addresses of the memory layout into the host memory.
+ */
+
+#ifndef __INCLUDE_ASMP_MPSHM_H
+#define __INCLUDE_ASMP_MPSHM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct mpshm_s {
+  void    *va;   /**< Host memory */
+  uint32_t pa;   /**< Address given by mpshm_remap() */
+  size_t   size;
+} mpshm_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int mpshm_init(mpshm_t *shm, int key, size_t size);
+int mpshm_destroy(mpshm_t *shm);
+void *mpshm_attach(mpshm_t *shm, int shmflg);
+int mpshm_detach(mpshm_t *shm);
+int mpshm_remap(mpshm_t *shm, void *pa);
+uintptr_t mpshm_phys2virt(mpshm_t *shm, const void *pa);
+uintptr_t mpshm_virt2phys(mpshm_t *shm, void *va);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_ASMP_MPSHM_H */
@@ -0,0 +1,27 @@
+/*
+ *  audio_frontend_api.h - Host stand-in of the audio API of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* The host SDK has all of the audio API in audio_high_level_api.h. */
+
+#ifndef AUDIO_FRONTEND_API_H
+#define AUDIO_FRONTEND_API_H
+
+#include "audio/audio_high_level_api.h"
+
+#endif /* AUDIO_FRONTEND_API_H */
@@ -0,0 +1,1058 @@
+/*
+ *  audio_high_level_api.h - Host stand-in of the audio API of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * The types and the functions of the audio subsystem that the Audio library
+ * uses, with the same names as in the SDK. The values of the codes are the
+ * simulator's own. The SDK headers audio_capture_api.h, audio_frontend_api.h,
+ * audio_message_types.h and audio_synthesizer_api.h include this one.
+ *
+ * src/AudioSimSdk.cpp implements the functions. Only the recorder path, the
+ * MicFrontend and the OutputMixer carry data; the other objects accept their
+ * commands and reply with success.
+ */
+
+#ifndef AUDIO_HIGH_LEVEL_API_H
+#define AUDIO_HIGH_LEVEL_API_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "memutils/message/Message.h"
+#include "memutils/memory_manager/MemHandle.h"
+
+/****************************************************************************
+ * Parameter values
+ ****************************************************************************/
+
+#define AS_ERR_CODE_OK          0
+#define AS_ERR_CODE_TIMEOUT     1
+
+#define AS_ECODE_OK             0x00
+#define AS_ECODE_STATE_VIOLATION 0x01
+#define AS_ECODE_COMMAND_NOT_SUPPOT 0x04
+#define AS_ECODE_COMMAND_PARAM_CODEC_TYPE     0x11
+#define AS_ECODE_COMMAND_PARAM_CHANNEL_NUMBER 0x13
+#define AS_ECODE_COMMAND_PARAM_SAMPLING_RATE  0x14
+#define AS_ECODE_COMMAND_PARAM_BIT_LENGTH     0x16
+#define AS_ECODE_COMMAND_PARAM_INPUT_DEVICE   0x19
+
+#define AS_MODULE_ID_AUDIO_MANAGER 0
+#define AS_MODULE_ID_MIC_FRONTEND  1
+#define AS_MODULE_ID_MEDIA_RECORDER 2
+#define AS_MODULE_ID_OUTPUT_MIX    3
+
+#define AS_ATTENTION_CODE_INFORMATION 0
+#define AS_ATTENTION_CODE_WARNING     1
+#define AS_ATTENTION_CODE_ERROR       2
+#define AS_ATTENTION_CODE_FATAL       3
+
+#define AS_ATTENTION_SUB_CODE_SIMPLE_FIFO_UNDERFLOW 0x05
+#define AS_ATTENTION_SUB_CODE_SIMPLE_FIFO_OVERFLOW  0x06
+#define AS_ATTENTION_SUB_CODE_MEMHANDLE_ALLOC_ERROR 0x0d
+
+#define AS_AUDIO_DSP_PATH_LEN          24
+#define AS_PREPROCESS_FILE_PATH_LEN    24
+#define AS_RECOGNIZER_FILE_PATH_LEN    24
+
+#define AS_CODECTYPE_MP3   0
+#define AS_CODECTYPE_WAV   1
+#define AS_CODECTYPE_AAC   2
+#define AS_CODECTYPE_OPUS  3
+#define AS_CODECTYPE_MEDIA 4
+#define AS_CODECTYPE_LPCM  5
+
+#define AS_SAMPLINGRATE_AUTO   0
+#define AS_SAMPLINGRATE_8000   8000
+#define AS_SAMPLINGRATE_16000  16000
+#define AS_SAMPLINGRATE_32000  32000
+#define AS_SAMPLINGRATE_44100  44100
+#define AS_SAMPLINGRATE_48000  48000
+#define AS_SAMPLINGRATE_96000  96000
+#define AS_SAMPLINGRATE_192000 192000
+
+#define AS_BITLENGTH_16 16
+#define AS_BITLENGTH_24 24
+#define AS_BITLENGTH_32 32
+
+#define AS_CHANNEL_MONO   1
+#define AS_CHANNEL_STEREO 2
+#define AS_CHANNEL_4CH    4
+#define AS_CHANNEL_6CH    6
+#define AS_CHANNEL_8CH    8
+
+#define AS_BITRATE_8000   8000
+#define AS_BITRATE_16000  16000
+#define AS_BITRATE_64000  64000
+#define AS_BITRATE_96000  96000
+#define AS_BITRATE_128000 128000
+
+#define AS_INITREC_COMPLEXITY_0 0
+
+#define AS_MIC_CHANNEL_MAX 8
+#define AS_MICGAIN_HOLD    215
+#define AS_VOLUME_MUTE     -1025
+
+#define AS_DISABLE_SOUNDEFFECT 0
+#define AS_ENABLE_SOUNDEFFECT  1
+
+#define AS_PLAYER_ID_0 0
+#define AS_PLAYER_ID_1 1
+
+#define AS_ACTPLAYER_MAIN 0
+#define AS_ACTPLAYER_SUB  1
+#define AS_ACTPLAYER_BOTH 2
+
+#define AS_SETPLAYER_INPUTDEVICE_RAM        1
+#define AS_SETPLAYER_OUTPUTDEVICE_SPHP      0
+#define AS_SETPLAYER_OUTPUTDEVICE_I2SOUTPUT 1
+
+#define AS_SETRECDR_STS_OUTPUTDEVICE_RAM 1
+
+#define AS_STOPPLAYER_NORMAL 0
+#define AS_STOPPLAYER_ESEND  1
+
+#define AS_OUT_SP  0
+#define AS_OUT_I2S 2
+
+#define AS_SP_DRV_MODE_LINEOUT  0
+#define AS_SP_DRV_MODE_1DRIVER  1
+#define AS_SP_DRV_MODE_2DRIVER  2
+#define AS_SP_DRV_MODE_4DRIVER  3
+
+#define AS_THROUGH_PATH_IN_MIC     0
+#define AS_THROUGH_PATH_IN_I2S1    1
+#define AS_THROUGH_PATH_IN_MIXER   2
+#define AS_THROUGH_PATH_OUT_MIXER1 0
+#define AS_THROUGH_PATH_OUT_MIXER2 1
+#define AS_THROUGH_PATH_OUT_I2S1   2
+
+typedef enum
+{
+  AS_CLKMODE_NORMAL = 0,
+  AS_CLKMODE_HIRES
+} AsClkMode;
+
+/****************************************************************************
+ * Commands of the AudioManager
+ ****************************************************************************/
+
+#define AUDCMD_POWERON              0x71
+#define AUDCMD_SETPOWEROFFSTATUS    0x72
+#define AUDCMD_SETREADYSTATUS       0x73
+#define AUDCMD_SETPLAYERSTATUS      0x74
+#define AUDCMD_SETRECORDERSTATUS    0x75
+#define AUDCMD_SETTHROUGHSTATUS     0x76
+#define AUDCMD_SETRECOGNIZERSTATUS  0x77
+
+#define AUDCMD_INITMICGAIN          0x51
+#define AUDCMD_INITOUTPUTSELECT     0x53
+#define AUDCMD_SETVOLUME            0x58
+#define AUDCMD_SETBEEPPARAM         0x59
+#define AUDCMD_SETTHROUGHPATH       0x5a
+#define AUDCMD_SETMICMAP            0x5b
+#define AUDCMD_SETRENDERINGCLK      0x5c
+#define AUDCMD_SETSPDRVMODE         0x5d
+
+#define AUDCMD_INITPLAYER           0x21
+#define AUDCMD_PLAYPLAYER           0x22
+#define AUDCMD_STOPPLAYER           0x23
+#define AUDCMD_SETGAIN              0x26
+
+#define AUDCMD_INITREC              0x31
+#define AUDCMD_STARTREC             0x32
+#define AUDCMD_STOPREC              0x33
+
+#define AUDCMD_INIT_MICFRONTEND     0x38
+#define AUDCMD_INIT_PREPROCESS_DSP  0x39
+#define AUDCMD_SET_PREPROCESS_DSP   0x3a
+
+#define AUDCMD_INIT_RECOGNIZER      0x3b
+#define AUDCMD_START_RECOGNIZER     0x3c
+#define AUDCMD_STOP_RECOGNIZER      0x3d
+#define AUDCMD_INIT_RECOGNIZER_DSP  0x3e
+#define AUDCMD_SET_RECOGNIZER_DSP   0x3f
+
+#define AUDRLT_STATUSCHANGED              0xf1
+#define AUDRLT_ERRORRESPONSE              0xf2
+#define AUDRLT_INITMICGAINCMPLT           0xd1
+#define AUDRLT_INITOUTPUTSELECTCMPLT      0xd3
+#define AUDRLT_SETVOLUMECMPLT             0xd8
+#define AUDRLT_SETBEEPCMPLT               0xd9
+#define AUDRLT_SETTHROUGHPATHCMPLT        0xda
+#define AUDRLT_SETMICMAPCMPLT             0xdb
+#define AUDRLT_SETRENDERINGCLKCMPLT       0xdc
+#define AUDRLT_SETSPDRVMODECMPLT          0xdd
+#define AUDRLT_INITPLAYERCMPLT            0xa1
+#define AUDRLT_PLAYCMPLT                  0xa2
+#define AUDRLT_STOPCMPLT                  0xa3
+#define AUDRLT_SETGAIN_CMPLT              0xa6
+#define AUDRLT_INITRECCMPLT               0xb1
+#define AUDRLT_RECCMPLT                   0xb2
+#define AUDRLT_STOPRECCMPLT               0xb3
+#define AUDRLT_INIT_MICFRONTEND           0xb8
+#define AUDRLT_INIT_PREPROCESS_DSP_CMPLT  0xb9
+#define AUDRLT_SET_PREPROCESS_DSP_CMPLT   0xba
+#define AUDRLT_INIT_RECOGNIZER_CMPLT      0xbb
+#define AUDRLT_START_RECOGNIZER_CMPLT     0xbc
+#define AUDRLT_STOP_RECOGNIZER_CMPLT      0xbd
+#define AUDRLT_INIT_RECOGNIZER_DSP_CMPLT  0xbe
+#define AUDRLT_SET_RECOGNIZER_DSP_CMPLT   0xbf
+
+/* The packet lengths are not checked on the host. */
+
+#define LENGTH_POWERON                2
+#define LENGTH_SET_POWEROFF_STATUS    2
+#define LENGTH_SET_READY_STATUS       2
+#define LENGTH_SET_PLAYER_STATUS      10
+#define LENGTH_SET_RECORDER_STATUS    6
+#define LENGTH_SET_THROUGH_STATUS     2
+#define LENGTH_SET_RECOGNIZER_STATUS  2
+#define LENGTH_INITMICGAIN            5
+#define LENGTH_INITOUTPUTSELECT       2
+#define LENGTH_SETVOLUME              3
+#define LENGTH_SETBEEPPARAM           3
+#define LENGTH_SET_THROUGH_PATH       4
+#define LENGTH_SETMICMAP              3
+#define LENGTH_SETRENDERINGCLK        2
+#define LENGTH_SETSPDRVMODE           2
+#define LENGTH_INIT_PLAYER            9
+#define LENGTH_PLAY_PLAYER            2
+#define LENGTH_STOP_PLAYER            2
+#define LENGTH_SET_GAIN               2
+#define LENGTH_INIT_RECORDER          10
+#define LENGTH_START_RECORDER         2
+#define LENGTH_STOP_RECORDER          2
+#define LENGTH_INIT_MICFRONTEND       10
+#define LENGTH_INIT_PREPROCESS_DSP    10
+#define LENGTH_SET_PREPROCESS_DSP     10
+#define LENGTH_INIT_RECOGNIZER        10
+#define LENGTH_START_RECOGNIZER       2
+#define LENGTH_STOP_RECOGNIZER        2
+#define LENGTH_INIT_RECOGNIZER_DSP    10
+#define LENGTH_SET_RECOGNIZER_DSP     10
+
+/****************************************************************************
+ * Common types
+ ****************************************************************************/
+
+/** Attention from an audio object */
+
+typedef struct
+{
+  uint8_t       error_code;          /**< AS_ATTENTION_CODE_XXX */
+  uint8_t       module_id;           /**< AS_MODULE_ID_XXX */
+  uint16_t      line_number;         /**< Line of the simulator */
+  unsigned long error_att_sub_code;  /**< AS_ATTENTION_SUB_CODE_XXX */
+} ErrorAttentionParam;
+
+typedef void (*AudioAttentionCb)(const ErrorAttentionParam *attparam);
+
+/** Reply of an object API */
+
+typedef struct
+{
+  uint32_t id;         /**< Command id of the reply */
+  uint32_t type;       /**< Type of the reply */
+  uint32_t module_id;  /**< AS_MODULE_ID_XXX */
+  uint32_t result;     /**< AS_ECODE_XXX */
+} AudioObjReply;
+
+typedef void (*PcmProcDoneCallback)(int32_t identifier, bool is_end);
+
+/** A frame of PCM between the objects */
+
+typedef struct
+{
+  uint32_t                 identifier; /**< Identifier of the sender */
+  PcmProcDoneCallback      callback;   /**< Unused */
+  MemMgrLite::MemHandle    mh;         /**< Segment of the frame */
+  uint32_t                 sample;     /**< Samples per channel */
+  uint32_t                 size;       /**< Bytes */
+  bool                     is_end;     /**< Last frame of the stream */
+  bool                     is_valid;   /**< The frame holds data */
+  uint8_t                  bit_length; /**< AS_BITLENGTH_XXX */
+} AsPcmDataParam;
+
+template<> err_t MsgLib::send<AsPcmDataParam>(MsgQueId dest,
+                                              MsgPri pri,
+                                              MsgType type,
+                                              MsgQueId reply,
+                                              const AsPcmDataParam &param);
+
+typedef void (*AsFrontendPcmDataCallback)(AsPcmDataParam pcm);
+
+/** Destination of the frames of the MicFrontend */
+
+typedef union
+{
+  AsFrontendPcmDataCallback cb;  /**< With AsDataPathCallback */
+  struct
+  {
+    MsgQueId msgqid;             /**< With AsDataPathMessage */
+    MsgType  msgtype;
+  } msg;
+} AsDataDest;
+
+typedef enum
+{
+  AsDataPathCallback = 0,
+  AsDataPathMessage
+} AsDataPathType;
+
+/** Handlers of the SimpleFIFO between the application and the objects */
+
+typedef struct
+{
+  void *simple_fifo_handler;                /**< CMN_SimpleFifoHandle */
+  void (*callback_function)(uint32_t size); /**< Called with the size of new data */
+  uint32_t notification_threshold_size;
+} AsRecorderOutputDeviceHdlr;
+
+typedef struct
+{
+  void *simple_fifo_handler;                /**< CMN_SimpleFifoHandle */
+  void (*callback_function)(uint32_t size); /**< Called with the size of taken data */
+  uint32_t notification_threshold_size;
+} AsPlayerInputDeviceHdlrForRAM;
+
+/****************************************************************************
+ * Parameters of creation
+ ****************************************************************************/
+
+typedef struct
+{
+  MsgQueId app;
+  MsgQueId mng;
+  MsgQueId player_main;
+  MsgQueId player_sub;
+  MsgQueId micfrontend;
+  MsgQueId mixer;
+  MsgQueId recorder;
+  MsgQueId effector;
+  MsgQueId recognizer;
+} AudioSubSystemIDs;
+
+typedef struct
+{
+  struct
+  {
+    MsgQueId player;
+    MsgQueId mng;
+    MsgQueId mixer;
+    MsgQueId dsp;
+  } msgq_id;
+  struct
+  {
+    MemMgrLite::PoolId es;
+    MemMgrLite::PoolId pcm;
+    MemMgrLite::PoolId dsp;
+    MemMgrLite::PoolId src_work;
+  } pool_id;
+} AsCreatePlayerParams_t;
+
+typedef struct
+{
+  struct
+  {
+    MsgQueId mixer;
+    MsgQueId render_path0_filter_dsp;
+    MsgQueId render_path1_filter_dsp;
+  } msgq_id;
+  struct
+  {
+    MemMgrLite::PoolId render_path0_filter_pcm;
+    MemMgrLite::PoolId render_path1_filter_pcm;
+    MemMgrLite::PoolId render_path0_filter_dsp;
+    MemMgrLite::PoolId render_path1_filter_dsp;
+  } pool_id;
+} AsCreateOutputMixParams_t;
+
+typedef struct
+{
+  struct
+  {
+    MsgQueId dev0_req;
+    MsgQueId dev0_sync;
+    MsgQueId dev1_req;
+    MsgQueId dev1_sync;
+  } msgq_id;
+} AsCreateRendererParam_t;
+
+typedef struct
+{
+  struct
+  {
+    MsgQueId dev0_req;
+    MsgQueId dev0_sync;
+    MsgQueId dev1_req;
+    MsgQueId dev1_sync;
+  } msgq_id;
+} AsCreateCaptureParam_t;
+
+typedef struct
+{
+  struct
+  {
+    MsgQueId micfrontend;
+    MsgQueId mng;
+    MsgQueId dsp;
+  } msgq_id;
+  struct
+  {
+    MemMgrLite::PoolId input;
+    MemMgrLite::PoolId output;
+    MemMgrLite::PoolId dsp;
+  } pool_id;
+} AsCreateMicFrontendParams_t;
+
+typedef struct
+{
+  struct
+  {
+    MsgQueId recorder;
+    MsgQueId mng;
+    MsgQueId dsp;
+  } msgq_id;
+  struct
+  {
+    MemMgrLite::PoolId input;
+    MemMgrLite::PoolId output;
+    MemMgrLite::PoolId dsp;
+  } pool_id;
+} AsCreateRecorderParams_t;
+
+typedef struct
+{
+  struct
+  {
+    MsgQueId recognizer;
+    MsgQueId mng;
+    MsgQueId dsp;
+  } msgq_id;
+  struct
+  {
+    MemMgrLite::PoolId out;
+    MemMgrLite::PoolId dsp;
+  } pool_id;
+} AsCreateRecognizerParam_t;
+
+typedef struct
+{
+  struct
+  {
+    MsgQueId synthesizer;
+    MsgQueId mng;
+    MsgQueId dsp;
+  } msgq_id;
+  struct
+  {
+    MemMgrLite::PoolId output;
+    MemMgrLite::PoolId dsp;
+  } pool_id;
+} AsCreateSynthesizerParam_t;
+
+/****************************************************************************
+ * AudioCommand and AudioResult
+ ****************************************************************************/
+
+typedef struct
+{
+  uint8_t reserved;
+  uint8_t sub_code;
+  uint8_t command_code;
+  uint8_t packet_length;
+} AudioCommandHeader;
+
+typedef struct
+{
+  uint8_t reserved;
+  uint8_t sub_code;
+  uint8_t result_code;
+  uint8_t packet_length;
+} AudioResultHeader;
+
+typedef struct
+{
+  uint8_t enable_sound_effect;
+} PowerOnParam;
+
+typedef struct
+{
+  int16_t mic_gain[AS_MIC_CHANNEL_MAX];
+} InitMicGainParam;
+
+typedef struct
+{
+  uint8_t output_device_sel;
+} InitOutputSelectParam;
+
+typedef struct
+{
+  int16_t input1_db;
+  int16_t input2_db;
+  int16_t master_db;
+} SetVolumeParam;
+
+typedef struct
+{
+  uint8_t  beep_en;
+  int16_t  beep_vol;
+  uint16_t beep_freq;
+} SetBeepParam;
+
+typedef struct
+{
+  uint8_t mic_map[AS_MIC_CHANNEL_MAX];
+} SetMicMapParam;
+
+typedef struct
+{
+  uint8_t clk_mode;
+} SetRenderingClkParam;
+
+typedef struct
+{
+  uint8_t mode;
+} SetSpDrvModeParam;
+
+typedef struct
+{
+  bool    en;
+  uint8_t in;
+  uint8_t out;
+} AsThroughPath;
+
+typedef struct
+{
+  AsThroughPath path1;
+  AsThroughPath path2;
+} SetThroughPathParam;
+
+typedef struct
+{
+  uint8_t                        input_device;
+  AsPlayerInputDeviceHdlrForRAM *ram_handler;
+  uint8_t                        output_device;
+} AsSetPlayerInputDevice;
+
+typedef struct
+{
+  uint8_t                active_player;
+  AsSetPlayerInputDevice player0;
+  AsSetPlayerInputDevice player1;
+} SetPlayerStsParam;
+
+typedef struct
+{
+  uint8_t                     input_device;
+  void                       *input_device_handler;
+  uint8_t                     output_device;
+  AsRecorderOutputDeviceHdlr *output_device_handler;
+} SetRecorderStsParam;
+
+typedef struct
+{
+  uint8_t input_device;
+} SetRecognizerStsParam;
+
+typedef struct
+{
+  uint8_t  codec_type;
+  uint8_t  bit_length;
+  uint8_t  channel_number;
+  uint32_t sampling_rate;
+  char     dsp_path[AS_AUDIO_DSP_PATH_LEN];
+} AsInitPlayerParam;
+
+typedef struct
+{
+  uint8_t stop_mode;
+} AsStopPlayerParam;
+
+typedef struct
+{
+  int16_t l_gain;
+  int16_t r_gain;
+} AsSetGainParam;
+
+typedef struct
+{
+  uint8_t player_id;
+  union
+  {
+    AsInitPlayerParam init_param;
+    AsStopPlayerParam stop_param;
+    AsSetGainParam    set_gain_param;
+  };
+} PlayerCommand;
+
+typedef struct
+{
+  uint32_t sampling_rate;
+  uint8_t  channel_number;
+  uint8_t  bit_length;
+  uint8_t  codec_type;
+  uint8_t  computational_complexity;
+  uint32_t bitrate;
+  char     dsp_path[AS_AUDIO_DSP_PATH_LEN];
+} AsInitRecorderParam;
+
+typedef struct
+{
+  union
+  {
+    AsInitRecorderParam init_param;
+  };
+} RecorderCommand;
+
+typedef struct
+{
+  uint8_t  ch_num;
+  uint8_t  bit_length;
+  uint8_t  preproc_type;
+  uint8_t  data_dest;
+  uint32_t samples;
+  char     preprocess_dsp_path[AS_PREPROCESS_FILE_PATH_LEN];
+} InitMicFrontendParam;
+
+typedef struct
+{
+  uint8_t *packet_addr;
+  uint32_t packet_size;
+} AsInitPreProcParam;
+
+typedef AsInitPreProcParam AsSetPreProcParam;
+
+typedef struct
+{
+  uint8_t *packet_addr;
+  uint32_t packet_size;
+} AsInitRecognizerProcParam;
+
+typedef struct
+{
+  uint32_t id;
+  uint32_t size;
+  uint8_t *data;
+} AsRecognitionInfo;
+
+typedef void (*RecognizerFindCallback)(AsRecognitionInfo info);
+
+typedef enum
+{
+  AsRecognizerTypeUserCustom = 0
+} AsRecognizerType;
+
+typedef struct
+{
+  RecognizerFindCallback fcb;
+  uint8_t                recognizer_type;
+  char                   recognizer_dsp_path[AS_RECOGNIZER_FILE_PATH_LEN];
+} AsInitRecognizerParam;
+
+typedef struct
+{
+  AudioCommandHeader header;
+  union
+  {
+    PowerOnParam              power_on_param;
+    InitMicGainParam          init_mic_gain_param;
+    InitOutputSelectParam     init_output_select_param;
+    SetVolumeParam            set_volume_param;
+    SetBeepParam              set_beep_param;
+    SetMicMapParam            set_mic_map_param;
+    SetRenderingClkParam      set_renderingclk_param;
+    SetSpDrvModeParam         set_sp_drv_mode;
+    SetThroughPathParam       set_through_path;
+    SetPlayerStsParam         set_player_sts_param;
+    SetRecorderStsParam       set_recorder_status_param;
+    SetRecognizerStsParam     set_recognizer_status_param;
+    PlayerCommand             player;
+    RecorderCommand           recorder;
+    InitMicFrontendParam      init_micfrontend_param;
+    AsInitPreProcParam        init_preproc_param;
+    AsSetPreProcParam         set_preproc_param;
+    AsInitRecognizerParam     init_recognizer;
+    AsInitRecognizerProcParam init_rcg_param;
+  };
+} AudioCommand;
+
+typedef struct
+{
+  uint32_t      module_id;
+  unsigned long error_code;
+  unsigned long error_sub_code;
+} ErrorResponseParam;
+
+typedef struct
+{
+  uint8_t status;
+} NotifyStatus;
+
+typedef struct
+{
+  AudioResultHeader header;
+  union
+  {
+    ErrorResponseParam error_response_param;
+    NotifyStatus       notify_status;
+  };
+} AudioResult;
+
+/****************************************************************************
+ * MicFrontend
+ ****************************************************************************/
+
+typedef enum
+{
+  AsMicFrontendEventAct = 0,
+  AsMicFrontendEventDeact,
+  AsMicFrontendEventInit,
+  AsMicFrontendEventStart,
+  AsMicFrontendEventStop,
+  AsMicFrontendEventInitPreProc,
+  AsMicFrontendEventSetPreProc,
+  AsMicFrontendEventSetMicGain
+} AsMicFrontendEvent;
+
+typedef bool (*MicFrontendCallback)(AsMicFrontendEvent evtype,
+                                    uint32_t result,
+                                    uint32_t sub_result);
+
+typedef enum
+{
+  AsMicFrontendDeviceMic = 0,
+  AsMicFrontendDeviceI2s
+} AsMicFrontendInputDevice;
+
+typedef enum
+{
+  AsMicFrontendPreProcThrough = 0,
+  AsMicFrontendPreProcSrc,
+  AsMicFrontendPreProcUserCustom
+} AsMicFrontendPreProcType;
+
+typedef enum
+{
+  AsMicFrontendDataToRecorder = 0,
+  AsMicFrontendDataToRecognizer
+} AsMicFrontendDataDest;
+
+typedef AsMicFrontendDataDest AsFrontendDataDest;
+
+typedef struct
+{
+  uint8_t input_device;
+} AsActivateFrontendParam;
+
+typedef struct
+{
+  AsActivateFrontendParam param;
+  MicFrontendCallback     cb;
+} AsActivateMicFrontend;
+
+typedef struct
+{
+  uint8_t    channel_number;
+  uint8_t    bit_length;
+  uint32_t   samples_per_frame;
+  uint32_t   out_fs;
+  uint8_t    preproc_type;
+  char       dsp_path[AS_PREPROCESS_FILE_PATH_LEN];
+  uint8_t    data_path;
+  AsDataDest dest;
+} AsInitMicFrontendParam;
+
+typedef struct
+{
+  uint32_t reserve;
+} AsStartMicFrontendParam;
+
+typedef struct
+{
+  uint32_t stop_mode;
+} AsStopMicFrontendParam;
+
+typedef struct
+{
+  uint32_t reserve;
+} AsDeactivateMicFrontendParam;
+
+typedef struct
+{
+  int16_t mic_gain[AS_MIC_CHANNEL_MAX];
+} AsMicFrontendMicGainParam;
+
+bool AS_CreateMicFrontend(AsCreateMicFrontendParams_t *param, AudioAttentionCb attcb);
+bool AS_ActivateMicFrontend(AsActivateMicFrontend *actparam);
+bool AS_InitMicFrontend(AsInitMicFrontendParam *initparam);
+bool AS_StartMicFrontend(AsStartMicFrontendParam *startparam);
+bool AS_StopMicFrontend(AsStopMicFrontendParam *stopparam);
+bool AS_InitPreprocFrontend(AsInitPreProcParam *param);
+bool AS_SetPreprocMicFrontend(AsSetPreProcParam *param);
+bool AS_SetMicGainMicFrontend(AsMicFrontendMicGainParam *micgain_param);
+bool AS_DeactivateMicFrontend(AsDeactivateMicFrontendParam *deactparam);
+bool AS_DeleteMicFrontend(void);
+
+/****************************************************************************
+ * MediaRecorder
+ ****************************************************************************/
+
+typedef enum
+{
+  AsRecorderEventAct = 0,
+  AsRecorderEventInit,
+  AsRecorderEventStart,
+  AsRecorderEventStop,
+  AsRecorderEventReqEncode,
+  AsRecorderEventSetMicGain,
+  AsRecorderEventDeact
+} AsRecorderEvent;
+
+typedef bool (*MediaRecorderCallback)(AsRecorderEvent evtype,
+                                      uint32_t result,
+                                      uint32_t sub_result);
+
+typedef enum
+{
+  AS_SETRECDR_STS_INPUTDEVICE_MIC = 0,
+  AS_SETRECDR_STS_INPUTDEVICE_I2S
+} AsSetRecorderStsInputDevice;
+
+typedef struct
+{
+  uint8_t                     input_device;
+  void                       *input_device_handler;
+  uint8_t                     output_device;
+  AsRecorderOutputDeviceHdlr *output_device_handler;
+} AsActivateRecorderParam;
+
+typedef struct
+{
+  AsActivateRecorderParam param;
+  MediaRecorderCallback   cb;
+} AsActivateRecorder;
+
+bool AS_CreateMediaRecorder(AsCreateRecorderParams_t *param, AudioAttentionCb attcb);
+bool AS_ActivateMediaRecorder(AsActivateRecorder *actparam);
+bool AS_InitMediaRecorder(AsInitRecorderParam *initparam);
+bool AS_StartMediaRecorder(void);
+bool AS_StopMediaRecorder(void);
+bool AS_DeactivateMediaRecorder(void);
+bool AS_DeleteMediaRecorder(void);
+
+/****************************************************************************
+ * OutputMixer and Renderer
+ ****************************************************************************/
+
+typedef enum
+{
+  OutputMixer0 = 0,
+  OutputMixer1,
+  OutputMixerHandleNum
+} AsOutputMixerHandle;
+
+typedef enum
+{
+  HPOutputDevice = 0,
+  I2SOutputDevice,
+  A2dpSrcOutputDevice
+} AsOutputMixDevice;
+
+typedef enum
+{
+  MainOnly = 0,
+  SoundEffectOnly,
+  MainSoundEffectMix
+} AsOutputMixerType;
+
+typedef enum
+{
+  PostFilterDisable = 0,
+  PostFilterEnable
+} AsOutputMixerPostEnable;
+
+typedef struct
+{
+  uint8_t handle;
+  bool    done_type;
+} AsOutputMixDoneParam;
+
+typedef void (*OutputMixerCallback)(MsgQueId requester_dtq,
+                                    MsgType reply_of,
+                                    AsOutputMixDoneParam *done_param);
+
+typedef struct
+{
+  uint8_t             output_device;
+  uint8_t             mixer_type;
+  uint8_t             post_enable;
+  OutputMixerCallback cb;
+} AsActivateOutputMixer;
+
+typedef struct
+{
+  uint8_t             handle;
+  PcmProcDoneCallback callback;
+  AsPcmDataParam      pcm;
+} AsSendDataOutputMixer;
+
+typedef struct
+{
+  uint32_t reserve;
+} AsDeactivateOutputMixer;
+
+typedef struct
+{
+  uint8_t *addr;
+  uint32_t size;
+} AsInitPostProc;
+
+typedef AsInitPostProc AsSetPostProc;
+
+bool AS_CreateOutputMixer(AsCreateOutputMixParams_t *param, AudioAttentionCb attcb);
+bool AS_ActivateOutputMixer(uint8_t handle, AsActivateOutputMixer *actparam);
+bool AS_SendDataOutputMixer(AsSendDataOutputMixer *sendparam);
+bool AS_InitPostprocOutputMixer(uint8_t handle, AsInitPostProc *initppparam);
+bool AS_SetPostprocOutputMixer(uint8_t handle, AsSetPostProc *setppparam);
+bool AS_DeactivateOutputMixer(uint8_t handle, AsDeactivateOutputMixer *deactparam);
+bool AS_DeleteOutputMix(void);
+
+bool AS_CreateRenderer(AsCreateRendererParam_t *param);
+bool AS_DeleteRenderer(void);
+
+/****************************************************************************
+ * Synthesizer
+ ****************************************************************************/
+
+#define AsSynthesizerMaxChannelNum 8
+
+typedef enum
+{
+  AsSynthesizerSinWave = 0,
+  AsSynthesizerRectWave,
+  AsSynthesizerSawWave
+} AsSynthesizerWaveMode;
+
+typedef enum
+{
+  AsSynthesizerDataPathCallback = 0,
+  AsSynthesizerDataPathMessage
+} AsSynthesizerDataPath;
+
+typedef enum
+{
+  AsSynthesizerEventActivate = 0,
+  AsSynthesizerEventInit,
+  AsSynthesizerEventStart,
+  AsSynthesizerEventStop,
+  AsSynthesizerEventSet,
+  AsSynthesizerEventDeactivate
+} AsSynthesizerEvent;
+
+typedef void (*SynthesizerCallback)(AsSynthesizerEvent evtype,
+                                    uint32_t result,
+                                    void *param);
+
+typedef union
+{
+  AsFrontendPcmDataCallback cb;
+  struct
+  {
+    MsgQueId id;
+    uint8_t  identifier;
+  } msg;
+} AsSynthesizerDataDest;
+
+typedef struct
+{
+  SynthesizerCallback cb;
+} AsActivateSynthesizer;
+
+typedef struct
+{
+  uint8_t               type;
+  uint8_t               channel_num;
+  uint32_t              sampling_rate;
+  uint8_t               bit_width;
+  uint8_t               data_path;
+  AsSynthesizerDataDest dest;
+  uint32_t              sample_size;
+  uint16_t              attack;
+  uint16_t              decay;
+  uint16_t              sustain;
+  uint16_t              release;
+  char                  dsp_path[AS_AUDIO_DSP_PATH_LEN];
+} AsInitSynthesizerParam;
+
+typedef struct
+{
+  uint8_t  channel_no;
+  uint32_t frequency;
+  uint16_t attack;
+  uint16_t decay;
+  uint16_t sustain;
+  uint16_t release;
+} AsSetSynthesizer;
+
+bool AS_CreateMediaSynthesizer(AsCreateSynthesizerParam_t *param, AudioAttentionCb attcb);
+bool AS_ActivateMediaSynthesizer(AsActivateSynthesizer *actparam);
+bool AS_InitMediaSynthesizer(AsInitSynthesizerParam *initparam);
+bool AS_StartMediaSynthesizer(void);
+bool AS_StopMediaSynthesizer(void);
+bool AS_SetMediaSynthesizer(AsSetSynthesizer *setparam);
+bool AS_DeleteMediaSynthesizer(void);
+
+/****************************************************************************
+ * AudioManager and the other objects
+ ****************************************************************************/
+
+int AS_CreateAudioManager(AudioSubSystemIDs ids, AudioAttentionCb att_cb);
+int AS_DeleteAudioManager(void);
+
+/**
+ * @brief Execute a command of the AudioManager.
+ *
+ * @details The command is done before the return, and its result is kept
+ *          for AS_ReceiveAudioResult().
+ */
+int AS_SendAudioCommand(AudioCommand *packet);
+
+/**
+ * @brief Take the oldest result of AS_SendAudioCommand().
+ */
+int AS_ReceiveAudioResult(AudioResult *packet);
+int AS_ReceiveAudioResult(AudioResult *packet, uint8_t id, uint32_t timeout);
+
+/**
+ * @brief Take the oldest reply of an object API to the queue.
+ *
+ * @return false if the queue has no reply.
+ */
+bool AS_ReceiveObjectReply(MsgQueId msgq_id, AudioObjReply *reply);
+
+bool AS_CreatePlayerMulti(uint8_t player_id, AsCreatePlayerParams_t *param, AudioAttentionCb attcb);
+bool AS_DeletePlayer(uint8_t player_id);
+bool AS_CreateCapture(AsCreateCaptureParam_t *param);
+bool AS_DeleteCapture(void);
+bool AS_CreateRecognizer(AsCreateRecognizerParam_t *param, AudioAttentionCb attcb);
+bool AS_DeleteRecognizer(void);
+
+#endif /* AUDIO_HIGH_LEVEL_API_H */
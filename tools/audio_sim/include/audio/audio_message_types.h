@@ -0,0 +1,38 @@
+/*
+ *  audio_message_types.h - Host stand-in of the audio API of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Message types of the frames between the audio objects. The host SDK
+ * routes the frames by the destination queue, so the types are only
+ * carried along. The OutputMixer gives the types of its replies to its
+ * callback.
+ */
+
+#ifndef AUDIO_MESSAGE_TYPES_H
+#define AUDIO_MESSAGE_TYPES_H
+
+#include "audio/audio_high_level_api.h"
+
+#define MSG_AUD_MRC_CMD_ENCODE 0x4001 /**< Frame to the MediaRecorder */
+#define MSG_AUD_RCG_EXEC       0x4002 /**< Frame to the Recognizer */
+#define MSG_AUD_MIX_CMD_DATA   0x4003 /**< Frame to the OutputMixer */
+#define MSG_AUD_MIX_CMD_ACT    0x4004 /**< Reply of the activation of the OutputMixer */
+#define MSG_AUD_MIX_CMD_DEACT  0x4005 /**< Reply of the deactivation of the OutputMixer */
+
+#endif /* AUDIO_MESSAGE_TYPES_H */
@@ -0,0 +1,38 @@
+/*
+ *  customproc_command_base.h - Host stand-in of the DSP command of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef CUSTOMPROC_COMMAND_BASE_H
+#define CUSTOMPROC_COMMAND_BASE_H
+
+#include <stdint.h>
+
+namespace CustomprocCommand {
+
+/** Header of a command packet to a user DSP */
+
+struct CmdBase
+{
+  uint8_t  cmd_type;
+  uint8_t  result;
+  uint16_t reserve;
+};
+
+} /* end of namespace CustomprocCommand */
+
+#endif /* CUSTOMPROC_COMMAND_BASE_H */
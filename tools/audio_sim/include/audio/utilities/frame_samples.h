@@ -0,0 +1,46 @@
+/*
+ *  frame_samples.h - Host stand-in of the frame sizes of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef FRAME_SAMPLES_H
+#define FRAME_SAMPLES_H
+
+#include <stdint.h>
+
+#include "audio/audio_high_level_api.h"
+
+/**
+ * @brief Samples per channel of a capture frame of the codec.
+ */
+static inline uint32_t getCapSampleNumPerFrame(uint32_t codec_type,
+                                               uint32_t sampling_rate)
+{
+  switch (codec_type)
+    {
+      case AS_CODECTYPE_MP3:
+        return (sampling_rate <= AS_SAMPLINGRATE_16000) ? 576 : 1152;
+
+      case AS_CODECTYPE_OPUS:
+        return sampling_rate / 50;
+
+      default:
+        return 768;
+    }
+}
+
+#endif /* FRAME_SAMPLES_H */
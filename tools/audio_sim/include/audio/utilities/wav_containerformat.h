@@ -0,0 +1,51 @@
+/*
+ *  wav_containerformat.h - Host stand-in of the WAV header of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef WAV_CONTAINERFORMAT_H
+#define WAV_CONTAINERFORMAT_H
+
+#include <stdint.h>
+
+#define CHUNKID_RIFF    0x46464952 /* "RIFF" */
+#define FORMAT_WAVE     0x45564157 /* "WAVE" */
+#define SUBCHUNKID_FMT  0x20746d66 /* "fmt " */
+#define SUBCHUNKID_DATA 0x61746164 /* "data" */
+#define FMT_CHUNK_SIZE  16
+#define FORMAT_ID_PCM   1
+
+/** Canonical 44 byte header of a PCM WAV file, little endian */
+
+typedef struct
+{
+  uint32_t riff;
+  uint32_t total_size;
+  uint32_t wave;
+  uint32_t fmt;
+  uint32_t fmt_size;
+  uint16_t format;
+  uint16_t channel;
+  uint32_t rate;
+  uint32_t avgbyte;
+  uint16_t block;
+  uint16_t bit;
+  uint32_t data;
+  uint32_t data_size;
+} WAVHEADER;
+
+#endif /* WAV_CONTAINERFORMAT_H */
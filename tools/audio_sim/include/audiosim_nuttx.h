@@ -0,0 +1,119 @@
+/*
+ *  audiosim_nuttx.h - NuttX compatibility for the host build of the library
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * The library sets tattr.stacksize on a NuttX pthread_attr_t and opens
+ * files on /mnt/sd0. On the host, the attribute is a small struct and the
+ * SD card is the directory in AUDIOSIM_SD0, or the current directory.
+ * An absolute host path given to the library, which becomes
+ * "/mnt/sd0//path", is opened as is.
+ *
+ * Include this before any other header, as Arduino.h of the host does.
+ */
+
+#ifndef AUDIOSIM_NUTTX_H
+#define AUDIOSIM_NUTTX_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef OK
+#define OK 0
+#endif
+
+typedef void *(*pthread_startroutine_t)(void *);
+
+static inline int get_errno(void)
+{
+  return errno;
+}
+
+typedef struct {
+  size_t stacksize;
+} audiosim_pthread_attr_t;
+
+static inline int audiosim_pthread_attr_init(audiosim_pthread_attr_t *attr)
+{
+  attr->stacksize = 0;
+  return 0;
+}
+
+/* Real-time priorities need privileges on the host. They are ignored. */
+
+static inline int audiosim_pthread_attr_setschedparam(audiosim_pthread_attr_t *attr,
+                                                      const struct sched_param *param)
+{
+  (void)attr;
+  (void)param;
+  return 0;
+}
+
+static inline int audiosim_pthread_create(pthread_t *thread,
+                                          const audiosim_pthread_attr_t *attr,
+                                          pthread_startroutine_t start,
+                                          void *arg)
+{
+  /* The stack size for NuttX is too small for the host libc. */
+
+  (void)attr;
+  return pthread_create(thread, NULL, start, arg);
+}
+
+static inline int audiosim_open(const char *path, int flags, ...)
+{
+  char host_path[256];
+  const char *sd_root = getenv("AUDIOSIM_SD0");
+  mode_t mode = 0;
+
+  if (flags & O_CREAT)
+    {
+      va_list ap;
+      va_start(ap, flags);
+      mode = (mode_t)va_arg(ap, int);
+      va_end(ap);
+    }
+
+  if (strncmp(path, "/mnt/sd0/", 9) == 0)
+    {
+      path += 9;
+      if ((path[0] != '/') && (sd_root != NULL))
+        {
+          snprintf(host_path, sizeof(host_path), "%s/%s", sd_root, path);
+          path = host_path;
+        }
+    }
+
+  return open(path, flags, mode);
+}
+
+#define pthread_attr_t             audiosim_pthread_attr_t
+#define pthread_attr_init          audiosim_pthread_attr_init
+#define pthread_attr_setschedparam audiosim_pthread_attr_setschedparam
+#define pthread_create             audiosim_pthread_create
+#define open                       audiosim_open
+
+#endif /* AUDIOSIM_NUTTX_H */
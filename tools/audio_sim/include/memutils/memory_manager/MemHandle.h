@@ -0,0 +1,107 @@
+/*
+ *  MemHandle.h - Host stand-in of the MemMgrLite memory handle of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Same API as memutils/memory_manager of the SDK. The pools are created
+ * from MemoryPoolLayouts with the same segment numbers and sizes as on the
+ * board, in host memory. A segment is freed when the last handle of it is
+ * destroyed or freed. Handles can be copied between threads.
+ */
+
+#ifndef MEMHANDLE_H_INCLUDED
+#define MEMHANDLE_H_INCLUDED
+
+#include "memutils/memory_manager/MemMgrTypes.h"
+
+namespace MemMgrLite {
+
+struct MemSegment;
+
+/**
+ * @class Manager
+ * @brief Pools of the memory manager
+ */
+class Manager
+{
+public:
+  static err_t initFirst(void *manager_area, uint32_t area_size);
+  static err_t initPerCpu(void *manager_area, MemPool ***static_pools,
+                          uint8_t *pool_num, uint8_t *layout_no);
+  static err_t createStaticPools(uint8_t sec_no, NumLayout layout_no,
+                                 void *work_area, uint32_t area_size,
+                                 const PoolSectionAttr *pool_attr);
+  static void destroyStaticPools();
+  static void destroyStaticPools(uint8_t sec_no);
+  static err_t finalize();
+
+  static NumLayout getCurrentLayoutNo(uint8_t sec_no = 0);
+  static bool isPoolAvailable(PoolId id);
+  static NumSeg getPoolNumSegs(PoolId id);
+  static NumSeg getPoolNumAvailSegs(PoolId id);
+  static PoolSize getPoolSize(PoolId id);
+};
+
+/**
+ * @class MemHandle
+ * @brief Reference to a segment of a pool
+ */
+class MemHandle
+{
+public:
+  MemHandle() : m_seg(NULL) {}
+  MemHandle(const MemHandle &mh);
+  ~MemHandle() { freeSeg(); }
+
+  MemHandle &operator=(const MemHandle &mh);
+
+  /**
+   * @brief Allocate a segment of the pool.
+   *
+   * @return ERR_OK, ERR_MEM_EMPTY if the pool has no free segment, or
+   *         ERR_DATA_SIZE if the size is larger than the segment.
+   */
+  err_t allocSeg(PoolId id, size_t size_for_check);
+
+  /**
+   * @brief Release the reference. The segment is freed with the last one.
+   */
+  void freeSeg();
+
+  bool isAvail() const { return m_seg != NULL; }
+  bool isNull() const { return m_seg == NULL; }
+  bool isSame(const MemHandle &mh) const { return m_seg == mh.m_seg; }
+
+  PoolId getPoolId() const;
+  uint32_t getSegSize() const;
+  uint8_t getRefCnt() const;
+  void *getVa() const;
+  void *getPa() const { return getVa(); }
+
+private:
+  MemSegment *m_seg;
+};
+
+} /* end of namespace MemMgrLite */
+
+/**
+ * @brief Host address of an address in the shared memory of the layout.
+ */
+void *translatePoolAddrToVa(MemMgrLite::PoolAddr addr);
+
+#endif /* MEMHANDLE_H_INCLUDED */
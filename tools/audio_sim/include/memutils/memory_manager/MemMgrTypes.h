@@ -0,0 +1,67 @@
+/*
+ *  MemMgrTypes.h - Host stand-in of the MemMgrLite types of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef MEMMGR_TYPES_H_INCLUDED
+#define MEMMGR_TYPES_H_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <assert.h>
+
+typedef unsigned int err_t;
+
+#define ERR_OK             0x00
+#define ERR_MEM_EMPTY      0x0d
+#define ERR_DATA_SIZE      0x0e
+#define ERR_STS            0x0f
+
+namespace MemMgrLite {
+
+typedef uint32_t PoolAddr;
+typedef uint32_t PoolSize;
+typedef uint8_t  PoolType;
+typedef uint8_t  NumLayout;
+typedef uint16_t NumSeg;
+
+const NumLayout BadLayoutNo = 0xff;
+const PoolType  BasicType   = 0;
+
+struct PoolId {
+  uint8_t pool; /**< Number of the pool in the section */
+  uint8_t sec;  /**< Section number */
+};
+
+/**
+ * @brief Attributes of a pool in a layout, as in pool_layout.h
+ */
+struct PoolSectionAttr {
+  PoolId   id;
+  PoolType type;
+  NumSeg   num_segs;
+  bool     fence;
+  PoolAddr addr;
+  PoolSize size;
+};
+
+class MemPool;
+
+} /* end of namespace MemMgrLite */
+
+#endif /* MEMMGR_TYPES_H_INCLUDED */
@@ -0,0 +1,83 @@
+/*
+ *  Message.h - Host stand-in of the message library of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Only the sending of a message object is simulated. The host SDK routes
+ * the messages to the simulated audio objects by the destination queue,
+ * so MsgLib::send() has a specialization for each message object, which is
+ * declared by the header of the object.
+ */
+
+#ifndef MESSAGE_H_INCLUDED
+#define MESSAGE_H_INCLUDED
+
+#include <stdint.h>
+
+#include "memutils/memory_manager/MemMgrTypes.h"
+
+typedef uint8_t  MsgQueId;
+typedef uint16_t MsgType;
+
+enum MsgPri {
+  MsgPriNormal, /**< Normal priority */
+  MsgPriHigh,   /**< High priority */
+  NumMsgPri
+};
+
+/**
+ * @brief Definition of a message queue, as in msgq_pool.h
+ */
+struct MsgQueDef {
+  uint32_t n_drm;   /**< Address of the queue of normal priority */
+  uint16_t n_size;  /**< Bytes of an element */
+  uint16_t n_num;   /**< Number of elements */
+  uint32_t h_drm;   /**< Address of the queue of high priority */
+  uint16_t h_size;
+  uint16_t h_num;
+  uint8_t  owner;   /**< CPU which owns the queue */
+};
+
+/**
+ * @class MsgLib
+ * @brief Message library
+ */
+class MsgLib
+{
+public:
+  static err_t initFirst(uint32_t num_pools, uint32_t top_drm);
+  static err_t initPerCpu();
+  static err_t finalize();
+
+  static bool isInitComplete() { return s_init; }
+
+  /**
+   * @brief Send a message object to a queue.
+   *
+   * @details Defined by specializations for the objects the host SDK can
+   *          route. A send of any other object fails to link.
+   */
+  template<typename T>
+  static err_t send(MsgQueId dest, MsgPri pri, MsgType type,
+                    MsgQueId reply, const T &param);
+
+private:
+  static bool s_init;
+};
+
+#endif /* MESSAGE_H_INCLUDED */
@@ -0,0 +1,93 @@
+/*
+ *  CMN_SimpleFifo.h - Host stand-in of the SimpleFIFO of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Same API as memutils/simple_fifo of the SDK, so that the library code
+ * using a player or recorder FIFO builds on the host. One producer and one
+ * consumer may run in different threads.
+ */
+
+#ifndef CMN_SIMPLE_FIFO_H
+#define CMN_SIMPLE_FIFO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  void *dummy;
+} CMN_SimpleFifoSync;
+
+typedef struct {
+  uint8_t *m_pBuf;
+  size_t   m_size;
+  size_t   m_rp;    /* Total bytes polled */
+  size_t   m_wp;    /* Total bytes offered */
+} CMN_SimpleFifoHandle;
+
+typedef struct {
+  void  *m_pChunk1;
+  size_t m_szChunk1;
+  void  *m_pChunk2;
+  size_t m_szChunk2;
+} CMN_SimpleFifoPeekHandle;
+
+/* Returns 0 on success. */
+
+int32_t CMN_SimpleFifoInitialize(CMN_SimpleFifoHandle *pHandle,
+                                 void *pFifoBuffer,
+                                 size_t fifoSize,
+                                 CMN_SimpleFifoSync *pSync);
+
+/* Returns size, or 0 if there is not enough room. Nothing is written then. */
+
+size_t CMN_SimpleFifoOffer(CMN_SimpleFifoHandle *pHandle,
+                           const void *pElement,
+                           size_t size);
+
+/* Returns size, or 0 if there is not enough data. pElement may be NULL to
+ * discard the data.
+ */
+
+size_t CMN_SimpleFifoPoll(CMN_SimpleFifoHandle *pHandle,
+                          void *pElement,
+                          size_t size);
+
+/* Returns size, or 0 if there is not enough data. The data stays in the
+ * FIFO.
+ */
+
+size_t CMN_SimpleFifoPeek(CMN_SimpleFifoHandle *pHandle,
+                          CMN_SimpleFifoPeekHandle *pPeekHandle,
+                          size_t size);
+
+void CMN_SimpleFifoClear(CMN_SimpleFifoHandle *pHandle);
+
+size_t CMN_SimpleFifoGetVacantSize(const CMN_SimpleFifoHandle *pHandle);
+
+size_t CMN_SimpleFifoGetOccupiedSize(const CMN_SimpleFifoHandle *pHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CMN_SIMPLE_FIFO_H */
@@ -0,0 +1,610 @@
+/*
+ *  AudioSim.cpp - Host-side simulator of the audio devices
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+//***************************************************************************
+// Included Files
+//***************************************************************************
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "AudioSim.h"
+
+#define print_err printf
+
+static uint64_t wall_us()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t get_le(const uint8_t *p, int len)
+{
+  uint32_t val = 0;
+
+  for (int i = len - 1; i >= 0; i--)
+    {
+      val = (val << 8) | p[i];
+    }
+
+  return val;
+}
+
+static void put_le(uint8_t *p, uint32_t val, int len)
+{
+  for (int i = 0; i < len; i++)
+    {
+      p[i] = (uint8_t)(val >> (i * 8));
+    }
+}
+
+/****************************************************************************
+ * WAV files
+ ****************************************************************************/
+bool audiosim_read_wav(const char *path, AudioSimFormat *fmt)
+{
+  uint8_t buf[16];
+  bool has_fmt = false;
+
+  FILE *fp = fopen(path, "rb");
+  if (fp == NULL)
+    {
+      print_err("ERROR: Cannot open %s.\n", path);
+      return false;
+    }
+
+  if ((fread(buf, 1, 12, fp) != 12) ||
+      (memcmp(buf, "RIFF", 4) != 0) || (memcmp(buf + 8, "WAVE", 4) != 0))
+    {
+      print_err("ERROR: %s is not a WAV file.\n", path);
+      fclose(fp);
+      return false;
+    }
+
+  while (fread(buf, 1, 8, fp) == 8)
+    {
+      uint32_t size = get_le(buf + 4, 4);
+      long next = ftell(fp) + size + (size & 1);
+
+      if (memcmp(buf, "fmt ", 4) == 0)
+        {
+          if ((size < 16) || (fread(buf, 1, 16, fp) != 16))
+            {
+              break;
+            }
+
+          /* PCM or WAVE_FORMAT_EXTENSIBLE */
+
+          uint32_t tag = get_le(buf, 2);
+          if ((tag != 1) && (tag != 0xfffe))
+            {
+              print_err("ERROR: %s is not PCM.\n", path);
+              break;
+            }
+
+          fmt->channels = get_le(buf + 2, 2);
+          fmt->rate     = get_le(buf + 4, 4);
+          fmt->bits     = get_le(buf + 14, 2);
+          has_fmt = true;
+        }
+      else if ((memcmp(buf, "data", 4) == 0) && has_fmt)
+        {
+          fmt->dataOffset = ftell(fp);
+          fmt->dataSize   = size;
+          fclose(fp);
+          return true;
+        }
+
+      if (fseek(fp, next, SEEK_SET) != 0)
+        {
+          break;
+        }
+    }
+
+  print_err("ERROR: No data of %s.\n", path);
+  fclose(fp);
+  return false;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioSimWavWriter::open(const char *path, const AudioSimFormat &fmt)
+{
+  uint8_t hdr[44];
+  uint32_t block = fmt.channels * fmt.bits / 8;
+
+  close();
+
+  m_fp = fopen(path, "wb");
+  if (m_fp == NULL)
+    {
+      print_err("ERROR: Cannot open %s.\n", path);
+      return false;
+    }
+
+  memcpy(hdr, "RIFF", 4);
+  put_le(hdr + 4, 36, 4);
+  memcpy(hdr + 8, "WAVEfmt ", 8);
+  put_le(hdr + 16, 16, 4);
+  put_le(hdr + 20, 1, 2);
+  put_le(hdr + 22, fmt.channels, 2);
+  put_le(hdr + 24, fmt.rate, 4);
+  put_le(hdr + 28, fmt.rate * block, 4);
+  put_le(hdr + 32, block, 2);
+  put_le(hdr + 34, fmt.bits, 2);
+  memcpy(hdr + 36, "data", 4);
+  put_le(hdr + 40, 0, 4);
+
+  m_size = 0;
+  return fwrite(hdr, 1, sizeof(hdr), m_fp) == sizeof(hdr);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioSimWavWriter::write(const void *data, size_t size)
+{
+  if ((m_fp == NULL) || (fwrite(data, 1, size, m_fp) != size))
+    {
+      return false;
+    }
+
+  m_size += size;
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSimWavWriter::close()
+{
+  uint8_t buf[4];
+
+  if (m_fp == NULL)
+    {
+      return;
+    }
+
+  put_le(buf, 36 + m_size, 4);
+  fseek(m_fp, 4, SEEK_SET);
+  fwrite(buf, 1, 4, m_fp);
+
+  put_le(buf, m_size, 4);
+  fseek(m_fp, 40, SEEK_SET);
+  fwrite(buf, 1, 4, m_fp);
+
+  fclose(m_fp);
+  m_fp = NULL;
+}
+
+/****************************************************************************
+ * AudioSimDevice
+ ****************************************************************************/
+AudioSimDevice::AudioSimDevice()
+  : m_fifo(NULL)
+  , m_frame_samples(0)
+  , m_frame_size(0)
+  , m_frame(NULL)
+  , m_index(0)
+  , m_next_us(0)
+  , m_end(true)
+  , m_checked(false)
+{
+  memset(&m_fmt, 0, sizeof(m_fmt));
+  memset(&m_stat, 0, sizeof(m_stat));
+}
+
+/*--------------------------------------------------------------------------*/
+AudioSimDevice::~AudioSimDevice()
+{
+  free(m_frame);
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t AudioSimDevice::bytesToUs(uint32_t bytes)
+{
+  uint32_t block = m_fmt.channels * m_fmt.bits / 8;
+
+  if ((block == 0) || (m_fmt.rate == 0))
+    {
+      return 0;
+    }
+
+  return (uint32_t)((uint64_t)(bytes / block) * 1000000 / m_fmt.rate);
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSimDevice::getStat(AudioSimDeviceStat *stat)
+{
+  if (stat != NULL)
+    {
+      *stat = m_stat;
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioSimDevice::setup(CMN_SimpleFifoHandle *fifo,
+                           const AudioSimFormat &fmt,
+                           uint32_t frame_samples)
+{
+  if ((frame_samples == 0) || (fmt.rate == 0) ||
+      (fmt.channels == 0) || ((fmt.bits != 16) && (fmt.bits != 24) && (fmt.bits != 32)))
+    {
+      print_err("ERROR: Invalid parameter of device.\n");
+      return false;
+    }
+
+  free(m_frame);
+
+  m_fifo          = fifo;
+  m_fmt           = fmt;
+  m_frame_samples = frame_samples;
+  m_frame_size    = frame_samples * fmt.channels * fmt.bits / 8;
+  m_frame         = (uint8_t *)malloc(m_frame_size);
+  m_index         = 0;
+  m_end           = false;
+  m_checked       = false;
+  memset(&m_stat, 0, sizeof(m_stat));
+
+  if (m_frame == NULL)
+    {
+      print_err("ERROR: Fail to allocate memory.\n");
+      m_end = true;
+      return false;
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+uint64_t AudioSimDevice::frameTime(uint32_t index)
+{
+  /* From the sample count, so that the frames do not drift. */
+
+  return (uint64_t)index * m_frame_samples * 1000000 / m_fmt.rate;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSimDevice::checkLevel(uint32_t level)
+{
+  if (level > m_stat.maxFifoUsed)
+    {
+      m_stat.maxFifoUsed = level;
+    }
+
+  if (!m_checked || (level < m_stat.minFifoUsed))
+    {
+      m_stat.minFifoUsed = level;
+    }
+
+  m_checked = true;
+}
+
+/****************************************************************************
+ * AudioSimCapture
+ ****************************************************************************/
+AudioSimCapture::AudioSimCapture()
+  : m_fp(NULL)
+  , m_remain(0)
+  , m_loop(false)
+  , m_callback(NULL)
+{
+}
+
+/*--------------------------------------------------------------------------*/
+AudioSimCapture::~AudioSimCapture()
+{
+  end();
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioSimCapture::begin(CMN_SimpleFifoHandle *fifo,
+                            const char *path,
+                            uint32_t frame_samples,
+                            bool loop)
+{
+  AudioSimFormat fmt;
+
+  end();
+
+  if (!audiosim_read_wav(path, &fmt) || !setup(fifo, fmt, frame_samples))
+    {
+      return false;
+    }
+
+  m_fp = fopen(path, "rb");
+  if ((m_fp == NULL) || (fseek(m_fp, fmt.dataOffset, SEEK_SET) != 0))
+    {
+      print_err("ERROR: Cannot open %s.\n", path);
+      end();
+      return false;
+    }
+
+  m_remain  = fmt.dataSize;
+  m_loop    = loop;
+  m_next_us = frameTime(1);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSimCapture::end()
+{
+  if (m_fp != NULL)
+    {
+      fclose(m_fp);
+      m_fp = NULL;
+    }
+
+  m_end = true;
+}
+
+/*--------------------------------------------------------------------------*/
+size_t AudioSimCapture::readInput(uint8_t *buf, size_t size)
+{
+  size_t total = 0;
+
+  while (total < size)
+    {
+      if (m_remain == 0)
+        {
+          if (!m_loop || (fseek(m_fp, m_fmt.dataOffset, SEEK_SET) != 0))
+            {
+              break;
+            }
+          m_remain = m_fmt.dataSize;
+        }
+
+      size_t len = size - total;
+      if (len > m_remain)
+        {
+          len = m_remain;
+        }
+
+      size_t ret = fread(buf + total, 1, len, m_fp);
+      if (ret == 0)
+        {
+          m_remain = 0;
+          if (!m_loop)
+            {
+              break;
+            }
+          continue;
+        }
+
+      m_remain -= ret;
+      total += ret;
+    }
+
+  return total;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSimCapture::tick()
+{
+  size_t size = readInput(m_frame, m_frame_size);
+
+  if (size == 0)
+    {
+      end();
+      return;
+    }
+
+  /* The recorder drops the frame if the application is too late. */
+
+  if (CMN_SimpleFifoOffer(m_fifo, m_frame, size) == 0)
+    {
+      m_stat.overruns++;
+    }
+  else
+    {
+      m_stat.bytes += size;
+      if (m_callback != NULL)
+        {
+          m_callback(size);
+        }
+    }
+
+  checkLevel(CMN_SimpleFifoGetOccupiedSize(m_fifo));
+  m_stat.frames++;
+
+  if (size < m_frame_size)
+    {
+      end();
+      return;
+    }
+
+  m_index++;
+  m_next_us = frameTime(m_index + 1);
+}
+
+/****************************************************************************
+ * AudioSimRender
+ ****************************************************************************/
+AudioSimRender::AudioSimRender()
+  : m_started(false)
+  , m_eos(false)
+{
+}
+
+/*--------------------------------------------------------------------------*/
+AudioSimRender::~AudioSimRender()
+{
+  end();
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioSimRender::begin(CMN_SimpleFifoHandle *fifo,
+                           const char *path,
+                           const AudioSimFormat &fmt,
+                           uint32_t frame_samples)
+{
+  end();
+
+  if (!setup(fifo, fmt, frame_samples))
+    {
+      return false;
+    }
+
+  if (!m_writer.open(path, fmt))
+    {
+      m_end = true;
+      return false;
+    }
+
+  m_started = false;
+  m_eos     = false;
+  m_next_us = frameTime(0);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSimRender::end()
+{
+  m_writer.close();
+  m_end = true;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSimRender::tick()
+{
+  /* Check the end of stream before the level, not to lose the last data. */
+
+  bool eos = __atomic_load_n(&m_eos, __ATOMIC_ACQUIRE);
+  uint32_t level = CMN_SimpleFifoGetOccupiedSize(m_fifo);
+
+  if (m_started && !eos)
+    {
+      checkLevel(level);
+    }
+
+  if (level >= m_frame_size)
+    {
+      CMN_SimpleFifoPoll(m_fifo, m_frame, m_frame_size);
+      m_writer.write(m_frame, m_frame_size);
+      m_stat.bytes += m_frame_size;
+      m_started = true;
+    }
+  else if (eos)
+    {
+      if (level > 0)
+        {
+          CMN_SimpleFifoPoll(m_fifo, m_frame, level);
+          m_writer.write(m_frame, level);
+          m_stat.bytes += level;
+        }
+      end();
+      return;
+    }
+  else if (m_started)
+    {
+      /* The speaker outputs silence. Keep it in the file. */
+
+      memset(m_frame, 0, m_frame_size);
+      m_writer.write(m_frame, m_frame_size);
+      m_stat.underruns++;
+    }
+
+  m_stat.frames++;
+  m_index++;
+  m_next_us = frameTime(m_index);
+}
+
+/****************************************************************************
+ * AudioSim
+ ****************************************************************************/
+AudioSim::AudioSim()
+  : m_dev_num(0)
+  , m_speed(1.0)
+  , m_now(0)
+{
+  memset(&m_stat, 0, sizeof(m_stat));
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioSim::add(AudioSimDevice *dev)
+{
+  if ((dev == NULL) || (m_dev_num >= AUDIOSIM_DEVICE_NUM))
+    {
+      return false;
+    }
+
+  m_devs[m_dev_num++] = dev;
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSim::run(uint64_t duration_us, bool (*pump)(void *arg), void *arg)
+{
+  uint64_t start = wall_us();
+  uint64_t base = now();
+
+  memset(&m_stat, 0, sizeof(m_stat));
+
+  for (; ; )
+    {
+      AudioSimDevice *dev = NULL;
+
+      for (int i = 0; i < m_dev_num; i++)
+        {
+          if (!m_devs[i]->isEnd() &&
+              ((dev == NULL) || (m_devs[i]->m_next_us < dev->m_next_us)))
+            {
+              dev = m_devs[i];
+            }
+        }
+
+      if (dev == NULL)
+        {
+          break;
+        }
+
+      uint64_t t = (dev->m_next_us > base) ? dev->m_next_us : base;
+      if ((duration_us > 0) && (t > base + duration_us))
+        {
+          break;
+        }
+
+      if (m_speed > 0)
+        {
+          uint64_t deadline = start + (uint64_t)((t - base) / m_speed);
+          uint64_t cur = wall_us();
+
+          if (cur < deadline)
+            {
+              usleep(deadline - cur);
+            }
+          else if (cur - deadline > m_stat.maxLateUs)
+            {
+              m_stat.maxLateUs = cur - deadline;
+            }
+        }
+
+      __atomic_store_n(&m_now, t, __ATOMIC_RELEASE);
+      dev->tick();
+      m_stat.ticks++;
+
+      if ((pump != NULL) && !pump(arg))
+        {
+          break;
+        }
+    }
+
+  m_stat.virtualUs = now() - base;
+  m_stat.wallUs = wall_us() - start;
+}
@@ -0,0 +1,277 @@
+/*
+ *  AudioSim.h - Host-side simulator of the audio devices
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file AudioSim.h
+ * @brief Host-side simulator of the audio devices.
+ * @details Stand-ins of the microphone and the speaker on the SimpleFIFO
+ *          of a recorder or a player. The microphone puts frames read from
+ *          a WAV file into the FIFO, and the speaker takes frames from the
+ *          FIFO into a WAV file, at the frame timing of the sampling rate.
+ *          The time is virtual, so a run can be faster than real time.
+ */
+
+#ifndef AudioSim_h
+#define AudioSim_h
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memutils/simple_fifo/CMN_SimpleFifo.h>
+
+#define AUDIOSIM_DEVICE_NUM 4
+
+/**
+ * @brief Format of the PCM data
+ */
+typedef struct {
+  uint32_t rate;       /**< Sampling rate */
+  uint16_t channels;   /**< Number of channels */
+  uint16_t bits;       /**< Bit length, 16 or 32 */
+  uint32_t dataOffset; /**< Offset of the data chunk in the WAV file */
+  uint32_t dataSize;   /**< Bytes of the data chunk */
+} AudioSimFormat;
+
+/**
+ * @brief Statistics of a device
+ */
+typedef struct {
+  uint32_t frames;      /**< Frames put or taken */
+  uint64_t bytes;       /**< Bytes put into or taken from the FIFO */
+  uint32_t overruns;    /**< Microphone frames dropped because the FIFO was full */
+  uint32_t underruns;   /**< Speaker frames without data after the first data */
+  uint32_t maxFifoUsed; /**< Maximum bytes in the FIFO at a frame */
+  uint32_t minFifoUsed; /**< Minimum bytes in the FIFO at a frame after the first data, until the end of stream */
+} AudioSimDeviceStat;
+
+/**
+ * @brief Statistics of a run
+ */
+typedef struct {
+  uint64_t virtualUs; /**< Simulated time */
+  uint64_t wallUs;    /**< Host time */
+  uint32_t ticks;     /**< Frames of all devices */
+  uint32_t maxLateUs; /**< Longest delay of a frame behind its scaled deadline */
+} AudioSimStat;
+
+/**
+ * @brief Read the format and the data chunk of a WAV file.
+ */
+bool audiosim_read_wav(const char *path, AudioSimFormat *fmt);
+
+/**
+ * @class AudioSimWavWriter
+ * @brief WAV file writer. The sizes are patched by close().
+ */
+class AudioSimWavWriter
+{
+public:
+  AudioSimWavWriter() : m_fp(NULL), m_size(0) {}
+  ~AudioSimWavWriter() { close(); }
+
+  bool open(const char *path, const AudioSimFormat &fmt);
+  bool write(const void *data, size_t size);
+  void close();
+
+private:
+  FILE    *m_fp;
+  uint32_t m_size;
+};
+
+/**
+ * @class AudioSimDevice
+ * @brief A device driven by AudioSim at each frame
+ */
+class AudioSimDevice
+{
+public:
+  AudioSimDevice();
+  virtual ~AudioSimDevice();
+
+  /**
+   * @brief Bytes of a frame.
+   */
+  uint32_t frameSize() { return m_frame_size; }
+
+  /**
+   * @brief Time of the given bytes in microseconds.
+   */
+  uint32_t bytesToUs(uint32_t bytes);
+
+  bool isEnd() { return m_end; }
+  void getStat(AudioSimDeviceStat *stat);
+
+protected:
+  friend class AudioSim;
+
+  CMN_SimpleFifoHandle *m_fifo;
+  AudioSimFormat m_fmt;
+  uint32_t  m_frame_samples;
+  uint32_t  m_frame_size;
+  uint8_t  *m_frame;
+  uint32_t  m_index;
+  uint64_t  m_next_us;
+  bool      m_end;
+  bool      m_checked;
+
+  AudioSimDeviceStat m_stat;
+
+  /**
+   * @brief Set the format and allocate a frame. The FIFO is NULL for a
+   *        device which does not work on a SimpleFIFO.
+   */
+  bool setup(CMN_SimpleFifoHandle *fifo, const AudioSimFormat &fmt,
+             uint32_t frame_samples);
+  uint64_t frameTime(uint32_t index);
+  void checkLevel(uint32_t level);
+  virtual void tick() = 0;
+};
+
+/**
+ * @class AudioSimCapture
+ * @brief Microphone stand-in. Puts the frames of a WAV file into the FIFO
+ *        of a recorder.
+ *
+ * @details A frame is put at the end of its capture period. If the FIFO has
+ *          no room for it, the frame is dropped as the recorder does.
+ *          After each frame put, the callback is called with the size, as
+ *          the recorder calls output_device_callback().
+ */
+class AudioSimCapture : public AudioSimDevice
+{
+public:
+  AudioSimCapture();
+  ~AudioSimCapture();
+
+  bool begin(
+      CMN_SimpleFifoHandle *fifo, /**< FIFO of the recorder */
+      const char *path,           /**< WAV file as the microphone input */
+      uint32_t frame_samples,     /**< Samples of a frame, 768 for PCM capture */
+      bool loop = false           /**< Repeat the file */
+  );
+  void end();
+
+  /**
+   * @brief Get the format of the input file.
+   */
+  const AudioSimFormat &format() { return m_fmt; }
+
+  void setCallback(void (*callback)(uint32_t size)) { m_callback = callback; }
+
+protected:
+  void tick();
+
+  /**
+   * @brief Read the input file, from the top again if looped.
+   *
+   * @return Bytes read, less than the size at the end of the input.
+   */
+  size_t readInput(uint8_t *buf, size_t size);
+
+private:
+  FILE    *m_fp;
+  uint32_t m_remain;
+  bool     m_loop;
+  void   (*m_callback)(uint32_t size);
+};
+
+/**
+ * @class AudioSimRender
+ * @brief Speaker stand-in. Takes frames from the FIFO of a player into a
+ *        WAV file.
+ *
+ * @details A frame is taken at the start of its output period. If the FIFO
+ *          has not a whole frame, silence is written so that the file keeps
+ *          the timing, and an underrun is counted after the first data.
+ *          After setEos(), the rest of the FIFO is written and the device
+ *          ends, as AS_STOPPLAYER_ESEND does.
+ */
+class AudioSimRender : public AudioSimDevice
+{
+public:
+  AudioSimRender();
+  ~AudioSimRender();
+
+  bool begin(
+      CMN_SimpleFifoHandle *fifo, /**< FIFO of the player */
+      const char *path,           /**< WAV file as the speaker output */
+      const AudioSimFormat &fmt,  /**< Format of the data in the FIFO */
+      uint32_t frame_samples      /**< Samples of a frame */
+  );
+  void end();
+
+  void setEos() { __atomic_store_n(&m_eos, true, __ATOMIC_RELEASE); }
+
+protected:
+  void tick();
+
+private:
+  AudioSimWavWriter m_writer;
+  bool m_started;
+  bool m_eos;
+};
+
+/**
+ * @class AudioSim
+ * @brief Timeline of the devices
+ *
+ * @details Runs the frames of all devices in the order of their time.
+ *          With speed 1.0 the frames are in real time, with speed 10.0 ten
+ *          times faster. With speed 0 the frames run without waiting, and
+ *          the code under test runs only in the pump function, which is
+ *          called after each frame. Use a speed above 0 if the code under
+ *          test has its own threads, or step them from the pump function.
+ *
+ *          The devices count their frames from the time 0, so call begin()
+ *          of the devices before the first run().
+ */
+class AudioSim
+{
+public:
+  AudioSim();
+
+  void setSpeed(double speed) { m_speed = speed; }
+  bool add(AudioSimDevice *dev);
+
+  /**
+   * @brief Run until all devices end, the duration passes, or the pump
+   *        function returns false.
+   */
+  void run(
+      uint64_t duration_us,         /**< Simulated time, 0 for no limit */
+      bool (*pump)(void *arg) = NULL,
+      void *arg = NULL
+  );
+
+  /**
+   * @brief Simulated time in microseconds. Can be called from any thread.
+   */
+  uint64_t now() { return __atomic_load_n(&m_now, __ATOMIC_ACQUIRE); }
+
+  void getStat(AudioSimStat *stat) { *stat = m_stat; }
+
+private:
+  AudioSimDevice *m_devs[AUDIOSIM_DEVICE_NUM];
+  int          m_dev_num;
+  double       m_speed;
+  uint64_t     m_now;
+  AudioSimStat m_stat;
+};
+
+#endif // AudioSim_h
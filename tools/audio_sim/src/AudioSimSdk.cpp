@@ -0,0 +1,1734 @@
+/*
+ *  AudioSimSdk.cpp - Host stand-in of the audio objects of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+//***************************************************************************
+// Included Files
+//***************************************************************************
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arch/board/board.h>
+#include <arch/board/cxd56_audio.h>
+#include <audio/audio_high_level_api.h>
+#include <audio/audio_message_types.h>
+#include <memutils/message/Message.h>
+
+#include "MemoryUtil.h"
+
+#include "AudioSimSdk.h"
+
+#define print_err printf
+
+#define RESULT_QUEUE_NUM  8
+#define REPLY_QUEUE_NUM   4
+#define REPLY_NUM         8
+#define SPEAKER_QUEUE_NUM 16
+
+using namespace MemMgrLite;
+
+/****************************************************************************
+ * Devices
+ ****************************************************************************/
+
+/**
+ * @class AudioSimMic
+ * @brief Microphone of the MicFrontend. Puts each frame into a segment of
+ *        the input pool, and sends it to the destination of the MicFrontend.
+ */
+class AudioSimMic : public AudioSimCapture
+{
+public:
+  AudioSimMic() : m_sim(NULL), m_path(NULL), m_repeat(false), m_start_us(0) {}
+
+  void init(AudioSim *sim, const char *path, bool loop)
+  {
+    m_sim    = sim;
+    m_path   = path;
+    m_repeat = loop;
+  }
+
+  const char *path() { return m_path; }
+
+  bool start(uint32_t frame_samples);
+  void stop() { end(); }
+
+protected:
+  void tick();
+
+private:
+  AudioSim   *m_sim;
+  const char *m_path;
+  bool        m_repeat;
+  uint64_t    m_start_us;
+};
+
+/**
+ * @class AudioSimSpeaker
+ * @brief Renderer of the OutputMixer. Writes the frames into a WAV file in
+ *        the order of sending, one frame at a time.
+ */
+class AudioSimSpeaker : public AudioSimDevice
+{
+public:
+  AudioSimSpeaker();
+  ~AudioSimSpeaker();
+
+  void init(AudioSim *sim, const char *path)
+  {
+    m_sim  = sim;
+    m_path = path;
+  }
+
+  /**
+   * @brief Queue a frame. Can be called from any thread.
+   */
+  bool push(const AsSendDataOutputMixer &data);
+  void close();
+
+protected:
+  void tick();
+
+private:
+  AudioSim         *m_sim;
+  const char       *m_path;
+  AudioSimWavWriter m_writer;
+  pthread_mutex_t   m_lock;
+  bool              m_started;
+  uint64_t          m_start_us;
+  uint64_t          m_played;
+
+  AsSendDataOutputMixer m_queue[SPEAKER_QUEUE_NUM];
+  int      m_head;
+  int      m_num;
+  uint32_t m_queued;
+
+  AsSendDataOutputMixer m_playing;
+  bool     m_has_playing;
+
+  bool start(const AsPcmDataParam &pcm);
+};
+
+/****************************************************************************
+ * Objects
+ ****************************************************************************/
+
+typedef struct
+{
+  bool             created;
+  AudioAttentionCb attcb;
+  MsgQueId         mng;
+  PoolId           input;
+  bool             active;
+  MicFrontendCallback cb;
+  bool             inited;
+  uint8_t          ch;
+  uint8_t          bits;
+  uint32_t         samples;
+  uint8_t          data_path;
+  AsDataDest       dest;
+  bool             started;
+} FrontendState;
+
+typedef struct
+{
+  bool             created;
+  AudioAttentionCb attcb;
+  MsgQueId         mng;
+  bool             active;
+  MediaRecorderCallback cb;
+  AsRecorderOutputDeviceHdlr out;
+  bool             inited;
+  AsInitRecorderParam init;
+  bool             started;
+} RecorderState;
+
+typedef struct
+{
+  bool             created;
+  AudioAttentionCb attcb;
+  bool             active[OutputMixerHandleNum];
+  OutputMixerCallback cb[OutputMixerHandleNum];
+} MixerState;
+
+typedef struct
+{
+  MsgQueId      id;
+  AudioObjReply replies[REPLY_NUM];
+  int           head;
+  int           num;
+} ReplyQueue;
+
+static AudioSimMic s_mic;
+static AudioSimSpeaker s_speaker;
+
+static FrontendState s_fed;
+static RecorderState s_rec;
+static MixerState s_mix;
+static MsgQueId s_synth_mng;
+
+static bool s_mgr_created;
+static AudioAttentionCb s_mgr_attcb;
+static AudioResult s_results[RESULT_QUEUE_NUM];
+static int s_result_head;
+static int s_result_num;
+static ReplyQueue s_replies[REPLY_QUEUE_NUM];
+
+static cxd56_audio_state_t s_power = CXD56_AUDIO_POWER_STATE_OFF;
+static cxd56_audio_clkmode_t s_clkmode = CXD56_AUDIO_CLKMODE_NORMAL;
+static bool s_muted = true;
+
+/* Frames dropped on the way to the recorder FIFO, kept after the delete */
+
+static uint32_t s_rec_overruns;
+
+static uint32_t capture_rate()
+{
+  return (s_clkmode == CXD56_AUDIO_CLKMODE_HIRES) ?
+           AS_SAMPLINGRATE_192000 : AS_SAMPLINGRATE_48000;
+}
+
+static void attention(AudioAttentionCb attcb, uint8_t module_id,
+                      uint8_t code, unsigned long sub_code, int line)
+{
+  ErrorAttentionParam param;
+
+  /* An object created without a callback notifies the AudioManager. */
+
+  if (attcb == NULL)
+    {
+      attcb = s_mgr_attcb;
+    }
+
+  if (attcb == NULL)
+    {
+      return;
+    }
+
+  param.error_code         = code;
+  param.module_id          = module_id;
+  param.line_number        = line;
+  param.error_att_sub_code = sub_code;
+
+  attcb(&param);
+}
+
+/*--------------------------------------------------------------------------*/
+static void reply(MsgQueId id, uint32_t type, uint32_t module_id, uint32_t result)
+{
+  ReplyQueue *q = NULL;
+
+  for (int i = 0; i < REPLY_QUEUE_NUM; i++)
+    {
+      if ((s_replies[i].num > 0) && (s_replies[i].id == id))
+        {
+          q = &s_replies[i];
+          break;
+        }
+      if ((q == NULL) && (s_replies[i].num == 0))
+        {
+          q = &s_replies[i];
+        }
+    }
+
+  if ((q == NULL) || (q->num >= REPLY_NUM))
+    {
+      print_err("ERROR: Reply queue %d is full.\n", id);
+      return;
+    }
+
+  AudioObjReply *r = &q->replies[(q->head + q->num) % REPLY_NUM];
+
+  r->id        = type;
+  r->type      = type;
+  r->module_id = module_id;
+  r->result    = result;
+
+  q->id = id;
+  q->num++;
+}
+
+/****************************************************************************
+ * MicFrontend
+ ****************************************************************************/
+static void fed_done(AsMicFrontendEvent event, uint32_t result)
+{
+  /* With a callback, the result goes to it instead of the reply queue. */
+
+  if (s_fed.cb != NULL)
+    {
+      s_fed.cb(event, result, 0);
+    }
+  else
+    {
+      reply(s_fed.mng, event, AS_MODULE_ID_MIC_FRONTEND, result);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t fed_activate(MicFrontendCallback cb)
+{
+  if (!s_fed.created || s_fed.active)
+    {
+      return AS_ECODE_STATE_VIOLATION;
+    }
+
+  s_fed.active = true;
+  s_fed.cb     = cb;
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t fed_init(uint8_t ch, uint8_t bits, uint32_t samples,
+                         uint8_t preproc_type, uint8_t data_path,
+                         AsDataDest dest)
+{
+  if (!s_fed.active || s_fed.started)
+    {
+      return AS_ECODE_STATE_VIOLATION;
+    }
+
+  if ((ch == 0) || (ch > AS_MIC_CHANNEL_MAX))
+    {
+      return AS_ECODE_COMMAND_PARAM_CHANNEL_NUMBER;
+    }
+
+  if ((bits != AS_BITLENGTH_16) && (bits != AS_BITLENGTH_24))
+    {
+      return AS_ECODE_COMMAND_PARAM_BIT_LENGTH;
+    }
+
+  /* The pre-process DSP is not simulated. */
+
+  if (preproc_type != AsMicFrontendPreProcThrough)
+    {
+      print_err("ERROR: Pre-process %d of MicFrontend is not simulated.\n", preproc_type);
+      return AS_ECODE_COMMAND_NOT_SUPPOT;
+    }
+
+  s_fed.inited    = true;
+  s_fed.ch        = ch;
+  s_fed.bits      = bits;
+  s_fed.samples   = samples;
+  s_fed.data_path = data_path;
+  s_fed.dest      = dest;
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t fed_start()
+{
+  AudioSimFormat fmt;
+
+  if (!s_fed.inited || s_fed.started)
+    {
+      return AS_ECODE_STATE_VIOLATION;
+    }
+
+  if ((s_mic.path() == NULL) || !audiosim_read_wav(s_mic.path(), &fmt))
+    {
+      print_err("ERROR: No microphone input.\n");
+      return AS_ECODE_COMMAND_PARAM_INPUT_DEVICE;
+    }
+
+  /* The input is taken as captured, so it must be in the capture format.
+   * 24bit is in 4 bytes on the capture.
+   */
+
+  if (fmt.channels != s_fed.ch)
+    {
+      print_err("ERROR: Microphone input has %d channels for %d.\n",
+                fmt.channels, s_fed.ch);
+      return AS_ECODE_COMMAND_PARAM_CHANNEL_NUMBER;
+    }
+
+  if (fmt.bits != ((s_fed.bits == AS_BITLENGTH_16) ? 16 : 32))
+    {
+      print_err("ERROR: Microphone input is %dbit for %dbit.\n", fmt.bits, s_fed.bits);
+      return AS_ECODE_COMMAND_PARAM_BIT_LENGTH;
+    }
+
+  if (fmt.rate != capture_rate())
+    {
+      print_err("ERROR: Microphone input is %luHz for %luHz.\n",
+                (unsigned long)fmt.rate, (unsigned long)capture_rate());
+      return AS_ECODE_COMMAND_PARAM_SAMPLING_RATE;
+    }
+
+  if (!s_mic.start(s_fed.samples))
+    {
+      return AS_ECODE_COMMAND_PARAM_INPUT_DEVICE;
+    }
+
+  s_fed.started = true;
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t fed_stop()
+{
+  if (!s_fed.started)
+    {
+      return AS_ECODE_STATE_VIOLATION;
+    }
+
+  s_mic.stop();
+  s_fed.started = false;
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t fed_deactivate()
+{
+  if (!s_fed.active || s_fed.started)
+    {
+      return AS_ECODE_STATE_VIOLATION;
+    }
+
+  s_fed.active = false;
+  s_fed.inited = false;
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_CreateMicFrontend(AsCreateMicFrontendParams_t *param, AudioAttentionCb attcb)
+{
+  if ((param == NULL) || s_fed.created)
+    {
+      return false;
+    }
+
+  memset(&s_fed, 0, sizeof(s_fed));
+  s_fed.created = true;
+  s_fed.attcb   = attcb;
+  s_fed.mng     = param->msgq_id.mng;
+  s_fed.input   = param->pool_id.input;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_ActivateMicFrontend(AsActivateMicFrontend *actparam)
+{
+  MicFrontendCallback cb = (actparam != NULL) ? actparam->cb : NULL;
+  uint32_t result = fed_activate(cb);
+
+  if (result != AS_ECODE_OK)
+    {
+      /* The callback is not taken on an error. */
+
+      reply(s_fed.mng, AsMicFrontendEventAct, AS_MODULE_ID_MIC_FRONTEND, result);
+      return true;
+    }
+
+  fed_done(AsMicFrontendEventAct, result);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_InitMicFrontend(AsInitMicFrontendParam *initparam)
+{
+  if (initparam == NULL)
+    {
+      return false;
+    }
+
+  fed_done(AsMicFrontendEventInit,
+           fed_init(initparam->channel_number, initparam->bit_length,
+                    initparam->samples_per_frame, initparam->preproc_type,
+                    initparam->data_path, initparam->dest));
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_StartMicFrontend(AsStartMicFrontendParam *startparam)
+{
+  fed_done(AsMicFrontendEventStart, fed_start());
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_StopMicFrontend(AsStopMicFrontendParam *stopparam)
+{
+  fed_done(AsMicFrontendEventStop, fed_stop());
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_InitPreprocFrontend(AsInitPreProcParam *param)
+{
+  fed_done(AsMicFrontendEventInitPreProc, AS_ECODE_COMMAND_NOT_SUPPOT);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_SetPreprocMicFrontend(AsSetPreProcParam *param)
+{
+  fed_done(AsMicFrontendEventSetPreProc, AS_ECODE_COMMAND_NOT_SUPPOT);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_SetMicGainMicFrontend(AsMicFrontendMicGainParam *micgain_param)
+{
+  /* The input is taken as captured, with the gain. */
+
+  fed_done(AsMicFrontendEventSetMicGain,
+           s_fed.active ? AS_ECODE_OK : AS_ECODE_STATE_VIOLATION);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeactivateMicFrontend(AsDeactivateMicFrontendParam *deactparam)
+{
+  MicFrontendCallback cb = s_fed.cb;
+  uint32_t result = fed_deactivate();
+
+  if (cb != NULL)
+    {
+      cb(AsMicFrontendEventDeact, result, 0);
+    }
+  else
+    {
+      reply(s_fed.mng, AsMicFrontendEventDeact, AS_MODULE_ID_MIC_FRONTEND, result);
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeleteMicFrontend(void)
+{
+  if (!s_fed.created)
+    {
+      return false;
+    }
+
+  s_mic.stop();
+  memset(&s_fed, 0, sizeof(s_fed));
+
+  return true;
+}
+
+/****************************************************************************
+ * MediaRecorder
+ ****************************************************************************/
+static void rec_done(AsRecorderEvent event, uint32_t result)
+{
+  if (s_rec.cb != NULL)
+    {
+      s_rec.cb(event, result, 0);
+    }
+  else
+    {
+      reply(s_rec.mng, event, AS_MODULE_ID_MEDIA_RECORDER, result);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t rec_activate(uint8_t input_device, AsRecorderOutputDeviceHdlr *out)
+{
+  if (!s_rec.created || s_rec.active)
+    {
+      return AS_ECODE_STATE_VIOLATION;
+    }
+
+  if (((input_device != AS_SETRECDR_STS_INPUTDEVICE_MIC) &&
+       (input_device != AS_SETRECDR_STS_INPUTDEVICE_I2S)) ||
+      (out == NULL) || (out->simple_fifo_handler == NULL))
+    {
+      return AS_ECODE_COMMAND_PARAM_INPUT_DEVICE;
+    }
+
+  s_rec.active = true;
+  s_rec.out    = *out;
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t rec_init(const AsInitRecorderParam *param)
+{
+  if (!s_rec.active || s_rec.started)
+    {
+      return AS_ECODE_STATE_VIOLATION;
+    }
+
+  /* No encoder and no sampling rate converter */
+
+  if ((param->codec_type != AS_CODECTYPE_LPCM) && (param->codec_type != AS_CODECTYPE_WAV))
+    {
+      print_err("ERROR: Codec %d of MediaRecorder is not simulated.\n", param->codec_type);
+      return AS_ECODE_COMMAND_PARAM_CODEC_TYPE;
+    }
+
+  if (param->sampling_rate != capture_rate())
+    {
+      print_err("ERROR: Recording at %luHz is not simulated.\n",
+                (unsigned long)param->sampling_rate);
+      return AS_ECODE_COMMAND_PARAM_SAMPLING_RATE;
+    }
+
+  s_rec.inited = true;
+  s_rec.init   = *param;
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t rec_start()
+{
+  if (!s_rec.inited || s_rec.started)
+    {
+      return AS_ECODE_STATE_VIOLATION;
+    }
+
+  /* The frames are recorded as they come from the MicFrontend. */
+
+  if (s_fed.inited && (s_rec.init.channel_number != s_fed.ch))
+    {
+      return AS_ECODE_COMMAND_PARAM_CHANNEL_NUMBER;
+    }
+
+  if (s_fed.inited && (s_rec.init.bit_length != s_fed.bits))
+    {
+      return AS_ECODE_COMMAND_PARAM_BIT_LENGTH;
+    }
+
+  s_rec.started = true;
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t rec_stop()
+{
+  if (!s_rec.started)
+    {
+      return AS_ECODE_STATE_VIOLATION;
+    }
+
+  s_rec.started = false;
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t rec_deactivate()
+{
+  if (!s_rec.active || s_rec.started)
+    {
+      return AS_ECODE_STATE_VIOLATION;
+    }
+
+  s_rec.active = false;
+  s_rec.inited = false;
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+static void rec_encode(const AsPcmDataParam &pcm)
+{
+  CMN_SimpleFifoHandle *fifo = (CMN_SimpleFifoHandle *)s_rec.out.simple_fifo_handler;
+
+  if (!s_rec.started || !pcm.is_valid || (pcm.size == 0))
+    {
+      return;
+    }
+
+  /* LPCM is put into the FIFO as it is. If the application is too late,
+   * the frame is lost with an attention.
+   */
+
+  if (CMN_SimpleFifoOffer(fifo, pcm.mh.getPa(), pcm.size) == 0)
+    {
+      s_rec_overruns++;
+      attention(s_rec.attcb, AS_MODULE_ID_MEDIA_RECORDER, AS_ATTENTION_CODE_WARNING,
+                AS_ATTENTION_SUB_CODE_SIMPLE_FIFO_OVERFLOW, __LINE__);
+      return;
+    }
+
+  if (s_rec.out.callback_function != NULL)
+    {
+      s_rec.out.callback_function(pcm.size);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_CreateMediaRecorder(AsCreateRecorderParams_t *param, AudioAttentionCb attcb)
+{
+  if ((param == NULL) || s_rec.created)
+    {
+      return false;
+    }
+
+  memset(&s_rec, 0, sizeof(s_rec));
+  s_rec.created = true;
+  s_rec.attcb   = attcb;
+  s_rec.mng     = param->msgq_id.mng;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_ActivateMediaRecorder(AsActivateRecorder *actparam)
+{
+  if (actparam == NULL)
+    {
+      return false;
+    }
+
+  uint32_t result = rec_activate(actparam->param.input_device,
+                                 actparam->param.output_device_handler);
+  if (result == AS_ECODE_OK)
+    {
+      s_rec.cb = actparam->cb;
+    }
+
+  rec_done(AsRecorderEventAct, result);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_InitMediaRecorder(AsInitRecorderParam *initparam)
+{
+  if (initparam == NULL)
+    {
+      return false;
+    }
+
+  rec_done(AsRecorderEventInit, rec_init(initparam));
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_StartMediaRecorder(void)
+{
+  rec_done(AsRecorderEventStart, rec_start());
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_StopMediaRecorder(void)
+{
+  rec_done(AsRecorderEventStop, rec_stop());
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeactivateMediaRecorder(void)
+{
+  MediaRecorderCallback cb = s_rec.cb;
+  uint32_t result = rec_deactivate();
+
+  if (cb != NULL)
+    {
+      cb(AsRecorderEventDeact, result, 0);
+    }
+  else
+    {
+      reply(s_rec.mng, AsRecorderEventDeact, AS_MODULE_ID_MEDIA_RECORDER, result);
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeleteMediaRecorder(void)
+{
+  if (!s_rec.created)
+    {
+      return false;
+    }
+
+  memset(&s_rec, 0, sizeof(s_rec));
+
+  return true;
+}
+
+/****************************************************************************
+ * OutputMixer and Renderer
+ ****************************************************************************/
+bool AS_CreateOutputMixer(AsCreateOutputMixParams_t *param, AudioAttentionCb attcb)
+{
+  if ((param == NULL) || s_mix.created)
+    {
+      return false;
+    }
+
+  memset(&s_mix, 0, sizeof(s_mix));
+  s_mix.created = true;
+  s_mix.attcb   = attcb;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_ActivateOutputMixer(uint8_t handle, AsActivateOutputMixer *actparam)
+{
+  if (!s_mix.created || (handle >= OutputMixerHandleNum) || (actparam == NULL))
+    {
+      return false;
+    }
+
+  s_mix.active[handle] = true;
+  s_mix.cb[handle]     = actparam->cb;
+
+  if (actparam->cb != NULL)
+    {
+      AsOutputMixDoneParam done = { handle, true };
+      actparam->cb(MSGQ_AUD_MGR, MSG_AUD_MIX_CMD_ACT, &done);
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_SendDataOutputMixer(AsSendDataOutputMixer *sendparam)
+{
+  if ((sendparam == NULL) || (sendparam->handle >= OutputMixerHandleNum) ||
+      !s_mix.active[sendparam->handle])
+    {
+      print_err("ERROR: OutputMixer is not active.\n");
+      return false;
+    }
+
+  return s_speaker.push(*sendparam);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_InitPostprocOutputMixer(uint8_t handle, AsInitPostProc *initppparam)
+{
+  /* The post-process DSP is not simulated. */
+
+  return false;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_SetPostprocOutputMixer(uint8_t handle, AsSetPostProc *setppparam)
+{
+  return false;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeactivateOutputMixer(uint8_t handle, AsDeactivateOutputMixer *deactparam)
+{
+  if (!s_mix.created || (handle >= OutputMixerHandleNum))
+    {
+      return false;
+    }
+
+  OutputMixerCallback cb = s_mix.cb[handle];
+
+  s_mix.active[handle] = false;
+  s_mix.cb[handle]     = NULL;
+
+  if (cb != NULL)
+    {
+      AsOutputMixDoneParam done = { handle, true };
+      cb(MSGQ_AUD_MGR, MSG_AUD_MIX_CMD_DEACT, &done);
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeleteOutputMix(void)
+{
+  if (!s_mix.created)
+    {
+      return false;
+    }
+
+  memset(&s_mix, 0, sizeof(s_mix));
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_CreateRenderer(AsCreateRendererParam_t *param)
+{
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeleteRenderer(void)
+{
+  return true;
+}
+
+/****************************************************************************
+ * Messages between the objects
+ ****************************************************************************/
+template<>
+err_t MsgLib::send<AsPcmDataParam>(MsgQueId dest,
+                                   MsgPri pri,
+                                   MsgType type,
+                                   MsgQueId reply,
+                                   const AsPcmDataParam &param)
+{
+  if (!isInitComplete())
+    {
+      return ERR_STS;
+    }
+
+  switch (dest)
+    {
+      case MSGQ_AUD_RECORDER:
+        rec_encode(param);
+        break;
+
+      case MSGQ_AUD_OUTPUT_MIX:
+        {
+          AsSendDataOutputMixer data;
+
+          data.handle   = OutputMixer0;
+          data.callback = NULL;
+          data.pcm      = param;
+
+          if (!s_mix.active[OutputMixer0] || !s_speaker.push(data))
+            {
+              return ERR_STS;
+            }
+        }
+        break;
+
+      default:
+
+        /* No object is simulated on the queue. The frame is freed. */
+
+        break;
+    }
+
+  return ERR_OK;
+}
+
+/****************************************************************************
+ * Objects not simulated
+ ****************************************************************************/
+bool AS_CreatePlayerMulti(uint8_t player_id, AsCreatePlayerParams_t *param, AudioAttentionCb attcb)
+{
+  /* Created, so that AudioClass::begin() works. It cannot be used. */
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeletePlayer(uint8_t player_id)
+{
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_CreateCapture(AsCreateCaptureParam_t *param)
+{
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeleteCapture(void)
+{
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_CreateRecognizer(AsCreateRecognizerParam_t *param, AudioAttentionCb attcb)
+{
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeleteRecognizer(void)
+{
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_CreateMediaSynthesizer(AsCreateSynthesizerParam_t *param, AudioAttentionCb attcb)
+{
+  if (param == NULL)
+    {
+      return false;
+    }
+
+  s_synth_mng = param->msgq_id.mng;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+static bool synth_not_supported(AsSynthesizerEvent event)
+{
+  reply(s_synth_mng, event, AS_MODULE_ID_AUDIO_MANAGER, AS_ECODE_COMMAND_NOT_SUPPOT);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_ActivateMediaSynthesizer(AsActivateSynthesizer *actparam)
+{
+  return synth_not_supported(AsSynthesizerEventActivate);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_InitMediaSynthesizer(AsInitSynthesizerParam *initparam)
+{
+  return synth_not_supported(AsSynthesizerEventInit);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_StartMediaSynthesizer(void)
+{
+  return synth_not_supported(AsSynthesizerEventStart);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_StopMediaSynthesizer(void)
+{
+  return synth_not_supported(AsSynthesizerEventStop);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_SetMediaSynthesizer(AsSetSynthesizer *setparam)
+{
+  return synth_not_supported(AsSynthesizerEventSet);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_DeleteMediaSynthesizer(void)
+{
+  return true;
+}
+
+/****************************************************************************
+ * AudioManager
+ ****************************************************************************/
+int AS_CreateAudioManager(AudioSubSystemIDs ids, AudioAttentionCb att_cb)
+{
+  s_mgr_created = true;
+  s_mgr_attcb   = att_cb;
+  s_result_num  = 0;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+int AS_DeleteAudioManager(void)
+{
+  s_mgr_created = false;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t mgr_set_ready()
+{
+  /* Leave the recorder mode */
+
+  if (s_fed.started)
+    {
+      fed_stop();
+    }
+
+  if (s_rec.started)
+    {
+      rec_stop();
+    }
+
+  if (s_fed.active)
+    {
+      fed_deactivate();
+    }
+
+  if (s_rec.active)
+    {
+      rec_deactivate();
+    }
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t mgr_set_recorder(const SetRecorderStsParam &param)
+{
+  uint32_t result = fed_activate(NULL);
+
+  if (result != AS_ECODE_OK)
+    {
+      return result;
+    }
+
+  result = rec_activate(param.input_device, param.output_device_handler);
+  if (result != AS_ECODE_OK)
+    {
+      fed_deactivate();
+    }
+
+  return result;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t mgr_init_micfrontend(const InitMicFrontendParam &param)
+{
+  AsDataDest dest;
+
+  if (param.data_dest == AsMicFrontendDataToRecorder)
+    {
+      dest.msg.msgqid  = MSGQ_AUD_RECORDER;
+      dest.msg.msgtype = MSG_AUD_MRC_CMD_ENCODE;
+    }
+  else
+    {
+      dest.msg.msgqid  = MSGQ_AUD_RECOGNIZER;
+      dest.msg.msgtype = MSG_AUD_RCG_EXEC;
+    }
+
+  return fed_init(param.ch_num, param.bit_length, param.samples,
+                  param.preproc_type, AsDataPathMessage, dest);
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t mgr_start_rec()
+{
+  uint32_t result = rec_start();
+
+  if (result != AS_ECODE_OK)
+    {
+      return result;
+    }
+
+  result = fed_start();
+  if (result != AS_ECODE_OK)
+    {
+      rec_stop();
+    }
+
+  return result;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t mgr_stop_rec()
+{
+  uint32_t result = fed_stop();
+
+  if (result != AS_ECODE_OK)
+    {
+      return result;
+    }
+
+  return rec_stop();
+}
+
+/*--------------------------------------------------------------------------*/
+int AS_SendAudioCommand(AudioCommand *packet)
+{
+  uint32_t result = AS_ECODE_OK;
+  uint8_t code = packet->header.command_code;
+
+  if (!s_mgr_created)
+    {
+      return AS_ERR_CODE_OK;
+    }
+
+  switch (code)
+    {
+      case AUDCMD_POWERON:
+        cxd56_audio_poweron();
+        break;
+
+      case AUDCMD_SETPOWEROFFSTATUS:
+        mgr_set_ready();
+        cxd56_audio_poweroff();
+        break;
+
+      case AUDCMD_SETREADYSTATUS:
+        result = mgr_set_ready();
+        break;
+
+      case AUDCMD_SETRECORDERSTATUS:
+        result = mgr_set_recorder(packet->set_recorder_status_param);
+        break;
+
+      case AUDCMD_INIT_MICFRONTEND:
+        result = mgr_init_micfrontend(packet->init_micfrontend_param);
+        break;
+
+      case AUDCMD_INITREC:
+        result = rec_init(&packet->recorder.init_param);
+        break;
+
+      case AUDCMD_STARTREC:
+        result = mgr_start_rec();
+        break;
+
+      case AUDCMD_STOPREC:
+        result = mgr_stop_rec();
+        break;
+
+      case AUDCMD_SETRENDERINGCLK:
+        cxd56_audio_set_clkmode((packet->set_renderingclk_param.clk_mode == AS_CLKMODE_HIRES) ?
+                                CXD56_AUDIO_CLKMODE_HIRES : CXD56_AUDIO_CLKMODE_NORMAL);
+        break;
+
+      /* Settings of the baseband, which is not simulated */
+
+      case AUDCMD_SETTHROUGHSTATUS:
+      case AUDCMD_INITMICGAIN:
+      case AUDCMD_INITOUTPUTSELECT:
+      case AUDCMD_SETVOLUME:
+      case AUDCMD_SETBEEPPARAM:
+      case AUDCMD_SETTHROUGHPATH:
+      case AUDCMD_SETMICMAP:
+      case AUDCMD_SETSPDRVMODE:
+        break;
+
+      /* The players, the recognizer and the DSP are not simulated. */
+
+      default:
+        print_err("ERROR: Command 0x%x is not simulated.\n", code);
+        result = AS_ECODE_COMMAND_NOT_SUPPOT;
+        break;
+    }
+
+  if (s_result_num >= RESULT_QUEUE_NUM)
+    {
+      print_err("ERROR: Result queue is full.\n");
+      return AS_ERR_CODE_OK;
+    }
+
+  AudioResult *r = &s_results[(s_result_head + s_result_num) % RESULT_QUEUE_NUM];
+
+  memset(r, 0, sizeof(*r));
+  r->header.packet_length = 2;
+  r->header.sub_code      = packet->header.sub_code;
+
+  if (result != AS_ECODE_OK)
+    {
+      r->header.result_code = AUDRLT_ERRORRESPONSE;
+      r->error_response_param.module_id  = AS_MODULE_ID_AUDIO_MANAGER;
+      r->error_response_param.error_code = result;
+    }
+  else if ((code >= AUDCMD_POWERON) && (code <= AUDCMD_SETRECOGNIZERSTATUS))
+    {
+      r->header.result_code = AUDRLT_STATUSCHANGED;
+    }
+  else
+    {
+      /* The result code of a command is the command code with 0x80. */
+
+      r->header.result_code = code | 0x80;
+    }
+
+  s_result_num++;
+
+  return AS_ERR_CODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+int AS_ReceiveAudioResult(AudioResult *packet)
+{
+  if (s_result_num == 0)
+    {
+      memset(packet, 0, sizeof(*packet));
+      packet->header.result_code = AUDRLT_ERRORRESPONSE;
+      packet->error_response_param.error_code = AS_ECODE_STATE_VIOLATION;
+      return AS_ERR_CODE_TIMEOUT;
+    }
+
+  *packet = s_results[s_result_head];
+  s_result_head = (s_result_head + 1) % RESULT_QUEUE_NUM;
+  s_result_num--;
+
+  return AS_ERR_CODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+int AS_ReceiveAudioResult(AudioResult *packet, uint8_t id, uint32_t timeout)
+{
+  /* The command is done already, so there is no wait. */
+
+  return AS_ReceiveAudioResult(packet);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_ReceiveObjectReply(MsgQueId msgq_id, AudioObjReply *reply)
+{
+  for (int i = 0; i < REPLY_QUEUE_NUM; i++)
+    {
+      ReplyQueue *q = &s_replies[i];
+
+      if ((q->num > 0) && (q->id == msgq_id))
+        {
+          *reply = q->replies[q->head];
+          q->head = (q->head + 1) % REPLY_NUM;
+          q->num--;
+          return true;
+        }
+    }
+
+  /* On the board, this waits forever. */
+
+  print_err("ERROR: No reply on queue %d.\n", msgq_id);
+  memset(reply, 0, sizeof(*reply));
+  reply->result = AS_ECODE_STATE_VIOLATION;
+
+  return false;
+}
+
+/****************************************************************************
+ * Baseband
+ ****************************************************************************/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_poweron(void)
+{
+  s_power = CXD56_AUDIO_POWER_STATE_ON;
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_poweroff(void)
+{
+  s_power = CXD56_AUDIO_POWER_STATE_OFF;
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" cxd56_audio_state_t cxd56_audio_get_status(void)
+{
+  return s_power;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_en_input(void)
+{
+  return (s_power == CXD56_AUDIO_POWER_STATE_ON) ?
+           CXD56_AUDIO_ECODE_OK : CXD56_AUDIO_ECODE_POW_STATE;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_dis_input(void)
+{
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_en_output(void)
+{
+  return (s_power == CXD56_AUDIO_POWER_STATE_ON) ?
+           CXD56_AUDIO_ECODE_OK : CXD56_AUDIO_ECODE_POW_STATE;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_dis_output(void)
+{
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_set_spout(bool sp_out)
+{
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_set_vol(cxd56_audio_volid_t id, int16_t vol)
+{
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_set_micgain(cxd56_audio_mic_gain_t *gain)
+{
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_set_micmap(uint32_t map)
+{
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_set_clkmode(cxd56_audio_clkmode_t mode)
+{
+  /* The clock cannot change while the devices run. */
+
+  if (s_fed.started || !s_speaker.isEnd())
+    {
+      return CXD56_AUDIO_ECODE_POW_STATE;
+    }
+
+  s_clkmode = mode;
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" cxd56_audio_clkmode_t cxd56_audio_get_clkmode(void)
+{
+  return s_clkmode;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_set_datapath(cxd56_audio_signal_t sig,
+                                                      cxd56_audio_sel_t sel)
+{
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" CXD56_AUDIO_ECODE cxd56_audio_en_i2s_io(void)
+{
+  return CXD56_AUDIO_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" int board_external_amp_mute_control(bool en)
+{
+  /* The speaker is silent while the amplifier is muted. */
+
+  __atomic_store_n(&s_muted, en, __ATOMIC_RELEASE);
+  return 0;
+}
+
+/****************************************************************************
+ * AudioSimMic
+ ****************************************************************************/
+bool AudioSimMic::start(uint32_t frame_samples)
+{
+  if (!begin(NULL, m_path, frame_samples, m_repeat))
+    {
+      return false;
+    }
+
+  /* The frames are counted from the start of the capture. */
+
+  m_start_us = m_sim->now();
+  m_next_us  = m_start_us + frameTime(1);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSimMic::tick()
+{
+  size_t size = readInput(m_frame, m_frame_size);
+
+  if (size == 0)
+    {
+      end();
+      return;
+    }
+
+  AsPcmDataParam pcm;
+
+  if (pcm.mh.allocSeg(s_fed.input, size) != ERR_OK)
+    {
+      /* The capture has no buffer for the frame. */
+
+      m_stat.overruns++;
+      attention(s_fed.attcb, AS_MODULE_ID_MIC_FRONTEND, AS_ATTENTION_CODE_WARNING,
+                AS_ATTENTION_SUB_CODE_MEMHANDLE_ALLOC_ERROR, __LINE__);
+    }
+  else
+    {
+      memcpy(pcm.mh.getPa(), m_frame, size);
+
+      pcm.identifier = 0;
+      pcm.callback   = NULL;
+      pcm.sample     = size / (m_fmt.channels * m_fmt.bits / 8);
+      pcm.size       = size;
+      pcm.is_end     = false;
+      pcm.is_valid   = true;
+      pcm.bit_length = s_fed.bits;
+
+      if (s_fed.data_path == AsDataPathCallback)
+        {
+          s_fed.dest.cb(pcm);
+        }
+      else
+        {
+          MsgLib::send<AsPcmDataParam>(s_fed.dest.msg.msgqid, MsgPriNormal,
+                                       s_fed.dest.msg.msgtype, MSGQ_AUD_FRONTEND,
+                                       pcm);
+        }
+
+      m_stat.bytes += size;
+    }
+
+  if (s_rec.started)
+    {
+      checkLevel(CMN_SimpleFifoGetOccupiedSize(
+                   (CMN_SimpleFifoHandle *)s_rec.out.simple_fifo_handler));
+    }
+
+  m_stat.frames++;
+
+  if (size < m_frame_size)
+    {
+      end();
+      return;
+    }
+
+  m_index++;
+  m_next_us = m_start_us + frameTime(m_index + 1);
+}
+
+/****************************************************************************
+ * AudioSimSpeaker
+ ****************************************************************************/
+AudioSimSpeaker::AudioSimSpeaker()
+  : m_sim(NULL)
+  , m_path(NULL)
+  , m_started(false)
+  , m_start_us(0)
+  , m_played(0)
+  , m_head(0)
+  , m_num(0)
+  , m_queued(0)
+  , m_has_playing(false)
+{
+  pthread_mutex_init(&m_lock, NULL);
+}
+
+/*--------------------------------------------------------------------------*/
+AudioSimSpeaker::~AudioSimSpeaker()
+{
+  close();
+  pthread_mutex_destroy(&m_lock);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioSimSpeaker::start(const AsPcmDataParam &pcm)
+{
+  AudioSimFormat fmt;
+  uint32_t bytes = (pcm.bit_length == AS_BITLENGTH_16) ? 2 : 4;
+
+  memset(&fmt, 0, sizeof(fmt));
+
+  /* The renderer runs at the clock. 24bit is in 4 bytes. */
+
+  fmt.rate     = capture_rate();
+  fmt.bits     = bytes * 8;
+  fmt.channels = (pcm.sample > 0) ? pcm.size / (pcm.sample * bytes) : 0;
+
+  if ((m_path == NULL) || (fmt.channels == 0) ||
+      (pcm.size != pcm.sample * fmt.channels * bytes))
+    {
+      print_err("ERROR: Speaker cannot render the frame.\n");
+      return false;
+    }
+
+  if (!setup(NULL, fmt, pcm.sample) || !m_writer.open(m_path, fmt))
+    {
+      m_end = true;
+      return false;
+    }
+
+  m_started  = true;
+  m_played   = 0;
+  m_start_us = m_sim->now();
+  m_next_us  = m_start_us;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioSimSpeaker::push(const AsSendDataOutputMixer &data)
+{
+  bool ret = false;
+
+  pthread_mutex_lock(&m_lock);
+
+  /* The renderer starts with the first frame, once for a run. */
+
+  if (!m_started && !start(data.pcm))
+    {
+      pthread_mutex_unlock(&m_lock);
+      return false;
+    }
+
+  if (m_end)
+    {
+      print_err("ERROR: Speaker has ended.\n");
+    }
+  else if (m_num >= SPEAKER_QUEUE_NUM)
+    {
+      print_err("ERROR: Speaker queue is full.\n");
+    }
+  else
+    {
+      m_queue[(m_head + m_num) % SPEAKER_QUEUE_NUM] = data;
+      m_num++;
+      m_queued += data.pcm.size;
+      ret = true;
+    }
+
+  pthread_mutex_unlock(&m_lock);
+
+  return ret;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSimSpeaker::close()
+{
+  m_writer.close();
+  m_end = true;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioSimSpeaker::tick()
+{
+  /* The frame rendered in the last period is done. The callback is called
+   * without the lock, as it can send the next frame.
+   */
+
+  if (m_has_playing)
+    {
+      PcmProcDoneCallback callback = m_playing.callback;
+      int32_t identifier = m_playing.pcm.identifier;
+      bool is_end = m_playing.pcm.is_end;
+
+      m_playing.pcm.mh.freeSeg();
+      m_has_playing = false;
+
+      if (callback != NULL)
+        {
+          callback(identifier, is_end);
+        }
+
+      if (is_end)
+        {
+          close();
+          return;
+        }
+    }
+
+  pthread_mutex_lock(&m_lock);
+
+  uint32_t level = m_queued;
+
+  if (m_num > 0)
+    {
+      m_playing = m_queue[m_head];
+      m_queue[m_head].pcm.mh.freeSeg();
+      m_head = (m_head + 1) % SPEAKER_QUEUE_NUM;
+      m_num--;
+      m_queued -= m_playing.pcm.size;
+      m_has_playing = true;
+    }
+
+  pthread_mutex_unlock(&m_lock);
+
+  checkLevel(level);
+
+  bool muted = __atomic_load_n(&s_muted, __ATOMIC_ACQUIRE);
+  uint32_t samples = m_frame_samples;
+
+  if (m_has_playing)
+    {
+      const AsPcmDataParam &pcm = m_playing.pcm;
+
+      if (!pcm.is_valid || muted)
+        {
+          memset(m_frame, 0, m_frame_size);
+          m_writer.write(m_frame, (pcm.size < m_frame_size) ? pcm.size : m_frame_size);
+        }
+      else
+        {
+          m_writer.write(pcm.mh.getPa(), pcm.size);
+        }
+
+      m_stat.bytes += pcm.size;
+      samples = pcm.sample;
+    }
+  else
+    {
+      /* No frame in time. The speaker outputs silence. */
+
+      memset(m_frame, 0, m_frame_size);
+      m_writer.write(m_frame, m_frame_size);
+      m_stat.underruns++;
+    }
+
+  m_stat.frames++;
+  m_index++;
+
+  /* From the sample count, so that the frames do not drift. */
+
+  m_played += samples;
+  m_next_us = m_start_us + m_played * 1000000 / m_fmt.rate;
+}
+
+/****************************************************************************
+ * Public API
+ ****************************************************************************/
+bool audiosim_sdk_begin(AudioSim *sim, const char *mic_path, bool loop,
+                        const char *speaker_path)
+{
+  if (sim == NULL)
+    {
+      return false;
+    }
+
+  s_rec_overruns = 0;
+  s_mic.init(sim, mic_path, loop);
+  s_speaker.init(sim, speaker_path);
+
+  return sim->add(&s_mic) && sim->add(&s_speaker);
+}
+
+/*--------------------------------------------------------------------------*/
+void audiosim_sdk_end()
+{
+  s_mic.stop();
+  s_speaker.close();
+}
+
+/*--------------------------------------------------------------------------*/
+void audiosim_sdk_get_mic_stat(AudioSimDeviceStat *stat)
+{
+  s_mic.getStat(stat);
+
+  if (stat != NULL)
+    {
+      stat->overruns += s_rec_overruns;
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+void audiosim_sdk_get_speaker_stat(AudioSimDeviceStat *stat)
+{
+  s_speaker.getStat(stat);
+}
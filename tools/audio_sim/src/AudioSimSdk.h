@@ -0,0 +1,90 @@
+/*
+ *  AudioSimSdk.h - Host stand-in of the audio objects of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file AudioSimSdk.h
+ * @brief Host stand-in of the audio objects of the Spresense SDK.
+ * @details AS_SendAudioCommand() of the AudioManager, and the object APIs
+ *          of the MicFrontend, the MediaRecorder and the OutputMixer, on the
+ *          devices of AudioSim. With them, AudioClass, MediaRecorder,
+ *          FrontEnd and OutputMixer of the Audio library run on the host
+ *          without change.
+ *
+ *          - The microphone starts with the MicFrontend, and puts each
+ *            frame read from a WAV file into a segment of the input pool
+ *            of the MicFrontend. The frame goes to the destination of the
+ *            MicFrontend, by callback or by message, as on the board.
+ *          - The MediaRecorder takes the frames by message, and puts them
+ *            into the SimpleFIFO of the application. Only LPCM is
+ *            recorded, without the sampling rate converter.
+ *          - The speaker renders the frames given to the OutputMixer
+ *            into a WAV file, in the order of sending. After a frame is
+ *            rendered, its segment is freed and its callback is called.
+ *
+ *          The commands and the object APIs are done before they return.
+ *          Their results and replies are kept for AS_ReceiveAudioResult()
+ *          and AS_ReceiveObjectReply(). The players, the recognizer and the
+ *          synthesizer are not simulated, and reply with an error.
+ */
+
+#ifndef AudioSimSdk_h
+#define AudioSimSdk_h
+
+#include "AudioSim.h"
+
+/**
+ * @brief Set the devices on the timeline.
+ *
+ * @details Call this before the objects are created. The microphone and
+ *          the speaker are added to the timeline, and start when the
+ *          objects start them.
+ *
+ * @return false if the devices cannot be added.
+ */
+bool audiosim_sdk_begin(
+    AudioSim *sim,           /**< Timeline of the devices */
+    const char *mic_path,    /**< WAV file as the microphone input, or NULL */
+    bool loop,               /**< Repeat the microphone input */
+    const char *speaker_path /**< WAV file as the speaker output, or NULL */
+);
+
+/**
+ * @brief Close the files of the devices.
+ */
+void audiosim_sdk_end();
+
+/**
+ * @brief Statistics of the microphone.
+ *
+ * @details The overruns are the frames dropped because the input pool or
+ *          the FIFO of the recorder was full. The FIFO levels are of the
+ *          FIFO of the recorder.
+ */
+void audiosim_sdk_get_mic_stat(AudioSimDeviceStat *stat);
+
+/**
+ * @brief Statistics of the speaker.
+ *
+ * @details The underruns are the frames of silence because no frame was
+ *          sent in time. The FIFO levels are the bytes of the frames
+ *          waiting in the renderer.
+ */
+void audiosim_sdk_get_speaker_stat(AudioSimDeviceStat *stat);
+
+#endif // AudioSimSdk_h
@@ -0,0 +1,157 @@
+/*
+ *  CMN_SimpleFifo.cpp - Host stand-in of the SimpleFIFO of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <string.h>
+
+#include <memutils/simple_fifo/CMN_SimpleFifo.h>
+
+/* The producer only writes m_wp and the consumer only writes m_rp.
+ * The counters are published after the data is copied.
+ */
+
+static inline size_t load(const size_t *p)
+{
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void store(size_t *p, size_t v)
+{
+  __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------------*/
+int32_t CMN_SimpleFifoInitialize(CMN_SimpleFifoHandle *pHandle,
+                                 void *pFifoBuffer,
+                                 size_t fifoSize,
+                                 CMN_SimpleFifoSync *pSync)
+{
+  (void)pSync;
+
+  if ((pHandle == NULL) || (pFifoBuffer == NULL) || (fifoSize == 0))
+    {
+      return -1;
+    }
+
+  pHandle->m_pBuf = (uint8_t *)pFifoBuffer;
+  pHandle->m_size = fifoSize;
+  pHandle->m_rp   = 0;
+  pHandle->m_wp   = 0;
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+size_t CMN_SimpleFifoOffer(CMN_SimpleFifoHandle *pHandle,
+                           const void *pElement,
+                           size_t size)
+{
+  if (CMN_SimpleFifoGetVacantSize(pHandle) < size)
+    {
+      return 0;
+    }
+
+  size_t wp = pHandle->m_wp;
+  size_t pos = wp % pHandle->m_size;
+  size_t len1 = pHandle->m_size - pos;
+
+  if (len1 > size)
+    {
+      len1 = size;
+    }
+
+  memcpy(pHandle->m_pBuf + pos, pElement, len1);
+  memcpy(pHandle->m_pBuf, (const uint8_t *)pElement + len1, size - len1);
+
+  store(&pHandle->m_wp, wp + size);
+
+  return size;
+}
+
+/*--------------------------------------------------------------------------*/
+size_t CMN_SimpleFifoPeek(CMN_SimpleFifoHandle *pHandle,
+                          CMN_SimpleFifoPeekHandle *pPeekHandle,
+                          size_t size)
+{
+  if (CMN_SimpleFifoGetOccupiedSize(pHandle) < size)
+    {
+      return 0;
+    }
+
+  size_t pos = pHandle->m_rp % pHandle->m_size;
+  size_t len1 = pHandle->m_size - pos;
+
+  if (len1 > size)
+    {
+      len1 = size;
+    }
+
+  pPeekHandle->m_pChunk1  = pHandle->m_pBuf + pos;
+  pPeekHandle->m_szChunk1 = len1;
+  pPeekHandle->m_pChunk2  = (size > len1) ? pHandle->m_pBuf : NULL;
+  pPeekHandle->m_szChunk2 = size - len1;
+
+  return size;
+}
+
+/*--------------------------------------------------------------------------*/
+size_t CMN_SimpleFifoPoll(CMN_SimpleFifoHandle *pHandle,
+                          void *pElement,
+                          size_t size)
+{
+  CMN_SimpleFifoPeekHandle peek;
+
+  if (CMN_SimpleFifoPeek(pHandle, &peek, size) != size)
+    {
+      return 0;
+    }
+
+  if (pElement != NULL)
+    {
+      memcpy(pElement, peek.m_pChunk1, peek.m_szChunk1);
+      if (peek.m_szChunk2 > 0)
+        {
+          memcpy((uint8_t *)pElement + peek.m_szChunk1, peek.m_pChunk2, peek.m_szChunk2);
+        }
+    }
+
+  store(&pHandle->m_rp, pHandle->m_rp + size);
+
+  return size;
+}
+
+/*--------------------------------------------------------------------------*/
+void CMN_SimpleFifoClear(CMN_SimpleFifoHandle *pHandle)
+{
+  store(&pHandle->m_rp, load(&pHandle->m_wp));
+}
+
+/*--------------------------------------------------------------------------*/
+size_t CMN_SimpleFifoGetVacantSize(const CMN_SimpleFifoHandle *pHandle)
+{
+  return pHandle->m_size - CMN_SimpleFifoGetOccupiedSize(pHandle);
+}
+
+/*--------------------------------------------------------------------------*/
+size_t CMN_SimpleFifoGetOccupiedSize(const CMN_SimpleFifoHandle *pHandle)
+{
+  size_t rp = load(&pHandle->m_rp);
+  size_t wp = load(&pHandle->m_wp);
+
+  return wp - rp;
+}
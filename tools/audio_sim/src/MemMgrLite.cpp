@@ -0,0 +1,503 @@
+/*
+ *  MemMgrLite.cpp - Host stand-in of the memory manager of the Spresense SDK
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * The shared memory of mpshm_init() is host memory, and the pools of a
+ * layout are carved from it at the addresses of pool_layout.h, as on the
+ * board. The segments are reference counted under one lock, so handles can
+ * be copied and freed from any thread.
+ */
+
+//***************************************************************************
+// Included Files
+//***************************************************************************
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <asmp/mpshm.h>
+#include <memutils/memory_manager/MemHandle.h>
+#include <memutils/message/Message.h>
+
+#define print_err printf
+
+#define SECTION_MAX 2
+#define POOL_MAX    32
+
+namespace MemMgrLite {
+
+struct MemPool;
+
+struct MemSegment {
+  MemPool *pool;
+  uint8_t *va;
+  uint8_t  refcnt;
+};
+
+struct MemPool {
+  PoolId      id;
+  NumSeg      num_segs;
+  NumSeg      avail;
+  uint32_t    seg_size;
+  MemSegment *segs;
+};
+
+} /* end of namespace MemMgrLite */
+
+using namespace MemMgrLite;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static MemPool *s_pools[SECTION_MAX][POOL_MAX];
+static NumLayout s_layout[SECTION_MAX] = { BadLayoutNo, BadLayoutNo };
+static mpshm_t *s_shm;
+
+bool MsgLib::s_init = false;
+
+static MemPool *find_pool(PoolId id)
+{
+  if ((id.sec >= SECTION_MAX) || (id.pool >= POOL_MAX))
+    {
+      return NULL;
+    }
+
+  return s_pools[id.sec][id.pool];
+}
+
+/****************************************************************************
+ * Shared memory
+ ****************************************************************************/
+extern "C" int mpshm_init(mpshm_t *shm, int key, size_t size)
+{
+  (void)key;
+
+  shm->va = calloc(1, size);
+  shm->pa = 0;
+  shm->size = size;
+
+  return (shm->va == NULL) ? -ENOMEM : 0;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" int mpshm_destroy(mpshm_t *shm)
+{
+  if (s_shm == shm)
+    {
+      s_shm = NULL;
+    }
+
+  free(shm->va);
+  shm->va = NULL;
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" void *mpshm_attach(mpshm_t *shm, int shmflg)
+{
+  (void)shmflg;
+
+  return shm->va;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" int mpshm_detach(mpshm_t *shm)
+{
+  (void)shm;
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" int mpshm_remap(mpshm_t *shm, void *pa)
+{
+  /* The layouts address the memory from here on. */
+
+  shm->pa = (uint32_t)(uintptr_t)pa;
+  s_shm = shm;
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" uintptr_t mpshm_phys2virt(mpshm_t *shm, const void *pa)
+{
+  uintptr_t addr = (uintptr_t)pa;
+
+  if ((addr < shm->pa) || (addr >= shm->pa + shm->size))
+    {
+      return 0;
+    }
+
+  return (uintptr_t)shm->va + (addr - shm->pa);
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" uintptr_t mpshm_virt2phys(mpshm_t *shm, void *va)
+{
+  uintptr_t addr = (uintptr_t)va;
+  uintptr_t base = (uintptr_t)shm->va;
+
+  if ((addr < base) || (addr >= base + shm->size))
+    {
+      return 0;
+    }
+
+  return shm->pa + (addr - base);
+}
+
+/*--------------------------------------------------------------------------*/
+void *translatePoolAddrToVa(PoolAddr addr)
+{
+  if (s_shm == NULL)
+    {
+      return NULL;
+    }
+
+  return (void *)mpshm_phys2virt(s_shm, (const void *)(uintptr_t)addr);
+}
+
+/****************************************************************************
+ * MsgLib
+ ****************************************************************************/
+err_t MsgLib::initFirst(uint32_t num_pools, uint32_t top_drm)
+{
+  (void)num_pools;
+  (void)top_drm;
+
+  return ERR_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+err_t MsgLib::initPerCpu()
+{
+  s_init = true;
+
+  return ERR_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+err_t MsgLib::finalize()
+{
+  s_init = false;
+
+  return ERR_OK;
+}
+
+/****************************************************************************
+ * Manager
+ ****************************************************************************/
+err_t Manager::initFirst(void *manager_area, uint32_t area_size)
+{
+  (void)manager_area;
+  (void)area_size;
+
+  return ERR_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+err_t Manager::initPerCpu(void *manager_area, MemPool ***static_pools,
+                          uint8_t *pool_num, uint8_t *layout_no)
+{
+  (void)manager_area;
+  (void)static_pools;
+  (void)pool_num;
+  (void)layout_no;
+
+  return ERR_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+err_t Manager::createStaticPools(uint8_t sec_no, NumLayout layout_no,
+                                 void *work_area, uint32_t area_size,
+                                 const PoolSectionAttr *pool_attr)
+{
+  (void)work_area;
+  (void)area_size;
+
+  if ((sec_no >= SECTION_MAX) || (s_layout[sec_no] != BadLayoutNo))
+    {
+      print_err("ERROR: Pools of section %d are already created.\n", sec_no);
+      return ERR_STS;
+    }
+
+  /* The layout ends with the NULL pool. */
+
+  for (; pool_attr->id.pool != 0; pool_attr++)
+    {
+      const PoolSectionAttr *attr = pool_attr;
+      uint8_t *va = (uint8_t *)translatePoolAddrToVa(attr->addr);
+
+      if ((va == NULL) || (attr->id.pool >= POOL_MAX) || (attr->num_segs == 0))
+        {
+          print_err("ERROR: Pool %d is out of the shared memory.\n", attr->id.pool);
+          destroyStaticPools(sec_no);
+          return ERR_STS;
+        }
+
+      MemPool *pool = (MemPool *)calloc(1, sizeof(MemPool));
+      MemSegment *segs = (MemSegment *)calloc(attr->num_segs, sizeof(MemSegment));
+
+      if ((pool == NULL) || (segs == NULL))
+        {
+          free(pool);
+          free(segs);
+          destroyStaticPools(sec_no);
+          return ERR_MEM_EMPTY;
+        }
+
+      pool->id       = attr->id;
+      pool->num_segs = attr->num_segs;
+      pool->avail    = attr->num_segs;
+      pool->seg_size = attr->size / attr->num_segs;
+      pool->segs     = segs;
+
+      for (int i = 0; i < attr->num_segs; i++)
+        {
+          segs[i].pool = pool;
+          segs[i].va   = va + i * pool->seg_size;
+        }
+
+      s_pools[sec_no][attr->id.pool] = pool;
+    }
+
+  s_layout[sec_no] = layout_no;
+
+  return ERR_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+void Manager::destroyStaticPools()
+{
+  for (uint8_t sec = 0; sec < SECTION_MAX; sec++)
+    {
+      destroyStaticPools(sec);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+void Manager::destroyStaticPools(uint8_t sec_no)
+{
+  if (sec_no >= SECTION_MAX)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&s_lock);
+
+  for (int i = 0; i < POOL_MAX; i++)
+    {
+      MemPool *pool = s_pools[sec_no][i];
+
+      if (pool == NULL)
+        {
+          continue;
+        }
+
+      /* On the board, the segments in use are lost with the layout. */
+
+      if (pool->avail != pool->num_segs)
+        {
+          print_err("ERROR: %d segments of pool %d are not freed.\n",
+                    pool->num_segs - pool->avail, i);
+          for (int j = 0; j < pool->num_segs; j++)
+            {
+              pool->segs[j].pool = NULL;
+            }
+        }
+      else
+        {
+          free(pool->segs);
+        }
+
+      free(pool);
+      s_pools[sec_no][i] = NULL;
+    }
+
+  s_layout[sec_no] = BadLayoutNo;
+
+  pthread_mutex_unlock(&s_lock);
+}
+
+/*--------------------------------------------------------------------------*/
+err_t Manager::finalize()
+{
+  return ERR_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+NumLayout Manager::getCurrentLayoutNo(uint8_t sec_no)
+{
+  return (sec_no < SECTION_MAX) ? s_layout[sec_no] : BadLayoutNo;
+}
+
+/*--------------------------------------------------------------------------*/
+bool Manager::isPoolAvailable(PoolId id)
+{
+  return find_pool(id) != NULL;
+}
+
+/*--------------------------------------------------------------------------*/
+NumSeg Manager::getPoolNumSegs(PoolId id)
+{
+  MemPool *pool = find_pool(id);
+
+  return (pool != NULL) ? pool->num_segs : 0;
+}
+
+/*--------------------------------------------------------------------------*/
+NumSeg Manager::getPoolNumAvailSegs(PoolId id)
+{
+  MemPool *pool = find_pool(id);
+
+  return (pool != NULL) ? pool->avail : 0;
+}
+
+/*--------------------------------------------------------------------------*/
+PoolSize Manager::getPoolSize(PoolId id)
+{
+  MemPool *pool = find_pool(id);
+
+  return (pool != NULL) ? pool->seg_size * pool->num_segs : 0;
+}
+
+/****************************************************************************
+ * MemHandle
+ ****************************************************************************/
+MemHandle::MemHandle(const MemHandle &mh)
+  : m_seg(NULL)
+{
+  *this = mh;
+}
+
+/*--------------------------------------------------------------------------*/
+MemHandle &MemHandle::operator=(const MemHandle &mh)
+{
+  if (m_seg == mh.m_seg)
+    {
+      return *this;
+    }
+
+  freeSeg();
+
+  pthread_mutex_lock(&s_lock);
+  m_seg = mh.m_seg;
+  if (m_seg != NULL)
+    {
+      m_seg->refcnt++;
+    }
+  pthread_mutex_unlock(&s_lock);
+
+  return *this;
+}
+
+/*--------------------------------------------------------------------------*/
+err_t MemHandle::allocSeg(PoolId id, size_t size_for_check)
+{
+  err_t ret = ERR_MEM_EMPTY;
+
+  freeSeg();
+
+  pthread_mutex_lock(&s_lock);
+
+  MemPool *pool = find_pool(id);
+
+  if (pool == NULL)
+    {
+      ret = ERR_STS;
+    }
+  else if (size_for_check > pool->seg_size)
+    {
+      ret = ERR_DATA_SIZE;
+    }
+  else
+    {
+      for (int i = 0; i < pool->num_segs; i++)
+        {
+          if (pool->segs[i].refcnt == 0)
+            {
+              m_seg = &pool->segs[i];
+              m_seg->refcnt = 1;
+              pool->avail--;
+              ret = ERR_OK;
+              break;
+            }
+        }
+    }
+
+  pthread_mutex_unlock(&s_lock);
+
+  return ret;
+}
+
+/*--------------------------------------------------------------------------*/
+void MemHandle::freeSeg()
+{
+  if (m_seg == NULL)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&s_lock);
+
+  if (--m_seg->refcnt == 0)
+    {
+      MemPool *pool = m_seg->pool;
+
+      if (pool != NULL)
+        {
+          pool->avail++;
+        }
+    }
+
+  m_seg = NULL;
+
+  pthread_mutex_unlock(&s_lock);
+}
+
+/*--------------------------------------------------------------------------*/
+PoolId MemHandle::getPoolId() const
+{
+  PoolId id = { 0, 0 };
+
+  if ((m_seg != NULL) && (m_seg->pool != NULL))
+    {
+      id = m_seg->pool->id;
+    }
+
+  return id;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t MemHandle::getSegSize() const
+{
+  return ((m_seg != NULL) && (m_seg->pool != NULL)) ? m_seg->pool->seg_size : 0;
+}
+
+/*--------------------------------------------------------------------------*/
+uint8_t MemHandle::getRefCnt() const
+{
+  return (m_seg != NULL) ? m_seg->refcnt : 0;
+}
+
+/*--------------------------------------------------------------------------*/
+void *MemHandle::getVa() const
+{
+  return (m_seg != NULL) ? m_seg->va : NULL;
+}
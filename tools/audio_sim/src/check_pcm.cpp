@@ -0,0 +1,159 @@
+/*
+ *  check_pcm.cpp - Check of the channel conversions of PcmConverter
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Runs mixToMono(), selectChannels() and toS16() of PcmConverter on fixed
+ * and random frames, and compares them with the plain computation.
+ *
+ * Usage: check_pcm
+ *
+ * Exit status is 0 if all cases pass, and 1 otherwise.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "PcmConverter.h"
+
+#define RANDOM_FRAMES 4096
+
+static int s_errors;
+
+static void check(const char *name, bool ok)
+{
+  printf("%s: %s\n", ok ? "PASS" : "FAIL", name);
+  if (!ok)
+    {
+      s_errors++;
+    }
+}
+
+/* The average rounded to the nearest, or rounded down for 2 channels */
+
+static int16_t mono_ref(const int16_t *frame, int channels)
+{
+  int32_t sum = 0;
+
+  for (int ch = 0; ch < channels; ch++)
+    {
+      sum += frame[ch];
+    }
+
+  double avg = (double)sum / channels;
+  return (int16_t)((channels == 2) ? floor(avg) : floor(avg + 0.5));
+}
+
+static void check_mono_fixed()
+{
+  /* Truncation gave 1, 4 and 7 */
+
+  int16_t buf[] = { 1, 2, 3,  4, 5, 6,  7, 8, 9 };
+  uint32_t ret = PcmConverter::mixToMono(buf, 3, 3);
+  check("mixToMono 3ch {1,2,3},{4,5,6},{7,8,9}",
+        (ret == 3 * sizeof(int16_t)) && (buf[0] == 2) && (buf[1] == 5) && (buf[2] == 8));
+
+  int16_t neg[] = { -1, -2, -3,  -1, -1, 0,  -1, 0, 0 };
+  PcmConverter::mixToMono(neg, 3, 3);
+  check("mixToMono 3ch negative", (neg[0] == -2) && (neg[1] == -1) && (neg[2] == 0));
+
+  int16_t quad[] = { 1, 2, 2, 2,  -1, -2, -2, -2 };
+  PcmConverter::mixToMono(quad, 2, 4);
+  check("mixToMono 4ch", (quad[0] == 2) && (quad[1] == -2));
+
+  int16_t full[7 * 2];
+  for (int ch = 0; ch < 7; ch++)
+    {
+      full[ch] = 32767;
+      full[7 + ch] = -32768;
+    }
+  PcmConverter::mixToMono(full, 2, 7);
+  check("mixToMono 7ch full scale", (full[0] == 32767) && (full[1] == -32768));
+}
+
+static void check_mono_random(int channels)
+{
+  int16_t *buf = (int16_t *)malloc(RANDOM_FRAMES * channels * sizeof(int16_t));
+  int16_t *ref = (int16_t *)malloc(RANDOM_FRAMES * sizeof(int16_t));
+  char name[32];
+
+  for (int i = 0; i < RANDOM_FRAMES * channels; i++)
+    {
+      buf[i] = (int16_t)(rand() & 0xffff);
+    }
+  for (int i = 0; i < RANDOM_FRAMES; i++)
+    {
+      ref[i] = mono_ref(&buf[i * channels], channels);
+    }
+
+  PcmConverter::mixToMono(buf, RANDOM_FRAMES, channels);
+
+  snprintf(name, sizeof(name), "mixToMono %dch random", channels);
+  check(name, memcmp(buf, ref, RANDOM_FRAMES * sizeof(int16_t)) == 0);
+
+  free(buf);
+  free(ref);
+}
+
+static void check_select()
+{
+  int16_t buf[] = { 0, 1, 2, 3,  10, 11, 12, 13 };
+  const uint8_t swap[] = { 3, 0 };
+  uint32_t ret = PcmConverter::selectChannels(buf, 2, 4, swap, 2);
+  check("selectChannels {3,0}",
+        (ret == 4 * sizeof(int16_t)) &&
+        (buf[0] == 3) && (buf[1] == 0) && (buf[2] == 13) && (buf[3] == 10));
+
+  const uint8_t bad[] = { 4 };
+  check("selectChannels out of range",
+        PcmConverter::selectChannels(buf, 2, 4, bad, 1) == 0);
+}
+
+static void check_s16()
+{
+  PcmConverter conv;
+  int32_t buf[] = { 0x000180, 0x00017f, -0x000180, 0x7fffff, -0x800000 };
+  uint32_t ret = conv.toS16(buf, 5, PcmFormatS24, false);
+  int16_t *out = (int16_t *)buf;
+  check("toS16 S24 rounding",
+        (ret == 5 * sizeof(int16_t)) &&
+        (out[0] == 2) && (out[1] == 1) && (out[2] == -1) &&
+        (out[3] == 32767) && (out[4] == -32768));
+}
+
+int main(int argc, char *argv[])
+{
+  (void)argc;
+  (void)argv;
+
+  srand(1);
+
+  check_mono_fixed();
+  for (int channels = 2; channels <= PCMRESAMPLER_CH_MAX; channels++)
+    {
+      check_mono_random(channels);
+    }
+  check_select();
+  check_s16();
+
+  printf("Result: %s (errors %d)\n", s_errors ? "FAIL" : "PASS", s_errors);
+
+  return s_errors ? 1 : 0;
+}
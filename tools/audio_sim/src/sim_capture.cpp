@@ -0,0 +1,299 @@
+/*
+ *  sim_capture.cpp - Recorder capture path on the audio simulator
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Puts a WAV file as the microphone input into a recorder FIFO, and reads
+ * it the way an application does with peekFrames() and consumeFrames(),
+ * once in each read interval. The data read is written to a WAV file.
+ * Optionally, the data is converted in the FIFO by PcmConverter and
+ * PcmResampler of the Audio library before it is written.
+ *
+ * Usage: sim_capture [-s speed] [-f fifo_size] [-n frame_samples]
+ *                    [-i interval_ms] [-c ch,ch...] [-m] [-r rate]
+ *                    input.wav output.wav
+ *
+ * Exit status is 0 if all frames are read, 2 if frames are dropped and 1
+ * on other errors.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "AudioSim.h"
+#include "PcmConverter.h"
+
+/* Same as READ_BUF_SIZE of AudioClass */
+
+#define DEFAULT_FIFO_SIZE (10 * 1024 * 2 * 8)
+
+/* Samples of a PCM capture frame */
+
+#define DEFAULT_FRAME_SAMPLES 768
+
+static CMN_SimpleFifoHandle s_fifo;
+static AudioSim s_sim;
+static AudioSimWavWriter s_writer;
+static uint64_t s_interval_us = 10000;
+static uint64_t s_next_read_us;
+static uint32_t s_notified;
+
+/* Conversion of the data read */
+
+static bool s_convert;
+static uint8_t s_select[PCMRESAMPLER_CH_MAX];
+static uint8_t s_select_num;
+static bool s_mono;
+static uint32_t s_out_rate;
+static AudioSimFormat s_in_fmt;
+static PcmConverter s_converter;
+static PcmResampler s_resampler;
+
+static void output_device_callback(uint32_t size)
+{
+  s_notified += size;
+}
+
+static void convert(void *data, size_t size)
+{
+  uint32_t frames = size / (s_in_fmt.channels * s_in_fmt.bits / 8);
+  uint8_t channels = s_in_fmt.channels;
+  PcmFormat format = (s_in_fmt.bits == 16) ? PcmFormatS16 :
+                     ((s_in_fmt.bits == 24) ? PcmFormatS24P : PcmFormatS32);
+  int16_t *pcm = (int16_t *)data;
+
+  s_converter.toS16(data, frames * channels, format);
+
+  if (s_select_num > 0)
+    {
+      PcmConverter::selectChannels(pcm, frames, channels, s_select, s_select_num);
+      channels = s_select_num;
+    }
+
+  if (s_mono)
+    {
+      PcmConverter::mixToMono(pcm, frames, channels);
+      channels = 1;
+    }
+
+  if (s_out_rate > 0)
+    {
+      frames = s_resampler.process(pcm, frames, pcm, frames);
+    }
+
+  s_writer.write(data, frames * channels * sizeof(int16_t));
+}
+
+static void write_data(void *data, size_t size)
+{
+  if (s_convert)
+    {
+      convert(data, size);
+    }
+  else
+    {
+      s_writer.write(data, size);
+    }
+}
+
+static void read_frames()
+{
+  CMN_SimpleFifoPeekHandle peek;
+  size_t size = CMN_SimpleFifoGetOccupiedSize(&s_fifo);
+
+  if ((size == 0) || (CMN_SimpleFifoPeek(&s_fifo, &peek, size) != size))
+    {
+      return;
+    }
+
+  write_data(peek.m_pChunk1, peek.m_szChunk1);
+  if (peek.m_szChunk2 > 0)
+    {
+      write_data(peek.m_pChunk2, peek.m_szChunk2);
+    }
+
+  CMN_SimpleFifoPoll(&s_fifo, NULL, size);
+}
+
+static bool pump(void *arg)
+{
+  (void)arg;
+
+  /* loop() of the application wakes up once in the interval */
+
+  if (s_sim.now() >= s_next_read_us)
+    {
+      read_frames();
+      s_next_read_us += s_interval_us;
+    }
+
+  return true;
+}
+
+static void usage()
+{
+  printf("Usage: sim_capture [-s speed] [-f fifo_size] [-n frame_samples]\n"
+         "                   [-i interval_ms] [-c ch,ch...] [-m] [-r rate]\n"
+         "                   input.wav output.wav\n"
+         "  -s: Speed to real time, 0 for no wait (default: 0)\n"
+         "  -f: Bytes of the recorder FIFO (default: %d)\n"
+         "  -n: Samples of a frame (default: %d)\n"
+         "  -i: Read interval of the application in ms (default: 10)\n"
+         "  -c: Pick the channels, from 0\n"
+         "  -m: Mix the channels to mono\n"
+         "  -r: Resample to the rate\n"
+         "  With -c, -m or -r, the output is 16bit.\n",
+         DEFAULT_FIFO_SIZE, DEFAULT_FRAME_SAMPLES);
+}
+
+int main(int argc, char *argv[])
+{
+  double speed = 0;
+  size_t fifo_size = DEFAULT_FIFO_SIZE;
+  uint32_t frame_samples = DEFAULT_FRAME_SAMPLES;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "s:f:n:i:c:mr:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 's':
+            speed = atof(optarg);
+            break;
+          case 'f':
+            fifo_size = strtoul(optarg, NULL, 0);
+            break;
+          case 'n':
+            frame_samples = strtoul(optarg, NULL, 0);
+            break;
+          case 'i':
+            s_interval_us = strtoull(optarg, NULL, 0) * 1000;
+            break;
+          case 'c':
+            for (char *p = strtok(optarg, ","); p != NULL; p = strtok(NULL, ","))
+              {
+                if (s_select_num < PCMRESAMPLER_CH_MAX)
+                  {
+                    s_select[s_select_num++] = atoi(p);
+                  }
+              }
+            s_convert = true;
+            break;
+          case 'm':
+            s_mono = true;
+            s_convert = true;
+            break;
+          case 'r':
+            s_out_rate = strtoul(optarg, NULL, 0);
+            s_convert = true;
+            break;
+          default:
+            usage();
+            return 1;
+        }
+    }
+
+  if (argc - optind != 2)
+    {
+      usage();
+      return 1;
+    }
+
+  uint8_t *fifo_buf = (uint8_t *)malloc(fifo_size);
+  if ((fifo_buf == NULL) ||
+      (CMN_SimpleFifoInitialize(&s_fifo, fifo_buf, fifo_size, NULL) != 0))
+    {
+      printf("ERROR: Cannot create FIFO.\n");
+      return 1;
+    }
+
+  AudioSimCapture mic;
+
+  if (!mic.begin(&s_fifo, argv[optind], frame_samples))
+    {
+      return 1;
+    }
+
+  s_in_fmt = mic.format();
+
+  AudioSimFormat out_fmt = s_in_fmt;
+
+  if (s_convert)
+    {
+      /* Each span of the FIFO must have whole frames. */
+
+      if (fifo_size % (s_in_fmt.channels * s_in_fmt.bits / 8) != 0)
+        {
+          printf("ERROR: FIFO size is not a multiple of the frame.\n");
+          return 1;
+        }
+
+      out_fmt.bits = 16;
+      out_fmt.channels = s_mono ? 1 : ((s_select_num > 0) ? s_select_num : s_in_fmt.channels);
+
+      if (s_out_rate > 0)
+        {
+          if ((s_out_rate > s_in_fmt.rate) ||
+              !s_resampler.begin(s_in_fmt.rate, s_out_rate, out_fmt.channels))
+            {
+              printf("ERROR: Cannot resample to %lu.\n", (unsigned long)s_out_rate);
+              return 1;
+            }
+          out_fmt.rate = s_out_rate;
+        }
+    }
+
+  if (!s_writer.open(argv[optind + 1], out_fmt))
+    {
+      return 1;
+    }
+
+  mic.setCallback(output_device_callback);
+
+  s_sim.setSpeed(speed);
+  s_sim.add(&mic);
+  s_next_read_us = s_interval_us;
+  s_sim.run(0, pump);
+
+  /* Same as stopRecorder() followed by the last readFrames() */
+
+  read_frames();
+  s_writer.close();
+
+  AudioSimDeviceStat stat;
+  AudioSimStat sim;
+
+  mic.getStat(&stat);
+  s_sim.getStat(&sim);
+
+  printf("frames %lu, bytes %llu, overruns %lu, notified %lu\n",
+         (unsigned long)stat.frames, (unsigned long long)stat.bytes,
+         (unsigned long)stat.overruns, (unsigned long)s_notified);
+  printf("FIFO max %lu bytes (%lu us)\n",
+         (unsigned long)stat.maxFifoUsed,
+         (unsigned long)mic.bytesToUs(stat.maxFifoUsed));
+  printf("time %llu us, wall %llu us, late max %lu us\n",
+         (unsigned long long)sim.virtualUs, (unsigned long long)sim.wallUs,
+         (unsigned long)sim.maxLateUs);
+
+  free(fifo_buf);
+
+  return (stat.overruns > 0) ? 2 : 0;
+}
@@ -0,0 +1,266 @@
+/*
+ *  sim_mixer.cpp - OutputMixerStream of the Audio library on the audio simulator
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Runs OutputMixer and OutputMixerStream on the stand-in of the SDK audio
+ * objects, as the rendering_stream example does. The fill function reads
+ * the frames from a WAV file, and the speaker renders them into a WAV file
+ * at the frame timing.
+ *
+ * The stream thread of OutputMixerStream runs on the host clock, so the
+ * simulation runs in its own thread at a speed above 0. With -d, each fill
+ * takes the time more, scaled by the speed, to find the frames and the
+ * frame size that bridge a slow fill function.
+ *
+ * Usage: sim_mixer [-s speed] [-n frame_samples] [-k frames] [-d fill_us]
+ *                  input.wav output.wav
+ *
+ * Exit status is 0 if the speaker never ran out of frames, 2 on underruns
+ * and 1 on other errors.
+ */
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <OutputMixer.h>
+#include <OutputMixerStream.h>
+#include <MemoryUtil.h>
+
+#include <arch/board/board.h>
+
+#include "AudioSimSdk.h"
+
+/* Same as the rendering_stream example */
+
+#define DEFAULT_FRAME_SAMPLES 240
+#define DEFAULT_FRAME_NUM     2
+
+static AudioSim s_sim;
+static OutputMixerStream s_stream;
+static FILE *s_input;
+static uint32_t s_remain;
+static uint32_t s_frame_bytes;
+static double s_speed = 1.0;
+static uint32_t s_fill_us;
+static bool s_eof;
+static uint32_t s_attentions;
+
+static bool fill_frame(void *buf, uint32_t samples, void *arg)
+{
+  uint32_t size = samples * s_frame_bytes;
+
+  if (s_fill_us > 0)
+    {
+      usleep((useconds_t)(s_fill_us / s_speed));
+    }
+
+  if (s_remain == 0)
+    {
+      __atomic_store_n(&s_eof, true, __ATOMIC_RELEASE);
+      return false;
+    }
+
+  /* The last frame is padded with silence. */
+
+  size = (size < s_remain) ? size : s_remain;
+  size = fread(buf, 1, size, s_input);
+  memset((uint8_t *)buf + size, 0, samples * s_frame_bytes - size);
+
+  s_remain = (size > 0) ? s_remain - size : 0;
+
+  return true;
+}
+
+static void outputmixer_done_callback(MsgQueId requester_dtq,
+                                      MsgType reply_of,
+                                      AsOutputMixDoneParam *done_param)
+{
+  return;
+}
+
+static void attention_cb(const ErrorAttentionParam *atprm)
+{
+  s_attentions++;
+  printf("Attention %d from module %d, sub code %lu\n",
+         atprm->error_code, atprm->module_id,
+         (unsigned long)atprm->error_att_sub_code);
+}
+
+static void *sim_thread(void *arg)
+{
+  (void)arg;
+
+  s_sim.run(0);
+
+  return NULL;
+}
+
+static void usage()
+{
+  printf("Usage: sim_mixer [-s speed] [-n frame_samples] [-k frames] [-d fill_us]\n"
+         "                 input.wav output.wav\n"
+         "  -s: Speed to real time, above 0 (default: 1)\n"
+         "  -n: Samples of a frame (default: %d)\n"
+         "  -k: Frames in the renderer, 2 up to %d (default: %d)\n"
+         "  -d: Time of each fill in us (default: 0)\n"
+         "  The input is 48kHz, 16bit or 32bit for 24bit.\n",
+         DEFAULT_FRAME_SAMPLES, OUTPUTMIXERSTREAM_FRAME_MAX, DEFAULT_FRAME_NUM);
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t frame_samples = DEFAULT_FRAME_SAMPLES;
+  int frame_num = DEFAULT_FRAME_NUM;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "s:n:k:d:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 's':
+            s_speed = atof(optarg);
+            break;
+          case 'n':
+            frame_samples = strtoul(optarg, NULL, 0);
+            break;
+          case 'k':
+            frame_num = atoi(optarg);
+            break;
+          case 'd':
+            s_fill_us = strtoul(optarg, NULL, 0);
+            break;
+          default:
+            usage();
+            return 1;
+        }
+    }
+
+  if ((argc - optind != 2) || (s_speed <= 0))
+    {
+      usage();
+      return 1;
+    }
+
+  AudioSimFormat fmt;
+
+  if (!audiosim_read_wav(argv[optind], &fmt))
+    {
+      return 1;
+    }
+
+  if ((fmt.rate != AS_SAMPLINGRATE_48000) || ((fmt.bits != 16) && (fmt.bits != 32)))
+    {
+      printf("ERROR: Input is not 48kHz 16bit or 32bit.\n");
+      return 1;
+    }
+
+  s_input = fopen(argv[optind], "rb");
+  if ((s_input == NULL) || (fseek(s_input, fmt.dataOffset, SEEK_SET) != 0))
+    {
+      printf("ERROR: Cannot open %s.\n", argv[optind]);
+      return 1;
+    }
+
+  s_remain = fmt.dataSize;
+  s_frame_bytes = fmt.channels * fmt.bits / 8;
+
+  s_sim.setSpeed(s_speed);
+  if (!audiosim_sdk_begin(&s_sim, NULL, false, argv[optind + 1]))
+    {
+      return 1;
+    }
+
+  /* Same as setup() of the rendering_stream example */
+
+  initMemoryPools();
+  createStaticPools(MEM_LAYOUT_PLAYER);
+
+  OutputMixer *mixer = OutputMixer::getInstance();
+
+  mixer->activateBaseband();
+  mixer->create(attention_cb);
+  mixer->setRenderingClkMode(OUTPUTMIXER_RNDCLK_NORMAL);
+  mixer->activate(OutputMixer0, HPOutputDevice, outputmixer_done_callback);
+  mixer->setVolume(-160, 0, 0);
+  board_external_amp_mute_control(false);
+
+  if (s_stream.begin(OutputMixer0, fill_frame, NULL, frame_samples, fmt.channels,
+                     (fmt.bits == 16) ? AS_BITLENGTH_16 : AS_BITLENGTH_24,
+                     frame_num) != OUTPUTMIXER_ECODE_OK)
+    {
+      printf("ERROR: Cannot start the stream.\n");
+      return 1;
+    }
+
+  /* The frames are rendered in the simulation thread, and the stream
+   * thread sends the next ones from its callbacks.
+   */
+
+  pthread_t tid;
+
+  if (pthread_create(&tid, NULL, sim_thread, NULL) != 0)
+    {
+      return 1;
+    }
+
+  while (!__atomic_load_n(&s_eof, __ATOMIC_ACQUIRE))
+    {
+      usleep(1000);
+    }
+
+  /* The last frames are rendered before the mute. */
+
+  s_stream.end();
+  board_external_amp_mute_control(true);
+  mixer->deactivate(OutputMixer0);
+
+  pthread_join(tid, NULL);
+
+  audiosim_sdk_end();
+  fclose(s_input);
+
+  mixer->end();
+  destroyStaticPools();
+  finalizeMemoryPools();
+
+  OutputMixerStreamStat stream;
+  AudioSimDeviceStat stat;
+  AudioSimStat sim;
+
+  s_stream.getStat(&stream);
+  audiosim_sdk_get_speaker_stat(&stat);
+  s_sim.getStat(&sim);
+
+  printf("frames %lu, silent %lu, stream underruns %lu, attentions %lu\n",
+         (unsigned long)stream.frames, (unsigned long)stream.silentFrames,
+         (unsigned long)stream.underruns, (unsigned long)s_attentions);
+  printf("latency max %lu us, fill max %lu us\n",
+         (unsigned long)stream.maxLatencyUs, (unsigned long)stream.maxFillUs);
+  printf("speaker frames %lu, underruns %lu, queued max %lu bytes\n",
+         (unsigned long)stat.frames, (unsigned long)stat.underruns,
+         (unsigned long)stat.maxFifoUsed);
+  printf("time %llu us, wall %llu us, late max %lu us\n",
+         (unsigned long long)sim.virtualUs, (unsigned long long)sim.wallUs,
+         (unsigned long)sim.maxLateUs);
+
+  return ((stat.underruns > 0) || (stream.underruns > 0)) ? 2 : 0;
+}
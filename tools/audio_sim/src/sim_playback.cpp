@@ -0,0 +1,422 @@
+/*
+ *  sim_playback.cpp - Player path with PlayerFeeder on the audio simulator
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Reads WAV files with PlayerFeeder of the Audio library into a player
+ * FIFO, and takes the frames as the speaker at the frame timing. The
+ * output is written to a WAV file, with silence where the FIFO ran out.
+ *
+ * By default, the feeder thread polls on the simulated time: after each
+ * frame, it runs until it has nothing to do before the next frame. So the
+ * result is the same at any speed, and speed 0 runs without waiting. The
+ * storage takes no time in this mode, so the speaker never runs out of
+ * data unless the FIFO is too small for a frame.
+ *
+ * With -c, the feeder runs on its own clock in a thread, as on the board,
+ * and each read takes the latency given by -l and -t. The speaker may then
+ * run out of data. The latency and the poll interval of the feeder are
+ * scaled by the speed, so the result is near the same at any speed above 0,
+ * within the timing of the host.
+ *
+ * Usage: sim_playback [-s speed] [-f fifo_size] [-n frame_samples]
+ *                     [-r read_size] [-c] [-l latency_us]
+ *                     [-t every:stall_us] output.wav input.wav...
+ *
+ * Exit status is 0 if the speaker never ran out of data, 2 on underruns
+ * and 1 on other errors.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <semaphore.h>
+#include <time.h>
+
+#include "AudioSim.h"
+#include "PlayerFeeder.h"
+
+/* Same as WRITE_BUF_SIZE of AudioClass */
+
+#define DEFAULT_FIFO_SIZE (8 * 1024 * 2 * 3)
+
+#define DEFAULT_FRAME_SAMPLES 1024
+#define DEFAULT_READ_SIZE     16384
+
+static uint64_t wall_us()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+class SimPlayerFeeder : public PlayerFeeder
+{
+public:
+  SimPlayerFeeder()
+    : m_ending(false)
+    , m_free_run(false)
+    , m_speed(1.0)
+    , m_latency_us(0)
+    , m_stall_every(0)
+    , m_stall_us(0)
+    , m_reads(0)
+  {
+    sem_init(&m_idle, 0, 0);
+    sem_init(&m_tick, 0, 0);
+  }
+
+  ~SimPlayerFeeder()
+  {
+    end();
+    sem_destroy(&m_idle);
+    sem_destroy(&m_tick);
+  }
+
+  bool begin(CMN_SimpleFifoHandle *fifo, size_t read_size)
+  {
+    if (!start(fifo, read_size))
+      {
+        return false;
+      }
+
+    /* Without a file, the feeder thread waits at once. Take that wait,
+     * so that the files queued next are read in step().
+     */
+
+    if (!m_free_run)
+      {
+        settle();
+      }
+
+    return true;
+  }
+
+  /* Run on the own clock of the feeder, scaled by the speed. Call before
+   * begin().
+   */
+
+  void setFreeRun(double speed)
+  {
+    m_free_run = true;
+    m_speed = speed;
+  }
+
+  /* Each read takes latency_us, and every stall_every-th read takes
+   * stall_us more, as a stall of the SD card. The time is simulated.
+   */
+
+  void setLatency(uint32_t latency_us, uint32_t stall_every, uint32_t stall_us)
+  {
+    m_latency_us = latency_us;
+    m_stall_every = stall_every;
+    m_stall_us = stall_us;
+  }
+
+  /* Wait until the feeder has nothing to do. */
+
+  void settle()
+  {
+    sem_wait(&m_idle);
+  }
+
+  /* Let the feeder run once for a new frame, and wait until it settles. */
+
+  void step()
+  {
+    sem_post(&m_tick);
+    sem_wait(&m_idle);
+  }
+
+  void end()
+  {
+    __atomic_store_n(&m_ending, true, __ATOMIC_RELEASE);
+    sem_post(&m_tick);
+    PlayerFeeder::end();
+  }
+
+protected:
+  void wait_poll()
+  {
+    /* While stopping, end() wakes up the feeder in the real time. */
+
+    if (__atomic_load_n(&m_ending, __ATOMIC_ACQUIRE))
+      {
+        PlayerFeeder::wait_poll();
+        return;
+      }
+
+    if (m_free_run)
+      {
+        usleep((useconds_t)(POLL_INTERVAL_MS * 1000 / m_speed));
+        return;
+      }
+
+    sem_post(&m_idle);
+    sem_wait(&m_tick);
+  }
+
+  ssize_t read_file(RawFile &file, uint8_t *buf, size_t size, uint32_t *us)
+  {
+    uint32_t latency = m_latency_us;
+
+    m_reads++;
+    if ((m_stall_every > 0) && (m_reads % m_stall_every == 0))
+      {
+        latency += m_stall_us;
+      }
+
+    uint64_t start = wall_us();
+
+    if (latency > 0)
+      {
+        usleep((useconds_t)(latency / m_speed));
+      }
+
+    ssize_t ret = file.read(buf, size, NULL);
+
+    /* In the simulated time */
+
+    *us = (uint32_t)((wall_us() - start) * m_speed);
+
+    return ret;
+  }
+
+private:
+  bool     m_ending;
+  bool     m_free_run;
+  double   m_speed;
+  uint32_t m_latency_us;
+  uint32_t m_stall_every;
+  uint32_t m_stall_us;
+  uint32_t m_reads;
+  sem_t    m_idle;
+  sem_t    m_tick;
+};
+
+static CMN_SimpleFifoHandle s_fifo;
+static SimPlayerFeeder s_feeder;
+static AudioSimRender s_speaker;
+static AudioSimFormat s_fmt;
+static char **s_files;
+static int s_file_num;
+static int s_next;
+static bool s_free_run;
+
+static bool same_format(const AudioSimFormat &a, const AudioSimFormat &b)
+{
+  return (a.rate == b.rate) && (a.channels == b.channels) && (a.bits == b.bits);
+}
+
+static void queue_files()
+{
+  while ((s_next < s_file_num) && (s_feeder.queued() < PLAYERFEEDER_QUEUE_NUM))
+    {
+      AudioSimFormat fmt;
+      const char *path = s_files[s_next++];
+
+      if (!audiosim_read_wav(path, &fmt) || !same_format(fmt, s_fmt))
+        {
+          printf("Skip %s\n", path);
+          continue;
+        }
+
+      s_feeder.queue(path, fmt.dataOffset, fmt.dataSize);
+    }
+}
+
+static bool pump(void *arg)
+{
+  (void)arg;
+
+  queue_files();
+  if (!s_free_run)
+    {
+      s_feeder.step();
+    }
+
+  if ((s_next == s_file_num) && s_feeder.isEnd())
+    {
+      s_speaker.setEos();
+    }
+
+  return true;
+}
+
+static void usage()
+{
+  printf("Usage: sim_playback [-s speed] [-f fifo_size] [-n frame_samples]\n"
+         "                    [-r read_size] [-c] [-l latency_us]\n"
+         "                    [-t every:stall_us] output.wav input.wav...\n"
+         "  -s: Speed to real time, 0 without waiting (default: 1)\n"
+         "  -f: Bytes of the player FIFO (default: %d)\n"
+         "  -n: Samples of a frame (default: %d)\n"
+         "  -r: Bytes of a read of the feeder (default: %d)\n"
+         "  -c: Run the feeder on its own clock\n"
+         "  -l: Latency of each read with -c (default: 0)\n"
+         "  -t: Stall of every n-th read with -c (default: none)\n",
+         DEFAULT_FIFO_SIZE, DEFAULT_FRAME_SAMPLES, DEFAULT_READ_SIZE);
+}
+
+int main(int argc, char *argv[])
+{
+  double speed = 1.0;
+  size_t fifo_size = DEFAULT_FIFO_SIZE;
+  uint32_t frame_samples = DEFAULT_FRAME_SAMPLES;
+  size_t read_size = DEFAULT_READ_SIZE;
+  uint32_t latency_us = 0;
+  uint32_t stall_every = 0;
+  uint32_t stall_us = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "s:f:n:r:cl:t:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 's':
+            speed = atof(optarg);
+            break;
+          case 'f':
+            fifo_size = strtoul(optarg, NULL, 0);
+            break;
+          case 'n':
+            frame_samples = strtoul(optarg, NULL, 0);
+            break;
+          case 'r':
+            read_size = strtoul(optarg, NULL, 0);
+            break;
+          case 'c':
+            s_free_run = true;
+            break;
+          case 'l':
+            latency_us = strtoul(optarg, NULL, 0);
+            break;
+          case 't':
+            if (sscanf(optarg, "%u:%u", &stall_every, &stall_us) != 2)
+              {
+                usage();
+                return 1;
+              }
+            break;
+          default:
+            usage();
+            return 1;
+        }
+    }
+
+  if ((argc - optind < 2) || (speed < 0))
+    {
+      usage();
+      return 1;
+    }
+
+  /* The feeder on its own clock needs the simulated time to pass. */
+
+  if (s_free_run && (speed == 0))
+    {
+      printf("ERROR: -c needs a speed above 0.\n");
+      return 1;
+    }
+
+  if (!s_free_run && ((latency_us > 0) || (stall_every > 0)))
+    {
+      printf("ERROR: -l and -t need -c.\n");
+      return 1;
+    }
+
+  s_files = &argv[optind + 1];
+  s_file_num = argc - optind - 1;
+
+  /* The format of the first file is used for all files */
+
+  if (!audiosim_read_wav(s_files[0], &s_fmt))
+    {
+      return 1;
+    }
+
+  uint8_t *fifo_buf = (uint8_t *)malloc(fifo_size);
+  if ((fifo_buf == NULL) ||
+      (CMN_SimpleFifoInitialize(&s_fifo, fifo_buf, fifo_size, NULL) != 0))
+    {
+      printf("ERROR: Cannot create FIFO.\n");
+      return 1;
+    }
+
+  if (s_free_run)
+    {
+      s_feeder.setFreeRun(speed);
+      s_feeder.setLatency(latency_us, stall_every, stall_us);
+    }
+
+  if (!s_feeder.begin(&s_fifo, read_size) ||
+      !s_speaker.begin(&s_fifo, argv[optind], s_fmt, frame_samples))
+    {
+      return 1;
+    }
+
+  /* Fill the FIFO before starting the player */
+
+  queue_files();
+  if (s_free_run)
+    {
+      while ((CMN_SimpleFifoGetVacantSize(&s_fifo) >= read_size) &&
+             !s_feeder.isEnd())
+        {
+          usleep(1000);
+        }
+    }
+  else
+    {
+      s_feeder.step();
+    }
+
+  AudioSim sim;
+
+  sim.setSpeed(speed);
+  sim.add(&s_speaker);
+  sim.run(0, pump);
+
+  s_feeder.end();
+  s_speaker.end();
+
+  PlayerFeederStat feed;
+  AudioSimDeviceStat stat;
+  AudioSimStat run;
+
+  s_feeder.getStat(&feed);
+  s_speaker.getStat(&stat);
+  sim.getStat(&run);
+
+  printf("feeder: %llu bytes, tracks %lu, errors %lu, read max %lu us\n",
+         (unsigned long long)feed.bytes, (unsigned long)feed.tracks,
+         (unsigned long)feed.errors, (unsigned long)feed.maxReadUs);
+  printf("speaker: frames %lu, bytes %llu, underruns %lu, "
+         "FIFO min %lu bytes (%lu us)\n",
+         (unsigned long)stat.frames, (unsigned long long)stat.bytes,
+         (unsigned long)stat.underruns, (unsigned long)stat.minFifoUsed,
+         (unsigned long)s_speaker.bytesToUs(stat.minFifoUsed));
+  printf("time %llu us, wall %llu us, late max %lu us\n",
+         (unsigned long long)run.virtualUs, (unsigned long long)run.wallUs,
+         (unsigned long)run.maxLateUs);
+
+  free(fifo_buf);
+
+  return (stat.underruns > 0) ? 2 : 0;
+}
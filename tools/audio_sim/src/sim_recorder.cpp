@@ -0,0 +1,451 @@
+/*
+ *  sim_recorder.cpp - Recorder objects of the Audio library on the audio simulator
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * Runs MediaRecorder, or AudioClass with -a, on the stand-in of the SDK
+ * audio objects, with a WAV file as the microphone. The application reads
+ * the recorder FIFO once in each read interval, with peekFrames() and
+ * consumeFrames(), and writes the data into a WAV file as recorded. The
+ * recorder takes LPCM at 48kHz, so the output has the data of the input.
+ *
+ * With -g, a FrontEndChain with a gain stage processes the frames in the
+ * FrontEnd before the recorder, and the statistics of the stage are
+ * printed.
+ *
+ * Usage: sim_recorder [-a] [-s speed] [-f fifo_size] [-i interval_ms]
+ *                     [-g gain] [-t time_ms [-l]] input.wav output.wav
+ *
+ * Exit status is 0 if all frames are recorded, 2 if frames are dropped and
+ * 1 on other errors.
+ */
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <File.h>
+#include <Audio.h>
+#include <MediaRecorder.h>
+#include <FrontEnd.h>
+#include <FrontEndChain.h>
+#include <MemoryUtil.h>
+
+#include "AudioSimSdk.h"
+
+/* Same as READ_BUF_SIZE of AudioClass */
+
+#define DEFAULT_FIFO_SIZE (10 * 1024 * 2 * 8)
+
+#define DSP_PATH "/mnt/sd0/BIN"
+
+/* Gain on 16bit PCM, as the AGC of the recorder_wav_chain example */
+
+class GainStage : public FrontEndStage
+{
+public:
+  GainStage() : m_channels(0), m_gain(1.0f) {}
+
+  void setGain(float gain) { m_gain = gain; }
+
+  virtual bool begin(uint8_t channels, uint8_t bit_length, uint32_t samples)
+  {
+    m_channels = channels;
+    return (bit_length == AS_BITLENGTH_16);
+  }
+
+  virtual bool process(void *data, uint32_t samples)
+  {
+    int16_t *pcm = (int16_t *)data;
+    uint32_t num = samples * m_channels;
+
+    for (uint32_t i = 0; i < num; i++)
+      {
+        int32_t v = (int32_t)(pcm[i] * m_gain);
+        pcm[i] = (v > 32767) ? 32767 : ((v < -32768) ? -32768 : v);
+      }
+
+    return true;
+  }
+
+private:
+  uint8_t m_channels;
+  float   m_gain;
+};
+
+static AudioSim s_sim;
+static File s_file;
+static bool s_audio_class;
+static uint64_t s_interval_us = 10000;
+static uint64_t s_next_read_us;
+static uint32_t s_attentions;
+static bool s_error;
+
+static GainStage s_gain;
+static FrontEndChain s_chain;
+
+static void attention_cb(const ErrorAttentionParam *atprm)
+{
+  /* The warnings of dropped frames are counted in the statistics. */
+
+  s_attentions++;
+  if (atprm->error_code >= AS_ATTENTION_CODE_ERROR)
+    {
+      printf("Attention %d from module %d, sub code %lu\n",
+             atprm->error_code, atprm->module_id,
+             (unsigned long)atprm->error_att_sub_code);
+    }
+}
+
+static bool recorder_done_cb(AsRecorderEvent event, uint32_t result, uint32_t sub_result)
+{
+  if (result != AS_ECODE_OK)
+    {
+      printf("ERROR: Recorder event %d, result 0x%lx\n", event, (unsigned long)result);
+      s_error = true;
+    }
+
+  return true;
+}
+
+/* Same as AudioClass::readFrames(File&), on MediaRecorder */
+
+static err_t read_frames()
+{
+  if (s_audio_class)
+    {
+      return AudioClass::getInstance()->readFrames(s_file);
+    }
+
+  MediaRecorder *recorder = MediaRecorder::getInstance();
+  AudioFifoSpan span;
+
+  err_t err = recorder->peekFrames(&span);
+  if (err != MEDIARECORDER_ECODE_OK)
+    {
+      return err;
+    }
+
+  if ((span.size1 > 0) && (s_file.write(span.data1, span.size1) != span.size1))
+    {
+      return MEDIARECORDER_ECODE_FILEACCESS_ERROR;
+    }
+
+  if ((span.size2 > 0) && (s_file.write(span.data2, span.size2) != span.size2))
+    {
+      recorder->consumeFrames(span.size1);
+      return MEDIARECORDER_ECODE_FILEACCESS_ERROR;
+    }
+
+  return recorder->consumeFrames(span.size1 + span.size2);
+}
+
+static bool pump(void *arg)
+{
+  (void)arg;
+
+  /* loop() of the application wakes up once in the interval */
+
+  if (s_sim.now() >= s_next_read_us)
+    {
+      if (read_frames() != MEDIARECORDER_ECODE_OK)
+        {
+          printf("ERROR: Cannot read the frames.\n");
+          s_error = true;
+          return false;
+        }
+      s_next_read_us += s_interval_us;
+    }
+
+  return !s_error;
+}
+
+/* FILE_WRITE of the host appends, as theSD.remove() is not on the host. */
+
+static bool create_file(const char *name)
+{
+  char path[128];
+
+  if (strncmp(name, "/mnt/", 5) != 0)
+    {
+      snprintf(path, sizeof(path), "/mnt/sd0/%s", name);
+      name = path;
+    }
+
+  int fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      printf("ERROR: Cannot create %s.\n", name);
+      return false;
+    }
+
+  close(fd);
+
+  return true;
+}
+
+static bool begin_media_recorder(const AudioSimFormat &fmt, uint32_t fifo_size)
+{
+  MediaRecorder *recorder = MediaRecorder::getInstance();
+  uint8_t bits = (fmt.bits == 16) ? AS_BITLENGTH_16 : AS_BITLENGTH_24;
+
+  initMemoryPools();
+  createStaticPools(MEM_LAYOUT_RECORDER);
+
+  if ((recorder->begin(attention_cb) != MEDIARECORDER_ECODE_OK) ||
+      !recorder->setCapturingClkMode(MEDIARECORDER_CAPCLK_NORMAL) ||
+      (recorder->activate(AS_SETRECDR_STS_INPUTDEVICE_MIC, recorder_done_cb,
+                          fifo_size) != MEDIARECORDER_ECODE_OK))
+    {
+      return false;
+    }
+
+  /* The chain is set before init of the recorder. */
+
+  if (s_chain.getStageNum() > 0)
+    {
+      FrontEnd::getInstance()->setChain(&s_chain);
+    }
+
+  if ((recorder->init(AS_CODECTYPE_WAV, fmt.channels, AS_SAMPLINGRATE_48000,
+                      bits, AS_BITRATE_8000, DSP_PATH) != MEDIARECORDER_ECODE_OK) ||
+      (recorder->writeWavHeader(s_file) != MEDIARECORDER_ECODE_OK))
+    {
+      return false;
+    }
+
+  return (recorder->start() == MEDIARECORDER_ECODE_OK) && !s_error;
+}
+
+static void end_media_recorder()
+{
+  MediaRecorder *recorder = MediaRecorder::getInstance();
+
+  recorder->stop();
+
+  /* Get the remaining data */
+
+  read_frames();
+  recorder->writeWavHeader(s_file);
+  s_file.close();
+
+  recorder->deactivate();
+  recorder->end();
+  FrontEnd::getInstance()->setChain(NULL);
+
+  destroyStaticPools();
+  finalizeMemoryPools();
+}
+
+static bool begin_audio_class(const AudioSimFormat &fmt, uint32_t fifo_size)
+{
+  AudioClass *audio = AudioClass::getInstance();
+  uint8_t bits = (fmt.bits == 16) ? AS_BITLENGTH_16 : AS_BITLENGTH_24;
+
+  return (audio->begin(attention_cb) == AUDIOLIB_ECODE_OK) &&
+         (audio->setRecorderMode(AS_SETRECDR_STS_INPUTDEVICE_MIC, 0,
+                                 fifo_size) == AUDIOLIB_ECODE_OK) &&
+         (audio->initRecorder(AS_CODECTYPE_WAV, DSP_PATH, AS_SAMPLINGRATE_48000,
+                              bits, fmt.channels) == AUDIOLIB_ECODE_OK) &&
+         (audio->writeWavHeader(s_file) == AUDIOLIB_ECODE_OK) &&
+         (audio->startRecorder() == AUDIOLIB_ECODE_OK);
+}
+
+static void end_audio_class()
+{
+  AudioClass *audio = AudioClass::getInstance();
+
+  audio->stopRecorder();
+
+  /* Get the remaining data */
+
+  read_frames();
+  audio->writeWavHeader(s_file);
+  s_file.close();
+
+  audio->setReadyMode();
+  audio->end();
+}
+
+static void print_chain_stat()
+{
+  FrontEndStageStat stat;
+
+  for (int i = 0; i < s_chain.getStageNum(); i++)
+    {
+      s_chain.getStat(i, &stat);
+      printf("%s: frames %lu, errors %lu, ns avg %lu, max %lu\n",
+             stat.name, (unsigned long)stat.frames, (unsigned long)stat.errors,
+             (unsigned long)((stat.frames > 0) ? stat.totalCycles / stat.frames : 0),
+             (unsigned long)stat.maxCycles);
+    }
+}
+
+static void usage()
+{
+  printf("Usage: sim_recorder [-a] [-s speed] [-f fifo_size] [-i interval_ms]\n"
+         "                    [-g gain] [-t time_ms [-l]] input.wav output.wav\n"
+         "  -a: Record with AudioClass instead of MediaRecorder\n"
+         "  -s: Speed to real time, 0 for no wait (default: 0)\n"
+         "  -f: Bytes of the recorder FIFO (default: %d)\n"
+         "  -i: Read interval of the application in ms (default: 10)\n"
+         "  -g: Gain of a FrontEndChain stage, on 16bit without -a\n"
+         "  -t: Record for the time, or to the end of the input\n"
+         "  -l: Repeat the input, with -t\n"
+         "  The input is 48kHz, 16bit or 32bit for 24bit. output.wav is a\n"
+         "  name on the SD card, or an absolute path.\n",
+         DEFAULT_FIFO_SIZE);
+}
+
+int main(int argc, char *argv[])
+{
+  double speed = 0;
+  uint32_t fifo_size = DEFAULT_FIFO_SIZE;
+  float gain = 0;
+  bool loop = false;
+  uint64_t duration_us = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "as:f:i:g:lt:h")) != -1)
+    {
+      switch (opt)
+        {
+          case 'a':
+            s_audio_class = true;
+            break;
+          case 's':
+            speed = atof(optarg);
+            break;
+          case 'f':
+            fifo_size = strtoul(optarg, NULL, 0);
+            break;
+          case 'i':
+            s_interval_us = strtoull(optarg, NULL, 0) * 1000;
+            break;
+          case 'g':
+            gain = atof(optarg);
+            break;
+          case 'l':
+            loop = true;
+            break;
+          case 't':
+            duration_us = strtoull(optarg, NULL, 0) * 1000;
+            break;
+          default:
+            usage();
+            return 1;
+        }
+    }
+
+  if ((argc - optind != 2) || (speed < 0) || (s_audio_class && (gain > 0)))
+    {
+      usage();
+      return 1;
+    }
+
+  if (loop && (duration_us == 0))
+    {
+      printf("ERROR: -l needs -t.\n");
+      return 1;
+    }
+
+  AudioSimFormat fmt;
+
+  if (!audiosim_read_wav(argv[optind], &fmt))
+    {
+      return 1;
+    }
+
+  /* The MicFrontend does not return the error of its start. */
+
+  if ((fmt.rate != AS_SAMPLINGRATE_48000) || ((fmt.bits != 16) && (fmt.bits != 32)))
+    {
+      printf("ERROR: Input is not 48kHz 16bit or 32bit.\n");
+      return 1;
+    }
+
+  if (gain > 0)
+    {
+      s_gain.setGain(gain);
+      s_chain.add(&s_gain, "gain");
+    }
+
+  if (!create_file(argv[optind + 1]))
+    {
+      return 1;
+    }
+
+  s_file = File(argv[optind + 1], FILE_WRITE);
+  if (!s_file)
+    {
+      return 1;
+    }
+
+  s_sim.setSpeed(speed);
+  if (!audiosim_sdk_begin(&s_sim, argv[optind], loop, NULL))
+    {
+      return 1;
+    }
+
+  bool ok = s_audio_class ? begin_audio_class(fmt, fifo_size) :
+                            begin_media_recorder(fmt, fifo_size);
+  if (!ok)
+    {
+      printf("ERROR: Cannot start the recorder.\n");
+      return 1;
+    }
+
+  s_next_read_us = s_sim.now() + s_interval_us;
+  s_sim.run(duration_us, pump);
+
+  if (s_audio_class)
+    {
+      end_audio_class();
+    }
+  else
+    {
+      end_media_recorder();
+    }
+
+  audiosim_sdk_end();
+
+  AudioSimDeviceStat stat;
+  AudioSimStat sim;
+
+  audiosim_sdk_get_mic_stat(&stat);
+  s_sim.getStat(&sim);
+
+  printf("frames %lu, bytes %llu, overruns %lu, attentions %lu\n",
+         (unsigned long)stat.frames, (unsigned long long)stat.bytes,
+         (unsigned long)stat.overruns, (unsigned long)s_attentions);
+  printf("FIFO max %lu bytes\n", (unsigned long)stat.maxFifoUsed);
+  printf("time %llu us, wall %llu us, late max %lu us\n",
+         (unsigned long long)sim.virtualUs, (unsigned long long)sim.wallUs,
+         (unsigned long)sim.maxLateUs);
+
+  print_chain_stat();
+
+  if (s_error)
+    {
+      return 1;
+    }
+
+  return (stat.overruns > 0) ? 2 : 0;
+}
@@ -0,0 +1,107 @@
+/*
+ *  Arduino.h - Host stand-in of the Arduino core for the DSP host build
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * The part of the core used by the SignalProcessing sketches. The sketches
+ * do not include Arduino.h themselves, so the Makefile gives this file
+ * with -include, as the Arduino IDE does.
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <malloc.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The heap of the host grows on demand */
+
+#define USER_HEAP_SIZE(size)
+
+/* mallinfo() of glibc is deprecated, and its counters are int */
+
+#define mallinfo mallinfo2
+
+#define LED0 0
+#define LED1 1
+#define LED2 2
+#define LED3 3
+
+static inline uint32_t micros(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+static inline uint32_t millis(void)
+{
+  return micros() / 1000;
+}
+
+static inline void delay(uint32_t ms)
+{
+  usleep(ms * 1000);
+}
+
+static inline void ledOn(uint8_t pin)
+{
+  (void)pin;
+}
+
+static inline void ledOff(uint8_t pin)
+{
+  (void)pin;
+}
+
+/* Serial is the standard output. The sketches print with printf(). */
+
+class HostSerial
+{
+public:
+  void begin(unsigned long baud)
+  {
+    (void)baud;
+  }
+
+  operator bool()
+  {
+    return true;
+  }
+
+  void print(const char *str)
+  {
+    fputs(str, stdout);
+  }
+
+  void println(const char *str)
+  {
+    puts(str);
+  }
+};
+
+static HostSerial Serial __attribute__((unused));
+
+#endif /* Arduino_h */
@@ -0,0 +1,146 @@
+/*
+ *  arm_math.h - Portable stand-in of CMSIS-DSP for host builds
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * The functions of CMSIS-DSP used by the SignalProcessing library, in
+ * plain C for a Linux host. The data formats and the scaling are the same
+ * as CMSIS-DSP, so the library and its sketches give the same results
+ * within the rounding of float:
+ *
+ *  - arm_rfft_fast_f32 packs X[0] and X[N/2] into the first 2 values.
+ *  - arm_rfft_q15/q31 write the full complex spectrum, scaled down by N/2.
+ *  - arm_cmplx_mag_q15/q31 output in 2.14/2.30 format.
+ *  - The float to fixed conversions truncate and saturate.
+ *
+ * The speed is not the speed of the Cortex-M4. Use the host build to check
+ * the results and to compare the code paths with each other.
+ */
+
+#ifndef _ARM_MATH_H
+#define _ARM_MATH_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PI 3.14159265358979f
+
+typedef int8_t  q7_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+typedef float   float32_t;
+typedef double  float64_t;
+
+typedef enum {
+  ARM_MATH_SUCCESS        =  0,
+  ARM_MATH_ARGUMENT_ERROR = -1,
+  ARM_MATH_LENGTH_ERROR   = -2,
+  ARM_MATH_SIZE_MISMATCH  = -3,
+  ARM_MATH_NANINF         = -4,
+  ARM_MATH_SINGULAR       = -5,
+  ARM_MATH_TEST_FAILURE   = -6
+} arm_status;
+
+typedef struct {
+  uint16_t fftLenRFFT;
+} arm_rfft_fast_instance_f32;
+
+typedef struct {
+  uint32_t fftLenReal;
+  uint8_t  ifftFlagR;
+  uint8_t  bitReverseFlagR;
+} arm_rfft_instance_q15;
+
+typedef arm_rfft_instance_q15 arm_rfft_instance_q31;
+
+typedef struct {
+  uint8_t          numStages;
+  float32_t       *pState;
+  const float32_t *pCoeffs;
+} arm_biquad_cascade_df2T_instance_f32;
+
+/* Basic math */
+
+float32_t arm_sin_f32(float32_t x);
+float32_t arm_cos_f32(float32_t x);
+arm_status arm_sqrt_f32(float32_t in, float32_t *pOut);
+
+void arm_copy_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_copy_q15(const q15_t *pSrc, q15_t *pDst, uint32_t blockSize);
+void arm_mult_f32(const float32_t *pSrcA, const float32_t *pSrcB,
+                  float32_t *pDst, uint32_t blockSize);
+void arm_mult_q15(const q15_t *pSrcA, const q15_t *pSrcB,
+                  q15_t *pDst, uint32_t blockSize);
+void arm_mult_q31(const q31_t *pSrcA, const q31_t *pSrcB,
+                  q31_t *pDst, uint32_t blockSize);
+
+/* Conversion */
+
+void arm_q15_to_float(const q15_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_q15_to_q31(const q15_t *pSrc, q31_t *pDst, uint32_t blockSize);
+void arm_float_to_q15(const float32_t *pSrc, q15_t *pDst, uint32_t blockSize);
+void arm_float_to_q31(const float32_t *pSrc, q31_t *pDst, uint32_t blockSize);
+
+/* Complex magnitude */
+
+void arm_cmplx_mag_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples);
+void arm_cmplx_mag_q15(const q15_t *pSrc, q15_t *pDst, uint32_t numSamples);
+void arm_cmplx_mag_q31(const q31_t *pSrc, q31_t *pDst, uint32_t numSamples);
+
+/* Real FFT */
+
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen);
+arm_status arm_rfft_32_fast_init_f32(arm_rfft_fast_instance_f32 *S);
+arm_status arm_rfft_64_fast_init_f32(arm_rfft_fast_instance_f32 *S);
+arm_status arm_rfft_128_fast_init_f32(arm_rfft_fast_instance_f32 *S);
+arm_status arm_rfft_256_fast_init_f32(arm_rfft_fast_instance_f32 *S);
+arm_status arm_rfft_512_fast_init_f32(arm_rfft_fast_instance_f32 *S);
+arm_status arm_rfft_1024_fast_init_f32(arm_rfft_fast_instance_f32 *S);
+arm_status arm_rfft_2048_fast_init_f32(arm_rfft_fast_instance_f32 *S);
+arm_status arm_rfft_4096_fast_init_f32(arm_rfft_fast_instance_f32 *S);
+void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32 *S,
+                       float32_t *p, float32_t *pOut, uint8_t ifftFlag);
+
+arm_status arm_rfft_init_q15(arm_rfft_instance_q15 *S, uint32_t fftLenReal,
+                             uint32_t ifftFlagR, uint32_t bitReverseFlag);
+void arm_rfft_q15(const arm_rfft_instance_q15 *S, q15_t *pSrc, q15_t *pDst);
+arm_status arm_rfft_init_q31(arm_rfft_instance_q31 *S, uint32_t fftLenReal,
+                             uint32_t ifftFlagR, uint32_t bitReverseFlag);
+void arm_rfft_q31(const arm_rfft_instance_q31 *S, q31_t *pSrc, q31_t *pDst);
+
+/* Biquad filter */
+
+void arm_biquad_cascade_df2T_init_f32(arm_biquad_cascade_df2T_instance_f32 *S,
+                                      uint8_t numStages,
+                                      const float32_t *pCoeffs,
+                                      float32_t *pState);
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S,
+                                 const float32_t *pSrc, float32_t *pDst,
+                                 uint32_t blockSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ARM_MATH_H */
@@ -0,0 +1,508 @@
+/*
+ *  arm_math_host.cpp - Portable stand-in of CMSIS-DSP for host builds
+ *  Copyright 2022 Sony Semiconductor Solutions Corporation
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cmsis/arm_math.h>
+
+#include <stdint.h>
+#include <math.h>
+
+/* The longest transform of CMSIS-DSP (arm_rfft_q15/q31) */
+
+#define FFT_MAX_LEN 8192
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static inline q15_t sat_q15(int64_t x)
+{
+  return (q15_t)((x > INT16_MAX) ? INT16_MAX : (x < INT16_MIN) ? INT16_MIN : x);
+}
+
+static inline q31_t sat_q31(int64_t x)
+{
+  return (q31_t)((x > INT32_MAX) ? INT32_MAX : (x < INT32_MIN) ? INT32_MIN : x);
+}
+
+static bool is_fft_len(uint32_t len, uint32_t min, uint32_t max)
+{
+  return (len >= min) && (len <= max) && ((len & (len - 1)) == 0);
+}
+
+/* exp(-2*pi*i*k/FFT_MAX_LEN) for k < FFT_MAX_LEN/2, built once.
+ * A transform of length N takes every (FFT_MAX_LEN/N)th entry.
+ */
+
+struct Twiddle
+{
+  double re[FFT_MAX_LEN / 2];
+  double im[FFT_MAX_LEN / 2];
+
+  Twiddle()
+  {
+    for (int k = 0; k < FFT_MAX_LEN / 2; k++)
+      {
+        re[k] = cos(2.0 * M_PI * k / FFT_MAX_LEN);
+        im[k] = -sin(2.0 * M_PI * k / FFT_MAX_LEN);
+      }
+  }
+};
+
+static const Twiddle &twiddle()
+{
+  static const Twiddle table;
+  return table;
+}
+
+/* In-place radix-2 complex FFT on interleaved re/im pairs in double.
+ * inverse conjugates the twiddles, and does not scale.
+ */
+
+static void cfft(double *buf, uint32_t len, bool inverse)
+{
+  const Twiddle &tw = twiddle();
+
+  /* Bit reversal */
+
+  for (uint32_t i = 1, j = 0; i < len; i++)
+    {
+      uint32_t bit = len >> 1;
+      for (; j & bit; bit >>= 1)
+        {
+          j ^= bit;
+        }
+      j ^= bit;
+
+      if (i < j)
+        {
+          double re = buf[2 * i];
+          double im = buf[2 * i + 1];
+          buf[2 * i]     = buf[2 * j];
+          buf[2 * i + 1] = buf[2 * j + 1];
+          buf[2 * j]     = re;
+          buf[2 * j + 1] = im;
+        }
+    }
+
+  /* Butterflies */
+
+  for (uint32_t size = 2; size <= len; size <<= 1)
+    {
+      uint32_t half = size >> 1;
+      uint32_t step = FFT_MAX_LEN / size;
+
+      for (uint32_t start = 0; start < len; start += size)
+        {
+          for (uint32_t k = 0; k < half; k++)
+            {
+              double wr = tw.re[k * step];
+              double wi = inverse ? -tw.im[k * step] : tw.im[k * step];
+              double *a = &buf[2 * (start + k)];
+              double *b = &buf[2 * (start + k + half)];
+              double tr = b[0] * wr - b[1] * wi;
+              double ti = b[0] * wi + b[1] * wr;
+
+              b[0] = a[0] - tr;
+              b[1] = a[1] - ti;
+              a[0] += tr;
+              a[1] += ti;
+            }
+        }
+    }
+}
+
+/* Work area of the transforms, one per thread as the library may run
+ * on several threads.
+ */
+
+static double *work()
+{
+  static thread_local double buf[2 * FFT_MAX_LEN];
+  return buf;
+}
+
+/* Full complex spectrum of a real input of len samples into work() */
+
+template <typename T> static double *real_fft(const T *src, uint32_t len)
+{
+  double *buf = work();
+
+  for (uint32_t i = 0; i < len; i++)
+    {
+      buf[2 * i]     = (double)src[i];
+      buf[2 * i + 1] = 0.0;
+    }
+
+  cfft(buf, len, false);
+  return buf;
+}
+
+/****************************************************************************
+ * Basic math
+ ****************************************************************************/
+
+float32_t arm_sin_f32(float32_t x)
+{
+  return sinf(x);
+}
+
+float32_t arm_cos_f32(float32_t x)
+{
+  return cosf(x);
+}
+
+arm_status arm_sqrt_f32(float32_t in, float32_t *pOut)
+{
+  if (in >= 0.0f)
+    {
+      *pOut = sqrtf(in);
+      return ARM_MATH_SUCCESS;
+    }
+
+  *pOut = 0.0f;
+  return ARM_MATH_ARGUMENT_ERROR;
+}
+
+void arm_copy_f32(const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+  memmove(pDst, pSrc, blockSize * sizeof(float32_t));
+}
+
+void arm_copy_q15(const q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  memmove(pDst, pSrc, blockSize * sizeof(q15_t));
+}
+
+void arm_mult_f32(const float32_t *pSrcA, const float32_t *pSrcB,
+                  float32_t *pDst, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+    {
+      pDst[i] = pSrcA[i] * pSrcB[i];
+    }
+}
+
+void arm_mult_q15(const q15_t *pSrcA, const q15_t *pSrcB,
+                  q15_t *pDst, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+    {
+      pDst[i] = sat_q15(((int32_t)pSrcA[i] * pSrcB[i]) >> 15);
+    }
+}
+
+void arm_mult_q31(const q31_t *pSrcA, const q31_t *pSrcB,
+                  q31_t *pDst, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+    {
+      pDst[i] = sat_q31(((int64_t)pSrcA[i] * pSrcB[i]) >> 31);
+    }
+}
+
+/****************************************************************************
+ * Conversion
+ ****************************************************************************/
+
+void arm_q15_to_float(const q15_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+    {
+      pDst[i] = (float32_t)pSrc[i] / 32768.0f;
+    }
+}
+
+void arm_q15_to_q31(const q15_t *pSrc, q31_t *pDst, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+    {
+      pDst[i] = (q31_t)((uint32_t)(int32_t)pSrc[i] << 16);
+    }
+}
+
+/* Truncated toward zero, as CMSIS-DSP without ARM_MATH_ROUNDING */
+
+void arm_float_to_q15(const float32_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+    {
+      pDst[i] = sat_q15((int32_t)(pSrc[i] * 32768.0f));
+    }
+}
+
+void arm_float_to_q31(const float32_t *pSrc, q31_t *pDst, uint32_t blockSize)
+{
+  for (uint32_t i = 0; i < blockSize; i++)
+    {
+      pDst[i] = sat_q31((int64_t)((double)pSrc[i] * 2147483648.0));
+    }
+}
+
+/****************************************************************************
+ * Complex magnitude
+ ****************************************************************************/
+
+void arm_cmplx_mag_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples)
+{
+  for (uint32_t i = 0; i < numSamples; i++)
+    {
+      float32_t re = pSrc[2 * i];
+      float32_t im = pSrc[2 * i + 1];
+      pDst[i] = sqrtf(re * re + im * im);
+    }
+}
+
+/* The result is in 2.14 (q15) or 2.30 (q31) format, i.e. half of the raw
+ * magnitude.
+ */
+
+void arm_cmplx_mag_q15(const q15_t *pSrc, q15_t *pDst, uint32_t numSamples)
+{
+  for (uint32_t i = 0; i < numSamples; i++)
+    {
+      int32_t re = pSrc[2 * i];
+      int32_t im = pSrc[2 * i + 1];
+      pDst[i] = sat_q15((int64_t)(sqrt((double)(re * re + im * im)) / 2.0));
+    }
+}
+
+void arm_cmplx_mag_q31(const q31_t *pSrc, q31_t *pDst, uint32_t numSamples)
+{
+  for (uint32_t i = 0; i < numSamples; i++)
+    {
+      double re = pSrc[2 * i];
+      double im = pSrc[2 * i + 1];
+      pDst[i] = sat_q31((int64_t)(sqrt(re * re + im * im) / 2.0));
+    }
+}
+
+/****************************************************************************
+ * Real FFT in float
+ ****************************************************************************/
+
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen)
+{
+  if (!is_fft_len(fftLen, 32, 4096))
+    {
+      return ARM_MATH_ARGUMENT_ERROR;
+    }
+
+  S->fftLenRFFT = fftLen;
+  twiddle();
+  return ARM_MATH_SUCCESS;
+}
+
+arm_status arm_rfft_32_fast_init_f32(arm_rfft_fast_instance_f32 *S)
+{
+  return arm_rfft_fast_init_f32(S, 32);
+}
+
+arm_status arm_rfft_64_fast_init_f32(arm_rfft_fast_instance_f32 *S)
+{
+  return arm_rfft_fast_init_f32(S, 64);
+}
+
+arm_status arm_rfft_128_fast_init_f32(arm_rfft_fast_instance_f32 *S)
+{
+  return arm_rfft_fast_init_f32(S, 128);
+}
+
+arm_status arm_rfft_256_fast_init_f32(arm_rfft_fast_instance_f32 *S)
+{
+  return arm_rfft_fast_init_f32(S, 256);
+}
+
+arm_status arm_rfft_512_fast_init_f32(arm_rfft_fast_instance_f32 *S)
+{
+  return arm_rfft_fast_init_f32(S, 512);
+}
+
+arm_status arm_rfft_1024_fast_init_f32(arm_rfft_fast_instance_f32 *S)
+{
+  return arm_rfft_fast_init_f32(S, 1024);
+}
+
+arm_status arm_rfft_2048_fast_init_f32(arm_rfft_fast_instance_f32 *S)
+{
+  return arm_rfft_fast_init_f32(S, 2048);
+}
+
+arm_status arm_rfft_4096_fast_init_f32(arm_rfft_fast_instance_f32 *S)
+{
+  return arm_rfft_fast_init_f32(S, 4096);
+}
+
+/* Forward: pOut = { X[0].re, X[N/2].re, X[1].re, X[1].im, ... X[N/2-1].im }
+ * Inverse: p is in the packed format above, and pOut gets x[n] scaled by 1/N.
+ */
+
+void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32 *S,
+                       float32_t *p, float32_t *pOut, uint8_t ifftFlag)
+{
+  uint32_t len = S->fftLenRFFT;
+
+  if (!ifftFlag)
+    {
+      double *buf = real_fft(p, len);
+
+      pOut[0] = (float32_t)buf[0];
+      pOut[1] = (float32_t)buf[len];
+      for (uint32_t k = 1; k < len / 2; k++)
+        {
+          pOut[2 * k]     = (float32_t)buf[2 * k];
+          pOut[2 * k + 1] = (float32_t)buf[2 * k + 1];
+        }
+    }
+  else
+    {
+      double *buf = work();
+
+      buf[0]       = p[0];
+      buf[1]       = 0.0;
+      buf[len]     = p[1];
+      buf[len + 1] = 0.0;
+      for (uint32_t k = 1; k < len / 2; k++)
+        {
+          buf[2 * k]             = p[2 * k];
+          buf[2 * k + 1]         = p[2 * k + 1];
+          buf[2 * (len - k)]     = p[2 * k];
+          buf[2 * (len - k) + 1] = -p[2 * k + 1];
+        }
+
+      cfft(buf, len, true);
+
+      for (uint32_t i = 0; i < len; i++)
+        {
+          pOut[i] = (float32_t)(buf[2 * i] / len);
+        }
+    }
+}
+
+/****************************************************************************
+ * Real FFT in fixed point
+ ****************************************************************************/
+
+/* Only the forward transform with the bit reversal is provided */
+
+static arm_status rfft_init_fixed(arm_rfft_instance_q15 *S, uint32_t fftLenReal,
+                                  uint32_t ifftFlagR, uint32_t bitReverseFlag)
+{
+  if (!is_fft_len(fftLenReal, 32, FFT_MAX_LEN) || ifftFlagR || !bitReverseFlag)
+    {
+      return ARM_MATH_ARGUMENT_ERROR;
+    }
+
+  S->fftLenReal      = fftLenReal;
+  S->ifftFlagR       = (uint8_t)ifftFlagR;
+  S->bitReverseFlagR = (uint8_t)bitReverseFlag;
+  twiddle();
+  return ARM_MATH_SUCCESS;
+}
+
+arm_status arm_rfft_init_q15(arm_rfft_instance_q15 *S, uint32_t fftLenReal,
+                             uint32_t ifftFlagR, uint32_t bitReverseFlag)
+{
+  return rfft_init_fixed(S, fftLenReal, ifftFlagR, bitReverseFlag);
+}
+
+arm_status arm_rfft_init_q31(arm_rfft_instance_q31 *S, uint32_t fftLenReal,
+                             uint32_t ifftFlagR, uint32_t bitReverseFlag)
+{
+  return rfft_init_fixed(S, fftLenReal, ifftFlagR, bitReverseFlag);
+}
+
+/* pDst gets all the len complex values, scaled down by len/2 */
+
+void arm_rfft_q15(const arm_rfft_instance_q15 *S, q15_t *pSrc, q15_t *pDst)
+{
+  uint32_t len = S->fftLenReal;
+  double *buf = real_fft(pSrc, len);
+  double scale = 2.0 / len;
+
+  for (uint32_t i = 0; i < 2 * len; i++)
+    {
+      pDst[i] = sat_q15((int64_t)floor(buf[i] * scale));
+    }
+}
+
+void arm_rfft_q31(const arm_rfft_instance_q31 *S, q31_t *pSrc, q31_t *pDst)
+{
+  uint32_t len = S->fftLenReal;
+  double *buf = real_fft(pSrc, len);
+  double scale = 2.0 / len;
+
+  for (uint32_t i = 0; i < 2 * len; i++)
+    {
+      pDst[i] = sat_q31((int64_t)floor(buf[i] * scale));
+    }
+}
+
+/****************************************************************************
+ * Biquad filter
+ ****************************************************************************/
+
+void arm_biquad_cascade_df2T_init_f32(arm_biquad_cascade_df2T_instance_f32 *S,
+                                      uint8_t numStages,
+                                      const float32_t *pCoeffs,
+                                      float32_t *pState)
+{
+  S->numStages = numStages;
+  S->pCoeffs   = pCoeffs;
+  S->pState    = pState;
+  memset(pState, 0, 2 * numStages * sizeof(float32_t));
+}
+
+/* Each stage has { b0, b1, b2, a1, a2 }, with the feedback coefficients
+ * already negated as CMSIS-DSP expects.
+ */
+
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S,
+                                 const float32_t *pSrc, float32_t *pDst,
+                                 uint32_t blockSize)
+{
+  const float32_t *coef = S->pCoeffs;
+  float32_t *state = S->pState;
+  const float32_t *in = pSrc;
+
+  for (uint8_t stage = 0; stage < S->numStages; stage++)
+    {
+      float32_t b0 = coef[0];
+      float32_t b1 = coef[1];
+      float32_t b2 = coef[2];
+      float32_t a1 = coef[3];
+      float32_t a2 = coef[4];
+      float32_t d1 = state[0];
+      float32_t d2 = state[1];
+
+      for (uint32_t i = 0; i < blockSize; i++)
+        {
+          float32_t x = in[i];
+          float32_t y = b0 * x + d1;
+          d1 = b1 * x + a1 * y + d2;
+          d2 = b2 * x + a2 * y;
+          pDst[i] = y;
+        }
+
+      state[0] = d1;
+      state[1] = d2;
+      coef  += 5;
+      state += 2;
+      in = pDst;
+    }
+}